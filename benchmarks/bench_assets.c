@@ -0,0 +1,429 @@
+#include "bench_framework.h"
+#include "bench_fixtures.h"
+
+#include "assets.h"
+#include "tree.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define ASSET_BENCH_ROOT "bench_assets_tmp"
+#define ASSET_BENCH_DIRECTORIES 100U
+#define ASSET_BENCH_FILES_PER_DIRECTORY 1000U
+#define ASSET_BENCH_EXPORT_ROOT "bench_export_tmp"
+#define ASSET_BENCH_EXPORT_FILES 64U
+#define ASSET_BENCH_EXPORT_FILE_BYTES (4U * 1024U * 1024U)
+#define ASSET_BENCH_TEXT_FILES 32U
+#define ASSET_BENCH_TEXT_FILE_BYTES (2U * 1024U * 1024U)
+
+static bool bench_assets_make_directory(const char *path)
+{
+#if defined(_WIN32)
+    return _mkdir(path) == 0 || errno == EEXIST;
+#else
+    return mkdir(path, 0775) == 0 || errno == EEXIST;
+#endif
+}
+
+static void bench_assets_remove_directory(const char *path)
+{
+#if defined(_WIN32)
+    (void)_rmdir(path);
+#else
+    (void)rmdir(path);
+#endif
+}
+
+static void bench_assets_file_path(char *buffer, size_t capacity, unsigned int directory, unsigned int file)
+{
+    (void)snprintf(buffer, capacity, "imports/dir_%03u/file_%05u.bin", directory, file);
+}
+
+/* ASSET_BENCH_DIRECTORIES folders under imports; every other file is referenced by its own person. */
+static FamilyTree *bench_assets_build_fixture(void)
+{
+    char path[256];
+    if (!bench_assets_make_directory(ASSET_BENCH_ROOT) || !bench_assets_make_directory(ASSET_BENCH_ROOT "/imports"))
+    {
+        return NULL;
+    }
+    FamilyTree *tree = family_tree_create("Asset Benchmark");
+    if (!tree)
+    {
+        return NULL;
+    }
+    uint32_t next_id = 1U;
+    for (unsigned int directory = 0U; directory < ASSET_BENCH_DIRECTORIES; ++directory)
+    {
+        (void)snprintf(path, sizeof(path), "%s/imports/dir_%03u", ASSET_BENCH_ROOT, directory);
+        if (!bench_assets_make_directory(path))
+        {
+            family_tree_destroy(tree);
+            return NULL;
+        }
+        for (unsigned int file = 0U; file < ASSET_BENCH_FILES_PER_DIRECTORY; ++file)
+        {
+            char relative[128];
+            bench_assets_file_path(relative, sizeof(relative), directory, file);
+            (void)snprintf(path, sizeof(path), "%s/%s", ASSET_BENCH_ROOT, relative);
+            FILE *stream = fopen(path, "wb");
+            if (!stream || fputs("asset", stream) < 0 || fclose(stream) != 0)
+            {
+                family_tree_destroy(tree);
+                return NULL;
+            }
+            if (file % 2U != 0U)
+            {
+                continue;
+            }
+            Person *person = family_tree_create_person(tree, next_id++);
+            if (!person || !family_tree_add_person(tree, person))
+            {
+                person_destroy(person);
+                family_tree_destroy(tree);
+                return NULL;
+            }
+            if (!person_add_certificate(person, relative))
+            {
+                family_tree_destroy(tree);
+                return NULL;
+            }
+        }
+    }
+    return tree;
+}
+
+static void bench_assets_remove_fixture(void)
+{
+    char path[256];
+    for (unsigned int directory = 0U; directory < ASSET_BENCH_DIRECTORIES; ++directory)
+    {
+        for (unsigned int file = 0U; file < ASSET_BENCH_FILES_PER_DIRECTORY; ++file)
+        {
+            char relative[128];
+            bench_assets_file_path(relative, sizeof(relative), directory, file);
+            (void)snprintf(path, sizeof(path), "%s/%s", ASSET_BENCH_ROOT, relative);
+            (void)remove(path);
+        }
+        (void)snprintf(path, sizeof(path), "%s/imports/dir_%03u", ASSET_BENCH_ROOT, directory);
+        bench_assets_remove_directory(path);
+    }
+    bench_assets_remove_directory(ASSET_BENCH_ROOT "/imports");
+    bench_assets_remove_directory(ASSET_BENCH_ROOT);
+}
+
+/* worker_count 1 goes through asset_cleanup, anything else through asset_cleanup_parallel. */
+static void bench_assets_run_cleanup(const char *label, size_t worker_count)
+{
+    FamilyTree *tree = bench_assets_build_fixture();
+    if (!tree)
+    {
+        fprintf(stderr, "  fixture setup failed\n");
+        bench_assets_remove_fixture();
+        return;
+    }
+    AssetCleanupStats stats;
+    char error[256];
+    double start = bench_now_seconds();
+    bool ok = worker_count == 1U
+                  ? asset_cleanup(tree, ASSET_BENCH_ROOT, "imports", &stats, error, sizeof(error))
+                  : asset_cleanup_parallel(tree, ASSET_BENCH_ROOT, "imports", worker_count, &stats, error,
+                                           sizeof(error));
+    double elapsed = bench_now_seconds() - start;
+    if (!ok)
+    {
+        fprintf(stderr, "  cleanup failed: %s\n", error);
+    }
+    bench_report_rate(label, (size_t)ASSET_BENCH_DIRECTORIES * ASSET_BENCH_FILES_PER_DIRECTORY, "files", elapsed);
+    printf("  referenced %zu, removed %zu\n", stats.referenced_files, stats.removed_files);
+    family_tree_destroy(tree);
+    bench_assets_remove_fixture();
+}
+
+static void bench_assets_cleanup(void)
+{
+    bench_assets_run_cleanup("cleanup, serial", 1U);
+    bench_assets_run_cleanup("cleanup, parallel", 0U);
+}
+
+static void bench_assets_remove_export_fixture(void)
+{
+    char path[256];
+    for (unsigned int file = 0U; file < ASSET_BENCH_EXPORT_FILES; ++file)
+    {
+        (void)snprintf(path, sizeof(path), "%s/assets/imports/scan_%02u.bin", ASSET_BENCH_EXPORT_ROOT, file);
+        (void)remove(path);
+    }
+    (void)remove(ASSET_BENCH_EXPORT_ROOT "/tree.json");
+    (void)remove(ASSET_BENCH_EXPORT_ROOT "/export.atpkg");
+    bench_assets_remove_directory(ASSET_BENCH_EXPORT_ROOT "/assets/imports");
+    bench_assets_remove_directory(ASSET_BENCH_EXPORT_ROOT "/assets");
+    bench_assets_remove_directory(ASSET_BENCH_EXPORT_ROOT);
+}
+
+/* Large scans, one certificate each, packaged into a single file. */
+static FamilyTree *bench_assets_build_export_fixture(void)
+{
+    if (!bench_assets_make_directory(ASSET_BENCH_EXPORT_ROOT) ||
+        !bench_assets_make_directory(ASSET_BENCH_EXPORT_ROOT "/assets") ||
+        !bench_assets_make_directory(ASSET_BENCH_EXPORT_ROOT "/assets/imports"))
+    {
+        return NULL;
+    }
+    FILE *json = fopen(ASSET_BENCH_EXPORT_ROOT "/tree.json", "wb");
+    if (!json || fputs("{}", json) < 0 || fclose(json) != 0)
+    {
+        return NULL;
+    }
+    unsigned char *block = malloc(ASSET_BENCH_EXPORT_FILE_BYTES);
+    FamilyTree *tree = block ? family_tree_create("Export Benchmark") : NULL;
+    if (!tree)
+    {
+        free(block);
+        return NULL;
+    }
+    for (size_t index = 0U; index < ASSET_BENCH_EXPORT_FILE_BYTES; ++index)
+    {
+        block[index] = (unsigned char)(index * 2654435761U >> 24U);
+    }
+    for (unsigned int file = 0U; file < ASSET_BENCH_EXPORT_FILES; ++file)
+    {
+        char relative[64];
+        char path[256];
+        (void)snprintf(relative, sizeof(relative), "imports/scan_%02u.bin", file);
+        (void)snprintf(path, sizeof(path), "%s/assets/%s", ASSET_BENCH_EXPORT_ROOT, relative);
+        block[0] = (unsigned char)file; /* Distinct payloads, so export deduplication keeps every file. */
+        FILE *stream = fopen(path, "wb");
+        bool ok = stream && fwrite(block, 1U, ASSET_BENCH_EXPORT_FILE_BYTES, stream) == ASSET_BENCH_EXPORT_FILE_BYTES;
+        ok = stream && fclose(stream) == 0 && ok;
+        Person *person = ok ? family_tree_create_person(tree, file + 1U) : NULL;
+        if (!person || !family_tree_add_person(tree, person))
+        {
+            person_destroy(person);
+            family_tree_destroy(tree);
+            free(block);
+            return NULL;
+        }
+        if (!person_add_certificate(person, relative))
+        {
+            family_tree_destroy(tree);
+            free(block);
+            return NULL;
+        }
+    }
+    free(block);
+    return tree;
+}
+
+/* Random single-entry reads through the package directory, the access pattern of a viewer over an export. */
+static void bench_assets_read_package(const char *package_path)
+{
+    char error[256];
+    double start = bench_now_seconds();
+    AssetPackage *package = asset_package_open(package_path, error, sizeof(error));
+    double open_elapsed = bench_now_seconds() - start;
+    if (!package)
+    {
+        fprintf(stderr, "  package open failed: %s\n", error);
+        return;
+    }
+    printf("  package open: %.3f ms for %zu entries\n", open_elapsed * 1000.0, asset_package_entry_count(package));
+    const size_t lookups = 1000000U;
+    uint32_t state = 12345U;
+    size_t found = 0U;
+    uint64_t touched = 0U;
+    start = bench_now_seconds();
+    for (size_t index = 0U; index < lookups; ++index)
+    {
+        char entry_path[64];
+        (void)snprintf(entry_path, sizeof(entry_path), "assets/imports/scan_%02u.bin",
+                       (unsigned int)(bench_random_next(&state) % ASSET_BENCH_EXPORT_FILES));
+        AssetPackageEntry entry;
+        if (asset_package_read_entry(package, entry_path, &entry))
+        {
+            found += 1U;
+            touched += entry.data[entry.size / 2U];
+        }
+    }
+    bench_report_rate("package entry lookup", lookups, "lookups", bench_now_seconds() - start);
+    printf("  found %zu (checksum %llu)\n", found, (unsigned long long)touched);
+    AssetPackageEntry entry;
+    start = bench_now_seconds();
+    bool intact = asset_package_read_entry(package, "assets/imports/scan_00.bin", &entry) &&
+                  asset_package_entry_is_intact(&entry);
+    printf("  verify one entry: %.3f ms (%s)\n", (bench_now_seconds() - start) * 1000.0, intact ? "intact" : "damaged");
+    asset_package_close(package);
+}
+
+static void bench_assets_export(void)
+{
+    FamilyTree *tree = bench_assets_build_export_fixture();
+    if (!tree)
+    {
+        fprintf(stderr, "  fixture setup failed\n");
+        bench_assets_remove_export_fixture();
+        return;
+    }
+    AssetExportStats stats;
+    char error[256];
+    double start = bench_now_seconds();
+    bool ok = asset_export(tree, ASSET_BENCH_EXPORT_ROOT "/assets", ASSET_BENCH_EXPORT_ROOT "/tree.json",
+                           ASSET_BENCH_EXPORT_ROOT "/export.atpkg", &stats, error, sizeof(error));
+    double elapsed = bench_now_seconds() - start;
+    if (!ok)
+    {
+        fprintf(stderr, "  export failed: %s\n", error);
+    }
+    else
+    {
+        bench_report_throughput("export", stats.exported_bytes, elapsed);
+        printf("  package writing: %.1f MiB/s over %zu files (%zu deduplicated)\n", stats.megabytes_per_second,
+               stats.exported_files, stats.deduplicated_files);
+        bench_assets_read_package(ASSET_BENCH_EXPORT_ROOT "/export.atpkg");
+    }
+    family_tree_destroy(tree);
+    bench_assets_remove_export_fixture();
+}
+
+/* JSON-shaped text, the kind of payload compressed packaging is for. */
+static size_t bench_assets_fill_json(char *buffer, size_t capacity, uint32_t *state)
+{
+    size_t length = 0U;
+    while (length + 160U < capacity)
+    {
+        unsigned int id = bench_random_next(state) % 1000000U;
+        length += (size_t)snprintf(buffer + length, capacity - length,
+                                   "{\"id\":%u,\"name\":{\"first\":\"Person%u\",\"last\":\"Family%u\"},"
+                                   "\"birth\":{\"date\":\"18%02u-%02u-%02u\",\"place\":\"Parish %u\"}},\n",
+                                   id, id % 997U, id % 89U, id % 100U, 1U + id % 12U, 1U + id % 28U, id % 53U);
+    }
+    return length;
+}
+
+static void bench_assets_remove_text_fixture(void)
+{
+    char path[256];
+    for (unsigned int file = 0U; file < ASSET_BENCH_TEXT_FILES; ++file)
+    {
+        (void)snprintf(path, sizeof(path), "%s/assets/imports/notes_%02u.json", ASSET_BENCH_EXPORT_ROOT, file);
+        (void)remove(path);
+    }
+    bench_assets_remove_export_fixture();
+}
+
+static FamilyTree *bench_assets_build_text_fixture(void)
+{
+    if (!bench_assets_make_directory(ASSET_BENCH_EXPORT_ROOT) ||
+        !bench_assets_make_directory(ASSET_BENCH_EXPORT_ROOT "/assets") ||
+        !bench_assets_make_directory(ASSET_BENCH_EXPORT_ROOT "/assets/imports"))
+    {
+        return NULL;
+    }
+    char *text = malloc(ASSET_BENCH_TEXT_FILE_BYTES);
+    FamilyTree *tree = text ? family_tree_create("Compressed Export Benchmark") : NULL;
+    if (!tree)
+    {
+        free(text);
+        return NULL;
+    }
+    uint32_t state = 77U;
+    for (unsigned int file = 0U; file <= ASSET_BENCH_TEXT_FILES; ++file)
+    {
+        char relative[64];
+        char path[256];
+        (void)snprintf(relative, sizeof(relative), "imports/notes_%02u.json", file);
+        if (file == ASSET_BENCH_TEXT_FILES)
+        {
+            (void)snprintf(path, sizeof(path), "%s/tree.json", ASSET_BENCH_EXPORT_ROOT);
+        }
+        else
+        {
+            (void)snprintf(path, sizeof(path), "%s/assets/%s", ASSET_BENCH_EXPORT_ROOT, relative);
+        }
+        size_t length = bench_assets_fill_json(text, ASSET_BENCH_TEXT_FILE_BYTES, &state);
+        FILE *stream = fopen(path, "wb");
+        bool ok = stream && fwrite(text, 1U, length, stream) == length;
+        ok = stream && fclose(stream) == 0 && ok;
+        if (!ok)
+        {
+            family_tree_destroy(tree);
+            free(text);
+            return NULL;
+        }
+        if (file == ASSET_BENCH_TEXT_FILES)
+        {
+            break;
+        }
+        Person *person = family_tree_create_person(tree, file + 1U);
+        if (!person || !family_tree_add_person(tree, person))
+        {
+            person_destroy(person);
+            family_tree_destroy(tree);
+            free(text);
+            return NULL;
+        }
+        if (!person_add_certificate(person, relative))
+        {
+            family_tree_destroy(tree);
+            free(text);
+            return NULL;
+        }
+    }
+    free(text);
+    return tree;
+}
+
+static void bench_assets_run_text_export(const FamilyTree *tree, const char *label, AssetPackageCodec codec,
+                                         size_t worker_count)
+{
+    AssetExportOptions options;
+    options.codec = codec;
+    options.worker_count = worker_count;
+    AssetExportStats stats;
+    char error[256];
+    double start = bench_now_seconds();
+    bool ok = asset_export_with_options(tree, ASSET_BENCH_EXPORT_ROOT "/assets", ASSET_BENCH_EXPORT_ROOT "/tree.json",
+                                        ASSET_BENCH_EXPORT_ROOT "/export.atpkg", &options, &stats, error,
+                                        sizeof(error));
+    double elapsed = bench_now_seconds() - start;
+    if (!ok)
+    {
+        fprintf(stderr, "  export failed: %s\n", error);
+        return;
+    }
+    bench_report_throughput(label, stats.exported_bytes, elapsed);
+    printf("  package %.1f MiB of %.1f MiB (%.1fx)\n", (double)stats.package_bytes / (1024.0 * 1024.0),
+           (double)stats.exported_bytes / (1024.0 * 1024.0),
+           stats.package_bytes > 0U ? (double)stats.exported_bytes / (double)stats.package_bytes : 0.0);
+}
+
+static void bench_assets_export_compressed(void)
+{
+    FamilyTree *tree = bench_assets_build_text_fixture();
+    if (!tree)
+    {
+        fprintf(stderr, "  fixture setup failed\n");
+        bench_assets_remove_text_fixture();
+        return;
+    }
+    bench_assets_run_text_export(tree, "export json, stored", ASSET_PACKAGE_CODEC_NONE, 1U);
+    bench_assets_run_text_export(tree, "export json, lz, 1 thread", ASSET_PACKAGE_CODEC_LZ, 1U);
+    bench_assets_run_text_export(tree, "export json, lz, all threads", ASSET_PACKAGE_CODEC_LZ, 0U);
+    family_tree_destroy(tree);
+    bench_assets_remove_text_fixture();
+}
+
+void register_assets_benchmarks(BenchRegistry *registry)
+{
+    REGISTER_BENCH(registry, bench_assets_cleanup);
+    REGISTER_BENCH(registry, bench_assets_export);
+    REGISTER_BENCH(registry, bench_assets_export_compressed);
+}
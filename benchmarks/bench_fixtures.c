@@ -0,0 +1,100 @@
+#include "bench_fixtures.h"
+
+#include "person.h"
+
+#include <stdio.h>
+
+static const char *const g_bench_first_names[] = {
+    "Ada", "Charles", "Mary", "Grace", "Alan", "Hedy", "Zo\xC3\xAB", "\xC3\x89lodie", "Bj\xC3\xB6rn", "Katherine",
+    "Srinivasa", "Sof\xC3\xAD" "a", "Jos\xC3\xA9", "Margaret", "Edsger", "Barbara", "Niklaus", "Frances"};
+static const char *const g_bench_last_names[] = {
+    "Lovelace", "Babbage", "Somerville", "Hopper", "Turing", "Lamarr", "M\xC3\xBCller", "Fran\xC3\xA7ois",
+    "Str\xC3\xB8m", "Johnson", "Ramanujan", "Kovalevskaya", "Dijkstra", "Liskov", "Wirth", "Allen"};
+static const char *const g_bench_locations[] = {"London, England", "Paris, France", "K\xC3\xB8" "benhavn, Denmark",
+                                                "New York, USA", "Z\xC3\xBCrich, Switzerland", "Kumbakonam, India",
+                                                "Moscow, Russia", "Rotterdam, Netherlands"};
+
+#define BENCH_COUNT_OF(array) (sizeof(array) / sizeof((array)[0]))
+
+uint32_t bench_random_next(uint32_t *state)
+{
+    uint32_t value = *state ? *state : 0x9E3779B9U;
+    value ^= value << 13;
+    value ^= value >> 17;
+    value ^= value << 5;
+    *state = value;
+    return value;
+}
+
+static bool bench_fill_person(Person *person, uint32_t *state)
+{
+    const char *first = g_bench_first_names[bench_random_next(state) % BENCH_COUNT_OF(g_bench_first_names)];
+    const char *middle = g_bench_first_names[bench_random_next(state) % BENCH_COUNT_OF(g_bench_first_names)];
+    const char *last = g_bench_last_names[bench_random_next(state) % BENCH_COUNT_OF(g_bench_last_names)];
+    const char *location = g_bench_locations[bench_random_next(state) % BENCH_COUNT_OF(g_bench_locations)];
+    char birth_date[16];
+    (void)snprintf(birth_date, sizeof(birth_date), "%04u-%02u-%02u", 1700U + bench_random_next(state) % 300U,
+                   1U + bench_random_next(state) % 12U, 1U + bench_random_next(state) % 28U);
+    char note[96];
+    (void)snprintf(note, sizeof(note), "Recorded as \"%s %s\" in the parish register.\nSee folio %u.", first, last,
+                   bench_random_next(state) % 1000U);
+    return person_set_name(person, first, middle, last) && person_set_birth(person, birth_date, location) &&
+           person_metadata_set(person, "note", note);
+}
+
+FamilyTree *bench_build_tree(size_t person_count, uint32_t seed)
+{
+    FamilyTree *tree = family_tree_create("Benchmark Tree");
+    if (!tree)
+    {
+        return NULL;
+    }
+    uint32_t state = seed;
+    for (size_t index = 1U; index <= person_count; ++index)
+    {
+        Person *person = family_tree_create_person(tree, (uint32_t)index);
+        if (!person || !family_tree_add_person(tree, person))
+        {
+            person_destroy(person);
+            family_tree_destroy(tree);
+            return NULL;
+        }
+        if (!bench_fill_person(person, &state))
+        {
+            family_tree_destroy(tree);
+            return NULL;
+        }
+        if (index > 1U)
+        {
+            (void)person_add_child(tree->persons[index / 2U - 1U], person);
+        }
+    }
+    return tree;
+}
+
+FamilyTree *bench_import_tree(size_t person_count, uint32_t seed, FamilyTreeBuilderStats *out_stats)
+{
+    FamilyTreeBuilder *builder = family_tree_builder_create("Benchmark Tree", person_count, person_count);
+    if (!builder)
+    {
+        return NULL;
+    }
+    uint32_t state = seed;
+    for (size_t index = 1U; index <= person_count; ++index)
+    {
+        Person *person = family_tree_create_person(family_tree_builder_tree(builder), (uint32_t)index);
+        if (!person || !family_tree_builder_add_person(builder, person))
+        {
+            person_destroy(person);
+            family_tree_builder_destroy(builder);
+            return NULL;
+        }
+        if (!bench_fill_person(person, &state) ||
+            (index > 1U && !family_tree_builder_add_child(builder, (uint32_t)(index / 2U), (uint32_t)index)))
+        {
+            family_tree_builder_destroy(builder);
+            return NULL;
+        }
+    }
+    return family_tree_builder_finish(builder, out_stats, NULL, 0U);
+}
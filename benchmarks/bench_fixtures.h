@@ -0,0 +1,16 @@
+#ifndef BENCH_FIXTURES_H
+#define BENCH_FIXTURES_H
+
+#include "tree.h"
+#include "tree_builder.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Deterministic name-heavy tree: ids 1..person_count, person i is a child of person i / 2. */
+FamilyTree *bench_build_tree(size_t person_count, uint32_t seed);
+/* Same tree assembled through family_tree_builder_*, validated once. */
+FamilyTree *bench_import_tree(size_t person_count, uint32_t seed, FamilyTreeBuilderStats *out_stats);
+uint32_t bench_random_next(uint32_t *state);
+
+#endif /* BENCH_FIXTURES_H */
@@ -0,0 +1,86 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "bench_framework.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+void bench_registry_init(BenchRegistry *registry, BenchCase *storage, int capacity)
+{
+    if (!registry)
+    {
+        return;
+    }
+    registry->cases = storage;
+    registry->capacity = capacity;
+    registry->count = 0;
+}
+
+bool bench_registry_add(BenchRegistry *registry, const char *name, BenchFunction function)
+{
+    if (!registry || !registry->cases || registry->count >= registry->capacity)
+    {
+        return false;
+    }
+    registry->cases[registry->count].name = name;
+    registry->cases[registry->count].function = function;
+    registry->count++;
+    return true;
+}
+
+int bench_registry_run(const BenchRegistry *registry, const char *filter)
+{
+    if (!registry)
+    {
+        return 0;
+    }
+    int executed = 0;
+    for (int index = 0; index < registry->count; ++index)
+    {
+        const BenchCase *bench_case = &registry->cases[index];
+        if (filter && !strstr(bench_case->name, filter))
+        {
+            continue;
+        }
+        fprintf(stdout, "[BENCH] %s\n", bench_case->name);
+        bench_case->function();
+        executed++;
+    }
+    return executed;
+}
+
+double bench_now_seconds(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+#endif
+}
+
+void bench_report_throughput(const char *label, size_t bytes, double seconds)
+{
+    double megabytes = (double)bytes / (1024.0 * 1024.0);
+    double rate = seconds > 0.0 ? megabytes / seconds : 0.0;
+    fprintf(stdout, "  %-40s %10.2f MB/s (%.1f MB in %.3f s)\n", label, rate, megabytes, seconds);
+}
+
+void bench_report_rate(const char *label, size_t items, const char *unit, double seconds)
+{
+    double rate = seconds > 0.0 ? (double)items / seconds : 0.0;
+    fprintf(stdout, "  %-40s %12.0f %s/s (%zu in %.3f s)\n", label, rate, unit ? unit : "ops", items, seconds);
+}
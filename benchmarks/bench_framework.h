@@ -0,0 +1,34 @@
+#ifndef BENCH_FRAMEWORK_H
+#define BENCH_FRAMEWORK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef void (*BenchFunction)(void);
+
+typedef struct BenchCase
+{
+    const char *name;
+    BenchFunction function;
+} BenchCase;
+
+typedef struct BenchRegistry
+{
+    BenchCase *cases;
+    int capacity;
+    int count;
+} BenchRegistry;
+
+void bench_registry_init(BenchRegistry *registry, BenchCase *storage, int capacity);
+bool bench_registry_add(BenchRegistry *registry, const char *name, BenchFunction function);
+/* Runs every benchmark whose name contains filter (all when filter is NULL); returns the number run. */
+int bench_registry_run(const BenchRegistry *registry, const char *filter);
+
+/* Monotonic wall-clock time in seconds. */
+double bench_now_seconds(void);
+void bench_report_throughput(const char *label, size_t bytes, double seconds);
+void bench_report_rate(const char *label, size_t items, const char *unit, double seconds);
+
+#define REGISTER_BENCH(registry_ptr, bench_name) (void)bench_registry_add((registry_ptr), #bench_name, (bench_name))
+
+#endif /* BENCH_FRAMEWORK_H */
@@ -0,0 +1,182 @@
+#include "bench_fixtures.h"
+#include "bench_framework.h"
+#include "json_parser.h"
+#include "persistence.h"
+#include "persistence_internal.h"
+
+#include "at_memory.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define JSON_BENCH_PERSONS 20000U
+#define JSON_BENCH_PASSES 10U
+#define JSON_BENCH_ARCHIVE_PATH "bench_json_archive.json"
+
+static void bench_json_parse_name_archive(void)
+{
+    FamilyTree *tree = bench_build_tree(JSON_BENCH_PERSONS, 7U);
+    char error[256];
+    char *text = NULL;
+    size_t length = 0U;
+    if (!tree || !persistence_tree_save(tree, JSON_BENCH_ARCHIVE_PATH, error, sizeof(error)) ||
+        !persistence_read_file(JSON_BENCH_ARCHIVE_PATH, &text, &length, error, sizeof(error)))
+    {
+        fprintf(stderr, "  fixture setup failed\n");
+        family_tree_destroy(tree);
+        (void)remove(JSON_BENCH_ARCHIVE_PATH);
+        return;
+    }
+    family_tree_destroy(tree);
+    double start = bench_now_seconds();
+    for (unsigned int pass = 0U; pass < JSON_BENCH_PASSES; ++pass)
+    {
+        JsonValue *root = json_parse(text, error, sizeof(error), NULL, NULL);
+        if (!root)
+        {
+            fprintf(stderr, "  parse failed: %s\n", error);
+            break;
+        }
+        json_value_destroy(root);
+    }
+    double elapsed = bench_now_seconds() - start;
+    bench_report_throughput("json_parse", length * JSON_BENCH_PASSES, elapsed);
+    free(text);
+    (void)remove(JSON_BENCH_ARCHIVE_PATH);
+    (void)remove(JSON_BENCH_ARCHIVE_PATH ".bak");
+}
+
+static void bench_json_serialize_name_archive(void)
+{
+    FamilyTree *tree = bench_build_tree(JSON_BENCH_PERSONS, 7U);
+    if (!tree)
+    {
+        fprintf(stderr, "  fixture setup failed\n");
+        return;
+    }
+    char error[256];
+    size_t total = 0U;
+    double start = bench_now_seconds();
+    for (unsigned int pass = 0U; pass < JSON_BENCH_PASSES; ++pass)
+    {
+        for (size_t index = 0U; index < tree->person_count; ++index)
+        {
+            char *text = NULL;
+            size_t length = 0U;
+            if (!persistence_person_serialize(tree->persons[index], &text, &length, error, sizeof(error)))
+            {
+                fprintf(stderr, "  serialise failed: %s\n", error);
+                family_tree_destroy(tree);
+                return;
+            }
+            total += length;
+            AT_FREE(text);
+        }
+    }
+    double elapsed = bench_now_seconds() - start;
+    bench_report_throughput("persistence_person_serialize", total, elapsed);
+    family_tree_destroy(tree);
+}
+
+/* Biographies and notes: long strings where the per-byte scan, not allocation, dominates. */
+static void bench_json_parse_long_text(void)
+{
+    const size_t string_count = 256U;
+    const size_t string_length = 16U * 1024U;
+    size_t capacity = string_count * (string_length + 8U) + 16U;
+    char *text = (char *)malloc(capacity);
+    if (!text)
+    {
+        fprintf(stderr, "  fixture allocation failed\n");
+        return;
+    }
+    static const char sentence[] = "Ada Lovelace wrote the first published algorithm for the Analytical Engine. ";
+    size_t length = 0U;
+    text[length++] = '[';
+    for (size_t index = 0U; index < string_count; ++index)
+    {
+        text[length++] = '"';
+        for (size_t offset = 0U; offset < string_length; ++offset)
+        {
+            text[length++] = sentence[offset % (sizeof(sentence) - 1U)];
+        }
+        text[length++] = '\\';
+        text[length++] = 'n';
+        text[length++] = '"';
+        text[length++] = index + 1U < string_count ? ',' : ']';
+    }
+    text[length] = '\0';
+    char error[256];
+    double start = bench_now_seconds();
+    for (unsigned int pass = 0U; pass < JSON_BENCH_PASSES; ++pass)
+    {
+        JsonValue *root = json_parse(text, error, sizeof(error), NULL, NULL);
+        if (!root)
+        {
+            fprintf(stderr, "  parse failed: %s\n", error);
+            break;
+        }
+        json_value_destroy(root);
+    }
+    double elapsed = bench_now_seconds() - start;
+    bench_report_throughput("json_parse (16 KiB strings)", length * JSON_BENCH_PASSES, elapsed);
+    free(text);
+}
+
+static void bench_json_parse_number_array(const char *label, bool integers)
+{
+    const size_t count = 500000U;
+    size_t capacity = count * 24U + 4U;
+    char *text = (char *)malloc(capacity);
+    if (!text)
+    {
+        fprintf(stderr, "  fixture allocation failed\n");
+        return;
+    }
+    uint32_t state = 11U;
+    size_t length = 0U;
+    text[length++] = '[';
+    for (size_t index = 0U; index < count; ++index)
+    {
+        uint32_t draw = bench_random_next(&state);
+        int written = integers ? snprintf(text + length, capacity - length, "%u", draw % 100000U)
+                               : snprintf(text + length, capacity - length, "%.6f", (double)draw / 1000.0);
+        length += (size_t)written;
+        text[length++] = index + 1U < count ? ',' : ']';
+    }
+    text[length] = '\0';
+    char error[256];
+    double start = bench_now_seconds();
+    for (unsigned int pass = 0U; pass < JSON_BENCH_PASSES; ++pass)
+    {
+        JsonValue *root = json_parse(text, error, sizeof(error), NULL, NULL);
+        if (!root)
+        {
+            fprintf(stderr, "  parse failed: %s\n", error);
+            break;
+        }
+        json_value_destroy(root);
+    }
+    double elapsed = bench_now_seconds() - start;
+    bench_report_rate(label, count * JSON_BENCH_PASSES, "numbers", elapsed);
+    free(text);
+}
+
+static void bench_json_parse_person_ids(void)
+{
+    bench_json_parse_number_array("json_parse (integer ids)", true);
+}
+
+static void bench_json_parse_decimals(void)
+{
+    bench_json_parse_number_array("json_parse (decimals)", false);
+}
+
+void register_json_benchmarks(BenchRegistry *registry)
+{
+    REGISTER_BENCH(registry, bench_json_parse_name_archive);
+    REGISTER_BENCH(registry, bench_json_serialize_name_archive);
+    REGISTER_BENCH(registry, bench_json_parse_long_text);
+    REGISTER_BENCH(registry, bench_json_parse_person_ids);
+    REGISTER_BENCH(registry, bench_json_parse_decimals);
+}
@@ -0,0 +1,29 @@
+#include "bench_framework.h"
+
+#include <stdio.h>
+
+void register_persistence_utf8_benchmarks(BenchRegistry *registry);
+void register_json_benchmarks(BenchRegistry *registry);
+void register_tree_benchmarks(BenchRegistry *registry);
+void register_assets_benchmarks(BenchRegistry *registry);
+
+int main(int argc, char **argv)
+{
+    BenchRegistry registry;
+    BenchCase cases[64];
+    bench_registry_init(&registry, cases, (int)(sizeof(cases) / sizeof(cases[0])));
+
+    register_persistence_utf8_benchmarks(&registry);
+    register_json_benchmarks(&registry);
+    register_tree_benchmarks(&registry);
+    register_assets_benchmarks(&registry);
+
+    const char *filter = argc > 1 ? argv[1] : NULL;
+    int executed = bench_registry_run(&registry, filter);
+    if (executed == 0)
+    {
+        fprintf(stderr, "No benchmarks matched.\n");
+        return 1;
+    }
+    return 0;
+}
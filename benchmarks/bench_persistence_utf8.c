@@ -0,0 +1,97 @@
+#include "bench_framework.h"
+#include "persistence_utf8.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define UTF8_BENCH_CORPUS_BYTES (8U * 1024U * 1024U)
+#define UTF8_BENCH_PASSES 8U
+
+static char *utf8_bench_build_corpus(const char *const *samples, size_t sample_count, size_t *out_length)
+{
+    char *corpus = (char *)malloc(UTF8_BENCH_CORPUS_BYTES);
+    if (!corpus)
+    {
+        return NULL;
+    }
+    size_t length = 0U;
+    size_t index = 0U;
+    for (;;)
+    {
+        const char *sample = samples[index % sample_count];
+        size_t sample_length = strlen(sample);
+        if (length + sample_length > UTF8_BENCH_CORPUS_BYTES)
+        {
+            break;
+        }
+        memcpy(corpus + length, sample, sample_length);
+        length += sample_length;
+        index++;
+    }
+    *out_length = length;
+    return corpus;
+}
+
+static void utf8_bench_run_corpus(const char *const *samples, size_t sample_count)
+{
+    static const struct
+    {
+        PersistenceUtf8Kernel kernel;
+        const char *label;
+    } kernels[] = {{PERSISTENCE_UTF8_KERNEL_SCALAR, "scalar"},
+                   {PERSISTENCE_UTF8_KERNEL_SSE4, "sse4.1"},
+                   {PERSISTENCE_UTF8_KERNEL_AVX2, "avx2"}};
+    size_t length = 0U;
+    char *corpus = utf8_bench_build_corpus(samples, sample_count, &length);
+    if (!corpus)
+    {
+        fprintf(stderr, "  corpus allocation failed\n");
+        return;
+    }
+    for (size_t index = 0U; index < sizeof(kernels) / sizeof(kernels[0]); ++index)
+    {
+        if (!persistence_utf8_kernel_supported(kernels[index].kernel))
+        {
+            fprintf(stdout, "  %-40s unsupported on this CPU\n", kernels[index].label);
+            continue;
+        }
+        bool valid = true;
+        double start = bench_now_seconds();
+        for (unsigned int pass = 0U; pass < UTF8_BENCH_PASSES; ++pass)
+        {
+            valid = persistence_utf8_validate_with(kernels[index].kernel, corpus, length) && valid;
+        }
+        double elapsed = bench_now_seconds() - start;
+        if (!valid)
+        {
+            fprintf(stderr, "  %s rejected a valid corpus\n", kernels[index].label);
+        }
+        bench_report_throughput(kernels[index].label, length * UTF8_BENCH_PASSES, elapsed);
+    }
+    free(corpus);
+}
+
+static void bench_utf8_ascii_names(void)
+{
+    static const char *const samples[] = {"Ada Lovelace", "1815-12-10", "London, England", "Byron Lovelace",
+                                          "Mathematician and writer; first published algorithm.",
+                                          "assets/portraits/ada.png"};
+    utf8_bench_run_corpus(samples, sizeof(samples) / sizeof(samples[0]));
+}
+
+static void bench_utf8_mixed_scripts(void)
+{
+    static const char *const samples[] = {"Zo\xC3\xAB M\xC3\xBCller", "\xC3\x89lodie Fran\xC3\xA7oise",
+                                          "\xE5\xB1\xB1\xE7\x94\xB0\xE5\xA4\xAA\xE9\x83\x8E",
+                                          "\xD0\x90\xD0\xBD\xD0\xBD\xD0\xB0 "
+                                          "\xD0\x9F\xD0\xB0\xD0\xB2\xD0\xBB\xD0\xBE\xD0\xB2\xD0\xB0",
+                                          "Family reunion \xF0\x9F\x8E\x89", "Ada Lovelace"};
+    utf8_bench_run_corpus(samples, sizeof(samples) / sizeof(samples[0]));
+}
+
+void register_persistence_utf8_benchmarks(BenchRegistry *registry)
+{
+    REGISTER_BENCH(registry, bench_utf8_ascii_names);
+    REGISTER_BENCH(registry, bench_utf8_mixed_scripts);
+}
@@ -0,0 +1,292 @@
+#include "bench_fixtures.h"
+#include "bench_framework.h"
+
+#include "at_memory.h"
+#include "layout.h"
+#include "render.h"
+#include "search.h"
+#include "tree_graph.h"
+
+#include <stdio.h>
+
+#define TREE_BENCH_PERSONS 20000U
+#define TREE_BENCH_IMPORT_PERSONS 200000U
+#define TREE_BENCH_WALK_PASSES 200U
+#define TREE_BENCH_LAYOUT_PASSES 5U
+#define TREE_BENCH_SEARCH_PASSES 50U
+#define TREE_BENCH_NAME_QUERIES 200U
+#define TREE_BENCH_VALIDATE_PASSES 3U
+#define TREE_BENCH_CONNECTION_PASSES 20U
+
+static void bench_tree_build_and_destroy(void)
+{
+    AtMemoryStats before;
+    at_memory_get_stats(&before);
+    double start = bench_now_seconds();
+    FamilyTree *tree = bench_build_tree(TREE_BENCH_PERSONS, 11U);
+    double built = bench_now_seconds();
+    if (!tree)
+    {
+        fprintf(stderr, "  fixture setup failed\n");
+        return;
+    }
+    AtMemoryStats after;
+    at_memory_get_stats(&after);
+    AtStringPoolStats strings;
+    family_tree_get_string_stats(tree, &strings);
+    double teardown_start = bench_now_seconds();
+    family_tree_destroy(tree);
+    double finished = bench_now_seconds();
+
+    bench_report_rate("build", TREE_BENCH_PERSONS, "persons", built - start);
+    bench_report_rate("destroy", TREE_BENCH_PERSONS, "persons", finished - teardown_start);
+    printf("  strings: %zu unique / %zu references, %zu of %zu bytes saved (%.1f%%), %zu arena bytes\n",
+           strings.unique_strings, strings.references, strings.bytes_saved, strings.bytes_requested,
+           strings.bytes_requested > 0U ? 100.0 * (double)strings.bytes_saved / (double)strings.bytes_requested
+                                        : 0.0,
+           strings.arena_bytes);
+    if (after.total_allocations > before.total_allocations)
+    {
+        printf("  allocations: %.2f per person\n",
+               (double)(after.total_allocations - before.total_allocations) / (double)TREE_BENCH_PERSONS);
+    }
+}
+
+static void bench_tree_walk_members(void)
+{
+    FamilyTree *tree = bench_build_tree(TREE_BENCH_PERSONS, 13U);
+    if (!tree)
+    {
+        fprintf(stderr, "  fixture setup failed\n");
+        return;
+    }
+    /* Touches a few hot fields per member, the way layout and search passes do. */
+    size_t checksum = 0U;
+    double start = bench_now_seconds();
+    for (unsigned int pass = 0U; pass < TREE_BENCH_WALK_PASSES; ++pass)
+    {
+        for (size_t index = 0U; index < tree->person_count; ++index)
+        {
+            const Person *person = tree->persons[index];
+            checksum += person->id + person->children_count + (person->parents[0] ? 1U : 0U);
+        }
+    }
+    double elapsed = bench_now_seconds() - start;
+    bench_report_rate("walk", (size_t)TREE_BENCH_PERSONS * TREE_BENCH_WALK_PASSES, "persons", elapsed);
+    printf("  checksum: %zu\n", checksum);
+    family_tree_destroy(tree);
+}
+
+static void bench_tree_layout_hierarchical(void)
+{
+    FamilyTree *tree = bench_build_tree(TREE_BENCH_PERSONS, 17U);
+    if (!tree)
+    {
+        fprintf(stderr, "  fixture setup failed\n");
+        return;
+    }
+    double start = bench_now_seconds();
+    for (unsigned int pass = 0U; pass < TREE_BENCH_LAYOUT_PASSES; ++pass)
+    {
+        LayoutResult layout = layout_calculate(tree);
+        layout_result_destroy(&layout);
+    }
+    double elapsed = bench_now_seconds() - start;
+    bench_report_rate("layout", (size_t)TREE_BENCH_PERSONS * TREE_BENCH_LAYOUT_PASSES, "persons", elapsed);
+    family_tree_destroy(tree);
+}
+
+static void bench_tree_search_birth_years(void)
+{
+    FamilyTree *tree = bench_build_tree(TREE_BENCH_PERSONS, 19U);
+    if (!tree)
+    {
+        fprintf(stderr, "  fixture setup failed\n");
+        return;
+    }
+    /* Narrow year window with a name filter: most members are rejected before their name is formatted. */
+    SearchFilter filter = {"lovelace", true, true, true, 1850, 1852};
+    const Person *results[64];
+    size_t matches = 0U;
+    double start = bench_now_seconds();
+    for (unsigned int pass = 0U; pass < TREE_BENCH_SEARCH_PASSES; ++pass)
+    {
+        matches = search_execute(tree, &filter, results, sizeof(results) / sizeof(results[0]));
+    }
+    double elapsed = bench_now_seconds() - start;
+    bench_report_rate("search", (size_t)TREE_BENCH_PERSONS * TREE_BENCH_SEARCH_PASSES, "persons", elapsed);
+    printf("  matches: %zu\n", matches);
+    family_tree_destroy(tree);
+}
+
+static void bench_tree_validate(void)
+{
+    FamilyTree *tree = bench_build_tree(TREE_BENCH_PERSONS, 23U);
+    if (!tree)
+    {
+        fprintf(stderr, "  fixture setup failed\n");
+        return;
+    }
+    bool valid = true;
+    char error[128];
+    double start = bench_now_seconds();
+    for (unsigned int pass = 0U; pass < TREE_BENCH_VALIDATE_PASSES; ++pass)
+    {
+        valid = family_tree_validate(tree, error, sizeof(error)) && valid;
+    }
+    double elapsed = bench_now_seconds() - start;
+    bench_report_rate("validate", (size_t)TREE_BENCH_PERSONS * TREE_BENCH_VALIDATE_PASSES, "persons", elapsed);
+    if (!valid)
+    {
+        fprintf(stderr, "  validation failed: %s\n", error);
+    }
+    family_tree_destroy(tree);
+}
+
+static void bench_tree_collect_connections(void)
+{
+    FamilyTree *tree = bench_build_tree(TREE_BENCH_PERSONS, 29U);
+    if (!tree)
+    {
+        fprintf(stderr, "  fixture setup failed\n");
+        return;
+    }
+    LayoutResult layout = layout_calculate(tree);
+    RenderConnectionSegment *segments = AT_MALLOC(TREE_BENCH_PERSONS * sizeof(RenderConnectionSegment));
+    if (!segments)
+    {
+        fprintf(stderr, "  segment buffer allocation failed\n");
+        layout_result_destroy(&layout);
+        family_tree_destroy(tree);
+        return;
+    }
+    size_t collected = 0U;
+    double start = bench_now_seconds();
+    for (unsigned int pass = 0U; pass < TREE_BENCH_CONNECTION_PASSES; ++pass)
+    {
+        collected = render_collect_parent_child_segments(&layout, segments, TREE_BENCH_PERSONS);
+    }
+    double elapsed = bench_now_seconds() - start;
+    bench_report_rate("connections", (size_t)TREE_BENCH_PERSONS * TREE_BENCH_CONNECTION_PASSES, "persons", elapsed);
+    printf("  segments: %zu\n", collected);
+    AT_FREE(segments);
+    layout_result_destroy(&layout);
+    family_tree_destroy(tree);
+}
+
+static void bench_tree_search_names(void)
+{
+    FamilyTree *tree = bench_import_tree(TREE_BENCH_IMPORT_PERSONS, 23U, NULL);
+    if (!tree)
+    {
+        fprintf(stderr, "  fixture setup failed\n");
+        return;
+    }
+    /* Full-name substrings over a large tree; the first query also builds the name index. */
+    static const char *const queries[] = {"ada niklaus wirth", "grace hedy hop", "margaret edsger dijk"};
+    const Person *results[64];
+    SearchFilter filter = {queries[0], true, true, false, 0, 0};
+    double start = bench_now_seconds();
+    size_t matches = search_execute(tree, &filter, results, sizeof(results) / sizeof(results[0]));
+    double first_elapsed = bench_now_seconds() - start;
+    start = bench_now_seconds();
+    for (unsigned int query = 0U; query < TREE_BENCH_NAME_QUERIES; ++query)
+    {
+        filter.name_substring = queries[query % (sizeof(queries) / sizeof(queries[0]))];
+        (void)search_execute(tree, &filter, results, sizeof(results) / sizeof(results[0]));
+    }
+    double elapsed = bench_now_seconds() - start;
+    printf("  first query: %.3f ms (%zu matches)\n", first_elapsed * 1000.0, matches);
+    bench_report_rate("name query", TREE_BENCH_NAME_QUERIES, "queries", elapsed);
+
+    /* A surname shared by about one member in sixteen; only the first page by name is kept and sorted. */
+    filter.name_substring = "lovelace";
+    start = bench_now_seconds();
+    for (unsigned int query = 0U; query < TREE_BENCH_NAME_QUERIES; ++query)
+    {
+        matches = search_execute(tree, &filter, results, sizeof(results) / sizeof(results[0]));
+    }
+    elapsed = bench_now_seconds() - start;
+    bench_report_rate("broad name query", TREE_BENCH_NAME_QUERIES, "queries", elapsed);
+    printf("  first result: %s\n", matches > 0U ? results[0]->name.first : "-");
+    family_tree_destroy(tree);
+}
+
+static void bench_tree_builder_import(void)
+{
+    FamilyTreeBuilderStats stats;
+    double start = bench_now_seconds();
+    FamilyTree *tree = bench_import_tree(TREE_BENCH_IMPORT_PERSONS, 11U, &stats);
+    double elapsed = bench_now_seconds() - start;
+    if (!tree)
+    {
+        fprintf(stderr, "  builder import failed\n");
+        return;
+    }
+    bench_report_rate("import", TREE_BENCH_IMPORT_PERSONS, "persons", elapsed);
+    printf("  phases: ingest %.3f s, resolve %.3f s (%zu links), validate %.3f s\n", stats.ingest_seconds,
+           stats.resolve_seconds, stats.relationships, stats.validate_seconds);
+    family_tree_destroy(tree);
+}
+
+/* Collects the branch under tree->persons[1], roughly half of the fixture. */
+static bool bench_tree_collect_branch(const FamilyTree *tree, TreeGraph *branch)
+{
+    tree_graph_init(branch);
+    return tree->person_count > 1U && tree_graph_build_descendants(branch, tree->persons[1]);
+}
+
+static void bench_tree_remove_branch(void)
+{
+    FamilyTree *bulk_tree = bench_build_tree(TREE_BENCH_PERSONS, 31U);
+    FamilyTree *single_tree = bench_build_tree(TREE_BENCH_PERSONS, 31U);
+    TreeGraph branch;
+    if (!bulk_tree || !single_tree || !bench_tree_collect_branch(bulk_tree, &branch))
+    {
+        fprintf(stderr, "  fixture setup failed\n");
+        family_tree_destroy(bulk_tree);
+        family_tree_destroy(single_tree);
+        return;
+    }
+    size_t branch_size = branch.count;
+    double start = bench_now_seconds();
+    size_t removed = family_tree_remove_persons(bulk_tree, branch.persons, branch.count);
+    double bulk_elapsed = bench_now_seconds() - start;
+    tree_graph_reset(&branch);
+
+    /* The per-person unlink, extract and shift sequence app_state_delete_person performs. */
+    if (!bench_tree_collect_branch(single_tree, &branch))
+    {
+        fprintf(stderr, "  fixture setup failed\n");
+        family_tree_destroy(bulk_tree);
+        family_tree_destroy(single_tree);
+        return;
+    }
+    start = bench_now_seconds();
+    for (size_t index = 0U; index < branch.count; ++index)
+    {
+        Person *person = branch.persons[index];
+        family_tree_unlink_person(single_tree, person);
+        (void)family_tree_remove_person(single_tree, person->id);
+    }
+    double single_elapsed = bench_now_seconds() - start;
+    tree_graph_reset(&branch);
+
+    bench_report_rate("bulk remove", removed, "persons", bulk_elapsed);
+    bench_report_rate("per-person remove", branch_size, "persons", single_elapsed);
+    family_tree_destroy(bulk_tree);
+    family_tree_destroy(single_tree);
+}
+
+void register_tree_benchmarks(BenchRegistry *registry)
+{
+    REGISTER_BENCH(registry, bench_tree_build_and_destroy);
+    REGISTER_BENCH(registry, bench_tree_builder_import);
+    REGISTER_BENCH(registry, bench_tree_walk_members);
+    REGISTER_BENCH(registry, bench_tree_layout_hierarchical);
+    REGISTER_BENCH(registry, bench_tree_search_birth_years);
+    REGISTER_BENCH(registry, bench_tree_search_names);
+    REGISTER_BENCH(registry, bench_tree_validate);
+    REGISTER_BENCH(registry, bench_tree_collect_connections);
+    REGISTER_BENCH(registry, bench_tree_remove_branch);
+}
@@ -41,6 +41,16 @@ extern "C"
         char current_path[512];
     } AppFileState;
 
+    typedef enum AppPersonChange
+    {
+        APP_PERSON_CHANGE_ADDED = 0,
+        APP_PERSON_CHANGE_REMOVED,
+        APP_PERSON_CHANGE_EDITED
+    } AppPersonChange;
+
+    /* Invoked after a person enters, leaves, or is edited in the tree, including through undo/redo. */
+    typedef void (*AppPersonChangeListener)(AppPersonChange change, const Person *person, void *user_data);
+
     struct AppState;
 
     typedef struct AppCommand AppCommand;
@@ -83,6 +93,8 @@ extern "C"
         AppCommandStack undo_stack;
         AppCommandStack redo_stack;
         ExpansionState expansion;
+        AppPersonChangeListener person_change_listener;
+        void *person_change_user_data;
         bool layout_transition_active;
         bool tree_dirty;
     } AppState;
@@ -105,6 +117,7 @@ extern "C"
     void app_state_shutdown(AppState *state);
     void app_state_reset_history(AppState *state);
     void app_state_tick(AppState *state, float delta_seconds);
+    void app_state_set_person_change_listener(AppState *state, AppPersonChangeListener listener, void *user_data);
 
     bool app_state_push_command(AppState *state, AppCommand *command, char *error_buffer, size_t error_buffer_size);
     bool app_state_undo(AppState *state, char *error_buffer, size_t error_buffer_size);
@@ -112,6 +125,9 @@ extern "C"
 
     bool app_state_add_person(AppState *state, Person *person, char *error_buffer, size_t error_buffer_size);
     bool app_state_delete_person(AppState *state, uint32_t person_id, char *error_buffer, size_t error_buffer_size);
+    /* Deletes person_id and all of its descendants in one linear pass; like app_state_delete_person, not undoable. */
+    bool app_state_delete_branch(AppState *state, uint32_t root_id, size_t *out_removed, char *error_buffer,
+                                 size_t error_buffer_size);
     bool app_state_edit_person(AppState *state, uint32_t person_id, const AppPersonEditData *edit_data,
                                char *error_buffer, size_t error_buffer_size);
 
@@ -3,6 +3,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C"
@@ -27,21 +28,80 @@ extern "C"
         size_t integrity_failures; /* Referenced files that failed integrity checks (e.g., zero length). */
     } AssetCleanupStats;
 
+    typedef enum AssetPackageCodec
+    {
+        ASSET_PACKAGE_CODEC_NONE = 0,
+        ASSET_PACKAGE_CODEC_LZ = 1 /* at_compress blocks. */
+    } AssetPackageCodec;
+
+    typedef struct AssetExportOptions
+    {
+        AssetPackageCodec codec; /* Entries that would not shrink are stored as is. */
+        size_t worker_count;     /* Threads compressing entries, the writer included; 0 uses one per processor. */
+    } AssetExportOptions;
+
     typedef struct AssetExportStats
     {
-        size_t referenced_files; /* Referenced asset count included in the package (excludes the tree JSON). */
-        size_t exported_files;   /* Total files written to the package, including the tree JSON. */
-        size_t exported_bytes;   /* Aggregate bytes written across all packaged files. */
+        size_t referenced_files;     /* Referenced asset count included in the package (excludes the tree JSON). */
+        size_t exported_files;       /* Total files written to the package, including the tree JSON. */
+        size_t exported_bytes;       /* Aggregate bytes written across all packaged files. */
+        size_t deduplicated_files;   /* Entries whose content matched an earlier one and was stored once. */
+        size_t compressed_files;     /* Entries stored compressed. */
+        size_t package_bytes;        /* Payload bytes in the package after compression. */
+        double elapsed_seconds;      /* Time spent writing the package. */
+        double megabytes_per_second; /* exported_bytes in MiB over elapsed_seconds. */
     } AssetExportStats;
 
+    /* Copies the source beneath the asset root unless a file with identical content was already imported there,
+     * in which case out_relative_path receives that file's path. */
     bool asset_copy(const AssetCopyRequest *request, char *out_relative_path, size_t relative_capacity,
                     char *error_buffer, size_t error_capacity);
+    /* Frees the content index asset_copy keeps in memory for the last asset root; the next copy reads it again. */
+    void asset_content_index_release(void);
 
     bool asset_cleanup(const struct FamilyTree *tree, const char *asset_root, const char *import_subdirectory,
                        AssetCleanupStats *stats, char *error_buffer, size_t error_capacity);
+    /* asset_cleanup with the reference checks and the directory walk spread over worker_count threads (0 uses one
+     * per processor). The Windows walk stays on one thread. */
+    bool asset_cleanup_parallel(const struct FamilyTree *tree, const char *asset_root, const char *import_subdirectory,
+                                size_t worker_count, AssetCleanupStats *stats, char *error_buffer,
+                                size_t error_capacity);
 
     bool asset_export(const struct FamilyTree *tree, const char *asset_root, const char *tree_json_path,
                       const char *package_path, AssetExportStats *stats, char *error_buffer, size_t error_capacity);
+    /* asset_export with entries compressed on a worker pool and written in order by the calling thread. NULL
+     * options behave like asset_export: one thread, nothing compressed. */
+    bool asset_export_with_options(const struct FamilyTree *tree, const char *asset_root, const char *tree_json_path,
+                                   const char *package_path, const AssetExportOptions *options,
+                                   AssetExportStats *stats, char *error_buffer, size_t error_capacity);
+
+    /* A read-only view of an exported package. The file is mapped once and entries are located through the
+     * package's trailing directory (or, for packages written before it existed, an index built on open). */
+    typedef struct AssetPackage AssetPackage;
+
+    typedef struct AssetPackageEntry
+    {
+        const char *path;           /* Entry path within the package; not NUL-terminated. */
+        size_t path_length;         /* Bytes in path. */
+        const unsigned char *data;  /* Stored bytes, valid until the package is closed. */
+        uint64_t size;              /* Bytes in data. */
+        uint64_t raw_size;          /* Bytes once decoded; equals size for uncompressed entries. */
+        AssetPackageCodec codec;    /* How data is encoded. */
+        uint32_t checksum;          /* Checksum of data recorded by the writer when has_checksum is set. */
+        bool has_checksum;          /* False for packages that predate the directory. */
+    } AssetPackageEntry;
+
+    AssetPackage *asset_package_open(const char *package_path, char *error_buffer, size_t error_capacity);
+    void asset_package_close(AssetPackage *package);
+    size_t asset_package_entry_count(const AssetPackage *package);
+    /* Entries are ordered by path. */
+    bool asset_package_entry_at(const AssetPackage *package, size_t index, AssetPackageEntry *out_entry);
+    /* Binary search over the directory; entry_path uses the package's form, e.g. "tree.json" or "assets/a.png". */
+    bool asset_package_read_entry(const AssetPackage *package, const char *entry_path, AssetPackageEntry *out_entry);
+    /* Recomputes the entry's checksum; entries without one are reported intact. */
+    bool asset_package_entry_is_intact(const AssetPackageEntry *entry);
+    /* Decodes the entry into buffer, which must hold raw_size bytes. */
+    bool asset_package_entry_decode(const AssetPackageEntry *entry, unsigned char *buffer, size_t capacity);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,18 @@
+#ifndef AT_COMPRESS_H
+#define AT_COMPRESS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Byte-oriented LZ77 block codec in the style of LZ4: sequences of literals plus (offset, length) back references
+ * within a 64 KiB window. Fast on both sides and about 5-10x on JSON; not an LZ4-compatible stream. */
+
+/* Worst-case compressed size for size input bytes. */
+size_t at_compress_bound(size_t size);
+/* Compresses size bytes into dst. Returns the compressed length, or 0 when it would not fit in capacity (pass
+ * at_compress_bound(size) to always succeed) or memory is exhausted. */
+size_t at_compress(const unsigned char *src, size_t size, unsigned char *dst, size_t capacity);
+/* Expands a block produced by at_compress; fails unless it decodes to exactly raw_size bytes. */
+bool at_decompress(const unsigned char *src, size_t size, unsigned char *dst, size_t raw_size);
+
+#endif /* AT_COMPRESS_H */
@@ -21,6 +21,18 @@ typedef struct AtMemoryStats
     size_t peak_bytes;
 } AtMemoryStats;
 
+/* Aggregate for one AT_MALLOC/AT_CALLOC/AT_REALLOC call site; a reallocation counts at the site that made it. */
+typedef struct AtMemorySiteStats
+{
+    const char *file;
+    int line;
+    size_t allocations;
+    size_t total_bytes;
+    size_t outstanding_allocations;
+    size_t outstanding_bytes;
+    size_t peak_bytes;
+} AtMemorySiteStats;
+
 bool at_check_mul_overflow_size(size_t a, size_t b, size_t *out_result);
 void *at_secure_realloc_impl(void *ptr, size_t new_count, size_t element_size, const char *file, int line);
 
@@ -33,6 +45,9 @@ void at_memory_reset_tracking(void);
 size_t at_memory_outstanding_allocations(void);
 size_t at_memory_outstanding_bytes(void);
 void at_memory_report_leaks(void);
+/* Copies up to capacity sites in first-seen order and returns how many exist; 0 when tracking is disabled. */
+size_t at_memory_get_site_stats(AtMemorySiteStats *out_sites, size_t capacity);
+bool at_memory_find_site_stats(const char *file, int line, AtMemorySiteStats *out_stats);
 
 #define at_secure_realloc(ptr, new_count, element_size) \
     at_secure_realloc_impl((ptr), (new_count), (element_size), __FILE__, __LINE__)
@@ -0,0 +1,30 @@
+#ifndef AT_STRING_POOL_H
+#define AT_STRING_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Reference-counted interning pool: equal strings share one copy carved from large arena blocks. */
+typedef struct AtStringPool AtStringPool;
+
+typedef struct AtStringPoolStats
+{
+    size_t unique_strings;  /* Distinct live values. */
+    size_t references;      /* Live handles held by callers. */
+    size_t bytes_stored;    /* Bytes occupied by the distinct values, terminators included. */
+    size_t bytes_requested; /* Bytes the same handles would need as private copies. */
+    size_t bytes_saved;     /* bytes_requested - bytes_stored. */
+    size_t arena_bytes;     /* Bytes reserved in arena blocks and oversized entries. */
+} AtStringPoolStats;
+
+AtStringPool *at_string_pool_create(void);
+void at_string_pool_destroy(AtStringPool *pool);
+/* Returns the shared copy of value with one more reference, or NULL when value is NULL or allocation fails. */
+const char *at_string_pool_intern(AtStringPool *pool, const char *value);
+/* Drops one reference taken by at_string_pool_intern; the storage is recycled when the last one goes. */
+void at_string_pool_release(AtStringPool *pool, const char *value);
+/* Turns later releases into no-ops so owners can be torn down right before the pool itself. */
+void at_string_pool_discard(AtStringPool *pool);
+void at_string_pool_get_stats(const AtStringPool *pool, AtStringPoolStats *out_stats);
+
+#endif /* AT_STRING_POOL_H */
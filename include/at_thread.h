@@ -0,0 +1,77 @@
+#ifndef AT_THREAD_H
+#define AT_THREAD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    typedef void (*AtThreadFunction)(void *user_data);
+
+    /* Thread handle owned by the caller; the struct must stay at a stable address until joined. */
+    typedef struct AtThread
+    {
+#if defined(_WIN32)
+        void *handle;
+#else
+        pthread_t handle;
+#endif
+        AtThreadFunction function;
+        void *user_data;
+        bool started;
+    } AtThread;
+
+    typedef struct AtMutex
+    {
+#if defined(_WIN32)
+        void *native; /* SRWLOCK storage (pointer sized). */
+#else
+        pthread_mutex_t native;
+#endif
+    } AtMutex;
+
+    typedef struct AtCondition
+    {
+#if defined(_WIN32)
+        void *native; /* CONDITION_VARIABLE storage (pointer sized). */
+#else
+        pthread_cond_t native;
+#endif
+    } AtCondition;
+
+#if defined(_WIN32)
+#define AT_MUTEX_INITIALIZER {NULL}
+#else
+#define AT_MUTEX_INITIALIZER {PTHREAD_MUTEX_INITIALIZER}
+#endif
+
+    bool at_thread_start(AtThread *thread, AtThreadFunction function, void *user_data);
+    bool at_thread_join(AtThread *thread);
+    bool at_thread_is_started(const AtThread *thread);
+    /* Online logical processors; at least 1. */
+    size_t at_thread_hardware_concurrency(void);
+
+    void at_mutex_init(AtMutex *mutex);
+    void at_mutex_destroy(AtMutex *mutex);
+    void at_mutex_lock(AtMutex *mutex);
+    void at_mutex_unlock(AtMutex *mutex);
+
+    void at_condition_init(AtCondition *condition);
+    void at_condition_destroy(AtCondition *condition);
+    /* Releases mutex while waiting and holds it again on return; wakeups may be spurious. */
+    void at_condition_wait(AtCondition *condition, AtMutex *mutex);
+    void at_condition_signal(AtCondition *condition);
+    void at_condition_broadcast(AtCondition *condition);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AT_THREAD_H */
@@ -0,0 +1,7 @@
+#ifndef AT_TIME_H
+#define AT_TIME_H
+
+/* Monotonic clock in seconds for measuring intervals; the epoch is unspecified. */
+double at_time_now_seconds(void);
+
+#endif /* AT_TIME_H */
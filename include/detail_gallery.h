@@ -4,7 +4,10 @@
 #include <stdbool.h>
 #include <stddef.h>
 
+#include "texture_residency.h"
+
 struct Person;
+struct ThumbnailCache;
 
 #if defined(ANCESTRYTREE_HAVE_RAYLIB)
 #include <raylib.h>
@@ -15,8 +18,13 @@ typedef struct DetailGalleryEntry
     char *path;
     bool file_available;
 #if defined(ANCESTRYTREE_HAVE_RAYLIB)
-    Texture2D texture;
+    Texture2D texture; /* Full resolution; only loaded while zoomed past detail_gallery_full_resolution_zoom(). */
     bool texture_loaded;
+    Texture2D thumbnail;
+    bool thumbnail_loaded;
+    TextureResidencyHandle texture_handle;
+    TextureResidencyHandle thumbnail_handle;
+    bool texture_over_budget; /* Full resolution was refused; retried once the full-size textures are released. */
 #endif
 } DetailGalleryEntry;
 
@@ -27,8 +35,14 @@ typedef struct DetailGallery
     size_t capacity;
     int selected_index;
     float zoom;
+    bool full_resolution;
+    struct ThumbnailCache *thumbnails; /* Borrowed; NULL loads every texture at full resolution. */
+    TextureResidency *residency;       /* Borrowed; NULL leaves uploads unbudgeted. */
 } DetailGallery;
 
+/* Returning false stops the walk. */
+typedef bool (*DetailGalleryMediaVisitor)(const char *path, void *user_data);
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -38,6 +52,9 @@ extern "C"
     void detail_gallery_reset(DetailGallery *gallery);
     void detail_gallery_shutdown(DetailGallery *gallery);
     bool detail_gallery_populate_from_person(DetailGallery *gallery, const struct Person *person);
+    /* Calls visitor for the profile image, certificates and timeline media of person, in gallery order. */
+    bool detail_gallery_visit_person_media(const struct Person *person, DetailGalleryMediaVisitor visitor,
+                                           void *user_data);
     bool detail_gallery_has_media(const DetailGallery *gallery);
     const DetailGalleryEntry *detail_gallery_get_entry(const DetailGallery *gallery, size_t index);
     bool detail_gallery_select(DetailGallery *gallery, size_t index);
@@ -47,8 +64,13 @@ extern "C"
     void detail_gallery_set_zoom(DetailGallery *gallery, float zoom);
     float detail_gallery_min_zoom(void);
     float detail_gallery_max_zoom(void);
+    float detail_gallery_full_resolution_zoom(void);
+    bool detail_gallery_uses_full_resolution(const DetailGallery *gallery);
+    void detail_gallery_set_thumbnail_cache(DetailGallery *gallery, struct ThumbnailCache *cache);
+    void detail_gallery_set_texture_residency(DetailGallery *gallery, TextureResidency *residency);
 
 #if defined(ANCESTRYTREE_HAVE_RAYLIB)
+    /* Returns 0 while a thumbnail is still being generated; callers draw a placeholder and ask again. */
     unsigned int detail_gallery_acquire_texture(DetailGallery *gallery, size_t index);
     void detail_gallery_release_textures(DetailGallery *gallery);
 #endif
@@ -0,0 +1,35 @@
+#ifndef DETAIL_PREFETCH_H
+#define DETAIL_PREFETCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct Person;
+struct ThumbnailCache;
+
+/* Warms the thumbnail cache for the people the user is likely to open next: the focused person and its parents,
+ * spouses and children. Decoded results are held within the cache's prefetch budget. */
+typedef struct DetailPrefetch
+{
+    struct ThumbnailCache *thumbnails; /* Borrowed; NULL disables prefetching. */
+    uint32_t focus_id;
+    bool has_focus;
+} DetailPrefetch;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    void detail_prefetch_init(DetailPrefetch *prefetch, struct ThumbnailCache *thumbnails);
+    /* Call every frame with the selected or hovered person. Only a change of focus does any work: prefetches
+     * that have not started are dropped and the new neighbourhood is queued. NULL keeps the current work.
+     * Returns the number of files queued. */
+    size_t detail_prefetch_focus(DetailPrefetch *prefetch, const struct Person *person);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DETAIL_PREFETCH_H */
@@ -9,10 +9,12 @@
 #endif
 
 #include "detail_gallery.h"
+#include "detail_prefetch.h"
 #include "detail_timeline.h"
 
 struct Person;
 struct nk_context;
+struct ThumbnailCache;
 
 typedef struct DetailViewState
 {
@@ -22,11 +24,17 @@ typedef struct DetailViewState
     DetailGallery gallery;
     DetailTimeline timeline;
     int gallery_hover_index;
+    struct ThumbnailCache *thumbnails; /* Shared by the profile image and the gallery; NULL in headless builds. */
+    DetailPrefetch prefetch;
+    TextureResidency *residency; /* Borrowed; shared with the gallery. */
 #if defined(ANCESTRYTREE_HAVE_RAYLIB)
     Texture2D profile_texture;
     bool profile_texture_loaded;
+    bool profile_failed; /* The thumbnail could not be decoded; not retried until the person changes. */
+    TextureResidencyHandle profile_handle;
     Texture2D certificate_preview_texture;
     bool certificate_preview_loaded;
+    TextureResidencyHandle certificate_preview_handle;
     char certificate_preview_path[260];
 #endif
 } DetailViewState;
@@ -39,6 +47,10 @@ extern "C"
     void detail_view_state_reset(DetailViewState *state);
     bool detail_view_init(DetailViewState *state);
     void detail_view_cleanup(DetailViewState *state);
+    /* Budgets the profile, certificate preview and gallery textures against residency. */
+    void detail_view_set_texture_residency(DetailViewState *state, TextureResidency *residency);
+    /* Warms media for person and its relatives; pass the selected or hovered person every frame. */
+    void detail_view_prefetch(DetailViewState *state, const struct Person *person);
     bool detail_view_render(DetailViewState *state, struct nk_context *ctx, const struct Person *person,
                             int viewport_width, int viewport_height, bool *out_exit_requested);
 
@@ -3,6 +3,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 typedef enum JsonValueType
 {
@@ -22,6 +23,8 @@ void json_value_destroy(JsonValue *value);
 JsonValueType json_value_type(const JsonValue *value);
 bool json_value_get_bool(const JsonValue *value, bool *out_value);
 bool json_value_get_number(const JsonValue *value, double *out_value);
+/* Exact for integer tokens; fails on negatives, fractions and values above UINT32_MAX. */
+bool json_value_get_uint32(const JsonValue *value, uint32_t *out_value);
 const char *json_value_get_string(const JsonValue *value);
 size_t json_value_array_size(const JsonValue *value);
 JsonValue *json_value_array_get(const JsonValue *value, size_t index);
@@ -30,4 +33,8 @@ size_t json_value_object_size(const JsonValue *value);
 const char *json_value_object_key(const JsonValue *value, size_t index);
 JsonValue *json_value_object_value(const JsonValue *value, size_t index);
 
+/* Length of the leading run of data that is copied verbatim inside a JSON string: no quote, backslash or
+ * control byte. Used by both the parser and the archive writer to move clean spans with memcpy. */
+size_t json_string_plain_prefix(const char *data, size_t length);
+
 #endif /* JSON_PARSER_H */
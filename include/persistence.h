@@ -9,6 +9,33 @@
 
 typedef struct PersistenceAutoSaveConfig PersistenceAutoSaveConfig;
 typedef struct PersistenceAutoSave PersistenceAutoSave;
+typedef struct PersistenceAutoSaveJob PersistenceAutoSaveJob;
+
+typedef enum PersistenceJournalOperation
+{
+    PERSISTENCE_JOURNAL_ADD = 0,
+    PERSISTENCE_JOURNAL_DELETE,
+    PERSISTENCE_JOURNAL_EDIT
+} PersistenceJournalOperation;
+
+/* Append-only log of person changes made since the snapshot it sits next to ("<snapshot>.journal"). */
+typedef struct PersistenceJournal
+{
+    char *path;
+    char *pending; /* Framed records buffered until the next flush. */
+    size_t pending_length;
+    size_t pending_capacity;
+    size_t pending_records;
+    size_t committed_records; /* Records already on disk since the last compaction. */
+} PersistenceJournal;
+
+typedef enum PersistenceAutoSaveEvent
+{
+    PERSISTENCE_AUTO_SAVE_EVENT_NONE = 0,
+    PERSISTENCE_AUTO_SAVE_EVENT_STARTED,
+    PERSISTENCE_AUTO_SAVE_EVENT_COMPLETED,
+    PERSISTENCE_AUTO_SAVE_EVENT_FAILED
+} PersistenceAutoSaveEvent;
 
 struct PersistenceAutoSaveConfig
 {
@@ -27,6 +54,13 @@ struct PersistenceAutoSave
     double elapsed_seconds;
     bool enabled;
     bool dirty;
+    bool background;                     /* Serialise snapshots on a writer thread instead of the caller. */
+    PersistenceAutoSaveJob *job;         /* In-flight background save, NULL when idle. */
+    PersistenceAutoSaveEvent last_event; /* Outcome reported by the most recent tick/flush/wait. */
+    PersistenceJournal journal;
+    bool journal_enabled;
+    bool snapshot_required;      /* Dirty state the journal cannot describe (tree swaps, untracked edits). */
+    size_t compaction_threshold; /* Journal records tolerated before rewriting the full snapshot. */
 };
 
 #ifdef __cplusplus
@@ -36,6 +70,26 @@ extern "C"
 
     bool persistence_tree_save(const FamilyTree *tree, const char *path, char *error_buffer, size_t error_buffer_size);
     FamilyTree *persistence_tree_load(const char *path, char *error_buffer, size_t error_buffer_size);
+    /* Loads the snapshot at path and replays any journal left next to it by an interrupted session. */
+    FamilyTree *persistence_tree_recover(const char *path, size_t *out_replayed, char *error_buffer,
+                                         size_t error_buffer_size);
+    /* Startup step: when a journal with records sits next to the snapshot at path, replays it, rewrites the
+     * snapshot and only then removes the journal. *out_tree stays NULL when there was nothing to replay. If
+     * replay or the rewrite fails the journal is moved to "<journal>.unrecovered" so the next auto-save cannot
+     * delete it; the error names where the journal ended up. */
+    bool persistence_journal_recover_pending(const char *path, FamilyTree **out_tree, size_t *out_replayed,
+                                             char *error_buffer, size_t error_buffer_size);
+
+    bool persistence_journal_init(PersistenceJournal *journal, const char *snapshot_path, char *error_buffer,
+                                  size_t error_buffer_size);
+    void persistence_journal_shutdown(PersistenceJournal *journal);
+    bool persistence_journal_record(PersistenceJournal *journal, PersistenceJournalOperation operation,
+                                    const Person *person, char *error_buffer, size_t error_buffer_size);
+    bool persistence_journal_flush(PersistenceJournal *journal, char *error_buffer, size_t error_buffer_size);
+    void persistence_journal_discard_pending(PersistenceJournal *journal);
+    bool persistence_journal_reset(PersistenceJournal *journal, char *error_buffer, size_t error_buffer_size);
+    bool persistence_journal_replay(FamilyTree *tree, const char *journal_path, size_t *out_applied,
+                                    char *error_buffer, size_t error_buffer_size);
 
     bool persistence_auto_save_init(PersistenceAutoSave *state, const PersistenceAutoSaveConfig *config,
                                     char *error_buffer, size_t error_buffer_size);
@@ -48,6 +102,13 @@ extern "C"
                                            size_t error_buffer_size);
     void persistence_auto_save_set_enabled(PersistenceAutoSave *state, bool enabled);
     void persistence_auto_save_set_interval(PersistenceAutoSave *state, unsigned int interval_seconds);
+    void persistence_auto_save_set_background(PersistenceAutoSave *state, bool background);
+    bool persistence_auto_save_is_busy(const PersistenceAutoSave *state);
+    bool persistence_auto_save_wait(PersistenceAutoSave *state, char *error_buffer, size_t error_buffer_size);
+    bool persistence_auto_save_enable_journal(PersistenceAutoSave *state, size_t compaction_threshold,
+                                              char *error_buffer, size_t error_buffer_size);
+    bool persistence_auto_save_record_change(PersistenceAutoSave *state, PersistenceJournalOperation operation,
+                                             const Person *person, char *error_buffer, size_t error_buffer_size);
     bool persistence_auto_save_set_tree_supplier(PersistenceAutoSave *state,
                                                  FamilyTree *(*tree_supplier)(void *user_data), void *user_data,
                                                  char *error_buffer, size_t error_buffer_size);
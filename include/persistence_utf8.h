@@ -0,0 +1,32 @@
+#ifndef PERSISTENCE_UTF8_H
+#define PERSISTENCE_UTF8_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    typedef enum PersistenceUtf8Kernel
+    {
+        PERSISTENCE_UTF8_KERNEL_SCALAR = 0,
+        PERSISTENCE_UTF8_KERNEL_SSE4,
+        PERSISTENCE_UTF8_KERNEL_AVX2
+    } PersistenceUtf8Kernel;
+
+    /* NULL counts as valid; dispatches to the widest kernel the CPU supports. */
+    bool persistence_utf8_validate(const char *value);
+    bool persistence_utf8_validate_length(const char *data, size_t length);
+    /* Byte-at-a-time reference validator; the vector kernels must agree with it on every input. */
+    bool persistence_utf8_validate_scalar(const char *data, size_t length);
+    bool persistence_utf8_validate_with(PersistenceUtf8Kernel kernel, const char *data, size_t length);
+    bool persistence_utf8_kernel_supported(PersistenceUtf8Kernel kernel);
+    PersistenceUtf8Kernel persistence_utf8_best_kernel(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PERSISTENCE_UTF8_H */
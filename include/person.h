@@ -35,6 +35,8 @@ typedef enum PersonParentSlot
 } PersonParentSlot;
 
 struct Person;
+struct AtStringPool;
+struct PersonSlab;
 
 typedef struct PersonSpouseRecord
 {
@@ -66,10 +68,26 @@ typedef struct Person
     PersonMetadataEntry *metadata;
     size_t metadata_count;
     size_t metadata_capacity;
+    /* Interning pool owning the string fields while the person belongs to a tree; NULL means private copies.
+     * Either way the strings are read-only: change them through the setters below. */
+    struct AtStringPool *string_pool;
+    /* Slab the record was carved from (normally its tree's); NULL for heap records. */
+    struct PersonSlab *slab;
 } Person;
 
 Person *person_create(uint32_t id);
+/* Record from slab (heap when NULL) with strings interned into pool (private when NULL). */
+Person *person_create_in(uint32_t id, struct PersonSlab *slab, struct AtStringPool *pool);
 void person_destroy(Person *person);
+/* Teardown of a whole tree: frees only the arrays the person owns on the heap. Its pooled strings and its slab
+ * record are left for the owner, which discards the pool and abandons the slab in one step each. */
+void person_release_arrays(Person *person);
+/* Deep-copies all owned data; parent/child/spouse pointers still reference the source graph until remapped. */
+Person *person_clone(const Person *source);
+/* As person_clone, with the copy allocated as by person_create_in. */
+Person *person_clone_into(const Person *source, struct PersonSlab *slab, struct AtStringPool *pool);
+/* Moves every string field (timeline entries excluded) into pool, or back to private copies when pool is NULL. */
+bool person_bind_string_pool(Person *person, struct AtStringPool *pool);
 
 bool person_set_name(Person *person, const char *first, const char *middle, const char *last);
 bool person_set_birth(Person *person, const char *date, const char *location);
@@ -79,11 +97,17 @@ bool person_set_parent(Person *child, Person *parent, PersonParentSlot slot);
 bool person_add_child(Person *parent, Person *child);
 bool person_add_spouse(Person *person, Person *spouse);
 bool person_add_certificate(Person *person, const char *path);
+bool person_set_profile_image(Person *person, const char *path);
 bool person_add_timeline_entry(Person *person, const TimelineEntry *entry);
 bool person_metadata_set(Person *person, const char *key, const char *value);
 bool person_set_marriage(Person *person, Person *spouse, const char *date, const char *location);
+/* Drops every parent, child and spouse link for which is_removed holds, keeping the order of the rest; dropped
+ * spouse records release their marriage strings. One pass per array. */
+void person_remove_links(Person *person, bool (*is_removed)(const Person *other, void *context), void *context);
 
 bool person_validate(const Person *person, char *error_buffer, size_t error_buffer_size);
+/* person_validate without the walk over descendants, for callers that check cycles across a whole tree. */
+bool person_validate_record(const Person *person, char *error_buffer, size_t error_buffer_size);
 bool person_format_display_name(const Person *person, char *buffer, size_t capacity);
 
 #endif /* PERSON_H */
@@ -0,0 +1,31 @@
+#ifndef PERSON_SLAB_H
+#define PERSON_SLAB_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+struct Person;
+
+/* Hands out zeroed Person records from contiguous blocks; released records go on a free list for reuse. */
+typedef struct PersonSlab PersonSlab;
+
+typedef struct PersonSlabStats
+{
+    size_t block_count;
+    size_t capacity;     /* Records carved out of all blocks so far. */
+    size_t live_records; /* Records handed out and not yet released. */
+    size_t free_records; /* Released records waiting on the free list. */
+} PersonSlabStats;
+
+PersonSlab *person_slab_create(void);
+struct Person *person_slab_acquire(PersonSlab *slab);
+/* Returns a record to the free list; frees the whole slab if it was orphaned and this was the last record. */
+void person_slab_release(PersonSlab *slab, struct Person *person);
+/* Called by the owner instead of destroying: blocks are freed now, or once the last live record is released. */
+void person_slab_orphan(PersonSlab *slab);
+/* As person_slab_orphan, first forgetting abandoned live records that will never be released; their memory goes
+ * with the blocks, so a whole tree is returned block by block instead of record by record. */
+void person_slab_abandon(PersonSlab *slab, size_t abandoned);
+void person_slab_get_stats(const PersonSlab *slab, PersonSlabStats *out_stats);
+
+#endif /* PERSON_SLAB_H */
@@ -13,6 +13,8 @@ struct LayoutResult;
 struct LayoutNode;
 struct Person;
 struct ExpansionState;
+struct TextureResidency;
+struct RenderConnectionCache;
 #if defined(ANCESTRYTREE_HAVE_RAYLIB)
 struct RenderLabelSystem;
 #endif
@@ -68,6 +70,7 @@ typedef struct RenderState
     const struct LayoutNode **batch_alive_nodes;
     const struct LayoutNode **batch_deceased_nodes;
     size_t batch_capacity;
+    struct RenderConnectionCache *connection_cache;
 #if defined(ANCESTRYTREE_HAVE_RAYLIB)
     struct Shader glow_shader;
     int glow_intensity_loc;
@@ -79,6 +82,7 @@ typedef struct RenderState
     struct RenderLabelSystem *label_system;
     bool label_system_ready;
     float label_system_font_size_applied;
+    struct TextureResidency *texture_residency;
 #endif
 } RenderState;
 
@@ -90,16 +94,25 @@ bool render_init(RenderState *state, const RenderConfig *config, char *error_buf
 void render_cleanup(RenderState *state);
 bool render_resize(RenderState *state, int width, int height, char *error_buffer, size_t error_buffer_size);
 bool render_has_render_target(const RenderState *state);
+/* Budgets name-panel textures against residency; call after render_init, which clears it. */
+void render_set_texture_residency(RenderState *state, struct TextureResidency *residency);
 
 bool render_scene(RenderState *state, const struct LayoutResult *layout, const struct CameraController *camera,
                   const struct Person *selected_person, const struct Person *hovered_person,
                   const struct ExpansionState *expansion);
 bool render_connections_render(RenderState *state, const struct LayoutResult *layout);
 
+/* Connections come from a relationship graph cached across frames and rebuilt only for a layout showing persons it
+ * does not know. Report person changes so edits reach it; invalidate whenever the whole tree is replaced. */
+void render_connections_person_added(RenderState *state, struct Person *person);
+void render_connections_person_edited(RenderState *state, const struct Person *person);
+void render_connections_person_removed(RenderState *state, const struct Person *person);
+void render_connections_invalidate(RenderState *state);
+
 bool render_find_person_position(const struct LayoutResult *layout, const struct Person *person, float out_position[3]);
-size_t render_collect_parent_child_segments(const struct LayoutResult *layout, RenderConnectionSegment *segments,
-                                            size_t segment_capacity);
-size_t render_collect_spouse_segments(const struct LayoutResult *layout, RenderConnectionSegment *segments,
-                                      size_t segment_capacity);
+size_t render_collect_parent_child_segments(RenderState *state, const struct LayoutResult *layout,
+                                            RenderConnectionSegment *segments, size_t segment_capacity);
+size_t render_collect_spouse_segments(RenderState *state, const struct LayoutResult *layout,
+                                      RenderConnectionSegment *segments, size_t segment_capacity);
 
 #endif /* RENDER_H */
@@ -4,6 +4,8 @@
 #include <stdbool.h>
 #include <stddef.h>
 
+#include "texture_residency.h"
+
 #if defined(ANCESTRYTREE_HAVE_RAYLIB)
 #include <raylib.h>
 #endif
@@ -36,6 +38,7 @@ typedef struct RenderLabelEntry
     float height_pixels;
     float font_size;
     bool in_use;
+    TextureResidencyHandle residency_handle;
 #else
     unsigned int person_id;
     float font_size;
@@ -54,6 +57,7 @@ typedef struct RenderLabelSystem
     Color background_color_top;
     Color background_color_bottom;
     Color frame_color;
+    TextureResidency *residency; /* Borrowed; NULL leaves label uploads unbudgeted. */
 #else
     RenderLabelEntry *entries;
     size_t count;
@@ -67,6 +71,7 @@ void render_labels_shutdown(RenderLabelSystem *system);
 void render_labels_begin_frame(RenderLabelSystem *system);
 void render_labels_end_frame(RenderLabelSystem *system);
 void render_labels_set_base_font_size(RenderLabelSystem *system, float font_size);
+void render_labels_set_texture_residency(RenderLabelSystem *system, TextureResidency *residency);
 bool render_labels_acquire(RenderLabelSystem *system, const struct Person *person, bool include_profile,
                            float font_size, RenderLabelInfo *out_info);
 
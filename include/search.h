@@ -21,6 +21,8 @@ extern "C"
         int birth_year_max;
     } SearchFilter;
 
+    /* Returns the first capacity matches ordered by case-insensitive display name, then id. Builds tree->search on
+     * first use; its folded names serve as the sort keys. */
     size_t search_execute(const FamilyTree *tree, const SearchFilter *filter, const Person **out_results,
                           size_t capacity);
 
@@ -0,0 +1,35 @@
+#ifndef SEARCH_INDEX_H
+#define SEARCH_INDEX_H
+
+#include "person.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Lower-cased display names of a tree's members plus a trigram posting list over them. Entries keep the order
+ * persons were added in, which matches tree->persons because the tree only appends and removes stably. */
+typedef struct SearchIndex SearchIndex;
+
+/* folded_name is the person's entry in the index; it doubles as a case-insensitive sort key. */
+typedef bool (*SearchIndexVisitor)(const Person *person, const char *folded_name, void *user_data);
+
+SearchIndex *search_index_create(void);
+void search_index_destroy(SearchIndex *index);
+/* Builds from persons unless the index is already current; edits through the calls below keep it so. */
+bool search_index_ensure(SearchIndex *index, Person *const *persons, size_t count);
+bool search_index_is_built(const SearchIndex *index);
+/* No-ops until the index is first built; a failed update marks it for a rebuild on the next ensure. */
+void search_index_add_person(SearchIndex *index, const Person *person);
+void search_index_update_person(SearchIndex *index, const Person *person);
+void search_index_remove_person(SearchIndex *index, const Person *person);
+
+/* Visits, in index order, every member whose folded name contains needle (compared as given, so pass it
+ * lower-cased; an empty needle visits everyone) until visit returns false. Returns the number visited. */
+size_t search_index_query(const SearchIndex *index, const char *needle, SearchIndexVisitor visit, void *user_data);
+/* The folded display name the index matches against, or NULL for persons it does not hold. */
+const char *search_index_folded_name(const SearchIndex *index, const Person *person);
+/* Lower-cased display name, or "person <id>" when the person has no name parts; the rule both search paths use. */
+void search_index_fold_name(const Person *person, char *buffer, size_t capacity);
+
+#endif /* SEARCH_INDEX_H */
@@ -40,6 +40,7 @@ typedef struct Settings
     SettingsLayoutAlgorithm default_layout_algorithm;
     SettingsColorScheme color_scheme;
     SettingsLanguage language;
+    unsigned int texture_budget_megabytes;
     unsigned int revision;
 } Settings;
 
@@ -6,6 +6,7 @@
 #include "settings.h"
 #include "camera_controller.h"
 #include "render.h"
+#include "texture_residency.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -16,6 +17,9 @@ extern "C"
 
     bool settings_runtime_apply_render(const Settings *settings, RenderConfig *config);
 
+    /* Clamps the configured budget to 16..8192 MiB and applies it, evicting idle textures when it shrinks. */
+    bool settings_runtime_apply_texture_budget(const Settings *settings, TextureResidency *residency);
+
     void settings_runtime_compute_input_sensitivity(const Settings *settings, float *orbit_sensitivity,
                                                     float *pan_mouse_sensitivity, float *pan_keyboard_sensitivity,
                                                     float *zoom_sensitivity);
@@ -0,0 +1,96 @@
+#ifndef TEXTURE_RESIDENCY_H
+#define TEXTURE_RESIDENCY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Accounts for every GPU texture the UI and renderer keep alive and holds them to one byte budget. The module
+ * never touches the GPU itself: consumers reserve room before uploading, track what they uploaded and unload
+ * when the manager asks them to through their evict callback. Textures used in the current frame are never
+ * evicted, because their draw calls may still be queued. */
+
+typedef enum TextureResidencyKind
+{
+    TEXTURE_RESIDENCY_DETAIL_VIEW = 0, /* Profile image and certificate preview. */
+    TEXTURE_RESIDENCY_GALLERY,
+    TEXTURE_RESIDENCY_LABEL,
+    TEXTURE_RESIDENCY_KIND_COUNT
+} TextureResidencyKind;
+
+/* 0 is never a valid handle, so consumers can use it for "untracked". */
+typedef uint32_t TextureResidencyHandle;
+
+/* Must unload the texture and forget its handle; slot is whatever the owner passed to track. */
+typedef void (*TextureResidencyEvictFunction)(void *owner, size_t slot);
+
+typedef struct TextureResidencyCounters
+{
+    size_t budget_bytes;
+    size_t resident_bytes;
+    size_t resident_textures;
+    size_t peak_bytes;
+    size_t bytes_by_kind[TEXTURE_RESIDENCY_KIND_COUNT];
+    size_t textures_by_kind[TEXTURE_RESIDENCY_KIND_COUNT];
+    size_t evictions;
+    size_t evicted_bytes;
+    size_t rejected_reservations; /* Requests that did not fit even after evicting everything idle. */
+} TextureResidencyCounters;
+
+typedef struct TextureResidencyEntry
+{
+    TextureResidencyKind kind;
+    size_t bytes;
+    uint64_t last_frame;
+    TextureResidencyEvictFunction evict;
+    void *owner;
+    size_t slot;
+    uint32_t previous; /* LRU list links as handles; 0 ends the list. */
+    uint32_t next;     /* Doubles as the free-list link for unused entries. */
+    bool in_use;
+} TextureResidencyEntry;
+
+typedef struct TextureResidency
+{
+    TextureResidencyEntry *entries;
+    size_t capacity;
+    uint32_t free_head;
+    uint32_t lru_head; /* Least recently used. */
+    uint32_t lru_tail;
+    uint64_t frame;
+    TextureResidencyCounters counters;
+} TextureResidency;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    void texture_residency_init(TextureResidency *residency, size_t budget_bytes);
+    /* Forgets all tracking without calling evict; owners are expected to have unloaded already. */
+    void texture_residency_shutdown(TextureResidency *residency);
+    /* A smaller budget evicts idle textures immediately. */
+    void texture_residency_set_budget(TextureResidency *residency, size_t budget_bytes);
+    void texture_residency_begin_frame(TextureResidency *residency);
+
+    /* RGBA8 footprint, plus a third for the mip chain when mipmapped. */
+    size_t texture_residency_estimate_bytes(int width, int height, bool mipmapped);
+    /* Evicts least recently used idle textures until bytes more fit. False means skip the upload. A NULL
+     * manager always succeeds, so consumers work unchanged without one. */
+    bool texture_residency_reserve(TextureResidency *residency, size_t bytes);
+    /* Records a texture uploaded after a successful reserve; it counts as used this frame. Returns 0 when
+     * residency is NULL or out of memory, in which case the texture is simply untracked. */
+    TextureResidencyHandle texture_residency_track(TextureResidency *residency, TextureResidencyKind kind,
+                                                   size_t bytes, TextureResidencyEvictFunction evict, void *owner,
+                                                   size_t slot);
+    /* Marks the texture as drawn this frame. */
+    void texture_residency_touch(TextureResidency *residency, TextureResidencyHandle handle);
+    /* The owner unloaded the texture itself; no callback is made. */
+    void texture_residency_release(TextureResidency *residency, TextureResidencyHandle handle);
+    void texture_residency_get_counters(const TextureResidency *residency, TextureResidencyCounters *out_counters);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TEXTURE_RESIDENCY_H */
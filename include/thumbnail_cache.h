@@ -0,0 +1,87 @@
+#ifndef THUMBNAIL_CACHE_H
+#define THUMBNAIL_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define THUMBNAIL_DEFAULT_MAX_EDGE 256
+
+/* Tightly packed RGBA8 pixels in row-major order; the holder of the struct owns the buffer. */
+typedef struct ThumbnailImage
+{
+    unsigned char *pixels;
+    int width;
+    int height;
+} ThumbnailImage;
+
+/* Decodes path into RGBA8. Called on worker threads, so it must not touch GPU or UI state. */
+typedef bool (*ThumbnailDecodeFunction)(const char *path, ThumbnailImage *out_image, void *user_data);
+
+typedef struct ThumbnailCacheConfig
+{
+    const char *cache_directory; /* Created on first write (parent must exist); holds one "<key>.thumb" per version. */
+    int max_edge;                /* Longest thumbnail side in pixels; 0 selects THUMBNAIL_DEFAULT_MAX_EDGE. */
+    size_t worker_count;         /* 0 derives it from the CPU count. */
+    ThumbnailDecodeFunction decode; /* NULL selects the raylib decoder when the build has one. */
+    void *decode_user_data;
+    size_t prefetch_budget_bytes; /* Cap on decoded prefetch pixels held in memory; 0 selects 32 MiB. */
+} ThumbnailCacheConfig;
+
+typedef struct ThumbnailCacheStats
+{
+    size_t prefetched_bytes;   /* Decoded prefetch results waiting to be fetched. */
+    size_t prefetch_hits;      /* Fetches served straight from a prefetch result. */
+    size_t prefetch_evictions; /* Prefetch results dropped to stay within the budget. */
+} ThumbnailCacheStats;
+
+typedef enum ThumbnailStatus
+{
+    THUMBNAIL_STATUS_PENDING = 0,
+    THUMBNAIL_STATUS_READY,
+    THUMBNAIL_STATUS_FAILED
+} ThumbnailStatus;
+
+typedef struct ThumbnailCache ThumbnailCache;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    void thumbnail_image_reset(ThumbnailImage *image);
+    /* Box-filters source so its longest side is at most max_edge, keeping the aspect ratio; smaller images are
+     * copied unchanged. */
+    bool thumbnail_downscale(const ThumbnailImage *source, int max_edge, ThumbnailImage *out_image);
+    /* Identifies the current version of path: a hash of the path, its modification time and size, and max_edge. */
+    bool thumbnail_cache_key(const char *path, int max_edge, uint64_t *out_key);
+    /* Synchronous stage run by the workers: reads the cached thumbnail for path, or decodes, downscales and stores
+     * it. out_cache_hit (optional) reports which happened. */
+    bool thumbnail_cache_load_or_build(const ThumbnailCacheConfig *config, const char *path,
+                                       ThumbnailImage *out_image, bool *out_cache_hit, char *error_buffer,
+                                       size_t error_buffer_size);
+
+    /* Returns NULL when no decoder is available or the workers cannot start. */
+    ThumbnailCache *thumbnail_cache_create(const ThumbnailCacheConfig *config);
+    void thumbnail_cache_destroy(ThumbnailCache *cache);
+    /* Never blocks. The first call for path queues it; READY moves the pixels into out_image (the caller resets
+     * it) and forgets the request, so a later fetch is served from the disk cache. FAILED is reported once and
+     * also forgets the request, so the next fetch retries; callers that poll every frame remember failures. */
+    ThumbnailStatus thumbnail_cache_fetch(ThumbnailCache *cache, const char *path, ThumbnailImage *out_image);
+    /* Blocks until nothing is queued or decoding. */
+    void thumbnail_cache_wait_idle(ThumbnailCache *cache);
+
+    /* Queues path behind every fetch so a later fetch finds it decoded. Results nobody fetches are evicted
+     * oldest first once they exceed the prefetch budget. Returns false when path is already known. */
+    bool thumbnail_cache_prefetch(ThumbnailCache *cache, const char *path);
+    /* Drops prefetches that have not started, e.g. when the focus moves to another person. */
+    void thumbnail_cache_cancel_prefetch(ThumbnailCache *cache);
+    /* True with *out_exists set when a decoded result proves path exists; false means unknown, so stat it. */
+    bool thumbnail_cache_lookup_exists(ThumbnailCache *cache, const char *path, bool *out_exists);
+    void thumbnail_cache_get_stats(ThumbnailCache *cache, ThumbnailCacheStats *out_stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* THUMBNAIL_CACHE_H */
@@ -1,12 +1,16 @@
 #ifndef TREE_H
 #define TREE_H
 
+#include "at_string_pool.h"
 #include "person.h"
+#include "person_slab.h"
 
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
+struct SearchIndex;
+
 typedef struct FamilyTree
 {
     char *name;
@@ -14,17 +18,39 @@ typedef struct FamilyTree
     Person **persons;
     size_t person_count;
     size_t person_capacity;
+    AtStringPool *strings;      /* Interns member names, places, dates and paths. */
+    PersonSlab *slab;           /* Backs persons from family_tree_create_person. */
+    struct SearchIndex *search; /* Name index built on the first search, then kept current by add and remove. */
 } FamilyTree;
 
 FamilyTree *family_tree_create(const char *name);
 void family_tree_destroy(FamilyTree *tree);
+/* Grows tree->persons to hold capacity members without reallocating again. */
+bool family_tree_reserve(FamilyTree *tree, size_t capacity);
+/* Deep copy with relationships remapped onto the copy; returns NULL if a link points outside the tree. */
+FamilyTree *family_tree_clone(const FamilyTree *source);
 
 bool family_tree_set_creation_date(FamilyTree *tree, const char *creation_date_iso8601);
+/* Detached person carved from the tree's slab with pooled strings; add it or person_destroy it. */
+Person *family_tree_create_person(FamilyTree *tree, uint32_t id);
 bool family_tree_add_person(FamilyTree *tree, Person *person);
 Person *family_tree_find_person(const FamilyTree *tree, uint32_t id);
 bool family_tree_remove_person(FamilyTree *tree, uint32_t id);
 Person *family_tree_extract_person(FamilyTree *tree, uint32_t id);
+/* Re-indexes person's name for search; call after editing a member in place. */
+void family_tree_note_person_edited(FamilyTree *tree, const Person *person);
+/* Drops every link other tree members hold to person; the person keeps its own links for relinking. */
+void family_tree_unlink_person(FamilyTree *tree, Person *person);
+/* Restores reciprocal links from person's own relationships to members still present in the tree. */
+bool family_tree_relink_person(FamilyTree *tree, Person *person);
+/* Destroys every tree member listed in persons after survivors drop their links to them. Linear in the tree
+ * size however many are removed; entries that are not members are ignored. Returns the number destroyed. */
+size_t family_tree_remove_persons(FamilyTree *tree, Person *const *persons, size_t count);
 size_t family_tree_get_roots(const FamilyTree *tree, Person **out_roots, size_t capacity);
 bool family_tree_validate(const FamilyTree *tree, char *error_buffer, size_t error_buffer_size);
+/* Just the parent -> child cycle pass of family_tree_validate; linear time, and the message names the full path. */
+bool family_tree_check_cycles(const FamilyTree *tree, char *error_buffer, size_t error_buffer_size);
+/* Deduplication figures for the member strings held in tree->strings. */
+void family_tree_get_string_stats(const FamilyTree *tree, AtStringPoolStats *out_stats);
 
 #endif /* TREE_H */
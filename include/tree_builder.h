@@ -0,0 +1,43 @@
+#ifndef TREE_BUILDER_H
+#define TREE_BUILDER_H
+
+#include "tree.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct FamilyTreeBuilder FamilyTreeBuilder;
+
+typedef struct FamilyTreeBuilderStats
+{
+    size_t persons;
+    size_t relationships;
+    double ingest_seconds;   /* From create to finish: adding persons and queueing links. */
+    double resolve_seconds;  /* Applying the queued links. */
+    double validate_seconds; /* The single family_tree_validate pass. */
+} FamilyTreeBuilderStats;
+
+/* Expected counts only size the initial allocations; either may be exceeded. */
+FamilyTreeBuilder *family_tree_builder_create(const char *name, size_t expected_persons,
+                                              size_t expected_relationships);
+/* Tree under construction, for metadata and family_tree_create_person. Members are not linked until finish. */
+FamilyTree *family_tree_builder_tree(FamilyTreeBuilder *builder);
+/* Takes ownership of person on success; duplicate ids are rejected in constant time. */
+bool family_tree_builder_add_person(FamilyTreeBuilder *builder, Person *person);
+Person *family_tree_builder_find_person(const FamilyTreeBuilder *builder, uint32_t id);
+
+/* Links are queued by id, so either end may be added later. They are applied in the order queued. */
+bool family_tree_builder_add_child(FamilyTreeBuilder *builder, uint32_t parent_id, uint32_t child_id);
+bool family_tree_builder_set_parent(FamilyTreeBuilder *builder, uint32_t child_id, uint32_t parent_id,
+                                    PersonParentSlot slot);
+bool family_tree_builder_add_spouse(FamilyTreeBuilder *builder, uint32_t person_id, uint32_t spouse_id,
+                                    const char *marriage_date, const char *marriage_location);
+
+/* Resolves every queued link, validates once and returns the tree. The builder is released either way; on
+ * failure the partial tree is destroyed and NULL returned. */
+FamilyTree *family_tree_builder_finish(FamilyTreeBuilder *builder, FamilyTreeBuilderStats *out_stats,
+                                       char *error_buffer, size_t error_buffer_size);
+void family_tree_builder_destroy(FamilyTreeBuilder *builder);
+
+#endif /* TREE_BUILDER_H */
@@ -0,0 +1,64 @@
+#ifndef TREE_GRAPH_H
+#define TREE_GRAPH_H
+
+#include "tree.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define TREE_GRAPH_NONE UINT32_MAX
+
+/* One relationship kind in CSR form: node i's neighbours are indices[start[i] .. start[i] + count[i]).
+ * Rows that outgrow their slot on update move to the tail; the holes are compacted once they dominate. */
+typedef struct TreeGraphRows
+{
+    uint32_t *start;
+    uint32_t *count;
+    uint32_t *slot; /* Room reserved at start[i]. */
+    uint32_t *indices;
+    size_t used;
+    size_t capacity;
+    size_t wasted;
+} TreeGraphRows;
+
+/* Dense 32-bit view of the relationships between a set of persons. Links to persons outside the set are
+ * dropped. Node i stands for persons[i]; removed nodes keep their index with a NULL person and empty rows. */
+typedef struct TreeGraph
+{
+    Person **persons;
+    size_t count;
+    size_t node_capacity;
+    TreeGraphRows children;
+    TreeGraphRows parents;
+    TreeGraphRows spouses;
+    const Person **lookup_keys;
+    uint32_t *lookup_values;
+    size_t lookup_capacity;
+} TreeGraph;
+
+void tree_graph_init(TreeGraph *graph);
+void tree_graph_reset(TreeGraph *graph);
+/* The first occurrence wins when persons lists someone twice. */
+bool tree_graph_build(TreeGraph *graph, Person *const *persons, size_t count);
+bool tree_graph_build_from_tree(TreeGraph *graph, const FamilyTree *tree);
+/* root and everyone reachable from it through child links. */
+bool tree_graph_build_descendants(TreeGraph *graph, const Person *root);
+uint32_t tree_graph_find(const TreeGraph *graph, const Person *person);
+
+const uint32_t *tree_graph_children(const TreeGraph *graph, uint32_t node, uint32_t *out_count);
+const uint32_t *tree_graph_parents(const TreeGraph *graph, uint32_t node, uint32_t *out_count);
+const uint32_t *tree_graph_spouses(const TreeGraph *graph, uint32_t node, uint32_t *out_count);
+
+/* Iterative depth-first walk over the child rows in O(V + E). On a cycle, *out_path receives its nodes in
+ * parent -> child order (release with AT_FREE); *out_length stays 0 when there is none. False only when out of
+ * memory. */
+bool tree_graph_find_cycle(const TreeGraph *graph, uint32_t **out_path, size_t *out_length);
+
+/* Incremental edits. Each call re-reads the rows of the person and of every relative on either side of the
+ * edit, so one call per changed person keeps reciprocal rows in sync. */
+bool tree_graph_add_person(TreeGraph *graph, Person *person);
+bool tree_graph_update_person(TreeGraph *graph, const Person *person);
+bool tree_graph_remove_person(TreeGraph *graph, const Person *person);
+
+#endif /* TREE_GRAPH_H */
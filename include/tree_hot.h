@@ -0,0 +1,51 @@
+#ifndef TREE_HOT_H
+#define TREE_HOT_H
+
+#include "tree.h"
+#include "tree_graph.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define TREE_HOT_NONE UINT32_MAX
+
+typedef enum TreeHotFlags
+{
+    TREE_HOT_ALIVE = 1 << 0,
+    TREE_HOT_HAS_BIRTH_YEAR = 1 << 1
+} TreeHotFlags;
+
+/* The fields traversal passes read, packed into 32 bytes. Relatives are dense indices into the same index. */
+typedef struct TreeHotRecord
+{
+    uint32_t id;
+    uint32_t parents[2];    /* TREE_HOT_NONE when unset or outside the tree. */
+    uint32_t child_offset;  /* Span into TreeHotIndex.edges. */
+    uint32_t child_count;
+    uint32_t spouse_offset; /* Span into TreeHotIndex.edges. */
+    uint32_t spouse_count;
+    int16_t birth_year;     /* Valid when TREE_HOT_HAS_BIRTH_YEAR is set. */
+    uint16_t flags;
+} TreeHotRecord;
+
+/* Snapshot of a tree: records[i], cold[i] and graph node i all describe tree->persons[i]. Rebuild after edits. */
+typedef struct TreeHotIndex
+{
+    TreeHotRecord *records;
+    Person **cold;
+    size_t count;
+    uint32_t *edges;
+    size_t edge_count;
+    TreeGraph graph; /* Relationship rows the spans are copied from; also backs tree_hot_index_find. */
+} TreeHotIndex;
+
+void tree_hot_index_init(TreeHotIndex *index);
+bool tree_hot_index_build(TreeHotIndex *index, const FamilyTree *tree);
+void tree_hot_index_reset(TreeHotIndex *index);
+/* Dense index of person, or TREE_HOT_NONE when the person is not part of the snapshot. */
+uint32_t tree_hot_index_find(const TreeHotIndex *index, const Person *person);
+/* First run of four digits in an ISO-8601 (or free-form) date, the rule search filters by. */
+bool tree_hot_parse_year(const char *value, int *out_year);
+
+#endif /* TREE_HOT_H */
@@ -12,6 +12,7 @@ struct RenderConfig;
 struct Person;
 typedef struct Settings Settings;
 struct ExpansionState;
+struct TextureResidency;
 
 typedef enum UIEventType
 {
@@ -76,5 +77,7 @@ bool ui_notify_status(UIContext *ui, const char *message);
 bool ui_handle_escape(UIContext *ui);
 bool ui_show_error_dialog(UIContext *ui, const char *title, const char *message);
 bool ui_pointer_blocks_interaction(const UIContext *ui);
+/* Budgets the detail view and gallery textures against residency; call after ui_init. */
+bool ui_set_texture_residency(UIContext *ui, struct TextureResidency *residency);
 
 #endif /* UI_H */
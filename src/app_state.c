@@ -4,12 +4,26 @@
 #include "at_string.h"
 #include "layout.h"
 #include "person.h"
+#include "tree_graph.h"
 
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
 static LayoutAlgorithm app_state_resolve_algorithm_from_settings(const Settings *settings);
+static void app_state_clear_selection_if_matches(AppState *state, const Person *person);
+
+static void app_state_notify_person_change(AppState *state, AppPersonChange change, const Person *person)
+{
+    if (state && change == APP_PERSON_CHANGE_EDITED && state->tree && *state->tree)
+    {
+        family_tree_note_person_edited(*state->tree, person);
+    }
+    if (state && state->person_change_listener && person)
+    {
+        state->person_change_listener(change, person, state->person_change_user_data);
+    }
+}
 
 static void app_command_stack_clear(AppCommandStack *stack)
 {
@@ -135,6 +149,8 @@ void app_state_shutdown(AppState *state)
     state->settings = NULL;
     state->persisted_settings = NULL;
     state->selected_person = NULL;
+    state->person_change_listener = NULL;
+    state->person_change_user_data = NULL;
     expansion_state_reset(&state->expansion);
     layout_result_destroy(&state->layout_transition_start);
     layout_result_destroy(&state->layout_transition_target);
@@ -395,6 +411,16 @@ static void app_state_refresh_layout(AppState *state, LayoutAlgorithm algorithm,
     state->active_layout_algorithm = algorithm;
 }
 
+void app_state_set_person_change_listener(AppState *state, AppPersonChangeListener listener, void *user_data)
+{
+    if (!state)
+    {
+        return;
+    }
+    state->person_change_listener = listener;
+    state->person_change_user_data = user_data;
+}
+
 void app_state_tick(AppState *state, float delta_seconds)
 {
     if (!state)
@@ -507,75 +533,54 @@ bool app_state_add_person(AppState *state, Person *person, char *error_buffer, s
     }
     app_state_refresh_layout(state, state->active_layout_algorithm, false);
     state->tree_dirty = true;
+    app_state_notify_person_change(state, APP_PERSON_CHANGE_ADDED, person);
     return true;
 }
 
-static void app_remove_person_relationship_links(FamilyTree *tree, Person *person)
+bool app_state_delete_person(AppState *state, uint32_t person_id, char *error_buffer, size_t error_buffer_size)
 {
-    if (!tree || !person)
-    {
-        return;
-    }
-    for (size_t index = 0; index < person->children_count; ++index)
+    if (!state || !state->tree || !*state->tree || person_id == 0U)
     {
-        Person *child = person->children[index];
-        if (!child)
-        {
-            continue;
-        }
-        for (size_t slot = 0; slot < 2U; ++slot)
+        if (error_buffer && error_buffer_size > 0U)
         {
-            if (child->parents[slot] == person)
-            {
-                child->parents[slot] = NULL;
-            }
+            (void)snprintf(error_buffer, error_buffer_size, "Invalid delete request");
         }
+        return false;
     }
-    for (size_t slot = 0; slot < 2U; ++slot)
+    Person *person = family_tree_find_person(*state->tree, person_id);
+    if (!person)
     {
-        Person *parent = person->parents[slot];
-        if (!parent)
-        {
-            continue;
-        }
-        for (size_t child_index = 0; child_index < parent->children_count; ++child_index)
+        if (error_buffer && error_buffer_size > 0U)
         {
-            if (parent->children[child_index] == person)
-            {
-                for (size_t shift = child_index + 1U; shift < parent->children_count; ++shift)
-                {
-                    parent->children[shift - 1U] = parent->children[shift];
-                }
-                parent->children_count -= 1U;
-                break;
-            }
+            (void)snprintf(error_buffer, error_buffer_size, "Person %u not found", person_id);
         }
+        return false;
     }
-    for (size_t index = 0; index < person->spouses_count; ++index)
+    family_tree_unlink_person(*state->tree, person);
+    if (!family_tree_extract_person(*state->tree, person_id))
     {
-        Person *spouse = person->spouses[index].partner;
-        if (!spouse)
-        {
-            continue;
-        }
-        for (size_t spouse_index = 0; spouse_index < spouse->spouses_count; ++spouse_index)
+        if (error_buffer && error_buffer_size > 0U)
         {
-            if (spouse->spouses[spouse_index].partner == person)
-            {
-                for (size_t shift = spouse_index + 1U; shift < spouse->spouses_count; ++shift)
-                {
-                    spouse->spouses[shift - 1U] = spouse->spouses[shift];
-                }
-                spouse->spouses_count -= 1U;
-                break;
-            }
+            (void)snprintf(error_buffer, error_buffer_size, "Failed to remove person %u", person_id);
         }
+        return false;
     }
+    app_state_notify_person_change(state, APP_PERSON_CHANGE_REMOVED, person);
+    person_destroy(person);
+    app_state_force_detail_abort(state);
+    app_state_refresh_layout(state, state->active_layout_algorithm, false);
+    state->tree_dirty = true;
+    return true;
 }
 
-bool app_state_delete_person(AppState *state, uint32_t person_id, char *error_buffer, size_t error_buffer_size)
+bool app_state_delete_branch(AppState *state, uint32_t root_id, size_t *out_removed, char *error_buffer,
+                             size_t error_buffer_size)
 {
-    if (!state || !state->tree || !*state->tree || person_id == 0U)
+    if (out_removed)
+    {
+        *out_removed = 0U;
+    }
+    if (!state || !state->tree || !*state->tree || root_id == 0U)
     {
         if (error_buffer && error_buffer_size > 0U)
         {
@@ -583,27 +588,40 @@ bool app_state_delete_person(AppState *state, uint32_t person_id, char *error_bu
         }
         return false;
     }
-    Person *person = family_tree_find_person(*state->tree, person_id);
-    if (!person)
+    Person *root = family_tree_find_person(*state->tree, root_id);
+    if (!root)
     {
         if (error_buffer && error_buffer_size > 0U)
         {
-            (void)snprintf(error_buffer, error_buffer_size, "Person %u not found", person_id);
+            (void)snprintf(error_buffer, error_buffer_size, "Person %u not found", root_id);
         }
         return false;
     }
-    app_remove_person_relationship_links(*state->tree, person);
-    if (!family_tree_remove_person(*state->tree, person_id))
+    TreeGraph branch;
+    tree_graph_init(&branch);
+    if (!tree_graph_build_descendants(&branch, root))
     {
         if (error_buffer && error_buffer_size > 0U)
         {
-            (void)snprintf(error_buffer, error_buffer_size, "Failed to remove person %u", person_id);
+            (void)snprintf(error_buffer, error_buffer_size, "Insufficient memory to delete branch of %u", root_id);
         }
         return false;
     }
     app_state_force_detail_abort(state);
+    for (size_t index = 0U; index < branch.count; ++index)
+    {
+        app_state_clear_selection_if_matches(state, branch.persons[index]);
+        app_state_notify_person_change(state, APP_PERSON_CHANGE_REMOVED, branch.persons[index]);
+    }
+    /* Single pass over the tree however large the branch, instead of one unlink and shift per member. */
+    size_t removed = family_tree_remove_persons(*state->tree, branch.persons, branch.count);
+    tree_graph_reset(&branch);
     app_state_refresh_layout(state, state->active_layout_algorithm, false);
     state->tree_dirty = true;
+    if (out_removed)
+    {
+        *out_removed = removed;
+    }
     return true;
 }
 
@@ -671,6 +689,7 @@ bool app_state_edit_person(AppState *state, uint32_t person_id, const AppPersonE
         return false;
     }
     state->tree_dirty = true;
+    app_state_notify_person_change(state, APP_PERSON_CHANGE_EDITED, person);
     if (state->expansion.person == person)
     {
         app_state_force_detail_abort(state);
@@ -788,84 +807,6 @@ static void app_state_clear_selection_if_matches(AppState *state, const Person *
     }
 }
 
-static bool app_restore_person_relationship_links(AppState *state, Person *person)
-{
-    if (!state || !state->tree || !*state->tree || !person)
-    {
-        return false;
-    }
-    FamilyTree *tree = *state->tree;
-    for (size_t index = 0U; index < 2U; ++index)
-    {
-        Person *parent = person->parents[index];
-        if (!parent)
-        {
-            continue;
-        }
-        if (!family_tree_find_person(tree, parent->id))
-        {
-            continue;
-        }
-        if (!person_add_child(parent, person))
-        {
-            return false;
-        }
-    }
-    for (size_t index = 0U; index < person->children_count; ++index)
-    {
-        Person *child = person->children[index];
-        if (!child)
-        {
-            continue;
-        }
-        if (!family_tree_find_person(tree, child->id))
-        {
-            continue;
-        }
-        bool slot_found = false;
-        for (size_t slot = 0U; slot < 2U; ++slot)
-        {
-            if (child->parents[slot] == person)
-            {
-                slot_found = true;
-                break;
-            }
-            if (!child->parents[slot])
-            {
-                child->parents[slot] = person;
-                slot_found = true;
-                break;
-            }
-        }
-        if (!slot_found)
-        {
-            return false;
-        }
-    }
-    for (size_t index = 0U; index < person->spouses_count; ++index)
-    {
-        PersonSpouseRecord *record = &person->spouses[index];
-        Person *partner = record->partner;
-        if (!partner)
-        {
-            continue;
-        }
-        if (!family_tree_find_person(tree, partner->id))
-        {
-            continue;
-        }
-        if (!person_add_spouse(partner, person))
-        {
-            return false;
-        }
-        if (!person_set_marriage(partner, person, record->marriage_date, record->marriage_location))
-        {
-            return false;
-        }
-    }
-    return true;
-}
-
 typedef struct AppCommandAddPerson
 {
     AppCommand base;
@@ -888,8 +829,11 @@ static bool app_command_add_person_execute(AppCommand *command, AppState *state)
     {
         return false;
     }
-    if (!app_restore_person_relationship_links(state, self->person))
+    /* Relinking is the edit that can close a loop through the new person; reject it before it lands. */
+    if (!family_tree_relink_person(*state->tree, self->person) ||
+        !family_tree_check_cycles(*state->tree, NULL, 0U))
     {
+        family_tree_unlink_person(*state->tree, self->person);
         (void)family_tree_extract_person(*state->tree, self->person->id);
         return false;
     }
@@ -897,6 +841,7 @@ static bool app_command_add_person_execute(AppCommand *command, AppState *state)
     state->tree_dirty = true;
     state->selected_person = self->person;
     self->inserted = true;
+    app_state_notify_person_change(state, APP_PERSON_CHANGE_ADDED, self->person);
     return true;
 }
 
@@ -911,7 +856,7 @@ static bool app_command_add_person_undo(AppCommand *command, AppState *state)
     {
         return true;
     }
-    app_remove_person_relationship_links(*state->tree, self->person);
+    family_tree_unlink_person(*state->tree, self->person);
     if (!family_tree_extract_person(*state->tree, self->person->id))
     {
         return false;
@@ -919,6 +864,7 @@ static bool app_command_add_person_undo(AppCommand *command, AppState *state)
     self->inserted = false;
     app_state_clear_selection_if_matches(state, self->person);
     app_state_refresh_layout(state, state->active_layout_algorithm, false);
+    app_state_notify_person_change(state, APP_PERSON_CHANGE_REMOVED, self->person);
     return true;
 }
 
@@ -968,7 +914,7 @@ static bool app_command_delete_person_execute(AppCommand *command, AppState *sta
         return false;
     }
     self->selection_was_target = (state->selected_person == person);
-    app_remove_person_relationship_links(*state->tree, person);
+    family_tree_unlink_person(*state->tree, person);
     self->person = family_tree_extract_person(*state->tree, self->person_id);
     if (!self->person)
     {
@@ -978,6 +924,7 @@ static bool app_command_delete_person_execute(AppCommand *command, AppState *sta
     app_state_clear_selection_if_matches(state, person);
     app_state_refresh_layout(state, state->active_layout_algorithm, false);
     state->tree_dirty = true;
+    app_state_notify_person_change(state, APP_PERSON_CHANGE_REMOVED, self->person);
     return true;
 }
 
@@ -996,7 +943,7 @@ static bool app_command_delete_person_undo(AppCommand *command, AppState *state)
     {
         return false;
     }
-    if (!app_restore_person_relationship_links(state, self->person))
+    if (!family_tree_relink_person(*state->tree, self->person))
     {
         (void)family_tree_extract_person(*state->tree, self->person->id);
         return false;
@@ -1008,6 +955,7 @@ static bool app_command_delete_person_undo(AppCommand *command, AppState *state)
     }
     app_state_refresh_layout(state, state->active_layout_algorithm, false);
     state->tree_dirty = true;
+    app_state_notify_person_change(state, APP_PERSON_CHANGE_ADDED, self->person);
     return true;
 }
 
@@ -1181,6 +1129,7 @@ static bool app_command_edit_person_execute(AppCommand *command, AppState *state
     }
     self->applied_new_state = true;
     state->tree_dirty = true;
+    app_state_notify_person_change(state, APP_PERSON_CHANGE_EDITED, person);
     return true;
 }
 
@@ -1202,6 +1151,7 @@ static bool app_command_edit_person_undo(AppCommand *command, AppState *state)
     }
     self->applied_new_state = false;
     state->tree_dirty = true;
+    app_state_notify_person_change(state, APP_PERSON_CHANGE_EDITED, person);
     return true;
 }
 
@@ -1,6 +1,19 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE /* copy_file_range */
+#endif
+#if !defined(_WIN32) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE
+#endif
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include "assets.h"
+#include "at_compress.h"
 #include "at_memory.h"
 #include "at_string.h"
+#include "at_thread.h"
+#include "at_time.h"
 #include "timeline.h"
 #include "tree.h"
 
@@ -16,13 +29,22 @@
 #include <direct.h>
 #else
 #include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 #endif
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#endif
 
 #define ASSET_PATH_MAX 512
 #define ASSET_FILENAME_MAX 128
+#define ASSET_COPY_BUFFER_SIZE (1024U * 1024U)
+#define ASSET_KERNEL_COPY_CHUNK (1024U * 1024U * 1024U)
+#define ASSET_COMPARE_CHUNK (64U * 1024U)
+#define ASSET_CONTENT_INDEX_NAME ".content_index"
 
 static void asset_set_error(char *error_buffer, size_t error_capacity, const char *message)
 {
@@ -201,11 +223,16 @@ static void asset_set_error_once(char *error_buffer, size_t error_capacity, cons
     asset_set_error(error_buffer, error_capacity, message);
 }
 
+/* Normalised relative paths in insertion order, with an open-addressing index so membership checks during
+ * collection and the cleanup walk stay constant time however many assets the tree references. */
 typedef struct AssetPathList
 {
     char **items;
+    uint32_t *hashes;
     size_t count;
     size_t capacity;
+    uint32_t *slots; /* Item index plus one; zero marks an empty slot. */
+    size_t slot_capacity;
 } AssetPathList;
 
 static void asset_path_list_init(AssetPathList *list)
@@ -215,8 +242,11 @@ static void asset_path_list_init(AssetPathList *list)
         return;
     }
     list->items = NULL;
+    list->hashes = NULL;
     list->count = 0U;
     list->capacity = 0U;
+    list->slots = NULL;
+    list->slot_capacity = 0U;
 }
 
 static void asset_path_list_dispose(AssetPathList *list)
@@ -230,38 +260,101 @@ static void asset_path_list_dispose(AssetPathList *list)
         AT_FREE(list->items[index]);
     }
     AT_FREE(list->items);
-    list->items = NULL;
-    list->count = 0U;
-    list->capacity = 0U;
+    AT_FREE(list->hashes);
+    AT_FREE(list->slots);
+    asset_path_list_init(list);
 }
 
-static bool asset_path_list_contains(const AssetPathList *list, const char *path)
+static uint32_t asset_path_hash(const char *path)
 {
-    if (!list || !path)
+    uint32_t hash = 2166136261U;
+    for (const unsigned char *cursor = (const unsigned char *)path; *cursor != '\0'; ++cursor)
+    {
+        hash ^= *cursor;
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+static void asset_path_list_index_item(AssetPathList *list, size_t item)
+{
+    size_t mask = list->slot_capacity - 1U;
+    size_t slot = (size_t)list->hashes[item] & mask;
+    while (list->slots[slot] != 0U)
+    {
+        slot = (slot + 1U) & mask;
+    }
+    list->slots[slot] = (uint32_t)(item + 1U);
+}
+
+/* Rebuilds the index at a size that keeps it at most half full once required items are present. */
+static bool asset_path_list_reindex(AssetPathList *list, size_t required)
+{
+    size_t slot_capacity = 32U;
+    while (slot_capacity < required * 2U)
+    {
+        slot_capacity *= 2U;
+    }
+    uint32_t *slots = AT_CALLOC(slot_capacity, sizeof(uint32_t));
+    if (!slots)
     {
         return false;
     }
+    AT_FREE(list->slots);
+    list->slots = slots;
+    list->slot_capacity = slot_capacity;
     for (size_t index = 0U; index < list->count; ++index)
     {
-        if (strcmp(list->items[index], path) == 0)
+        asset_path_list_index_item(list, index);
+    }
+    return true;
+}
+
+static bool asset_path_list_contains_hashed(const AssetPathList *list, const char *path, uint32_t hash)
+{
+    if (list->slot_capacity == 0U)
+    {
+        return false;
+    }
+    size_t mask = list->slot_capacity - 1U;
+    size_t slot = (size_t)hash & mask;
+    while (list->slots[slot] != 0U)
+    {
+        size_t item = (size_t)list->slots[slot] - 1U;
+        if (list->hashes[item] == hash && strcmp(list->items[item], path) == 0)
         {
             return true;
         }
+        slot = (slot + 1U) & mask;
     }
     return false;
 }
 
+static bool asset_path_list_contains(const AssetPathList *list, const char *path)
+{
+    if (!list || !path)
+    {
+        return false;
+    }
+    return asset_path_list_contains_hashed(list, path, asset_path_hash(path));
+}
+
 static bool asset_path_list_add_unique(AssetPathList *list, const char *path)
 {
     if (!list || !path)
     {
         return false;
     }
-    if (asset_path_list_contains(list, path))
+    uint32_t hash = asset_path_hash(path);
+    if (asset_path_list_contains_hashed(list, path, hash))
     {
         return true;
     }
     size_t required = list->count + 1U;
+    if (required >= UINT32_MAX)
+    {
+        return false;
+    }
     if (required > list->capacity)
     {
         size_t new_capacity = (list->capacity == 0U) ? 16U : list->capacity * 2U;
@@ -275,14 +368,27 @@ static bool asset_path_list_add_unique(AssetPathList *list, const char *path)
             return false;
         }
         list->items = items;
+        uint32_t *hashes = (uint32_t *)at_secure_realloc(list->hashes, new_capacity, sizeof(uint32_t));
+        if (!hashes)
+        {
+            return false;
+        }
+        list->hashes = hashes;
         list->capacity = new_capacity;
     }
+    if (required * 2U > list->slot_capacity && !asset_path_list_reindex(list, required))
+    {
+        return false;
+    }
     char *copy = at_string_dup(path);
     if (!copy)
     {
         return false;
     }
-    list->items[list->count++] = copy;
+    list->items[list->count] = copy;
+    list->hashes[list->count] = hash;
+    asset_path_list_index_item(list, list->count);
+    list->count++;
     return true;
 }
 
@@ -314,6 +420,13 @@ static void asset_path_list_sort(AssetPathList *list)
         return;
     }
     qsort(list->items, list->count, sizeof(char *), asset_path_compare);
+    /* Items moved, so re-pair their hashes and re-index them in the existing slots. */
+    memset(list->slots, 0, list->slot_capacity * sizeof(uint32_t));
+    for (size_t index = 0U; index < list->count; ++index)
+    {
+        list->hashes[index] = asset_path_hash(list->items[index]);
+        asset_path_list_index_item(list, index);
+    }
 }
 
 #if defined(_WIN32)
@@ -442,15 +555,12 @@ static bool asset_get_file_size(const char *path, size_t *out_size)
     {
         return false;
     }
-    FILE *file = NULL;
 #if defined(_WIN32)
+    FILE *file = NULL;
     if (fopen_s(&file, path, "rb") != 0)
     {
         file = NULL;
     }
-#else
-    file = fopen(path, "rb");
-#endif
     if (!file)
     {
         return false;
@@ -472,6 +582,19 @@ static bool asset_get_file_size(const char *path, size_t *out_size)
     }
     fclose(file);
     return true;
+#else
+    /* One stat instead of open, seek, tell and close. */
+    struct stat file_info;
+    if (stat(path, &file_info) != 0)
+    {
+        return false;
+    }
+    if (out_size)
+    {
+        *out_size = (size_t)file_info.st_size;
+    }
+    return true;
+#endif
 }
 
 static bool asset_join_path(char *buffer, size_t capacity, const char *base, const char *suffix)
@@ -531,221 +654,797 @@ static bool asset_build_relative_path(char *buffer, size_t capacity, const char
     return true;
 }
 
-static bool asset_copy_stream(FILE *source, FILE *destination)
+/* FNV-1a over little-endian 64-bit words, then the tail bytes and the length. Streaming callers pass every chunk
+ * but the last as a multiple of 8 bytes. The 64-bit hash keys duplicate detection, where a match is always
+ * confirmed byte for byte; packages keep it folded to 32 bits as an integrity checksum. */
+#define ASSET_HASH_SEED 14695981039346656037ULL
+#define ASSET_HASH_PRIME 1099511628211ULL
+
+static uint64_t asset_hash_update(uint64_t state, const unsigned char *data, size_t size)
 {
-    if (!source || !destination)
+    size_t index = 0U;
+    for (; index + 8U <= size; index += 8U)
+    {
+        uint64_t word = (uint64_t)data[index] | ((uint64_t)data[index + 1U] << 8U) |
+                        ((uint64_t)data[index + 2U] << 16U) | ((uint64_t)data[index + 3U] << 24U) |
+                        ((uint64_t)data[index + 4U] << 32U) | ((uint64_t)data[index + 5U] << 40U) |
+                        ((uint64_t)data[index + 6U] << 48U) | ((uint64_t)data[index + 7U] << 56U);
+        state = (state ^ word) * ASSET_HASH_PRIME;
+    }
+    for (; index < size; ++index)
+    {
+        state = (state ^ data[index]) * ASSET_HASH_PRIME;
+    }
+    return state;
+}
+
+static uint64_t asset_hash_finish(uint64_t state, uint64_t size)
+{
+    return (state ^ size) * ASSET_HASH_PRIME;
+}
+
+static uint32_t asset_checksum_fold(uint64_t hash)
+{
+    return (uint32_t)(hash ^ (hash >> 32U));
+}
+
+static uint32_t asset_checksum(const unsigned char *data, uint64_t size)
+{
+    return asset_checksum_fold(asset_hash_finish(asset_hash_update(ASSET_HASH_SEED, data, (size_t)size), size));
+}
+
+static int64_t asset_file_tell(FILE *file)
+{
+#if defined(_WIN32)
+    return (int64_t)_ftelli64(file);
+#else
+    return (int64_t)ftello(file);
+#endif
+}
+
+static bool asset_file_seek(FILE *file, int64_t offset, int origin)
+{
+#if defined(_WIN32)
+    return _fseeki64(file, offset, origin) == 0;
+#else
+    return fseeko(file, (off_t)offset, origin) == 0;
+#endif
+}
+
+/* Hashes size bytes of source from its start and leaves the stream there; a mapping avoids copying the data out
+ * of the page cache, with a buffered read as the fallback. */
+static bool asset_hash_stream(FILE *source, uint64_t size, uint64_t *out_hash)
+{
+#if !defined(_WIN32)
+    if (size > 0U && size <= (uint64_t)SIZE_MAX)
+    {
+        void *mapping = mmap(NULL, (size_t)size, PROT_READ, MAP_PRIVATE, fileno(source), 0);
+        if (mapping != MAP_FAILED)
+        {
+            *out_hash = asset_hash_finish(asset_hash_update(ASSET_HASH_SEED, mapping, (size_t)size), size);
+            (void)munmap(mapping, (size_t)size);
+            return true;
+        }
+    }
+#endif
+    unsigned char *buffer = AT_MALLOC(ASSET_COPY_BUFFER_SIZE);
+    if (!buffer)
     {
         return false;
     }
-    unsigned char buffer[64U * 1024U];
-    size_t read_bytes = fread(buffer, 1U, sizeof(buffer), source);
-    while (read_bytes > 0U)
+    uint64_t state = ASSET_HASH_SEED;
+    uint64_t consumed = 0U;
+    while (consumed < size)
     {
-        size_t written = fwrite(buffer, 1U, read_bytes, destination);
-        if (written != read_bytes)
+        uint64_t remaining = size - consumed;
+        size_t chunk = remaining > ASSET_COPY_BUFFER_SIZE ? ASSET_COPY_BUFFER_SIZE : (size_t)remaining;
+        size_t read_bytes = fread(buffer, 1U, chunk, source);
+        if (read_bytes != chunk)
         {
+            AT_FREE(buffer);
             return false;
         }
-        read_bytes = fread(buffer, 1U, sizeof(buffer), source);
+        state = asset_hash_update(state, buffer, read_bytes);
+        consumed += read_bytes;
     }
-    return ferror(source) == 0;
+    AT_FREE(buffer);
+    *out_hash = asset_hash_finish(state, size);
+    return asset_file_seek(source, 0, SEEK_SET);
 }
 
-static bool asset_generate_unique_name(const char *prefix, const char *extension, const char *directory,
-                                       char *out_name, size_t name_capacity)
+static FILE *asset_open_file(const char *path, const char *mode)
 {
-    if (!prefix || prefix[0] == '\0')
+    FILE *file = NULL;
+#if defined(_WIN32)
+    if (fopen_s(&file, path, mode) != 0)
     {
-        prefix = "asset";
+        file = NULL;
     }
-    if (!extension)
+#else
+    file = fopen(path, mode);
+#endif
+    return file;
+}
+
+/* Byte comparison of two files already known to be size bytes long. */
+static bool asset_files_equal(const char *lhs_path, const char *rhs_path, uint64_t size)
+{
+    FILE *lhs = asset_open_file(lhs_path, "rb");
+    FILE *rhs = lhs ? asset_open_file(rhs_path, "rb") : NULL;
+    unsigned char *buffer = rhs ? AT_MALLOC(2U * ASSET_COMPARE_CHUNK) : NULL;
+    bool equal = buffer != NULL;
+    uint64_t compared = 0U;
+    while (equal && compared < size)
     {
-        extension = "";
+        uint64_t remaining = size - compared;
+        size_t chunk = remaining > ASSET_COMPARE_CHUNK ? ASSET_COMPARE_CHUNK : (size_t)remaining;
+        equal = fread(buffer, 1U, chunk, lhs) == chunk &&
+                fread(buffer + ASSET_COMPARE_CHUNK, 1U, chunk, rhs) == chunk &&
+                memcmp(buffer, buffer + ASSET_COMPARE_CHUNK, chunk) == 0;
+        compared += chunk;
     }
-    time_t now = time(NULL);
-    if (now == (time_t)-1)
+    AT_FREE(buffer);
+    if (rhs)
     {
-        now = 0;
+        fclose(rhs);
     }
-    for (unsigned int attempt = 0U; attempt < 2000U; ++attempt)
+    if (lhs)
     {
-        unsigned long long stamp = (unsigned long long)now * 1000ULL + (unsigned long long)(attempt);
-        int written;
-        if (extension[0] != '\0')
-        {
-            written = snprintf(out_name, name_capacity, "%s_%llu%s", prefix, stamp, extension);
-        }
-        else
-        {
-            written = snprintf(out_name, name_capacity, "%s_%llu", prefix, stamp);
-        }
-        if (written < 0 || (size_t)written >= name_capacity)
-        {
-            return false;
-        }
-        char absolute[ASSET_PATH_MAX];
-        if (snprintf(absolute, sizeof(absolute), "%s/%s", directory, out_name) >= (int)sizeof(absolute))
-        {
-            return false;
-        }
-        asset_normalise_path(absolute);
-        if (!asset_file_exists(absolute))
-        {
-            return true;
-        }
-        now += 1;
+        fclose(lhs);
     }
-    return false;
+    return equal;
 }
 
-bool asset_copy(const AssetCopyRequest *request, char *out_relative_path, size_t relative_capacity,
-                char *error_buffer, size_t error_capacity)
+/* The content index lives at the asset root as one "<hash> <size> <relative path>" line per imported file. It is
+ * read once per asset root into a table keyed by (hash, size); later copies look up and append in memory and on
+ * disk together. An entry whose file was since removed or replaced is dropped when a lookup finds it, and the
+ * file is then rewritten with only the live entries. */
+static bool asset_is_reserved_path(const char *relative_path)
 {
-    if (!request || !request->source_path || request->source_path[0] == '\0')
-    {
-        asset_set_error(error_buffer, error_capacity, "Invalid asset copy request");
-        return false;
-    }
-    const char *asset_root = (request->asset_root && request->asset_root[0] != '\0') ? request->asset_root : "assets";
-    const char *subdirectory = (request->subdirectory && request->subdirectory[0] != '\0') ? request->subdirectory : "imports";
+    return strcmp(relative_path, ASSET_CONTENT_INDEX_NAME) == 0;
+}
 
-    char root_buffer[ASSET_PATH_MAX];
-    if (snprintf(root_buffer, sizeof(root_buffer), "%s", asset_root) >= (int)sizeof(root_buffer))
+typedef struct AssetContentEntry
+{
+    uint64_t hash;
+    uint64_t size;
+    char *relative_path;
+} AssetContentEntry;
+
+typedef struct AssetContentIndex
+{
+    char root[ASSET_PATH_MAX]; /* Empty until loaded. */
+    AssetContentEntry *entries;
+    size_t count;
+    size_t capacity;
+    uint32_t *slots; /* Entry index plus one; zero marks an empty slot. */
+    size_t slot_capacity;
+    size_t file_bytes; /* Index file size after our last read or write; any other size means it changed under us. */
+} AssetContentIndex;
+
+static AssetContentIndex g_asset_content_index;
+static AtMutex g_asset_content_index_lock = AT_MUTEX_INITIALIZER;
+
+static size_t asset_content_slot_for(const AssetContentIndex *index, uint64_t hash, uint64_t size)
+{
+    uint64_t mixed = hash ^ (size * 0x9E3779B97F4A7C15ULL);
+    return (size_t)(mixed ^ (mixed >> 32U)) & (index->slot_capacity - 1U);
+}
+
+static void asset_content_index_slot_entry(AssetContentIndex *index, size_t entry)
+{
+    size_t mask = index->slot_capacity - 1U;
+    size_t slot = asset_content_slot_for(index, index->entries[entry].hash, index->entries[entry].size);
+    while (index->slots[slot] != 0U)
     {
-        asset_set_error(error_buffer, error_capacity, "Asset root path too long");
-        return false;
+        slot = (slot + 1U) & mask;
     }
-    asset_normalise_path(root_buffer);
+    index->slots[slot] = (uint32_t)(entry + 1U);
+}
 
-    char subdir_buffer[ASSET_PATH_MAX];
-    if (snprintf(subdir_buffer, sizeof(subdir_buffer), "%s", subdirectory) >= (int)sizeof(subdir_buffer))
+/* Rebuilds the slots at a size that keeps them at most half full once required entries are present. */
+static bool asset_content_index_rehash(AssetContentIndex *index, size_t required)
+{
+    size_t slot_capacity = 32U;
+    while (slot_capacity < required * 2U)
     {
-        asset_set_error(error_buffer, error_capacity, "Asset subdirectory too long");
-        return false;
+        slot_capacity *= 2U;
     }
-    asset_normalise_path(subdir_buffer);
-    asset_trim_leading_slashes(subdir_buffer);
-    if (strstr(subdir_buffer, ".."))
+    uint32_t *slots = AT_CALLOC(slot_capacity, sizeof(uint32_t));
+    if (!slots)
     {
-        asset_set_error(error_buffer, error_capacity, "Relative asset path must not traverse upward");
         return false;
     }
-
-    char destination_directory[ASSET_PATH_MAX];
-    if (subdir_buffer[0] != '\0')
+    AT_FREE(index->slots);
+    index->slots = slots;
+    index->slot_capacity = slot_capacity;
+    for (size_t entry = 0U; entry < index->count; ++entry)
     {
-        if (snprintf(destination_directory, sizeof(destination_directory), "%s/%s", root_buffer, subdir_buffer) >=
-            (int)sizeof(destination_directory))
-        {
-            asset_set_error(error_buffer, error_capacity, "Destination path too long");
-            return false;
-        }
+        asset_content_index_slot_entry(index, entry);
     }
-    else
+    return true;
+}
+
+static void asset_content_index_clear(AssetContentIndex *index)
+{
+    for (size_t entry = 0U; entry < index->count; ++entry)
     {
-        if (snprintf(destination_directory, sizeof(destination_directory), "%s", root_buffer) >=
-            (int)sizeof(destination_directory))
-        {
-            asset_set_error(error_buffer, error_capacity, "Destination path too long");
-            return false;
-        }
+        AT_FREE(index->entries[entry].relative_path);
     }
-    asset_normalise_path(destination_directory);
+    AT_FREE(index->entries);
+    AT_FREE(index->slots);
+    memset(index, 0, sizeof(*index));
+}
 
-    if (!asset_ensure_directories(destination_directory))
+static bool asset_content_index_add(AssetContentIndex *index, uint64_t hash, uint64_t size, const char *relative)
+{
+    size_t required = index->count + 1U;
+    if (required >= UINT32_MAX)
     {
-        asset_set_error(error_buffer, error_capacity, "Failed to prepare destination directory");
         return false;
     }
-
-    FILE *source = NULL;
-#if defined(_WIN32)
-    if (fopen_s(&source, request->source_path, "rb") != 0)
+    if (required > index->capacity)
     {
-        source = NULL;
+        size_t capacity = (index->capacity == 0U) ? 64U : index->capacity * 2U;
+        AssetContentEntry *entries =
+            (AssetContentEntry *)at_secure_realloc(index->entries, capacity, sizeof(AssetContentEntry));
+        if (!entries)
+        {
+            return false;
+        }
+        index->entries = entries;
+        index->capacity = capacity;
     }
-#else
-    source = fopen(request->source_path, "rb");
-#endif
-    if (!source)
+    if (required * 2U > index->slot_capacity && !asset_content_index_rehash(index, required))
     {
-        asset_set_error(error_buffer, error_capacity, "Source asset unavailable");
         return false;
     }
-
-    const char *extension = asset_find_extension(request->source_path);
-    char filename[ASSET_FILENAME_MAX];
-    if (!asset_generate_unique_name(request->name_prefix ? request->name_prefix : "asset", extension,
-                                    destination_directory, filename, sizeof(filename)))
+    char *copy = at_string_dup(relative);
+    if (!copy)
     {
-        fclose(source);
-        asset_set_error(error_buffer, error_capacity, "Unable to generate unique filename");
         return false;
     }
+    AssetContentEntry *entry = &index->entries[index->count];
+    entry->hash = hash;
+    entry->size = size;
+    entry->relative_path = copy;
+    asset_content_index_slot_entry(index, index->count);
+    index->count++;
+    return true;
+}
 
-    char destination_path[ASSET_PATH_MAX];
-    if (snprintf(destination_path, sizeof(destination_path), "%s/%s", destination_directory, filename) >=
-        (int)sizeof(destination_path))
+/* Makes index describe the file at asset_root, reading it only when the root changed or the file no longer has
+ * the size we last saw (deleted, or written by another process). */
+static bool asset_content_index_load(AssetContentIndex *index, const char *asset_root)
+{
+    char index_path[ASSET_PATH_MAX];
+    if (!asset_join_path(index_path, sizeof(index_path), asset_root, ASSET_CONTENT_INDEX_NAME))
     {
-        fclose(source);
-        asset_set_error(error_buffer, error_capacity, "Destination file path too long");
         return false;
     }
-    asset_normalise_path(destination_path);
-
-    FILE *destination = NULL;
-#if defined(_WIN32)
-    if (fopen_s(&destination, destination_path, "wb") != 0)
+    size_t file_bytes = 0U;
+    if (!asset_get_file_size(index_path, &file_bytes))
     {
-        destination = NULL;
+        file_bytes = 0U;
     }
-#else
-    destination = fopen(destination_path, "wb");
-#endif
-    if (!destination)
+    if (index->root[0] != '\0' && strcmp(index->root, asset_root) == 0 && index->file_bytes == file_bytes)
     {
-        fclose(source);
-        asset_set_error(error_buffer, error_capacity, "Unable to open destination asset file");
-        return false;
+        return true;
     }
-
-    bool copy_result = asset_copy_stream(source, destination);
-    fclose(source);
-    if (fflush(destination) != 0)
+    asset_content_index_clear(index);
+    (void)snprintf(index->root, sizeof(index->root), "%s", asset_root);
+    index->file_bytes = file_bytes;
+    if (file_bytes == 0U)
     {
-        copy_result = false;
+        return true;
     }
-    if (fclose(destination) != 0)
+    FILE *file = asset_open_file(index_path, "rb");
+    if (!file)
     {
-        copy_result = false;
+        return true;
     }
-    if (!copy_result)
+    char line[ASSET_PATH_MAX + 64U];
+    bool loaded = true;
+    while (loaded && fgets(line, (int)sizeof(line), file))
     {
-        (void)remove(destination_path);
-        asset_set_error(error_buffer, error_capacity, "Asset copy failed");
-        return false;
+        char *cursor = NULL;
+        unsigned long long line_hash = strtoull(line, &cursor, 16);
+        if (cursor == line || *cursor != ' ')
+        {
+            continue;
+        }
+        char *size_start = cursor + 1;
+        unsigned long long line_size = strtoull(size_start, &cursor, 10);
+        if (cursor == size_start || *cursor != ' ')
+        {
+            continue;
+        }
+        char *relative = cursor + 1;
+        relative[strcspn(relative, "\r\n")] = '\0';
+        if (relative[0] != '\0')
+        {
+            loaded = asset_content_index_add(index, (uint64_t)line_hash, (uint64_t)line_size, relative);
+        }
     }
+    fclose(file);
+    if (!loaded)
+    {
+        asset_content_index_clear(index);
+    }
+    return loaded;
+}
 
-    if (out_relative_path && relative_capacity > 0U)
+/* Replaces the index file with one line per live entry, written aside and renamed into place. */
+static void asset_content_index_rewrite(AssetContentIndex *index)
+{
+    char index_path[ASSET_PATH_MAX];
+    char temp_path[ASSET_PATH_MAX];
+    if (!asset_join_path(index_path, sizeof(index_path), index->root, ASSET_CONTENT_INDEX_NAME) ||
+        snprintf(temp_path, sizeof(temp_path), "%s.tmp", index_path) >= (int)sizeof(temp_path))
+    {
+        return;
+    }
+    FILE *file = asset_open_file(temp_path, "wb");
+    if (!file)
+    {
+        return;
+    }
+    bool written = true;
+    for (size_t entry = 0U; written && entry < index->count; ++entry)
+    {
+        const AssetContentEntry *item = &index->entries[entry];
+        written = fprintf(file, "%016llx %llu %s\n", (unsigned long long)item->hash, (unsigned long long)item->size,
+                          item->relative_path) > 0;
+    }
+    written = (fclose(file) == 0) && written;
+#if defined(_WIN32)
+    written = written && MoveFileExA(temp_path, index_path, MOVEFILE_REPLACE_EXISTING);
+#else
+    written = written && rename(temp_path, index_path) == 0;
+#endif
+    if (!written)
+    {
+        (void)remove(temp_path);
+    }
+    /* On failure the old file still holds the dropped lines; they fail verification again and are harmless. */
+    size_t file_bytes = 0U;
+    index->file_bytes = asset_get_file_size(index_path, &file_bytes) ? file_bytes : 0U;
+}
+
+/* Removes entry by moving the last one into its place; the caller rehashes afterwards. */
+static void asset_content_index_drop(AssetContentIndex *index, size_t entry)
+{
+    AT_FREE(index->entries[entry].relative_path);
+    index->count--;
+    if (entry != index->count)
     {
-        if (subdir_buffer[0] != '\0')
+        index->entries[entry] = index->entries[index->count];
+    }
+}
+
+static bool asset_content_index_find(const char *asset_root, uint64_t hash, uint64_t size, const char *source_path,
+                                     char *out_relative, size_t relative_capacity)
+{
+    at_mutex_lock(&g_asset_content_index_lock);
+    AssetContentIndex *index = &g_asset_content_index;
+    bool found = false;
+    if (!asset_content_index_load(index, asset_root) || index->count == 0U)
+    {
+        at_mutex_unlock(&g_asset_content_index_lock);
+        return false;
+    }
+    size_t stale[8];
+    size_t stale_count = 0U;
+    size_t mask = index->slot_capacity - 1U;
+    for (size_t slot = asset_content_slot_for(index, hash, size); !found && index->slots[slot] != 0U;
+         slot = (slot + 1U) & mask)
+    {
+        size_t entry = (size_t)index->slots[slot] - 1U;
+        const AssetContentEntry *item = &index->entries[entry];
+        if (item->hash != hash || item->size != size)
+        {
+            continue;
+        }
+        char candidate[ASSET_PATH_MAX];
+        size_t candidate_size = 0U;
+        if (!asset_join_path(candidate, sizeof(candidate), asset_root, item->relative_path) ||
+            !asset_get_file_size(candidate, &candidate_size) || (uint64_t)candidate_size != size)
         {
-            if (snprintf(out_relative_path, relative_capacity, "%s/%s", subdir_buffer, filename) >=
-                (int)relative_capacity)
+            if (stale_count < sizeof(stale) / sizeof(stale[0]))
             {
-                asset_set_error(error_buffer, error_capacity, "Relative path buffer too small");
-                return false;
+                stale[stale_count++] = entry;
+            }
+            continue;
+        }
+        /* Same hash and size but other bytes is a collision (or an edit in place); the entry still names a live
+         * file, so keep it and look on. */
+        if (!asset_files_equal(source_path, candidate, size))
+        {
+            continue;
+        }
+        if (strlen(item->relative_path) < relative_capacity)
+        {
+            (void)snprintf(out_relative, relative_capacity, "%s", item->relative_path);
+            found = true;
+        }
+    }
+    if (stale_count > 0U)
+    {
+        /* Highest index first so moving the last entry down never relocates one still to be dropped. */
+        for (size_t pass = 0U; pass < stale_count; ++pass)
+        {
+            size_t highest = pass;
+            for (size_t other = pass + 1U; other < stale_count; ++other)
+            {
+                if (stale[other] > stale[highest])
+                {
+                    highest = other;
+                }
             }
+            size_t entry = stale[highest];
+            stale[highest] = stale[pass];
+            asset_content_index_drop(index, entry);
+        }
+        if (!asset_content_index_rehash(index, index->count))
+        {
+            asset_content_index_clear(index);
+        }
+        else
+        {
+            asset_content_index_rewrite(index);
+        }
+    }
+    at_mutex_unlock(&g_asset_content_index_lock);
+    return found;
+}
+
+static void asset_content_index_append(const char *asset_root, uint64_t hash, uint64_t size,
+                                       const char *relative_path)
+{
+    at_mutex_lock(&g_asset_content_index_lock);
+    AssetContentIndex *index = &g_asset_content_index;
+    char index_path[ASSET_PATH_MAX];
+    FILE *file = NULL;
+    if (asset_content_index_load(index, asset_root) &&
+        asset_join_path(index_path, sizeof(index_path), asset_root, ASSET_CONTENT_INDEX_NAME))
+    {
+        file = asset_open_file(index_path, "ab");
+    }
+    if (file)
+    {
+        int written =
+            fprintf(file, "%016llx %llu %s\n", (unsigned long long)hash, (unsigned long long)size, relative_path);
+        bool closed = fclose(file) == 0;
+        if (written > 0 && closed && asset_content_index_add(index, hash, size, relative_path))
+        {
+            index->file_bytes += (size_t)written;
+        }
+        else
+        {
+            /* Out of step with the file; the next lookup reads it again. */
+            asset_content_index_clear(index);
+        }
+    }
+    at_mutex_unlock(&g_asset_content_index_lock);
+}
+
+void asset_content_index_release(void)
+{
+    at_mutex_lock(&g_asset_content_index_lock);
+    asset_content_index_clear(&g_asset_content_index);
+    at_mutex_unlock(&g_asset_content_index_lock);
+}
+
+/* Copies up to limit bytes (to end of file for UINT64_MAX) from source's position to the end of destination.
+ * Linux keeps the data in the kernel with copy_file_range, or sendfile across file systems that refuse it;
+ * elsewhere, or when neither applies, it goes through a 1 MiB buffer. */
+static bool asset_copy_stream(FILE *source, FILE *destination, uint64_t limit, uint64_t *out_copied)
+{
+    if (!source || !destination)
+    {
+        return false;
+    }
+    uint64_t copied = 0U;
+    bool at_end = false;
+#if defined(__linux__)
+    if (fflush(destination) != 0)
+    {
+        return false;
+    }
+    int source_fd = fileno(source);
+    int destination_fd = fileno(destination);
+    bool use_copy_range = true;
+    bool use_kernel = true;
+    while (use_kernel && !at_end && copied < limit)
+    {
+        uint64_t remaining = limit - copied;
+        size_t chunk = remaining > ASSET_KERNEL_COPY_CHUNK ? ASSET_KERNEL_COPY_CHUNK : (size_t)remaining;
+        ssize_t moved = use_copy_range ? copy_file_range(source_fd, NULL, destination_fd, NULL, chunk, 0U)
+                                       : sendfile(destination_fd, source_fd, NULL, chunk);
+        if (moved > 0)
+        {
+            copied += (uint64_t)moved;
+        }
+        else if (moved == 0)
+        {
+            at_end = true;
+        }
+        else if (errno == EINTR)
+        {
+            continue;
+        }
+        else if (use_copy_range && (errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP))
+        {
+            use_copy_range = false;
+        }
+        else if (!use_copy_range && (errno == ENOSYS || errno == EINVAL))
+        {
+            use_kernel = false;
         }
         else
         {
-            if (snprintf(out_relative_path, relative_capacity, "%s", filename) >= (int)relative_capacity)
+            return false;
+        }
+    }
+    /* The descriptors moved on without stdio; put destination's stream back at the end of what was written. */
+    if (fseeko(destination, 0, SEEK_END) != 0)
+    {
+        return false;
+    }
+#endif
+    if (!at_end && copied < limit)
+    {
+        unsigned char *buffer = AT_MALLOC(ASSET_COPY_BUFFER_SIZE);
+        if (!buffer)
+        {
+            return false;
+        }
+        bool ok = true;
+        while (copied < limit)
+        {
+            uint64_t remaining = limit - copied;
+            size_t chunk = remaining > ASSET_COPY_BUFFER_SIZE ? ASSET_COPY_BUFFER_SIZE : (size_t)remaining;
+            size_t read_bytes = fread(buffer, 1U, chunk, source);
+            if (read_bytes == 0U)
             {
-                asset_set_error(error_buffer, error_capacity, "Relative path buffer too small");
-                return false;
+                ok = ferror(source) == 0;
+                break;
             }
+            if (fwrite(buffer, 1U, read_bytes, destination) != read_bytes)
+            {
+                ok = false;
+                break;
+            }
+            copied += read_bytes;
+        }
+        AT_FREE(buffer);
+        if (!ok)
+        {
+            return false;
+        }
+    }
+    if (out_copied)
+    {
+        *out_copied = copied;
+    }
+    return true;
+}
+
+static bool asset_generate_unique_name(const char *prefix, const char *extension, const char *directory,
+                                       char *out_name, size_t name_capacity)
+{
+    if (!prefix || prefix[0] == '\0')
+    {
+        prefix = "asset";
+    }
+    if (!extension)
+    {
+        extension = "";
+    }
+    time_t now = time(NULL);
+    if (now == (time_t)-1)
+    {
+        now = 0;
+    }
+    for (unsigned int attempt = 0U; attempt < 2000U; ++attempt)
+    {
+        unsigned long long stamp = (unsigned long long)now * 1000ULL + (unsigned long long)(attempt);
+        int written;
+        if (extension[0] != '\0')
+        {
+            written = snprintf(out_name, name_capacity, "%s_%llu%s", prefix, stamp, extension);
+        }
+        else
+        {
+            written = snprintf(out_name, name_capacity, "%s_%llu", prefix, stamp);
+        }
+        if (written < 0 || (size_t)written >= name_capacity)
+        {
+            return false;
+        }
+        char absolute[ASSET_PATH_MAX];
+        if (snprintf(absolute, sizeof(absolute), "%s/%s", directory, out_name) >= (int)sizeof(absolute))
+        {
+            return false;
+        }
+        asset_normalise_path(absolute);
+        if (!asset_file_exists(absolute))
+        {
+            return true;
+        }
+        now += 1;
+    }
+    return false;
+}
+
+bool asset_copy(const AssetCopyRequest *request, char *out_relative_path, size_t relative_capacity,
+                char *error_buffer, size_t error_capacity)
+{
+    if (!request || !request->source_path || request->source_path[0] == '\0')
+    {
+        asset_set_error(error_buffer, error_capacity, "Invalid asset copy request");
+        return false;
+    }
+    const char *asset_root = (request->asset_root && request->asset_root[0] != '\0') ? request->asset_root : "assets";
+    const char *subdirectory = (request->subdirectory && request->subdirectory[0] != '\0') ? request->subdirectory : "imports";
+
+    char root_buffer[ASSET_PATH_MAX];
+    if (snprintf(root_buffer, sizeof(root_buffer), "%s", asset_root) >= (int)sizeof(root_buffer))
+    {
+        asset_set_error(error_buffer, error_capacity, "Asset root path too long");
+        return false;
+    }
+    asset_normalise_path(root_buffer);
+
+    char subdir_buffer[ASSET_PATH_MAX];
+    if (snprintf(subdir_buffer, sizeof(subdir_buffer), "%s", subdirectory) >= (int)sizeof(subdir_buffer))
+    {
+        asset_set_error(error_buffer, error_capacity, "Asset subdirectory too long");
+        return false;
+    }
+    asset_normalise_path(subdir_buffer);
+    asset_trim_leading_slashes(subdir_buffer);
+    if (strstr(subdir_buffer, ".."))
+    {
+        asset_set_error(error_buffer, error_capacity, "Relative asset path must not traverse upward");
+        return false;
+    }
+
+    char destination_directory[ASSET_PATH_MAX];
+    if (subdir_buffer[0] != '\0')
+    {
+        if (snprintf(destination_directory, sizeof(destination_directory), "%s/%s", root_buffer, subdir_buffer) >=
+            (int)sizeof(destination_directory))
+        {
+            asset_set_error(error_buffer, error_capacity, "Destination path too long");
+            return false;
+        }
+    }
+    else
+    {
+        if (snprintf(destination_directory, sizeof(destination_directory), "%s", root_buffer) >=
+            (int)sizeof(destination_directory))
+        {
+            asset_set_error(error_buffer, error_capacity, "Destination path too long");
+            return false;
+        }
+    }
+    asset_normalise_path(destination_directory);
+
+    if (!asset_ensure_directories(destination_directory))
+    {
+        asset_set_error(error_buffer, error_capacity, "Failed to prepare destination directory");
+        return false;
+    }
+
+    FILE *source = NULL;
+#if defined(_WIN32)
+    if (fopen_s(&source, request->source_path, "rb") != 0)
+    {
+        source = NULL;
+    }
+#else
+    source = fopen(request->source_path, "rb");
+#endif
+    if (!source)
+    {
+        asset_set_error(error_buffer, error_capacity, "Source asset unavailable");
+        return false;
+    }
+
+    size_t source_size = 0U;
+    uint64_t content_hash = 0U;
+    if (!asset_get_file_size(request->source_path, &source_size) ||
+        !asset_hash_stream(source, (uint64_t)source_size, &content_hash))
+    {
+        fclose(source);
+        asset_set_error(error_buffer, error_capacity, "Source asset unreadable");
+        return false;
+    }
+
+    char relative_path[ASSET_PATH_MAX];
+    if (asset_content_index_find(root_buffer, content_hash, (uint64_t)source_size, request->source_path,
+                                 relative_path, sizeof(relative_path)))
+    {
+        fclose(source);
+        if (out_relative_path && relative_capacity > 0U &&
+            snprintf(out_relative_path, relative_capacity, "%s", relative_path) >= (int)relative_capacity)
+        {
+            asset_set_error(error_buffer, error_capacity, "Relative path buffer too small");
+            return false;
+        }
+        asset_set_error(error_buffer, error_capacity, "");
+        return true;
+    }
+
+    const char *extension = asset_find_extension(request->source_path);
+    char filename[ASSET_FILENAME_MAX];
+    if (!asset_generate_unique_name(request->name_prefix ? request->name_prefix : "asset", extension,
+                                    destination_directory, filename, sizeof(filename)))
+    {
+        fclose(source);
+        asset_set_error(error_buffer, error_capacity, "Unable to generate unique filename");
+        return false;
+    }
+
+    char destination_path[ASSET_PATH_MAX];
+    if (snprintf(destination_path, sizeof(destination_path), "%s/%s", destination_directory, filename) >=
+        (int)sizeof(destination_path))
+    {
+        fclose(source);
+        asset_set_error(error_buffer, error_capacity, "Destination file path too long");
+        return false;
+    }
+    asset_normalise_path(destination_path);
+
+    FILE *destination = NULL;
+#if defined(_WIN32)
+    if (fopen_s(&destination, destination_path, "wb") != 0)
+    {
+        destination = NULL;
+    }
+#else
+    destination = fopen(destination_path, "wb");
+#endif
+    if (!destination)
+    {
+        fclose(source);
+        asset_set_error(error_buffer, error_capacity, "Unable to open destination asset file");
+        return false;
+    }
+
+    bool copy_result = asset_copy_stream(source, destination, UINT64_MAX, NULL);
+    fclose(source);
+    if (fflush(destination) != 0)
+    {
+        copy_result = false;
+    }
+    if (fclose(destination) != 0)
+    {
+        copy_result = false;
+    }
+    if (!copy_result)
+    {
+        (void)remove(destination_path);
+        asset_set_error(error_buffer, error_capacity, "Asset copy failed");
+        return false;
+    }
+
+    if (!asset_build_relative_path(relative_path, sizeof(relative_path), subdir_buffer, filename))
+    {
+        (void)remove(destination_path);
+        asset_set_error(error_buffer, error_capacity, "Relative asset path too long");
+        return false;
+    }
+    asset_content_index_append(root_buffer, content_hash, (uint64_t)source_size, relative_path);
+
+    if (out_relative_path && relative_capacity > 0U)
+    {
+        if (snprintf(out_relative_path, relative_capacity, "%s", relative_path) >= (int)relative_capacity)
+        {
+            asset_set_error(error_buffer, error_capacity, "Relative path buffer too small");
+            return false;
         }
-        asset_normalise_path(out_relative_path);
     }
 
     asset_set_error(error_buffer, error_capacity, "");
@@ -888,49 +1587,132 @@ static bool asset_collect_tree_assets(const FamilyTree *tree, AssetPathList *lis
     return success;
 }
 
-static bool asset_verify_references(const char *asset_root, const AssetPathList *references,
-                                    AssetCleanupStats *stats, char *error_buffer, size_t error_capacity)
+/* Runs worker(context) on worker_count threads, the caller's included; falls back to fewer if threads fail to start. */
+static void asset_run_workers(size_t worker_count, AtThreadFunction worker, void *context)
 {
-    if (!asset_root || !references || !stats)
+    AtThread *threads = worker_count > 1U ? AT_CALLOC(worker_count - 1U, sizeof(AtThread)) : NULL;
+    size_t started = 0U;
+    if (threads)
     {
-        asset_set_error_once(error_buffer, error_capacity, "Invalid parameters for asset verification");
-        return false;
+        while (started < worker_count - 1U && at_thread_start(&threads[started], worker, context))
+        {
+            ++started;
+        }
     }
-    bool success = true;
-    for (size_t index = 0U; index < references->count; ++index)
+    worker(context);
+    for (size_t index = 0U; index < started; ++index)
     {
-        const char *relative = references->items[index];
-        char absolute[ASSET_PATH_MAX];
-        if (!asset_join_path(absolute, sizeof(absolute), asset_root, relative))
+        (void)at_thread_join(&threads[index]);
+    }
+    AT_FREE(threads);
+}
+
+#define ASSET_VERIFY_CHUNK 256U
+
+/* Workers claim references in chunks and keep their counts and first error locally until they finish. */
+typedef struct AssetVerifyJob
+{
+    const char *asset_root;
+    const AssetPathList *references;
+    AtMutex mutex;
+    size_t next;
+    size_t missing_files;
+    size_t integrity_failures;
+    size_t error_index; /* Reference the reported message belongs to; the lowest wins, as in a serial pass. */
+    char error[ASSET_PATH_MAX + 64U];
+} AssetVerifyJob;
+
+static void asset_verify_worker(void *user_data)
+{
+    AssetVerifyJob *job = (AssetVerifyJob *)user_data;
+    size_t missing = 0U;
+    size_t failures = 0U;
+    size_t error_index = SIZE_MAX;
+    char error[ASSET_PATH_MAX + 64U];
+    error[0] = '\0';
+    for (;;)
+    {
+        at_mutex_lock(&job->mutex);
+        size_t begin = job->next;
+        job->next += ASSET_VERIFY_CHUNK;
+        at_mutex_unlock(&job->mutex);
+        if (begin >= job->references->count)
         {
-            stats->integrity_failures += 1U;
-            char message[ASSET_PATH_MAX + 64U];
-            (void)snprintf(message, sizeof(message), "Asset path too long: %s", relative);
-            asset_set_error_once(error_buffer, error_capacity, message);
-            success = false;
-            continue;
+            break;
         }
-        asset_normalise_path(absolute);
-        size_t file_size = 0U;
-        if (!asset_get_file_size(absolute, &file_size))
+        size_t end = begin + ASSET_VERIFY_CHUNK;
+        if (end > job->references->count)
         {
-            stats->missing_files += 1U;
-            char message[ASSET_PATH_MAX + 64U];
-            (void)snprintf(message, sizeof(message), "Missing asset: %s", relative);
-            asset_set_error_once(error_buffer, error_capacity, message);
-            success = false;
-            continue;
+            end = job->references->count;
         }
-        if (file_size == 0U)
+        for (size_t index = begin; index < end; ++index)
         {
-            stats->integrity_failures += 1U;
-            char message[ASSET_PATH_MAX + 64U];
-            (void)snprintf(message, sizeof(message), "Asset is empty: %s", relative);
-            asset_set_error_once(error_buffer, error_capacity, message);
-            success = false;
+            const char *relative = job->references->items[index];
+            const char *problem = NULL;
+            char absolute[ASSET_PATH_MAX];
+            size_t file_size = 0U;
+            if (!asset_join_path(absolute, sizeof(absolute), job->asset_root, relative))
+            {
+                failures += 1U;
+                problem = "Asset path too long";
+            }
+            else
+            {
+                asset_normalise_path(absolute);
+                if (!asset_get_file_size(absolute, &file_size))
+                {
+                    missing += 1U;
+                    problem = "Missing asset";
+                }
+                else if (file_size == 0U)
+                {
+                    failures += 1U;
+                    problem = "Asset is empty";
+                }
+            }
+            if (problem && index < error_index)
+            {
+                error_index = index;
+                (void)snprintf(error, sizeof(error), "%s: %s", problem, relative);
+            }
         }
     }
-    return success && stats->missing_files == 0U && stats->integrity_failures == 0U;
+    at_mutex_lock(&job->mutex);
+    job->missing_files += missing;
+    job->integrity_failures += failures;
+    if (error_index < job->error_index)
+    {
+        job->error_index = error_index;
+        memcpy(job->error, error, sizeof(error));
+    }
+    at_mutex_unlock(&job->mutex);
+}
+
+static bool asset_verify_references(const char *asset_root, const AssetPathList *references, size_t worker_count,
+                                    AssetCleanupStats *stats, char *error_buffer, size_t error_capacity)
+{
+    if (!asset_root || !references || !stats)
+    {
+        asset_set_error_once(error_buffer, error_capacity, "Invalid parameters for asset verification");
+        return false;
+    }
+    AssetVerifyJob job;
+    memset(&job, 0, sizeof(job));
+    job.asset_root = asset_root;
+    job.references = references;
+    job.error_index = SIZE_MAX;
+    at_mutex_init(&job.mutex);
+    size_t chunks = (references->count + ASSET_VERIFY_CHUNK - 1U) / ASSET_VERIFY_CHUNK;
+    asset_run_workers(worker_count < chunks ? worker_count : (chunks > 0U ? chunks : 1U), asset_verify_worker, &job);
+    at_mutex_destroy(&job.mutex);
+
+    stats->missing_files += job.missing_files;
+    stats->integrity_failures += job.integrity_failures;
+    if (job.error_index != SIZE_MAX)
+    {
+        asset_set_error_once(error_buffer, error_capacity, job.error);
+    }
+    return job.error_index == SIZE_MAX && stats->missing_files == 0U && stats->integrity_failures == 0U;
 }
 
 #if defined(_WIN32)
@@ -1002,7 +1784,7 @@ static bool asset_cleanup_directory_win(const char *absolute_dir, const char *re
                 success = false;
                 continue;
             }
-            if (!asset_path_list_contains(references, relative_path))
+            if (!asset_path_list_contains(references, relative_path) && !asset_is_reserved_path(relative_path))
             {
                 if (!asset_remove_file_native(child_absolute))
                 {
@@ -1036,23 +1818,103 @@ static bool asset_cleanup_directory_win(const char *absolute_dir, const char *re
     return success;
 }
 #else
-static bool asset_cleanup_directory_posix(const char *absolute_dir, const char *relative_prefix,
-                                          const AssetPathList *references, AssetCleanupStats *stats,
-                                          char *error_buffer, size_t error_capacity, bool is_root)
+typedef struct AssetWalkDirectory
 {
-    DIR *dir = opendir(absolute_dir);
-    if (!dir)
+    char *absolute;
+    char *relative;
+    bool is_root;
+} AssetWalkDirectory;
+
+/* Directory walk shared by the cleanup workers: a stack of directories still to list that any idle worker pops
+ * from, plus the directories already listed so they can be removed deepest first once the walk is over. */
+typedef struct AssetWalk
+{
+    const AssetPathList *references;
+    AtMutex mutex;
+    AtCondition wake;
+    AssetWalkDirectory *pending;
+    size_t pending_count;
+    size_t pending_capacity;
+    char **visited;
+    size_t visited_count;
+    size_t visited_capacity;
+    size_t active;
+    size_t removed_files;
+    bool success;
+    char *error_buffer;
+    size_t error_capacity;
+} AssetWalk;
+
+static void asset_walk_fail(AssetWalk *walk, const char *message)
+{
+    at_mutex_lock(&walk->mutex);
+    walk->success = false;
+    asset_set_error_once(walk->error_buffer, walk->error_capacity, message);
+    at_mutex_unlock(&walk->mutex);
+}
+
+static bool asset_walk_push(AssetWalk *walk, const char *absolute, const char *relative, bool is_root)
+{
+    AssetWalkDirectory directory = {at_string_dup(absolute), at_string_dup(relative), is_root};
+    if (!directory.absolute || !directory.relative)
+    {
+        AT_FREE(directory.absolute);
+        AT_FREE(directory.relative);
+        return false;
+    }
+    at_mutex_lock(&walk->mutex);
+    if (walk->pending_count == walk->pending_capacity)
     {
-        if (errno == ENOENT)
+        size_t capacity = walk->pending_capacity > 0U ? walk->pending_capacity * 2U : 16U;
+        AssetWalkDirectory *pending = at_secure_realloc(walk->pending, capacity, sizeof(AssetWalkDirectory));
+        if (!pending)
         {
-            return true;
+            at_mutex_unlock(&walk->mutex);
+            AT_FREE(directory.absolute);
+            AT_FREE(directory.relative);
+            return false;
         }
-        char message[ASSET_PATH_MAX + 64U];
-        (void)snprintf(message, sizeof(message), "Failed to open directory: %s", absolute_dir);
-        asset_set_error_once(error_buffer, error_capacity, message);
+        walk->pending = pending;
+        walk->pending_capacity = capacity;
+    }
+    walk->pending[walk->pending_count++] = directory;
+    at_condition_signal(&walk->wake);
+    at_mutex_unlock(&walk->mutex);
+    return true;
+}
+
+static bool asset_walk_is_directory(DIR *dir, const struct dirent *entry)
+{
+#if defined(DT_DIR) && defined(DT_REG)
+    /* Most file systems report the type in the entry itself, which saves a stat per file. */
+    if (entry->d_type == DT_DIR)
+    {
+        return true;
+    }
+    if (entry->d_type == DT_REG)
+    {
         return false;
     }
-    bool success = true;
+#endif
+    struct stat file_info;
+    return fstatat(dirfd(dir), entry->d_name, &file_info, 0) == 0 && S_ISDIR(file_info.st_mode);
+}
+
+/* Lists one directory: queues its subdirectories and deletes its unreferenced files. Returns the files deleted. */
+static size_t asset_walk_directory(AssetWalk *walk, const AssetWalkDirectory *directory)
+{
+    DIR *dir = opendir(directory->absolute);
+    if (!dir)
+    {
+        if (errno != ENOENT)
+        {
+            char message[ASSET_PATH_MAX + 64U];
+            (void)snprintf(message, sizeof(message), "Failed to open directory: %s", directory->absolute);
+            asset_walk_fail(walk, message);
+        }
+        return 0U;
+    }
+    size_t removed = 0U;
     struct dirent *entry = NULL;
     while ((entry = readdir(dir)) != NULL)
     {
@@ -1062,79 +1924,149 @@ static bool asset_cleanup_directory_posix(const char *absolute_dir, const char *
             continue;
         }
         char child_absolute[ASSET_PATH_MAX];
-        if (!asset_join_path(child_absolute, sizeof(child_absolute), absolute_dir, name))
+        if (!asset_join_path(child_absolute, sizeof(child_absolute), directory->absolute, name))
         {
             char message[ASSET_PATH_MAX + 64U];
-            (void)snprintf(message, sizeof(message), "Path too long: %s/%s", absolute_dir, name);
-            asset_set_error_once(error_buffer, error_capacity, message);
-            success = false;
+            (void)snprintf(message, sizeof(message), "Path too long: %s/%s", directory->absolute, name);
+            asset_walk_fail(walk, message);
             continue;
         }
-        struct stat file_info;
-        bool is_directory = false;
-        if (stat(child_absolute, &file_info) == 0)
+        char child_relative[ASSET_PATH_MAX];
+        if (!asset_build_relative_path(child_relative, sizeof(child_relative), directory->relative, name))
         {
-            is_directory = S_ISDIR(file_info.st_mode);
+            asset_walk_fail(walk, "Relative asset path too long");
+            continue;
         }
-        if (is_directory)
+        if (asset_walk_is_directory(dir, entry))
         {
-            char child_relative[ASSET_PATH_MAX];
-            if (!asset_build_relative_path(child_relative, sizeof(child_relative), relative_prefix, name))
+            if (!asset_walk_push(walk, child_absolute, child_relative, false))
             {
-                asset_set_error_once(error_buffer, error_capacity, "Relative asset path too long");
-                success = false;
-                continue;
+                asset_walk_fail(walk, "Out of memory while walking assets");
+            }
+        }
+        else if (!asset_path_list_contains(walk->references, child_relative) &&
+                 !asset_is_reserved_path(child_relative))
+        {
+            if (unlinkat(dirfd(dir), name, 0) == 0 || errno == ENOENT)
+            {
+                removed += 1U;
             }
-            if (!asset_cleanup_directory_posix(child_absolute, child_relative, references, stats, error_buffer,
-                                               error_capacity, false))
+            else
             {
-                success = false;
+                char message[ASSET_PATH_MAX + 64U];
+                (void)snprintf(message, sizeof(message), "Failed to remove asset: %s", child_absolute);
+                asset_walk_fail(walk, message);
             }
-            asset_remove_directory_native(child_absolute);
         }
-        else
+    }
+    if (closedir(dir) != 0)
+    {
+        char message[ASSET_PATH_MAX + 64U];
+        (void)snprintf(message, sizeof(message), "Failed to close directory: %s", directory->absolute);
+        asset_walk_fail(walk, message);
+    }
+    return removed;
+}
+
+static void asset_walk_worker(void *user_data)
+{
+    AssetWalk *walk = (AssetWalk *)user_data;
+    at_mutex_lock(&walk->mutex);
+    for (;;)
+    {
+        if (walk->pending_count == 0U)
         {
-            char relative_path[ASSET_PATH_MAX];
-            if (!asset_build_relative_path(relative_path, sizeof(relative_path), relative_prefix, name))
+            if (walk->active == 0U)
             {
-                asset_set_error_once(error_buffer, error_capacity, "Relative asset path too long");
-                success = false;
-                continue;
+                break;
             }
-            if (!asset_path_list_contains(references, relative_path))
-            {
-                if (!asset_remove_file_native(child_absolute))
-                {
-                    char message[ASSET_PATH_MAX + 64U];
-                    (void)snprintf(message, sizeof(message), "Failed to remove asset: %s", child_absolute);
-                    asset_set_error_once(error_buffer, error_capacity, message);
-                    success = false;
-                }
-                else
-                {
-                    stats->removed_files += 1U;
-                }
+            at_condition_wait(&walk->wake, &walk->mutex);
+            continue;
+        }
+        AssetWalkDirectory directory = walk->pending[--walk->pending_count];
+        walk->active++;
+        at_mutex_unlock(&walk->mutex);
+        size_t removed = asset_walk_directory(walk, &directory);
+        AT_FREE(directory.relative);
+        at_mutex_lock(&walk->mutex);
+        walk->removed_files += removed;
+        walk->active--;
+        if (!directory.is_root && walk->visited_count == walk->visited_capacity)
+        {
+            size_t capacity = walk->visited_capacity > 0U ? walk->visited_capacity * 2U : 16U;
+            char **visited = at_secure_realloc(walk->visited, capacity, sizeof(char *));
+            if (visited)
+            {
+                walk->visited = visited;
+                walk->visited_capacity = capacity;
             }
         }
+        if (!directory.is_root && walk->visited_count < walk->visited_capacity)
+        {
+            walk->visited[walk->visited_count++] = directory.absolute;
+        }
+        else
+        {
+            AT_FREE(directory.absolute);
+        }
+        if (walk->pending_count == 0U && walk->active == 0U)
+        {
+            at_condition_broadcast(&walk->wake);
+        }
     }
-    if (closedir(dir) != 0)
+    at_mutex_unlock(&walk->mutex);
+}
+
+static int asset_compare_deepest_first(const void *lhs, const void *rhs)
+{
+    size_t left = strlen(*(const char *const *)lhs);
+    size_t right = strlen(*(const char *const *)rhs);
+    return (left < right) - (left > right);
+}
+
+static bool asset_cleanup_directory_posix(const char *absolute_dir, const char *relative_prefix,
+                                          const AssetPathList *references, size_t worker_count,
+                                          AssetCleanupStats *stats, char *error_buffer, size_t error_capacity)
+{
+    AssetWalk walk;
+    memset(&walk, 0, sizeof(walk));
+    walk.references = references;
+    walk.success = true;
+    walk.error_buffer = error_buffer;
+    walk.error_capacity = error_capacity;
+    at_mutex_init(&walk.mutex);
+    at_condition_init(&walk.wake);
+    if (asset_walk_push(&walk, absolute_dir, relative_prefix, true))
+    {
+        asset_run_workers(worker_count, asset_walk_worker, &walk);
+    }
+    else
     {
-        char message[ASSET_PATH_MAX + 64U];
-        (void)snprintf(message, sizeof(message), "Failed to close directory: %s", absolute_dir);
-        asset_set_error_once(error_buffer, error_capacity, message);
-        success = false;
+        asset_set_error_once(error_buffer, error_capacity, "Out of memory while walking assets");
+        walk.success = false;
     }
-    if (!is_root)
+    /* A child path is longer than its parent's, so this order empties subdirectories before their parents. */
+    if (walk.visited_count > 1U)
     {
-        asset_remove_directory_native(absolute_dir);
+        qsort(walk.visited, walk.visited_count, sizeof(char *), asset_compare_deepest_first);
     }
-    return success;
+    for (size_t index = 0U; index < walk.visited_count; ++index)
+    {
+        (void)asset_remove_directory_native(walk.visited[index]);
+        AT_FREE(walk.visited[index]);
+    }
+    AT_FREE(walk.visited);
+    AT_FREE(walk.pending);
+    at_condition_destroy(&walk.wake);
+    at_mutex_destroy(&walk.mutex);
+    stats->removed_files += walk.removed_files;
+    return walk.success;
 }
 #endif
 
 static bool asset_remove_unreferenced(const char *asset_root, const char *normalized_subdir,
-                                      const AssetPathList *references, AssetCleanupStats *stats,
-                                      char *error_buffer, size_t error_capacity)
+                                      const AssetPathList *references, size_t worker_count,
+                                      AssetCleanupStats *stats, char *error_buffer, size_t error_capacity)
 {
     if (!asset_root || !references || !stats)
     {
@@ -1164,16 +2096,18 @@ static bool asset_remove_unreferenced(const char *asset_root, const char *normal
     const char *relative_prefix = (normalized_subdir && normalized_subdir[0] != '\0') ? normalized_subdir : "";
 
 #if defined(_WIN32)
+    (void)worker_count;
     return asset_cleanup_directory_win(base_path, relative_prefix, references, stats, error_buffer, error_capacity,
                                        true);
 #else
-    return asset_cleanup_directory_posix(base_path, relative_prefix, references, stats, error_buffer, error_capacity,
-                                         true);
+    return asset_cleanup_directory_posix(base_path, relative_prefix, references, worker_count, stats, error_buffer,
+                                         error_capacity);
 #endif
 }
 
-bool asset_cleanup(const FamilyTree *tree, const char *asset_root, const char *import_subdirectory,
-                   AssetCleanupStats *stats, char *error_buffer, size_t error_capacity)
+static bool asset_cleanup_run(const FamilyTree *tree, const char *asset_root, const char *import_subdirectory,
+                              size_t worker_count, AssetCleanupStats *stats, char *error_buffer,
+                              size_t error_capacity)
 {
     AssetCleanupStats local_stats;
     local_stats.referenced_files = 0U;
@@ -1231,13 +2165,14 @@ bool asset_cleanup(const FamilyTree *tree, const char *asset_root, const char *i
 
     if (collection_ok)
     {
-        bool verify_ok = asset_verify_references(asset_root, &references, &local_stats, error_buffer, error_capacity);
+        bool verify_ok = asset_verify_references(asset_root, &references, worker_count, &local_stats, error_buffer,
+                                                 error_capacity);
         if (!verify_ok)
         {
             success = false;
         }
-        else if (!asset_remove_unreferenced(asset_root, normalized_subdir, &references, &local_stats, error_buffer,
-                                            error_capacity))
+        else if (!asset_remove_unreferenced(asset_root, normalized_subdir, &references, worker_count, &local_stats,
+                                            error_buffer, error_capacity))
         {
             success = false;
         }
@@ -1258,6 +2193,23 @@ bool asset_cleanup(const FamilyTree *tree, const char *asset_root, const char *i
     return success;
 }
 
+bool asset_cleanup(const FamilyTree *tree, const char *asset_root, const char *import_subdirectory,
+                   AssetCleanupStats *stats, char *error_buffer, size_t error_capacity)
+{
+    return asset_cleanup_run(tree, asset_root, import_subdirectory, 1U, stats, error_buffer, error_capacity);
+}
+
+bool asset_cleanup_parallel(const FamilyTree *tree, const char *asset_root, const char *import_subdirectory,
+                            size_t worker_count, AssetCleanupStats *stats, char *error_buffer, size_t error_capacity)
+{
+    if (worker_count == 0U)
+    {
+        worker_count = at_thread_hardware_concurrency();
+    }
+    return asset_cleanup_run(tree, asset_root, import_subdirectory, worker_count, stats, error_buffer,
+                             error_capacity);
+}
+
 static bool asset_write_u16(FILE *file, uint16_t value)
 {
     unsigned char buffer[2];
@@ -1290,8 +2242,266 @@ static bool asset_write_u64(FILE *file, uint64_t value)
     return fwrite(buffer, 1U, sizeof(buffer), file) == sizeof(buffer);
 }
 
+/* Package layout, all integers little-endian:
+ *   header     "ATPKG", u32 version, u32 stored entry count
+ *   entries    u16 path length, path, u8 codec, u64 raw size, u64 stored size, data (tree.json first, then
+ *              assets/... in path order)
+ *   directory  per path, sorted: u16 path length, path, u64 data offset, u64 stored size, u64 raw size, u8 codec,
+ *              u32 checksum of the stored bytes
+ *   footer     u64 directory offset, u32 directory entry count, u32 directory checksum, "ATPKGEND"
+ * A payload identical to an earlier one is stored once, so the directory may list more paths than the entry
+ * stream, with duplicates sharing an offset. Versions 2 and 3 lack the codec and raw size fields (every entry is
+ * stored as is), version 2 never shares payloads, and version 1 packages end after the entries; readers index
+ * those by scanning them once. */
+#define ASSET_PACKAGE_VERSION 4U
+#define ASSET_PACKAGE_HEADER_SIZE 13U
+#define ASSET_PACKAGE_FOOTER_SIZE 24U
+/* Compressed exports hold an entry in memory from read to write; larger files are streamed uncompressed. */
+#define ASSET_EXPORT_COMPRESS_LIMIT (16U * 1024U * 1024U)
+
+static const unsigned char g_asset_package_magic[5] = {'A', 'T', 'P', 'K', 'G'};
+static const unsigned char g_asset_package_footer_magic[8] = {'A', 'T', 'P', 'K', 'G', 'E', 'N', 'D'};
+
+typedef struct AssetPackageDirectoryEntry
+{
+    char *path;
+    char *source_path; /* NULL for entries that alias an earlier payload. */
+    uint64_t offset;
+    uint64_t stored_size;
+    uint64_t raw_size;
+    uint64_t hash; /* Of the raw content; keys duplicate detection. */
+    uint32_t checksum;
+    AssetPackageCodec codec;
+} AssetPackageDirectoryEntry;
+
+/* Entries in write order, plus an open-addressing table over the stored payloads' hashes (entry index + 1). */
+typedef struct AssetPackageDirectory
+{
+    AssetPackageDirectoryEntry *entries;
+    size_t count;
+    size_t capacity;
+    size_t stored_count;
+    size_t *slots;
+    size_t slot_capacity;
+} AssetPackageDirectory;
+
+static void asset_package_directory_dispose(AssetPackageDirectory *directory)
+{
+    for (size_t index = 0U; index < directory->count; ++index)
+    {
+        AT_FREE(directory->entries[index].path);
+        AT_FREE(directory->entries[index].source_path);
+    }
+    AT_FREE(directory->entries);
+    AT_FREE(directory->slots);
+    directory->entries = NULL;
+    directory->count = 0U;
+    directory->capacity = 0U;
+    directory->stored_count = 0U;
+    directory->slots = NULL;
+    directory->slot_capacity = 0U;
+}
+
+static void asset_package_directory_index(AssetPackageDirectory *directory, size_t item)
+{
+    size_t mask = directory->slot_capacity - 1U;
+    size_t slot = (size_t)directory->entries[item].hash & mask;
+    while (directory->slots[slot] != 0U)
+    {
+        slot = (slot + 1U) & mask;
+    }
+    directory->slots[slot] = item + 1U;
+}
+
+/* Keeps the payload table at most half full. */
+static bool asset_package_directory_reserve_slots(AssetPackageDirectory *directory)
+{
+    if ((directory->stored_count + 1U) * 2U <= directory->slot_capacity)
+    {
+        return true;
+    }
+    size_t capacity = directory->slot_capacity > 0U ? directory->slot_capacity * 2U : 64U;
+    size_t *slots = AT_CALLOC(capacity, sizeof(size_t));
+    if (!slots)
+    {
+        return false;
+    }
+    AT_FREE(directory->slots);
+    directory->slots = slots;
+    directory->slot_capacity = capacity;
+    for (size_t index = 0U; index < directory->count; ++index)
+    {
+        if (directory->entries[index].source_path)
+        {
+            asset_package_directory_index(directory, index);
+        }
+    }
+    return true;
+}
+
+/* Returns an earlier stored entry whose source matches source_path byte for byte, or NULL. */
+static const AssetPackageDirectoryEntry *asset_package_directory_find(const AssetPackageDirectory *directory,
+                                                                      const char *source_path, uint64_t raw_size,
+                                                                      uint64_t hash)
+{
+    if (directory->slot_capacity == 0U)
+    {
+        return NULL;
+    }
+    size_t mask = directory->slot_capacity - 1U;
+    for (size_t slot = (size_t)hash & mask; directory->slots[slot] != 0U; slot = (slot + 1U) & mask)
+    {
+        const AssetPackageDirectoryEntry *entry = &directory->entries[directory->slots[slot] - 1U];
+        if (entry->hash == hash && entry->raw_size == raw_size &&
+            asset_files_equal(entry->source_path, source_path, raw_size))
+        {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/* Records path with payload's location and encoding; source_path is NULL when the payload was stored earlier. */
+static bool asset_package_directory_add(AssetPackageDirectory *directory, const char *path, const char *source_path,
+                                        const AssetPackageDirectoryEntry *payload)
+{
+    if (directory->count == directory->capacity)
+    {
+        size_t capacity = directory->capacity > 0U ? directory->capacity * 2U : 16U;
+        AssetPackageDirectoryEntry *entries =
+            at_secure_realloc(directory->entries, capacity, sizeof(AssetPackageDirectoryEntry));
+        if (!entries)
+        {
+            return false;
+        }
+        directory->entries = entries;
+        directory->capacity = capacity;
+    }
+    if (source_path && !asset_package_directory_reserve_slots(directory))
+    {
+        return false;
+    }
+    char *path_copy = at_string_dup(path);
+    char *source_copy = source_path ? at_string_dup(source_path) : NULL;
+    if (!path_copy || (source_path && !source_copy))
+    {
+        AT_FREE(path_copy);
+        AT_FREE(source_copy);
+        return false;
+    }
+    AssetPackageDirectoryEntry *entry = &directory->entries[directory->count];
+    *entry = *payload;
+    entry->path = path_copy;
+    entry->source_path = source_copy;
+    if (source_copy)
+    {
+        asset_package_directory_index(directory, directory->count);
+        directory->stored_count += 1U;
+    }
+    directory->count += 1U;
+    return true;
+}
+
+static int asset_package_directory_compare(const void *lhs, const void *rhs)
+{
+    return strcmp(((const AssetPackageDirectoryEntry *)lhs)->path, ((const AssetPackageDirectoryEntry *)rhs)->path);
+}
+
+static void asset_put_le(unsigned char *cursor, uint64_t value, size_t bytes)
+{
+    for (size_t index = 0U; index < bytes; ++index)
+    {
+        cursor[index] = (unsigned char)((value >> (index * 8U)) & 0xFFU);
+    }
+}
+
+/* Appends the sorted directory and the footer at the package's current end. */
+static bool asset_package_write_directory(FILE *package, AssetPackageDirectory *directory)
+{
+    int64_t directory_offset = asset_file_tell(package);
+    if (directory_offset < 0 || directory->count > UINT32_MAX)
+    {
+        return false;
+    }
+    if (directory->count > 1U)
+    {
+        qsort(directory->entries, directory->count, sizeof(AssetPackageDirectoryEntry),
+              asset_package_directory_compare);
+    }
+    size_t directory_size = 0U;
+    for (size_t index = 0U; index < directory->count; ++index)
+    {
+        directory_size += 2U + strlen(directory->entries[index].path) + 8U + 8U + 8U + 1U + 4U;
+    }
+    unsigned char *buffer = AT_MALLOC(directory_size + ASSET_PACKAGE_FOOTER_SIZE);
+    if (!buffer)
+    {
+        return false;
+    }
+    unsigned char *cursor = buffer;
+    for (size_t index = 0U; index < directory->count; ++index)
+    {
+        const AssetPackageDirectoryEntry *entry = &directory->entries[index];
+        size_t path_length = strlen(entry->path);
+        asset_put_le(cursor, path_length, 2U);
+        memcpy(cursor + 2U, entry->path, path_length);
+        cursor += 2U + path_length;
+        asset_put_le(cursor, entry->offset, 8U);
+        asset_put_le(cursor + 8U, entry->stored_size, 8U);
+        asset_put_le(cursor + 16U, entry->raw_size, 8U);
+        cursor[24] = (unsigned char)entry->codec;
+        asset_put_le(cursor + 25U, entry->checksum, 4U);
+        cursor += 29U;
+    }
+    asset_put_le(cursor, (uint64_t)directory_offset, 8U);
+    asset_put_le(cursor + 8U, directory->count, 4U);
+    asset_put_le(cursor + 12U, asset_checksum(buffer, directory_size), 4U);
+    memcpy(cursor + 16U, g_asset_package_footer_magic, sizeof(g_asset_package_footer_magic));
+    size_t total = directory_size + ASSET_PACKAGE_FOOTER_SIZE;
+    bool written = fwrite(buffer, 1U, total, package) == total;
+    AT_FREE(buffer);
+    return written;
+}
+
+/* Writes an entry header and records where its data will start in payload->offset. */
+static bool asset_package_write_entry_header(FILE *package, const char *entry_path,
+                                             AssetPackageDirectoryEntry *payload)
+{
+    size_t path_length = strlen(entry_path);
+    unsigned char codec = (unsigned char)payload->codec;
+    if (path_length == 0U || path_length > UINT16_MAX || !asset_write_u16(package, (uint16_t)path_length) ||
+        fwrite(entry_path, 1U, path_length, package) != path_length || fwrite(&codec, 1U, 1U, package) != 1U ||
+        !asset_write_u64(package, payload->raw_size) || !asset_write_u64(package, payload->stored_size))
+    {
+        return false;
+    }
+    int64_t offset = asset_file_tell(package);
+    payload->offset = (uint64_t)offset;
+    return offset >= 0;
+}
+
+/* Points entry_path at an identical payload already in the package. */
+static bool asset_package_write_alias(AssetPackageDirectory *directory, const char *entry_path,
+                                      const AssetPackageDirectoryEntry *stored, AssetExportStats *stats,
+                                      char *error_buffer, size_t error_capacity)
+{
+    AssetPackageDirectoryEntry alias = *stored;
+    if (!asset_package_directory_add(directory, entry_path, NULL, &alias))
+    {
+        asset_set_error_once(error_buffer, error_capacity, "Failed to record asset in package directory");
+        return false;
+    }
+    if (stats)
+    {
+        stats->deduplicated_files += 1U;
+    }
+    return true;
+}
+
+/* Streams source_path into the package uncompressed; entry_path is already normalised. */
 static bool asset_package_write_entry(FILE *package, const char *entry_path, const char *source_path,
-                                      AssetExportStats *stats, char *error_buffer, size_t error_capacity)
+                                      AssetPackageDirectory *directory, AssetExportStats *stats,
+                                      char *error_buffer, size_t error_capacity)
 {
     if (!package || !entry_path || !source_path)
     {
@@ -1307,15 +2517,7 @@ static bool asset_package_write_entry(FILE *package, const char *entry_path, con
         return false;
     }
 
-    FILE *source = NULL;
-#if defined(_WIN32)
-    if (fopen_s(&source, source_path, "rb") != 0)
-    {
-        source = NULL;
-    }
-#else
-    source = fopen(source_path, "rb");
-#endif
+    FILE *source = asset_open_file(source_path, "rb");
     if (!source)
     {
         char message[ASSET_PATH_MAX + 64U];
@@ -1324,54 +2526,37 @@ static bool asset_package_write_entry(FILE *package, const char *entry_path, con
         return false;
     }
 
-    char normalized_path[ASSET_PATH_MAX + 32U];
-    if (!asset_prepare_relative_path(entry_path, normalized_path, sizeof(normalized_path)))
+    AssetPackageDirectoryEntry payload;
+    memset(&payload, 0, sizeof(payload));
+    payload.raw_size = (uint64_t)file_size;
+    payload.stored_size = (uint64_t)file_size;
+    payload.codec = ASSET_PACKAGE_CODEC_NONE;
+    if (!asset_hash_stream(source, payload.raw_size, &payload.hash))
     {
-        asset_set_error_once(error_buffer, error_capacity, "Export entry path invalid");
+        asset_set_error_once(error_buffer, error_capacity, "Failed to checksum asset for export");
         fclose(source);
         return false;
     }
-    size_t path_length = strlen(normalized_path);
-    if (path_length == 0U || path_length > UINT16_MAX)
+    payload.checksum = asset_checksum_fold(payload.hash);
+    const AssetPackageDirectoryEntry *stored =
+        asset_package_directory_find(directory, source_path, payload.raw_size, payload.hash);
+    if (stored)
     {
-        asset_set_error_once(error_buffer, error_capacity, "Export entry path too long");
         fclose(source);
-        return false;
+        return asset_package_write_alias(directory, entry_path, stored, stats, error_buffer, error_capacity);
     }
 
-    bool success = asset_write_u16(package, (uint16_t)path_length);
-    if (success)
-    {
-        success = fwrite(normalized_path, 1U, path_length, package) == path_length;
-    }
-    if (success)
+    bool success = asset_package_write_entry_header(package, entry_path, &payload);
+    if (!success)
     {
-        success = asset_write_u64(package, (uint64_t)file_size);
+        asset_set_error_once(error_buffer, error_capacity, "Failed to write package entry header");
     }
 
-    unsigned char buffer[4096];
-    size_t total_written = 0U;
-    while (success && total_written < file_size)
+    uint64_t total_written = 0U;
+    if (success && !asset_copy_stream(source, package, payload.raw_size, &total_written))
     {
-        size_t remaining = file_size - total_written;
-        size_t chunk_size = remaining > sizeof(buffer) ? sizeof(buffer) : remaining;
-        size_t read = fread(buffer, 1U, chunk_size, source);
-        if (read == 0U)
-        {
-            if (ferror(source))
-            {
-                asset_set_error_once(error_buffer, error_capacity, "Failed to read asset while exporting");
-            }
-            success = false;
-            break;
-        }
-        if (fwrite(buffer, 1U, read, package) != read)
-        {
-            asset_set_error_once(error_buffer, error_capacity, "Failed to write package data");
-            success = false;
-            break;
-        }
-        total_written += read;
+        asset_set_error_once(error_buffer, error_capacity, "Failed to copy asset into package");
+        success = false;
     }
 
     fclose(source);
@@ -1380,23 +2565,309 @@ static bool asset_package_write_entry(FILE *package, const char *entry_path, con
         asset_set_error_once(error_buffer, error_capacity, "Incomplete asset export");
         success = false;
     }
+    if (success && !asset_package_directory_add(directory, entry_path, source_path, &payload))
+    {
+        asset_set_error_once(error_buffer, error_capacity, "Failed to record asset in package directory");
+        success = false;
+    }
 
     if (success && stats)
     {
         stats->exported_files += 1U;
         stats->exported_bytes += file_size;
+        stats->package_bytes += file_size;
+    }
+
+    return success;
+}
+
+/* One package entry on its way through a compressed export. Workers fill in the payload; the writer consumes
+ * jobs strictly in order. */
+typedef struct AssetExportJob
+{
+    char *entry_path;
+    char *source_path;
+    unsigned char *payload; /* Stored bytes; NULL when the writer should stream the file itself. */
+    AssetPackageDirectoryEntry encoding;
+    bool done;
+} AssetExportJob;
+
+typedef struct AssetExportPipeline
+{
+    AssetExportJob *jobs;
+    size_t count;
+    AssetPackageCodec codec;
+    size_t next_job; /* Next job to claim. */
+    size_t written;  /* Jobs the writer has finished with. */
+    size_t window;   /* Claims may run at most this far ahead of the writer, bounding memory. */
+    bool cancelled;
+    AtMutex mutex;
+    AtCondition ready;
+    AtCondition space;
+} AssetExportPipeline;
+
+static void asset_export_job_dispose(AssetExportJob *job)
+{
+    AT_FREE(job->entry_path);
+    AT_FREE(job->source_path);
+    AT_FREE(job->payload);
+    job->entry_path = NULL;
+    job->source_path = NULL;
+    job->payload = NULL;
+}
+
+/* Reads, hashes and compresses one job's file. Entries that do not shrink are kept raw; files that cannot be read
+ * here, or are too large to hold, are left for the writer to stream so that it reports any error in order. */
+static void asset_export_job_prepare(AssetExportJob *job, AssetPackageCodec codec)
+{
+    size_t file_size = 0U;
+    if (!asset_get_file_size(job->source_path, &file_size) || file_size > ASSET_EXPORT_COMPRESS_LIMIT)
+    {
+        return;
+    }
+    FILE *source = asset_open_file(job->source_path, "rb");
+    unsigned char *raw = source ? AT_MALLOC(file_size > 0U ? file_size : 1U) : NULL;
+    bool read_ok = raw && fread(raw, 1U, file_size, source) == file_size;
+    if (source)
+    {
+        fclose(source);
+    }
+    if (!read_ok)
+    {
+        AT_FREE(raw);
+        return;
+    }
+    AssetPackageDirectoryEntry *encoding = &job->encoding;
+    encoding->raw_size = (uint64_t)file_size;
+    encoding->hash = asset_hash_finish(asset_hash_update(ASSET_HASH_SEED, raw, file_size), file_size);
+    encoding->codec = ASSET_PACKAGE_CODEC_NONE;
+    encoding->stored_size = (uint64_t)file_size;
+    job->payload = raw;
+    if (codec == ASSET_PACKAGE_CODEC_LZ && file_size > 0U)
+    {
+        unsigned char *packed = AT_MALLOC(file_size);
+        size_t packed_size = packed ? at_compress(raw, file_size, packed, file_size - 1U) : 0U;
+        if (packed_size > 0U)
+        {
+            AT_FREE(raw);
+            job->payload = packed;
+            encoding->codec = ASSET_PACKAGE_CODEC_LZ;
+            encoding->stored_size = (uint64_t)packed_size;
+        }
+        else
+        {
+            AT_FREE(packed);
+        }
+    }
+    encoding->checksum = asset_checksum(job->payload, encoding->stored_size);
+}
+
+static void asset_export_worker(void *user_data)
+{
+    AssetExportPipeline *pipeline = (AssetExportPipeline *)user_data;
+    at_mutex_lock(&pipeline->mutex);
+    for (;;)
+    {
+        while (!pipeline->cancelled && pipeline->next_job < pipeline->count &&
+               pipeline->next_job >= pipeline->written + pipeline->window)
+        {
+            at_condition_wait(&pipeline->space, &pipeline->mutex);
+        }
+        if (pipeline->cancelled || pipeline->next_job >= pipeline->count)
+        {
+            break;
+        }
+        AssetExportJob *job = &pipeline->jobs[pipeline->next_job++];
+        at_mutex_unlock(&pipeline->mutex);
+        asset_export_job_prepare(job, pipeline->codec);
+        at_mutex_lock(&pipeline->mutex);
+        job->done = true;
+        at_condition_broadcast(&pipeline->ready);
+    }
+    at_mutex_unlock(&pipeline->mutex);
+}
+
+/* Waits for job index, preparing it on this thread when no worker has claimed it yet. */
+static AssetExportJob *asset_export_pipeline_next(AssetExportPipeline *pipeline, size_t index)
+{
+    AssetExportJob *job = &pipeline->jobs[index];
+    at_mutex_lock(&pipeline->mutex);
+    while (!job->done)
+    {
+        if (pipeline->next_job == index)
+        {
+            pipeline->next_job += 1U;
+            at_mutex_unlock(&pipeline->mutex);
+            asset_export_job_prepare(job, pipeline->codec);
+            at_mutex_lock(&pipeline->mutex);
+            job->done = true;
+        }
+        else
+        {
+            at_condition_wait(&pipeline->ready, &pipeline->mutex);
+        }
+    }
+    at_mutex_unlock(&pipeline->mutex);
+    return job;
+}
+
+static bool asset_export_write_job(FILE *package, AssetExportJob *job, AssetPackageDirectory *directory,
+                                   AssetExportStats *stats, char *error_buffer, size_t error_capacity)
+{
+    if (!job->payload)
+    {
+        return asset_package_write_entry(package, job->entry_path, job->source_path, directory, stats,
+                                         error_buffer, error_capacity);
+    }
+    AssetPackageDirectoryEntry *encoding = &job->encoding;
+    const AssetPackageDirectoryEntry *stored =
+        asset_package_directory_find(directory, job->source_path, encoding->raw_size, encoding->hash);
+    if (stored)
+    {
+        return asset_package_write_alias(directory, job->entry_path, stored, stats, error_buffer, error_capacity);
+    }
+    if (!asset_package_write_entry_header(package, job->entry_path, encoding) ||
+        fwrite(job->payload, 1U, (size_t)encoding->stored_size, package) != (size_t)encoding->stored_size)
+    {
+        asset_set_error_once(error_buffer, error_capacity, "Failed to write compressed asset into package");
+        return false;
+    }
+    if (!asset_package_directory_add(directory, job->entry_path, job->source_path, encoding))
+    {
+        asset_set_error_once(error_buffer, error_capacity, "Failed to record asset in package directory");
+        return false;
+    }
+    if (stats)
+    {
+        stats->exported_files += 1U;
+        stats->exported_bytes += (size_t)encoding->raw_size;
+        stats->package_bytes += (size_t)encoding->stored_size;
+        stats->compressed_files += encoding->codec != ASSET_PACKAGE_CODEC_NONE ? 1U : 0U;
+    }
+    return true;
+}
+
+/* Compresses on worker_count threads (this one included) while this thread writes finished entries in order. */
+static bool asset_export_write_compressed(FILE *package, AssetExportJob *jobs, size_t job_count,
+                                          AssetPackageCodec codec, size_t worker_count,
+                                          AssetPackageDirectory *directory, AssetExportStats *stats,
+                                          char *error_buffer, size_t error_capacity)
+{
+    AssetExportPipeline pipeline;
+    pipeline.jobs = jobs;
+    pipeline.count = job_count;
+    pipeline.codec = codec;
+    pipeline.next_job = 0U;
+    pipeline.written = 0U;
+    pipeline.window = worker_count * 2U;
+    pipeline.cancelled = false;
+    at_mutex_init(&pipeline.mutex);
+    at_condition_init(&pipeline.ready);
+    at_condition_init(&pipeline.space);
+
+    AtThread *threads = worker_count > 1U ? AT_CALLOC(worker_count - 1U, sizeof(AtThread)) : NULL;
+    size_t started = 0U;
+    if (threads)
+    {
+        while (started < worker_count - 1U && at_thread_start(&threads[started], asset_export_worker, &pipeline))
+        {
+            ++started;
+        }
+    }
+
+    bool write_ok = true;
+    for (size_t index = 0U; write_ok && index < job_count; ++index)
+    {
+        AssetExportJob *job = asset_export_pipeline_next(&pipeline, index);
+        write_ok = asset_export_write_job(package, job, directory, stats, error_buffer, error_capacity);
+        AT_FREE(job->payload);
+        job->payload = NULL;
+        at_mutex_lock(&pipeline.mutex);
+        pipeline.written = index + 1U;
+        pipeline.cancelled = !write_ok;
+        at_condition_broadcast(&pipeline.space);
+        at_mutex_unlock(&pipeline.mutex);
+    }
+
+    for (size_t index = 0U; index < started; ++index)
+    {
+        (void)at_thread_join(&threads[index]);
+    }
+    AT_FREE(threads);
+    at_condition_destroy(&pipeline.space);
+    at_condition_destroy(&pipeline.ready);
+    at_mutex_destroy(&pipeline.mutex);
+    return write_ok;
+}
+
+/* tree.json followed by every reference under "assets/", with normalised entry paths. */
+static bool asset_export_build_jobs(const char *asset_root, const char *tree_json_path,
+                                    const AssetPathList *references, AssetExportJob *jobs, char *error_buffer,
+                                    size_t error_capacity)
+{
+    for (size_t index = 0U; index <= references->count; ++index)
+    {
+        char entry_path[ASSET_PATH_MAX + 32U];
+        char absolute[ASSET_PATH_MAX];
+        if (index == 0U)
+        {
+            (void)snprintf(entry_path, sizeof(entry_path), "tree.json");
+            (void)snprintf(absolute, sizeof(absolute), "%s", tree_json_path);
+        }
+        else
+        {
+            const char *reference = references->items[index - 1U];
+            int written = snprintf(entry_path, sizeof(entry_path), "assets/%s", reference);
+            if (written < 0 || (size_t)written >= sizeof(entry_path))
+            {
+                asset_set_error_once(error_buffer, error_capacity, "Export entry path too long");
+                return false;
+            }
+            if (!asset_join_path(absolute, sizeof(absolute), asset_root, reference))
+            {
+                asset_set_error_once(error_buffer, error_capacity, "Failed to build absolute asset path for export");
+                return false;
+            }
+            asset_normalise_path(absolute);
+        }
+        char normalized_path[ASSET_PATH_MAX + 32U];
+        if (!asset_prepare_relative_path(entry_path, normalized_path, sizeof(normalized_path)) ||
+            normalized_path[0] == '\0')
+        {
+            asset_set_error_once(error_buffer, error_capacity, "Export entry path invalid");
+            return false;
+        }
+        jobs[index].entry_path = at_string_dup(normalized_path);
+        jobs[index].source_path = at_string_dup(absolute);
+        if (!jobs[index].entry_path || !jobs[index].source_path)
+        {
+            asset_set_error_once(error_buffer, error_capacity, "Out of memory preparing export");
+            return false;
+        }
     }
-
-    return success;
+    return true;
 }
 
 bool asset_export(const FamilyTree *tree, const char *asset_root, const char *tree_json_path,
                   const char *package_path, AssetExportStats *stats, char *error_buffer, size_t error_capacity)
+{
+    return asset_export_with_options(tree, asset_root, tree_json_path, package_path, NULL, stats, error_buffer,
+                                     error_capacity);
+}
+
+bool asset_export_with_options(const FamilyTree *tree, const char *asset_root, const char *tree_json_path,
+                               const char *package_path, const AssetExportOptions *options,
+                               AssetExportStats *stats, char *error_buffer, size_t error_capacity)
 {
     AssetExportStats local_stats;
     local_stats.referenced_files = 0U;
     local_stats.exported_files = 0U;
     local_stats.exported_bytes = 0U;
+    local_stats.deduplicated_files = 0U;
+    local_stats.compressed_files = 0U;
+    local_stats.package_bytes = 0U;
+    local_stats.elapsed_seconds = 0.0;
+    local_stats.megabytes_per_second = 0.0;
 
     if (stats)
     {
@@ -1416,6 +2887,13 @@ bool asset_export(const FamilyTree *tree, const char *asset_root, const char *tr
         return false;
     }
 
+    AssetPackageCodec codec = options ? options->codec : ASSET_PACKAGE_CODEC_NONE;
+    size_t worker_count = options ? options->worker_count : 1U;
+    if (worker_count == 0U)
+    {
+        worker_count = at_thread_hardware_concurrency();
+    }
+
     asset_set_error(error_buffer, error_capacity, "");
 
     AssetPathList references;
@@ -1436,7 +2914,8 @@ bool asset_export(const FamilyTree *tree, const char *asset_root, const char *tr
 
     local_stats.referenced_files = references.count;
 
-    if (!asset_verify_references(asset_root, &references, &verification_stats, error_buffer, error_capacity))
+    if (!asset_verify_references(asset_root, &references, worker_count, &verification_stats, error_buffer,
+                                 error_capacity))
     {
         asset_path_list_dispose(&references);
         if (stats)
@@ -1448,9 +2927,20 @@ bool asset_export(const FamilyTree *tree, const char *asset_root, const char *tr
 
     asset_path_list_sort(&references);
 
-    if (!asset_ensure_parent_directories(package_path))
+    size_t job_count = references.count + 1U;
+    AssetExportJob *jobs = AT_CALLOC(job_count, sizeof(AssetExportJob));
+    if (!jobs || !asset_export_build_jobs(asset_root, tree_json_path, &references, jobs, error_buffer,
+                                          error_capacity))
     {
-        asset_set_error_once(error_buffer, error_capacity, "Failed to prepare export directories");
+        if (!jobs)
+        {
+            asset_set_error_once(error_buffer, error_capacity, "Out of memory preparing export");
+        }
+        for (size_t index = 0U; jobs && index < job_count; ++index)
+        {
+            asset_export_job_dispose(&jobs[index]);
+        }
+        AT_FREE(jobs);
         asset_path_list_dispose(&references);
         if (stats)
         {
@@ -1458,20 +2948,32 @@ bool asset_export(const FamilyTree *tree, const char *asset_root, const char *tr
         }
         return false;
     }
+    asset_path_list_dispose(&references);
 
-    FILE *package = NULL;
-#if defined(_WIN32)
-    if (fopen_s(&package, package_path, "wb") != 0)
+    if (!asset_ensure_parent_directories(package_path))
     {
-        package = NULL;
+        asset_set_error_once(error_buffer, error_capacity, "Failed to prepare export directories");
+        for (size_t index = 0U; index < job_count; ++index)
+        {
+            asset_export_job_dispose(&jobs[index]);
+        }
+        AT_FREE(jobs);
+        if (stats)
+        {
+            *stats = local_stats;
+        }
+        return false;
     }
-#else
-    package = fopen(package_path, "wb");
-#endif
+
+    FILE *package = asset_open_file(package_path, "wb");
     if (!package)
     {
         asset_set_error_once(error_buffer, error_capacity, "Unable to open export package for writing");
-        asset_path_list_dispose(&references);
+        for (size_t index = 0U; index < job_count; ++index)
+        {
+            asset_export_job_dispose(&jobs[index]);
+        }
+        AT_FREE(jobs);
         if (stats)
         {
             *stats = local_stats;
@@ -1479,53 +2981,56 @@ bool asset_export(const FamilyTree *tree, const char *asset_root, const char *tr
         return false;
     }
 
+    double start_seconds = at_time_now_seconds();
     bool write_ok = true;
-    const unsigned char magic[5] = {'A', 'T', 'P', 'K', 'G'};
-    if (fwrite(magic, 1U, sizeof(magic), package) != sizeof(magic))
+    AssetPackageDirectory directory = {NULL, 0U, 0U, 0U, NULL, 0U};
+    if (fwrite(g_asset_package_magic, 1U, sizeof(g_asset_package_magic), package) != sizeof(g_asset_package_magic))
     {
         asset_set_error_once(error_buffer, error_capacity, "Failed to write package header");
         write_ok = false;
     }
-    if (write_ok && !asset_write_u32(package, 1U))
+    if (write_ok && !asset_write_u32(package, ASSET_PACKAGE_VERSION))
     {
         asset_set_error_once(error_buffer, error_capacity, "Failed to write package version");
         write_ok = false;
     }
-    uint32_t file_total = (uint32_t)(references.count + 1U);
+    uint32_t file_total = (uint32_t)job_count;
     if (write_ok && !asset_write_u32(package, file_total))
     {
         asset_set_error_once(error_buffer, error_capacity, "Failed to write package manifest");
         write_ok = false;
     }
 
-    if (write_ok)
+    if (write_ok && codec != ASSET_PACKAGE_CODEC_NONE)
     {
-        write_ok = asset_package_write_entry(package, "tree.json", tree_json_path, &local_stats, error_buffer,
-                                             error_capacity);
+        write_ok = asset_export_write_compressed(package, jobs, job_count, codec, worker_count, &directory,
+                                                 &local_stats, error_buffer, error_capacity);
     }
-
-    for (size_t index = 0U; write_ok && index < references.count; ++index)
+    for (size_t index = 0U; write_ok && codec == ASSET_PACKAGE_CODEC_NONE && index < job_count; ++index)
     {
-        char entry_path[ASSET_PATH_MAX + 32U];
-        int written = snprintf(entry_path, sizeof(entry_path), "assets/%s", references.items[index]);
-        if (written < 0 || (size_t)written >= sizeof(entry_path))
-        {
-            asset_set_error_once(error_buffer, error_capacity, "Export entry path too long");
-            write_ok = false;
-            break;
-        }
-
-        char absolute[ASSET_PATH_MAX];
-        if (!asset_join_path(absolute, sizeof(absolute), asset_root, references.items[index]))
-        {
-            asset_set_error_once(error_buffer, error_capacity, "Failed to build absolute asset path for export");
-            write_ok = false;
-            break;
-        }
-        asset_normalise_path(absolute);
+        write_ok = asset_package_write_entry(package, jobs[index].entry_path, jobs[index].source_path, &directory,
+                                             &local_stats, error_buffer, error_capacity);
+    }
+    for (size_t index = 0U; index < job_count; ++index)
+    {
+        asset_export_job_dispose(&jobs[index]);
+    }
+    AT_FREE(jobs);
 
-        write_ok = asset_package_write_entry(package, entry_path, absolute, &local_stats, error_buffer, error_capacity);
+    if (write_ok && !asset_package_write_directory(package, &directory))
+    {
+        asset_set_error_once(error_buffer, error_capacity, "Failed to write package directory");
+        write_ok = false;
+    }
+    /* Duplicates left the entry stream shorter than the header announced. */
+    if (write_ok && directory.stored_count != file_total &&
+        (!asset_file_seek(package, 9, SEEK_SET) || !asset_write_u32(package, (uint32_t)directory.stored_count) ||
+         !asset_file_seek(package, 0, SEEK_END)))
+    {
+        asset_set_error_once(error_buffer, error_capacity, "Failed to write package manifest");
+        write_ok = false;
     }
+    asset_package_directory_dispose(&directory);
 
     if (write_ok && fflush(package) != 0)
     {
@@ -1539,8 +3044,15 @@ bool asset_export(const FamilyTree *tree, const char *asset_root, const char *tr
     {
         (void)asset_remove_file_native(package_path);
     }
-
-    asset_path_list_dispose(&references);
+    else
+    {
+        local_stats.elapsed_seconds = at_time_now_seconds() - start_seconds;
+        if (local_stats.elapsed_seconds > 0.0)
+        {
+            local_stats.megabytes_per_second =
+                (double)local_stats.exported_bytes / (1024.0 * 1024.0) / local_stats.elapsed_seconds;
+        }
+    }
 
     if (stats)
     {
@@ -1549,3 +3061,409 @@ bool asset_export(const FamilyTree *tree, const char *asset_root, const char *tr
 
     return write_ok;
 }
+
+typedef struct AssetPackageRecord
+{
+    const char *path;
+    size_t path_length;
+    uint64_t offset;
+    uint64_t size;
+    uint64_t raw_size;
+    uint32_t checksum;
+    AssetPackageCodec codec;
+} AssetPackageRecord;
+
+struct AssetPackage
+{
+    const unsigned char *base;
+    uint64_t size;
+    AssetPackageRecord *records;
+    size_t record_count;
+    bool has_checksums;
+#if defined(_WIN32)
+    HANDLE file;
+    HANDLE mapping;
+#endif
+};
+
+static uint64_t asset_get_le(const unsigned char *cursor, size_t bytes)
+{
+    uint64_t value = 0U;
+    for (size_t index = 0U; index < bytes; ++index)
+    {
+        value |= (uint64_t)cursor[index] << (index * 8U);
+    }
+    return value;
+}
+
+static int asset_package_compare_path(const char *lhs, size_t lhs_length, const char *rhs, size_t rhs_length)
+{
+    size_t shared = lhs_length < rhs_length ? lhs_length : rhs_length;
+    int order = memcmp(lhs, rhs, shared);
+    if (order != 0)
+    {
+        return order;
+    }
+    return lhs_length < rhs_length ? -1 : (lhs_length > rhs_length ? 1 : 0);
+}
+
+static int asset_package_record_compare(const void *lhs, const void *rhs)
+{
+    const AssetPackageRecord *left = (const AssetPackageRecord *)lhs;
+    const AssetPackageRecord *right = (const AssetPackageRecord *)rhs;
+    return asset_package_compare_path(left->path, left->path_length, right->path, right->path_length);
+}
+
+static void asset_package_sort_records(AssetPackage *package)
+{
+    for (size_t index = 1U; index < package->record_count; ++index)
+    {
+        if (asset_package_record_compare(&package->records[index - 1U], &package->records[index]) > 0)
+        {
+            qsort(package->records, package->record_count, sizeof(AssetPackageRecord),
+                  asset_package_record_compare);
+            return;
+        }
+    }
+}
+
+static bool asset_package_map(AssetPackage *package, const char *package_path)
+{
+#if defined(_WIN32)
+    package->file = CreateFileA(package_path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL, NULL);
+    if (package->file == INVALID_HANDLE_VALUE)
+    {
+        package->file = NULL;
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(package->file, &size) || size.QuadPart <= 0)
+    {
+        return false;
+    }
+    package->mapping = CreateFileMappingA(package->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!package->mapping)
+    {
+        return false;
+    }
+    package->base = (const unsigned char *)MapViewOfFile(package->mapping, FILE_MAP_READ, 0, 0, 0);
+    package->size = (uint64_t)size.QuadPart;
+    return package->base != NULL;
+#else
+    int descriptor = open(package_path, O_RDONLY);
+    if (descriptor < 0)
+    {
+        return false;
+    }
+    struct stat info;
+    if (fstat(descriptor, &info) != 0 || info.st_size <= 0 || (uint64_t)info.st_size > (uint64_t)SIZE_MAX)
+    {
+        close(descriptor);
+        return false;
+    }
+    void *mapping = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    close(descriptor);
+    if (mapping == MAP_FAILED)
+    {
+        return false;
+    }
+    package->base = (const unsigned char *)mapping;
+    package->size = (uint64_t)info.st_size;
+    return true;
+#endif
+}
+
+/* Reads the trailing directory, checking it against the header and the package bounds. */
+static bool asset_package_load_directory(AssetPackage *package, uint32_t version, uint32_t header_count)
+{
+    uint64_t record_size = version >= 4U ? 29U : 20U;
+    if (package->size < ASSET_PACKAGE_HEADER_SIZE + ASSET_PACKAGE_FOOTER_SIZE)
+    {
+        return false;
+    }
+    const unsigned char *footer = package->base + package->size - ASSET_PACKAGE_FOOTER_SIZE;
+    if (memcmp(footer + 16U, g_asset_package_footer_magic, sizeof(g_asset_package_footer_magic)) != 0)
+    {
+        return false;
+    }
+    uint64_t directory_offset = asset_get_le(footer, 8U);
+    uint32_t entry_count = (uint32_t)asset_get_le(footer + 8U, 4U);
+    uint32_t directory_checksum = (uint32_t)asset_get_le(footer + 12U, 4U);
+    uint64_t directory_end = package->size - ASSET_PACKAGE_FOOTER_SIZE;
+    if (entry_count < header_count || directory_offset < ASSET_PACKAGE_HEADER_SIZE ||
+        directory_offset > directory_end ||
+        asset_checksum(package->base + directory_offset, directory_end - directory_offset) != directory_checksum)
+    {
+        return false;
+    }
+    /* Every record takes at least its length prefix and fixed fields, so a forged count cannot size the table. */
+    if ((uint64_t)entry_count > (directory_end - directory_offset) / (2U + record_size))
+    {
+        return false;
+    }
+    package->records = entry_count > 0U ? AT_CALLOC(entry_count, sizeof(AssetPackageRecord)) : NULL;
+    if (entry_count > 0U && !package->records)
+    {
+        return false;
+    }
+    uint64_t cursor = directory_offset;
+    for (uint32_t index = 0U; index < entry_count; ++index)
+    {
+        if (directory_end - cursor < 2U)
+        {
+            return false;
+        }
+        size_t path_length = (size_t)asset_get_le(package->base + cursor, 2U);
+        cursor += 2U;
+        if (directory_end - cursor < (uint64_t)path_length + record_size)
+        {
+            return false;
+        }
+        AssetPackageRecord *record = &package->records[index];
+        record->path = (const char *)(package->base + cursor);
+        record->path_length = path_length;
+        cursor += path_length;
+        const unsigned char *fields = package->base + cursor;
+        record->offset = asset_get_le(fields, 8U);
+        record->size = asset_get_le(fields + 8U, 8U);
+        if (version >= 4U)
+        {
+            record->raw_size = asset_get_le(fields + 16U, 8U);
+            record->codec = (AssetPackageCodec)fields[24];
+            record->checksum = (uint32_t)asset_get_le(fields + 25U, 4U);
+        }
+        else
+        {
+            record->raw_size = record->size;
+            record->codec = ASSET_PACKAGE_CODEC_NONE;
+            record->checksum = (uint32_t)asset_get_le(fields + 16U, 4U);
+        }
+        cursor += record_size;
+        if (record->offset < ASSET_PACKAGE_HEADER_SIZE || record->offset > directory_offset ||
+            record->size > directory_offset - record->offset ||
+            record->codec > ASSET_PACKAGE_CODEC_LZ ||
+            (record->codec == ASSET_PACKAGE_CODEC_NONE && record->raw_size != record->size))
+        {
+            return false;
+        }
+    }
+    if (cursor != directory_end)
+    {
+        return false;
+    }
+    package->record_count = entry_count;
+    package->has_checksums = true;
+    return true;
+}
+
+/* Version 1 packages carry no directory, so walk the entry stream once and index it. */
+static bool asset_package_scan_entries(AssetPackage *package, uint32_t header_count)
+{
+    if ((uint64_t)header_count > (package->size - ASSET_PACKAGE_HEADER_SIZE) / 10U)
+    {
+        return false;
+    }
+    package->records = header_count > 0U ? AT_CALLOC(header_count, sizeof(AssetPackageRecord)) : NULL;
+    if (header_count > 0U && !package->records)
+    {
+        return false;
+    }
+    uint64_t cursor = ASSET_PACKAGE_HEADER_SIZE;
+    for (uint32_t index = 0U; index < header_count; ++index)
+    {
+        if (package->size - cursor < 2U)
+        {
+            return false;
+        }
+        size_t path_length = (size_t)asset_get_le(package->base + cursor, 2U);
+        cursor += 2U;
+        if (package->size - cursor < (uint64_t)path_length + 8U)
+        {
+            return false;
+        }
+        AssetPackageRecord *record = &package->records[index];
+        record->path = (const char *)(package->base + cursor);
+        record->path_length = path_length;
+        cursor += path_length;
+        record->size = asset_get_le(package->base + cursor, 8U);
+        cursor += 8U;
+        if (record->size > package->size - cursor)
+        {
+            return false;
+        }
+        record->offset = cursor;
+        record->raw_size = record->size;
+        record->codec = ASSET_PACKAGE_CODEC_NONE;
+        cursor += record->size;
+    }
+    package->record_count = header_count;
+    package->has_checksums = false;
+    return true;
+}
+
+AssetPackage *asset_package_open(const char *package_path, char *error_buffer, size_t error_capacity)
+{
+    if (!package_path || package_path[0] == '\0')
+    {
+        asset_set_error(error_buffer, error_capacity, "Invalid package path");
+        return NULL;
+    }
+    AssetPackage *package = AT_CALLOC(1U, sizeof(AssetPackage));
+    if (!package)
+    {
+        asset_set_error(error_buffer, error_capacity, "Out of memory opening package");
+        return NULL;
+    }
+    if (!asset_package_map(package, package_path))
+    {
+        asset_set_error(error_buffer, error_capacity, "Unable to map package");
+        asset_package_close(package);
+        return NULL;
+    }
+    if (package->size < ASSET_PACKAGE_HEADER_SIZE ||
+        memcmp(package->base, g_asset_package_magic, sizeof(g_asset_package_magic)) != 0)
+    {
+        asset_set_error(error_buffer, error_capacity, "Not an asset package");
+        asset_package_close(package);
+        return NULL;
+    }
+    uint32_t version = (uint32_t)asset_get_le(package->base + 5U, 4U);
+    uint32_t entry_count = (uint32_t)asset_get_le(package->base + 9U, 4U);
+    bool indexed = false;
+    if (version == 1U)
+    {
+        indexed = asset_package_scan_entries(package, entry_count);
+    }
+    else if (version >= 2U && version <= ASSET_PACKAGE_VERSION)
+    {
+        indexed = asset_package_load_directory(package, version, entry_count);
+    }
+    else
+    {
+        asset_set_error(error_buffer, error_capacity, "Unsupported package version");
+        asset_package_close(package);
+        return NULL;
+    }
+    if (!indexed)
+    {
+        asset_set_error(error_buffer, error_capacity, "Package directory is damaged");
+        asset_package_close(package);
+        return NULL;
+    }
+    asset_package_sort_records(package);
+    asset_set_error(error_buffer, error_capacity, "");
+    return package;
+}
+
+void asset_package_close(AssetPackage *package)
+{
+    if (!package)
+    {
+        return;
+    }
+    AT_FREE(package->records);
+#if defined(_WIN32)
+    if (package->base)
+    {
+        (void)UnmapViewOfFile(package->base);
+    }
+    if (package->mapping)
+    {
+        (void)CloseHandle(package->mapping);
+    }
+    if (package->file)
+    {
+        (void)CloseHandle(package->file);
+    }
+#else
+    if (package->base)
+    {
+        (void)munmap((void *)package->base, (size_t)package->size);
+    }
+#endif
+    AT_FREE(package);
+}
+
+size_t asset_package_entry_count(const AssetPackage *package)
+{
+    return package ? package->record_count : 0U;
+}
+
+bool asset_package_entry_at(const AssetPackage *package, size_t index, AssetPackageEntry *out_entry)
+{
+    if (!package || !out_entry || index >= package->record_count)
+    {
+        return false;
+    }
+    const AssetPackageRecord *record = &package->records[index];
+    out_entry->path = record->path;
+    out_entry->path_length = record->path_length;
+    out_entry->data = package->base + record->offset;
+    out_entry->size = record->size;
+    out_entry->raw_size = record->raw_size;
+    out_entry->codec = record->codec;
+    out_entry->checksum = record->checksum;
+    out_entry->has_checksum = package->has_checksums;
+    return true;
+}
+
+bool asset_package_read_entry(const AssetPackage *package, const char *entry_path, AssetPackageEntry *out_entry)
+{
+    if (!package || !entry_path || !out_entry)
+    {
+        return false;
+    }
+    size_t path_length = strlen(entry_path);
+    size_t low = 0U;
+    size_t high = package->record_count;
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2U;
+        const AssetPackageRecord *record = &package->records[middle];
+        int order = asset_package_compare_path(record->path, record->path_length, entry_path, path_length);
+        if (order == 0)
+        {
+            return asset_package_entry_at(package, middle, out_entry);
+        }
+        if (order < 0)
+        {
+            low = middle + 1U;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return false;
+}
+
+bool asset_package_entry_is_intact(const AssetPackageEntry *entry)
+{
+    if (!entry)
+    {
+        return false;
+    }
+    return !entry->has_checksum || asset_checksum(entry->data, entry->size) == entry->checksum;
+}
+
+bool asset_package_entry_decode(const AssetPackageEntry *entry, unsigned char *buffer, size_t capacity)
+{
+    if (!entry || (!buffer && entry->raw_size > 0U) || entry->raw_size > (uint64_t)capacity)
+    {
+        return false;
+    }
+    if (entry->codec == ASSET_PACKAGE_CODEC_LZ)
+    {
+        return at_decompress(entry->data, (size_t)entry->size, buffer, (size_t)entry->raw_size);
+    }
+    if (entry->codec != ASSET_PACKAGE_CODEC_NONE || entry->size != entry->raw_size)
+    {
+        return false;
+    }
+    if (entry->size > 0U)
+    {
+        memcpy(buffer, entry->data, (size_t)entry->size);
+    }
+    return true;
+}
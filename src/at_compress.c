@@ -0,0 +1,230 @@
+#include "at_compress.h"
+
+#include "at_memory.h"
+
+#include <stdint.h>
+#include <string.h>
+
+/* Block layout: a series of sequences, each a token byte (literal count in the high nibble, match length minus
+ * AT_COMPRESS_MIN_MATCH in the low one; 15 means more length bytes follow, 255 meaning keep adding), the
+ * literals, then a little-endian u16 offset and any extra match-length bytes. The final sequence stops after its
+ * literals. */
+#define AT_COMPRESS_MIN_MATCH 4U
+#define AT_COMPRESS_TAIL 5U /* Trailing bytes always emitted as literals. */
+#define AT_COMPRESS_MAX_OFFSET 65535U
+#define AT_COMPRESS_HASH_BITS 14U
+#define AT_COMPRESS_SKIP_SHIFT 6U /* Probe less often the longer a run goes without a match. */
+
+static uint32_t at_compress_read32(const unsigned char *cursor)
+{
+    uint32_t value;
+    memcpy(&value, cursor, sizeof(value));
+    return value;
+}
+
+static size_t at_compress_hash(uint32_t value)
+{
+    return (size_t)((value * 2654435761U) >> (32U - AT_COMPRESS_HASH_BITS));
+}
+
+static unsigned char *at_compress_put_length(unsigned char *out, const unsigned char *end, size_t length)
+{
+    while (length >= 255U)
+    {
+        if (out >= end)
+        {
+            return NULL;
+        }
+        *out++ = 255U;
+        length -= 255U;
+    }
+    if (out >= end)
+    {
+        return NULL;
+    }
+    *out++ = (unsigned char)length;
+    return out;
+}
+
+/* Writes literals [literal, literal + literal_length) and, when match_length is non-zero, the back reference. */
+static unsigned char *at_compress_put_sequence(unsigned char *out, const unsigned char *end,
+                                               const unsigned char *literal, size_t literal_length, size_t offset,
+                                               size_t match_length)
+{
+    if (out >= end)
+    {
+        return NULL;
+    }
+    size_t match_code = match_length > 0U ? match_length - AT_COMPRESS_MIN_MATCH : 0U;
+    unsigned char *token = out++;
+    *token = (unsigned char)(((literal_length < 15U ? literal_length : 15U) << 4U) |
+                             (match_code < 15U ? match_code : 15U));
+    if (literal_length >= 15U && !(out = at_compress_put_length(out, end, literal_length - 15U)))
+    {
+        return NULL;
+    }
+    if ((size_t)(end - out) < literal_length)
+    {
+        return NULL;
+    }
+    if (literal_length > 0U)
+    {
+        memcpy(out, literal, literal_length);
+        out += literal_length;
+    }
+    if (match_length == 0U)
+    {
+        return out;
+    }
+    if (end - out < 2)
+    {
+        return NULL;
+    }
+    out[0] = (unsigned char)(offset & 0xFFU);
+    out[1] = (unsigned char)(offset >> 8U);
+    out += 2;
+    if (match_code >= 15U && !(out = at_compress_put_length(out, end, match_code - 15U)))
+    {
+        return NULL;
+    }
+    return out;
+}
+
+size_t at_compress_bound(size_t size)
+{
+    return size + size / 255U + 16U;
+}
+
+size_t at_compress(const unsigned char *src, size_t size, unsigned char *dst, size_t capacity)
+{
+    if ((!src && size > 0U) || !dst)
+    {
+        return 0U;
+    }
+    const unsigned char *end = dst + capacity;
+    unsigned char *out = dst;
+    size_t anchor = 0U;
+    if (size > AT_COMPRESS_TAIL + AT_COMPRESS_MIN_MATCH)
+    {
+        /* Positions + 1, so zero marks an empty slot. */
+        uint32_t *table = AT_CALLOC((size_t)1U << AT_COMPRESS_HASH_BITS, sizeof(uint32_t));
+        if (!table)
+        {
+            return 0U;
+        }
+        size_t match_limit = size - AT_COMPRESS_TAIL;
+        size_t position = 0U;
+        while (position + AT_COMPRESS_MIN_MATCH <= match_limit)
+        {
+            uint32_t value = at_compress_read32(src + position);
+            size_t slot = at_compress_hash(value);
+            size_t candidate = table[slot];
+            table[slot] = (uint32_t)(position + 1U);
+            if (candidate == 0U || position - (candidate - 1U) > AT_COMPRESS_MAX_OFFSET ||
+                at_compress_read32(src + candidate - 1U) != value)
+            {
+                position += 1U + ((position - anchor) >> AT_COMPRESS_SKIP_SHIFT);
+                continue;
+            }
+            size_t match = candidate - 1U;
+            size_t length = AT_COMPRESS_MIN_MATCH;
+            while (position + length < match_limit && src[match + length] == src[position + length])
+            {
+                ++length;
+            }
+            out = at_compress_put_sequence(out, end, src + anchor, position - anchor, position - match, length);
+            if (!out)
+            {
+                AT_FREE(table);
+                return 0U;
+            }
+            position += length;
+            anchor = position;
+        }
+        AT_FREE(table);
+    }
+    out = at_compress_put_sequence(out, end, src + anchor, size - anchor, 0U, 0U);
+    return out ? (size_t)(out - dst) : 0U;
+}
+
+static bool at_compress_get_length(const unsigned char **cursor, const unsigned char *end, size_t *length)
+{
+    unsigned char byte;
+    do
+    {
+        if (*cursor >= end)
+        {
+            return false;
+        }
+        byte = *(*cursor)++;
+        if (*length > SIZE_MAX - byte)
+        {
+            return false;
+        }
+        *length += byte;
+    } while (byte == 255U);
+    return true;
+}
+
+bool at_decompress(const unsigned char *src, size_t size, unsigned char *dst, size_t raw_size)
+{
+    if (!src || (!dst && raw_size > 0U))
+    {
+        return false;
+    }
+    const unsigned char *in = src;
+    const unsigned char *in_end = src + size;
+    unsigned char *out = dst;
+    unsigned char *out_end = dst + raw_size;
+    while (in < in_end)
+    {
+        unsigned char token = *in++;
+        size_t literal_length = token >> 4U;
+        if (literal_length == 15U && !at_compress_get_length(&in, in_end, &literal_length))
+        {
+            return false;
+        }
+        if (literal_length > (size_t)(in_end - in) || literal_length > (size_t)(out_end - out))
+        {
+            return false;
+        }
+        memcpy(out, in, literal_length);
+        in += literal_length;
+        out += literal_length;
+        if (in == in_end)
+        {
+            break;
+        }
+        if (in_end - in < 2)
+        {
+            return false;
+        }
+        size_t offset = (size_t)in[0] | ((size_t)in[1] << 8U);
+        in += 2;
+        size_t match_length = token & 0x0FU;
+        if (match_length == 15U && !at_compress_get_length(&in, in_end, &match_length))
+        {
+            return false;
+        }
+        match_length += AT_COMPRESS_MIN_MATCH;
+        if (offset == 0U || offset > (size_t)(out - dst) || match_length > (size_t)(out_end - out))
+        {
+            return false;
+        }
+        const unsigned char *match = out - offset;
+        if (offset >= match_length)
+        {
+            memcpy(out, match, match_length);
+            out += match_length;
+        }
+        else
+        {
+            /* Overlapping copy repeats the last offset bytes, which is how runs are encoded. */
+            for (size_t index = 0U; index < match_length; ++index)
+            {
+                *out++ = match[index];
+            }
+        }
+    }
+    return out == out_end;
+}
@@ -1,26 +1,42 @@
 #include "at_memory.h"
+#include "at_thread.h"
 
 #include <limits.h>
 #include <stdio.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+
+#define AT_MEMORY_NO_SITE SIZE_MAX
 
 typedef struct AtMemoryRecord
 {
-    void *pointer;
+    void *pointer; /* NULL marks an empty slot. */
     size_t size;
     const char *file;
     int line;
     unsigned long long id;
+    size_t site;
 } AtMemoryRecord;
 
 #if AT_MEMORY_ENABLE_TRACKING
+/* Live allocations sit in an open-addressing table keyed by pointer (linear probing, at most half full), so
+ * frees and reallocations stay O(1) no matter how many blocks are outstanding. */
 static AtMemoryRecord *g_records = NULL;
 static size_t g_record_count = 0U;
 static size_t g_record_capacity = 0U;
+/* Call sites are never removed: a dense array for enumeration plus an index table of site + 1 keyed by file:line. */
+static AtMemorySiteStats *g_sites = NULL;
+static size_t g_site_count = 0U;
+static size_t g_site_capacity = 0U;
+static size_t *g_site_slots = NULL;
+static size_t g_site_slot_capacity = 0U;
 static AtMemoryStats g_stats = {0U, 0U, 0U, 0U, 0U};
 static unsigned long long g_next_id = 0ULL;
 static int g_tracking_initialized = 0;
 static int g_suppress_tracking = 0;
+/* Background workers (auto-save, asset jobs) allocate concurrently with the frame thread. */
+static AtMutex g_tracking_lock = AT_MUTEX_INITIALIZER;
 
 static void at_memory_report_leaks_internal(void);
 
@@ -33,83 +49,203 @@ static void at_memory_tracking_initialize(void)
     }
 }
 
-static void at_memory_records_reserve(size_t required)
+static size_t at_memory_mix(unsigned long long value)
+{
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    return (size_t)value;
+}
+
+static size_t at_memory_pointer_home(const void *pointer)
+{
+    return at_memory_mix((unsigned long long)(uintptr_t)pointer) & (g_record_capacity - 1U);
+}
+
+static const char *at_memory_site_file(const char *file)
+{
+    return file ? file : "<unknown>";
+}
+
+static size_t at_memory_site_home(const char *file, int line)
 {
-    if (g_record_capacity >= required)
+    unsigned long long hash = 1469598103934665603ULL;
+    for (const unsigned char *cursor = (const unsigned char *)file; *cursor != '\0'; ++cursor)
     {
-        return;
+        hash ^= *cursor;
+        hash *= 1099511628211ULL;
     }
-    size_t new_capacity = g_record_capacity == 0U ? 32U : g_record_capacity * 2U;
-    while (new_capacity < required)
+    return at_memory_mix(hash ^ (unsigned long long)(unsigned int)line) & (g_site_slot_capacity - 1U);
+}
+
+/* __FILE__ literals are usually shared within a translation unit, so the pointer check settles most lookups. */
+static bool at_memory_site_matches(const AtMemorySiteStats *site, const char *file, int line)
+{
+    return site->line == line && (site->file == file || strcmp(site->file, file) == 0);
+}
+
+static size_t at_memory_site_slot(const char *file, int line)
+{
+    size_t mask = g_site_slot_capacity - 1U;
+    size_t slot = at_memory_site_home(file, line);
+    while (g_site_slots[slot] != 0U && !at_memory_site_matches(&g_sites[g_site_slots[slot] - 1U], file, line))
     {
-        new_capacity *= 2U;
+        slot = (slot + 1U) & mask;
+    }
+    return slot;
+}
+
+static bool at_memory_sites_reserve(void)
+{
+    if (g_site_count < g_site_capacity && (g_site_count + 1U) * 2U <= g_site_slot_capacity)
+    {
+        return true;
     }
+    size_t capacity = g_site_capacity == 0U ? 64U : g_site_capacity * 2U;
     g_suppress_tracking = 1;
-    AtMemoryRecord *records = (AtMemoryRecord *)realloc(g_records, new_capacity * sizeof(AtMemoryRecord));
+    AtMemorySiteStats *sites = (AtMemorySiteStats *)realloc(g_sites, capacity * sizeof(AtMemorySiteStats));
+    size_t *slots = sites ? (size_t *)calloc(capacity * 2U, sizeof(size_t)) : NULL;
     g_suppress_tracking = 0;
-    if (!records)
+    if (sites)
+    {
+        g_sites = sites;
+    }
+    if (!slots)
+    {
+        return false;
+    }
+    free(g_site_slots);
+    g_site_slots = slots;
+    g_site_slot_capacity = capacity * 2U;
+    g_site_capacity = capacity;
+    for (size_t index = 0U; index < g_site_count; ++index)
+    {
+        g_site_slots[at_memory_site_slot(g_sites[index].file, g_sites[index].line)] = index + 1U;
+    }
+    return true;
+}
+
+static size_t at_memory_site_acquire(const char *file, int line)
+{
+    file = at_memory_site_file(file);
+    if (g_site_slot_capacity != 0U)
+    {
+        size_t existing = g_site_slots[at_memory_site_slot(file, line)];
+        if (existing != 0U)
+        {
+            return existing - 1U;
+        }
+    }
+    if (!at_memory_sites_reserve())
+    {
+        return AT_MEMORY_NO_SITE;
+    }
+    size_t index = g_site_count++;
+    AtMemorySiteStats *site = &g_sites[index];
+    memset(site, 0, sizeof(*site));
+    site->file = file;
+    site->line = line;
+    g_site_slots[at_memory_site_slot(file, line)] = index + 1U;
+    return index;
+}
+
+static void at_memory_site_add(size_t index, size_t size)
+{
+    if (index == AT_MEMORY_NO_SITE)
     {
         return;
     }
-    g_records = records;
-    g_record_capacity = new_capacity;
+    AtMemorySiteStats *site = &g_sites[index];
+    site->allocations++;
+    site->total_bytes += size;
+    site->outstanding_allocations++;
+    site->outstanding_bytes += size;
+    if (site->outstanding_bytes > site->peak_bytes)
+    {
+        site->peak_bytes = site->outstanding_bytes;
+    }
 }
 
-static void at_memory_add_record(void *pointer, size_t size, const char *file, int line)
+static void at_memory_site_remove(size_t index, size_t size)
 {
-    if (!pointer)
+    if (index == AT_MEMORY_NO_SITE)
     {
         return;
     }
-    at_memory_records_reserve(g_record_count + 1U);
-    if (g_record_capacity == 0U)
+    AtMemorySiteStats *site = &g_sites[index];
+    site->outstanding_allocations -= 1U;
+    site->outstanding_bytes = site->outstanding_bytes >= size ? site->outstanding_bytes - size : 0U;
+}
+
+/* Returns the slot holding pointer, or the empty slot where it would go. */
+static size_t at_memory_record_slot(const void *pointer)
+{
+    size_t mask = g_record_capacity - 1U;
+    size_t slot = at_memory_pointer_home(pointer);
+    while (g_records[slot].pointer != NULL && g_records[slot].pointer != pointer)
+    {
+        slot = (slot + 1U) & mask;
+    }
+    return slot;
+}
+
+static void at_memory_records_reserve(size_t required)
+{
+    if (required * 2U <= g_record_capacity)
     {
         return;
     }
-    AtMemoryRecord record;
-    record.pointer = pointer;
-    record.size = size;
-    record.file = file;
-    record.line = line;
-    record.id = ++g_next_id;
-    g_records[g_record_count++] = record;
-    g_stats.total_allocations++;
-    g_stats.outstanding_allocations++;
-    g_stats.outstanding_bytes += size;
-    if (g_stats.outstanding_bytes > g_stats.peak_bytes)
+    size_t new_capacity = g_record_capacity == 0U ? 64U : g_record_capacity * 2U;
+    while (required * 2U > new_capacity)
     {
-        g_stats.peak_bytes = g_stats.outstanding_bytes;
+        new_capacity *= 2U;
+    }
+    g_suppress_tracking = 1;
+    AtMemoryRecord *records = (AtMemoryRecord *)calloc(new_capacity, sizeof(AtMemoryRecord));
+    g_suppress_tracking = 0;
+    if (!records)
+    {
+        return;
+    }
+    AtMemoryRecord *old_records = g_records;
+    size_t old_capacity = g_record_capacity;
+    g_records = records;
+    g_record_capacity = new_capacity;
+    for (size_t i = 0U; i < old_capacity; ++i)
+    {
+        if (old_records[i].pointer)
+        {
+            g_records[at_memory_record_slot(old_records[i].pointer)] = old_records[i];
+        }
     }
+    free(old_records);
 }
 
 static AtMemoryRecord *at_memory_find_record(void *pointer, size_t *out_index)
 {
-    if (!pointer)
+    if (!pointer || g_record_count == 0U)
     {
         return NULL;
     }
-    for (size_t i = 0U; i < g_record_count; ++i)
+    size_t slot = at_memory_record_slot(pointer);
+    if (!g_records[slot].pointer)
     {
-        if (g_records[i].pointer == pointer)
-        {
-            if (out_index)
-            {
-                *out_index = i;
-            }
-            return &g_records[i];
-        }
+        return NULL;
+    }
+    if (out_index)
+    {
+        *out_index = slot;
     }
-    return NULL;
+    return &g_records[slot];
 }
 
 static void at_memory_remove_index(size_t index)
 {
-    if (index >= g_record_count)
+    if (index >= g_record_capacity || !g_records[index].pointer)
     {
         return;
     }
     AtMemoryRecord removed = g_records[index];
-    g_records[index] = g_records[g_record_count - 1U];
     g_record_count -= 1U;
     g_stats.outstanding_allocations -= 1U;
     if (g_stats.outstanding_bytes >= removed.size)
@@ -121,6 +257,62 @@ static void at_memory_remove_index(size_t index)
         g_stats.outstanding_bytes = 0U;
     }
     g_stats.total_frees++;
+    at_memory_site_remove(removed.site, removed.size);
+
+    /* Backward-shift deletion: pull later members of the probe run into the hole so lookups never need
+     * tombstones. An entry may move only if its home slot does not lie cyclically in (hole, slot]. */
+    size_t mask = g_record_capacity - 1U;
+    size_t hole = index;
+    size_t slot = (hole + 1U) & mask;
+    while (g_records[slot].pointer)
+    {
+        size_t home = at_memory_pointer_home(g_records[slot].pointer);
+        bool home_between = (hole <= slot) ? (home > hole && home <= slot) : (home > hole || home <= slot);
+        if (!home_between)
+        {
+            g_records[hole] = g_records[slot];
+            hole = slot;
+        }
+        slot = (slot + 1U) & mask;
+    }
+    g_records[hole].pointer = NULL;
+}
+
+static void at_memory_add_record(void *pointer, size_t size, const char *file, int line)
+{
+    if (!pointer)
+    {
+        return;
+    }
+    at_memory_records_reserve(g_record_count + 1U);
+    if (g_record_capacity == 0U || g_record_count + 1U >= g_record_capacity)
+    {
+        return;
+    }
+    size_t slot = at_memory_record_slot(pointer);
+    if (g_records[slot].pointer)
+    {
+        /* The allocator handed out an address we still track, so the block was freed behind our back. */
+        at_memory_remove_index(slot);
+        slot = at_memory_record_slot(pointer);
+    }
+    AtMemoryRecord record;
+    record.pointer = pointer;
+    record.size = size;
+    record.file = file;
+    record.line = line;
+    record.id = ++g_next_id;
+    record.site = at_memory_site_acquire(file, line);
+    at_memory_site_add(record.site, size);
+    g_records[slot] = record;
+    g_record_count++;
+    g_stats.total_allocations++;
+    g_stats.outstanding_allocations++;
+    g_stats.outstanding_bytes += size;
+    if (g_stats.outstanding_bytes > g_stats.peak_bytes)
+    {
+        g_stats.peak_bytes = g_stats.outstanding_bytes;
+    }
 }
 
 static void at_memory_report_leaks_internal(void)
@@ -131,9 +323,13 @@ static void at_memory_report_leaks_internal(void)
     }
     fprintf(stderr, "at_memory: detected %zu leaked allocation(s) totalling %zu bytes\n", g_record_count,
             g_stats.outstanding_bytes);
-    for (size_t i = 0U; i < g_record_count; ++i)
+    for (size_t i = 0U; i < g_record_capacity; ++i)
     {
         const AtMemoryRecord *record = &g_records[i];
+        if (!record->pointer)
+        {
+            continue;
+        }
         const char *file = record->file ? record->file : "<unknown>";
         fprintf(stderr, "  leak #%llu -> ptr=%p size=%zu at %s:%d\n", record->id, record->pointer, record->size, file,
                 record->line);
@@ -183,11 +379,13 @@ void *at_memory_allocate(size_t size, const char *file, int line)
 {
     void *pointer = malloc(size);
 #if AT_MEMORY_ENABLE_TRACKING
+    at_mutex_lock(&g_tracking_lock);
     if (pointer && !g_suppress_tracking)
     {
         at_memory_tracking_initialize();
         at_memory_add_record(pointer, size, file, line);
     }
+    at_mutex_unlock(&g_tracking_lock);
 #else
     (void)file;
     (void)line;
@@ -204,11 +402,13 @@ void *at_memory_callocate(size_t count, size_t size, const char *file, int line)
     }
     void *pointer = calloc(count, size);
 #if AT_MEMORY_ENABLE_TRACKING
+    at_mutex_lock(&g_tracking_lock);
     if (pointer && !g_suppress_tracking)
     {
         at_memory_tracking_initialize();
         at_memory_add_record(pointer, total_size, file, line);
     }
+    at_mutex_unlock(&g_tracking_lock);
 #else
     (void)file;
     (void)line;
@@ -231,6 +431,7 @@ void *at_memory_reallocate(void *ptr, size_t size, const char *file, int line)
 #if AT_MEMORY_ENABLE_TRACKING
     size_t index = 0U;
     AtMemoryRecord *record = NULL;
+    at_mutex_lock(&g_tracking_lock);
     if (!g_suppress_tracking)
     {
         at_memory_tracking_initialize();
@@ -241,6 +442,9 @@ void *at_memory_reallocate(void *ptr, size_t size, const char *file, int line)
     void *result = realloc(ptr, size);
     if (!result)
     {
+#if AT_MEMORY_ENABLE_TRACKING
+        at_mutex_unlock(&g_tracking_lock);
+#endif
         return NULL;
     }
 
@@ -259,9 +463,12 @@ void *at_memory_reallocate(void *ptr, size_t size, const char *file, int line)
                 {
                     g_stats.outstanding_bytes = 0U;
                 }
+                at_memory_site_remove(record->site, record->size);
                 record->size = size;
                 record->file = file;
                 record->line = line;
+                record->site = at_memory_site_acquire(file, line);
+                at_memory_site_add(record->site, size);
                 g_stats.outstanding_bytes += size;
                 if (g_stats.outstanding_bytes > g_stats.peak_bytes)
                 {
@@ -279,6 +486,7 @@ void *at_memory_reallocate(void *ptr, size_t size, const char *file, int line)
             at_memory_add_record(result, size, file, line);
         }
     }
+    at_mutex_unlock(&g_tracking_lock);
 #else
     (void)file;
     (void)line;
@@ -296,6 +504,7 @@ void at_memory_release(void *ptr, const char *file, int line)
 #if AT_MEMORY_ENABLE_TRACKING
     (void)file;
     (void)line;
+    at_mutex_lock(&g_tracking_lock);
     if (!g_suppress_tracking)
     {
         at_memory_tracking_initialize();
@@ -311,6 +520,7 @@ void at_memory_release(void *ptr, const char *file, int line)
                     file ? file : "<unknown>", line);
         }
     }
+    at_mutex_unlock(&g_tracking_lock);
 #else
     (void)file;
     (void)line;
@@ -324,18 +534,32 @@ void at_memory_get_stats(AtMemoryStats *out_stats)
     {
         return;
     }
+#if AT_MEMORY_ENABLE_TRACKING
+    at_mutex_lock(&g_tracking_lock);
     *out_stats = g_stats;
+    at_mutex_unlock(&g_tracking_lock);
+#else
+    *out_stats = g_stats;
+#endif
 }
 
 void at_memory_reset_tracking(void)
 {
 #if AT_MEMORY_ENABLE_TRACKING
+    at_mutex_lock(&g_tracking_lock);
     g_suppress_tracking = 1;
     free(g_records);
+    free(g_sites);
+    free(g_site_slots);
     g_records = NULL;
+    g_sites = NULL;
+    g_site_slots = NULL;
     g_suppress_tracking = 0;
     g_record_count = 0U;
     g_record_capacity = 0U;
+    g_site_count = 0U;
+    g_site_capacity = 0U;
+    g_site_slot_capacity = 0U;
     g_next_id = 0ULL;
 #endif
     g_stats.total_allocations = 0U;
@@ -343,6 +567,9 @@ void at_memory_reset_tracking(void)
     g_stats.outstanding_allocations = 0U;
     g_stats.outstanding_bytes = 0U;
     g_stats.peak_bytes = 0U;
+#if AT_MEMORY_ENABLE_TRACKING
+    at_mutex_unlock(&g_tracking_lock);
+#endif
 }
 
 size_t at_memory_outstanding_allocations(void)
@@ -361,3 +588,49 @@ void at_memory_report_leaks(void)
     at_memory_report_leaks_internal();
 #endif
 }
+
+size_t at_memory_get_site_stats(AtMemorySiteStats *out_sites, size_t capacity)
+{
+#if AT_MEMORY_ENABLE_TRACKING
+    at_mutex_lock(&g_tracking_lock);
+    size_t count = g_site_count;
+    for (size_t index = 0U; out_sites && index < count && index < capacity; ++index)
+    {
+        out_sites[index] = g_sites[index];
+    }
+    at_mutex_unlock(&g_tracking_lock);
+    return count;
+#else
+    (void)out_sites;
+    (void)capacity;
+    return 0U;
+#endif
+}
+
+bool at_memory_find_site_stats(const char *file, int line, AtMemorySiteStats *out_stats)
+{
+    if (!out_stats)
+    {
+        return false;
+    }
+#if AT_MEMORY_ENABLE_TRACKING
+    bool found = false;
+    file = at_memory_site_file(file);
+    at_mutex_lock(&g_tracking_lock);
+    if (g_site_slot_capacity != 0U)
+    {
+        size_t index = g_site_slots[at_memory_site_slot(file, line)];
+        if (index != 0U)
+        {
+            *out_stats = g_sites[index - 1U];
+            found = true;
+        }
+    }
+    at_mutex_unlock(&g_tracking_lock);
+    return found;
+#else
+    (void)file;
+    (void)line;
+    return false;
+#endif
+}
@@ -0,0 +1,286 @@
+#include "at_string_pool.h"
+
+#include "at_memory.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#define AT_STRING_POOL_BLOCK_SIZE (64U * 1024U)
+#define AT_STRING_POOL_GRANULE 16U
+#define AT_STRING_POOL_CLASS_COUNT 32U /* Entries up to 512 bytes come from arena blocks. */
+#define AT_STRING_POOL_INITIAL_BUCKETS 1024U
+
+typedef struct AtStringPoolEntry
+{
+    struct AtStringPoolEntry *next; /* Bucket chain while live, free list once recycled. */
+    size_t length;
+    size_t references;
+    uint32_t hash;
+    uint32_t size_class; /* AT_STRING_POOL_CLASS_COUNT marks an individually allocated entry. */
+    char text[];
+} AtStringPoolEntry;
+
+typedef struct AtStringPoolBlock
+{
+    struct AtStringPoolBlock *next;
+    size_t used;
+    size_t capacity;
+    unsigned char *data;
+} AtStringPoolBlock;
+
+struct AtStringPool
+{
+    AtStringPoolEntry **buckets;
+    size_t bucket_count;
+    AtStringPoolEntry *free_lists[AT_STRING_POOL_CLASS_COUNT];
+    AtStringPoolBlock *blocks;
+    AtStringPoolStats stats;
+    bool discarding;
+};
+
+static uint32_t at_string_pool_hash(const char *value, size_t *out_length)
+{
+    uint32_t hash = 2166136261U;
+    const unsigned char *cursor = (const unsigned char *)value;
+    while (*cursor != '\0')
+    {
+        hash ^= *cursor++;
+        hash *= 16777619U;
+    }
+    *out_length = (size_t)((const char *)cursor - value);
+    return hash;
+}
+
+static size_t at_string_pool_entry_size(size_t length)
+{
+    size_t raw = offsetof(AtStringPoolEntry, text) + length + 1U;
+    return (raw + AT_STRING_POOL_GRANULE - 1U) / AT_STRING_POOL_GRANULE * AT_STRING_POOL_GRANULE;
+}
+
+static AtStringPoolEntry *at_string_pool_entry_from_text(const char *text)
+{
+    return (AtStringPoolEntry *)(void *)(text - offsetof(AtStringPoolEntry, text));
+}
+
+static bool at_string_pool_grow_buckets(AtStringPool *pool)
+{
+    size_t new_count = pool->bucket_count * 2U;
+    AtStringPoolEntry **buckets = AT_CALLOC(new_count, sizeof(AtStringPoolEntry *));
+    if (!buckets)
+    {
+        return false;
+    }
+    for (size_t index = 0U; index < pool->bucket_count; ++index)
+    {
+        AtStringPoolEntry *entry = pool->buckets[index];
+        while (entry)
+        {
+            AtStringPoolEntry *next = entry->next;
+            size_t slot = entry->hash & (new_count - 1U);
+            entry->next = buckets[slot];
+            buckets[slot] = entry;
+            entry = next;
+        }
+    }
+    AT_FREE(pool->buckets);
+    pool->buckets = buckets;
+    pool->bucket_count = new_count;
+    return true;
+}
+
+static AtStringPoolEntry *at_string_pool_allocate_entry(AtStringPool *pool, size_t entry_size)
+{
+    size_t size_class = entry_size / AT_STRING_POOL_GRANULE - 1U;
+    if (size_class >= AT_STRING_POOL_CLASS_COUNT)
+    {
+        AtStringPoolEntry *entry = AT_MALLOC(entry_size);
+        if (entry)
+        {
+            entry->size_class = AT_STRING_POOL_CLASS_COUNT;
+            pool->stats.arena_bytes += entry_size;
+        }
+        return entry;
+    }
+    AtStringPoolEntry *recycled = pool->free_lists[size_class];
+    if (recycled)
+    {
+        pool->free_lists[size_class] = recycled->next;
+        return recycled;
+    }
+    AtStringPoolBlock *block = pool->blocks;
+    if (!block || block->capacity - block->used < entry_size)
+    {
+        block = AT_MALLOC(sizeof(AtStringPoolBlock));
+        if (!block)
+        {
+            return NULL;
+        }
+        block->data = AT_MALLOC(AT_STRING_POOL_BLOCK_SIZE);
+        if (!block->data)
+        {
+            AT_FREE(block);
+            return NULL;
+        }
+        block->capacity = AT_STRING_POOL_BLOCK_SIZE;
+        block->used = 0U;
+        block->next = pool->blocks;
+        pool->blocks = block;
+        pool->stats.arena_bytes += AT_STRING_POOL_BLOCK_SIZE;
+    }
+    AtStringPoolEntry *entry = (AtStringPoolEntry *)(void *)(block->data + block->used);
+    block->used += entry_size;
+    entry->size_class = (uint32_t)size_class;
+    return entry;
+}
+
+AtStringPool *at_string_pool_create(void)
+{
+    AtStringPool *pool = AT_CALLOC(1U, sizeof(AtStringPool));
+    if (!pool)
+    {
+        return NULL;
+    }
+    pool->buckets = AT_CALLOC(AT_STRING_POOL_INITIAL_BUCKETS, sizeof(AtStringPoolEntry *));
+    if (!pool->buckets)
+    {
+        AT_FREE(pool);
+        return NULL;
+    }
+    pool->bucket_count = AT_STRING_POOL_INITIAL_BUCKETS;
+    return pool;
+}
+
+void at_string_pool_destroy(AtStringPool *pool)
+{
+    if (!pool)
+    {
+        return;
+    }
+    /* Oversized entries are individual allocations; arena entries vanish with their blocks. */
+    for (size_t index = 0U; index < pool->bucket_count; ++index)
+    {
+        AtStringPoolEntry *entry = pool->buckets[index];
+        while (entry)
+        {
+            AtStringPoolEntry *next = entry->next;
+            if (entry->size_class == AT_STRING_POOL_CLASS_COUNT)
+            {
+                AT_FREE(entry);
+            }
+            entry = next;
+        }
+    }
+    AtStringPoolBlock *block = pool->blocks;
+    while (block)
+    {
+        AtStringPoolBlock *next = block->next;
+        AT_FREE(block->data);
+        AT_FREE(block);
+        block = next;
+    }
+    AT_FREE(pool->buckets);
+    AT_FREE(pool);
+}
+
+const char *at_string_pool_intern(AtStringPool *pool, const char *value)
+{
+    if (!pool || !value)
+    {
+        return NULL;
+    }
+    size_t length = 0U;
+    uint32_t hash = at_string_pool_hash(value, &length);
+    size_t slot = hash & (pool->bucket_count - 1U);
+    for (AtStringPoolEntry *entry = pool->buckets[slot]; entry; entry = entry->next)
+    {
+        if (entry->hash == hash && entry->length == length && memcmp(entry->text, value, length) == 0)
+        {
+            entry->references++;
+            pool->stats.references++;
+            pool->stats.bytes_requested += length + 1U;
+            return entry->text;
+        }
+    }
+    if (pool->stats.unique_strings + 1U > pool->bucket_count / 4U * 3U && at_string_pool_grow_buckets(pool))
+    {
+        slot = hash & (pool->bucket_count - 1U);
+    }
+    AtStringPoolEntry *entry = at_string_pool_allocate_entry(pool, at_string_pool_entry_size(length));
+    if (!entry)
+    {
+        return NULL;
+    }
+    entry->length = length;
+    entry->references = 1U;
+    entry->hash = hash;
+    memcpy(entry->text, value, length + 1U);
+    entry->next = pool->buckets[slot];
+    pool->buckets[slot] = entry;
+    pool->stats.unique_strings++;
+    pool->stats.references++;
+    pool->stats.bytes_stored += length + 1U;
+    pool->stats.bytes_requested += length + 1U;
+    return entry->text;
+}
+
+void at_string_pool_release(AtStringPool *pool, const char *value)
+{
+    if (!pool || !value || pool->discarding)
+    {
+        return;
+    }
+    AtStringPoolEntry *entry = at_string_pool_entry_from_text(value);
+    if (entry->references == 0U)
+    {
+        return;
+    }
+    entry->references--;
+    pool->stats.references--;
+    pool->stats.bytes_requested -= entry->length + 1U;
+    if (entry->references > 0U)
+    {
+        return;
+    }
+    AtStringPoolEntry **link = &pool->buckets[entry->hash & (pool->bucket_count - 1U)];
+    while (*link && *link != entry)
+    {
+        link = &(*link)->next;
+    }
+    if (*link)
+    {
+        *link = entry->next;
+    }
+    pool->stats.unique_strings--;
+    pool->stats.bytes_stored -= entry->length + 1U;
+    if (entry->size_class == AT_STRING_POOL_CLASS_COUNT)
+    {
+        pool->stats.arena_bytes -= at_string_pool_entry_size(entry->length);
+        AT_FREE(entry);
+        return;
+    }
+    entry->next = pool->free_lists[entry->size_class];
+    pool->free_lists[entry->size_class] = entry;
+}
+
+void at_string_pool_discard(AtStringPool *pool)
+{
+    if (pool)
+    {
+        pool->discarding = true;
+    }
+}
+
+void at_string_pool_get_stats(const AtStringPool *pool, AtStringPoolStats *out_stats)
+{
+    if (!out_stats)
+    {
+        return;
+    }
+    if (!pool)
+    {
+        memset(out_stats, 0, sizeof(*out_stats));
+        return;
+    }
+    *out_stats = pool->stats;
+    out_stats->bytes_saved = pool->stats.bytes_requested - pool->stats.bytes_stored;
+}
@@ -0,0 +1,202 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "at_thread.h"
+
+#include <stddef.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+static DWORD WINAPI at_thread_trampoline(LPVOID parameter)
+{
+    AtThread *thread = (AtThread *)parameter;
+    thread->function(thread->user_data);
+    return 0U;
+}
+#else
+static void *at_thread_trampoline(void *parameter)
+{
+    AtThread *thread = (AtThread *)parameter;
+    thread->function(thread->user_data);
+    return NULL;
+}
+#endif
+
+bool at_thread_start(AtThread *thread, AtThreadFunction function, void *user_data)
+{
+    if (!thread || !function || thread->started)
+    {
+        return false;
+    }
+    thread->function = function;
+    thread->user_data = user_data;
+#if defined(_WIN32)
+    HANDLE handle = CreateThread(NULL, 0U, at_thread_trampoline, thread, 0U, NULL);
+    if (!handle)
+    {
+        return false;
+    }
+    thread->handle = handle;
+#else
+    if (pthread_create(&thread->handle, NULL, at_thread_trampoline, thread) != 0)
+    {
+        return false;
+    }
+#endif
+    thread->started = true;
+    return true;
+}
+
+bool at_thread_join(AtThread *thread)
+{
+    if (!thread || !thread->started)
+    {
+        return false;
+    }
+#if defined(_WIN32)
+    HANDLE handle = (HANDLE)thread->handle;
+    bool joined = WaitForSingleObject(handle, INFINITE) == WAIT_OBJECT_0;
+    CloseHandle(handle);
+    thread->handle = NULL;
+#else
+    bool joined = pthread_join(thread->handle, NULL) == 0;
+#endif
+    thread->started = false;
+    return joined;
+}
+
+bool at_thread_is_started(const AtThread *thread)
+{
+    return thread && thread->started;
+}
+
+size_t at_thread_hardware_concurrency(void)
+{
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0U ? (size_t)info.dwNumberOfProcessors : 1U;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0L ? (size_t)count : 1U;
+#endif
+}
+
+void at_mutex_init(AtMutex *mutex)
+{
+    if (!mutex)
+    {
+        return;
+    }
+#if defined(_WIN32)
+    InitializeSRWLock((PSRWLOCK)&mutex->native);
+#else
+    (void)pthread_mutex_init(&mutex->native, NULL);
+#endif
+}
+
+void at_mutex_destroy(AtMutex *mutex)
+{
+    if (!mutex)
+    {
+        return;
+    }
+#if !defined(_WIN32)
+    (void)pthread_mutex_destroy(&mutex->native);
+#endif
+}
+
+void at_mutex_lock(AtMutex *mutex)
+{
+    if (!mutex)
+    {
+        return;
+    }
+#if defined(_WIN32)
+    AcquireSRWLockExclusive((PSRWLOCK)&mutex->native);
+#else
+    (void)pthread_mutex_lock(&mutex->native);
+#endif
+}
+
+void at_mutex_unlock(AtMutex *mutex)
+{
+    if (!mutex)
+    {
+        return;
+    }
+#if defined(_WIN32)
+    ReleaseSRWLockExclusive((PSRWLOCK)&mutex->native);
+#else
+    (void)pthread_mutex_unlock(&mutex->native);
+#endif
+}
+
+void at_condition_init(AtCondition *condition)
+{
+    if (!condition)
+    {
+        return;
+    }
+#if defined(_WIN32)
+    InitializeConditionVariable((PCONDITION_VARIABLE)&condition->native);
+#else
+    (void)pthread_cond_init(&condition->native, NULL);
+#endif
+}
+
+void at_condition_destroy(AtCondition *condition)
+{
+    if (!condition)
+    {
+        return;
+    }
+#if !defined(_WIN32)
+    (void)pthread_cond_destroy(&condition->native);
+#endif
+}
+
+void at_condition_wait(AtCondition *condition, AtMutex *mutex)
+{
+    if (!condition || !mutex)
+    {
+        return;
+    }
+#if defined(_WIN32)
+    (void)SleepConditionVariableSRW((PCONDITION_VARIABLE)&condition->native, (PSRWLOCK)&mutex->native, INFINITE, 0U);
+#else
+    (void)pthread_cond_wait(&condition->native, &mutex->native);
+#endif
+}
+
+void at_condition_signal(AtCondition *condition)
+{
+    if (!condition)
+    {
+        return;
+    }
+#if defined(_WIN32)
+    WakeConditionVariable((PCONDITION_VARIABLE)&condition->native);
+#else
+    (void)pthread_cond_signal(&condition->native);
+#endif
+}
+
+void at_condition_broadcast(AtCondition *condition)
+{
+    if (!condition)
+    {
+        return;
+    }
+#if defined(_WIN32)
+    WakeAllConditionVariable((PCONDITION_VARIABLE)&condition->native);
+#else
+    (void)pthread_cond_broadcast(&condition->native);
+#endif
+}
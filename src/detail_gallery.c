@@ -3,6 +3,7 @@
 #include "at_memory.h"
 #include "at_string.h"
 #include "person.h"
+#include "thumbnail_cache.h"
 #include "timeline.h"
 
 #include <stdio.h>
@@ -11,6 +12,7 @@
 #define DETAIL_GALLERY_MIN_ZOOM 0.35f
 #define DETAIL_GALLERY_MAX_ZOOM 3.0f
 #define DETAIL_GALLERY_DEFAULT_ZOOM 1.0f
+#define DETAIL_GALLERY_FULL_RES_ZOOM 1.5f
 
 static bool detail_gallery_ensure_capacity(DetailGallery *gallery, size_t capacity)
 {
@@ -40,6 +42,11 @@ static bool detail_gallery_ensure_capacity(DetailGallery *gallery, size_t capaci
 #if defined(ANCESTRYTREE_HAVE_RAYLIB)
         entries[index].texture_loaded = false;
         entries[index].texture.id = 0;
+        entries[index].thumbnail_loaded = false;
+        entries[index].thumbnail.id = 0;
+        entries[index].texture_handle = 0U;
+        entries[index].thumbnail_handle = 0U;
+        entries[index].texture_over_budget = false;
 #endif
     }
     gallery->entries = entries;
@@ -60,6 +67,12 @@ static void detail_gallery_entry_reset(DetailGalleryEntry *entry)
         entry->texture_loaded = false;
         entry->texture.id = 0;
     }
+    if (entry->thumbnail_loaded)
+    {
+        UnloadTexture(entry->thumbnail);
+        entry->thumbnail_loaded = false;
+        entry->thumbnail.id = 0;
+    }
 #endif
     AT_FREE(entry->path);
     entry->path = NULL;
@@ -67,21 +80,74 @@ static void detail_gallery_entry_reset(DetailGalleryEntry *entry)
 }
 
 #if defined(ANCESTRYTREE_HAVE_RAYLIB)
+/* Residency slots encode the entry index and which of its two textures is meant. */
+#define DETAIL_GALLERY_RESIDENCY_SLOT(index, thumbnail) ((index) * 2U + ((thumbnail) ? 1U : 0U))
+
+static void detail_gallery_unload_full(DetailGallery *gallery, DetailGalleryEntry *entry)
+{
+    if (entry->texture_loaded)
+    {
+        texture_residency_release(gallery->residency, entry->texture_handle);
+        UnloadTexture(entry->texture);
+        entry->texture_loaded = false;
+        entry->texture.id = 0;
+    }
+    entry->texture_handle = 0U;
+    entry->texture_over_budget = false;
+}
+
+static void detail_gallery_unload_thumbnail(DetailGallery *gallery, DetailGalleryEntry *entry)
+{
+    if (entry->thumbnail_loaded)
+    {
+        texture_residency_release(gallery->residency, entry->thumbnail_handle);
+        UnloadTexture(entry->thumbnail);
+        entry->thumbnail_loaded = false;
+        entry->thumbnail.id = 0;
+    }
+    entry->thumbnail_handle = 0U;
+}
+
+/* The manager has already forgotten the handle, so clearing it first turns the release above into a no-op. */
+static void detail_gallery_evict_texture(void *owner, size_t slot)
+{
+    DetailGallery *gallery = (DetailGallery *)owner;
+    size_t index = slot / 2U;
+    if (!gallery || index >= gallery->count)
+    {
+        return;
+    }
+    DetailGalleryEntry *entry = &gallery->entries[index];
+    if ((slot % 2U) != 0U)
+    {
+        entry->thumbnail_handle = 0U;
+        detail_gallery_unload_thumbnail(gallery, entry);
+    }
+    else
+    {
+        entry->texture_handle = 0U;
+        detail_gallery_unload_full(gallery, entry);
+    }
+}
+
+static void detail_gallery_release_full_textures(DetailGallery *gallery)
+{
+    for (size_t index = 0U; index < gallery->count; ++index)
+    {
+        detail_gallery_unload_full(gallery, &gallery->entries[index]);
+    }
+}
+
 void detail_gallery_release_textures(DetailGallery *gallery)
 {
     if (!gallery)
     {
         return;
     }
+    detail_gallery_release_full_textures(gallery);
     for (size_t index = 0U; index < gallery->count; ++index)
     {
-        DetailGalleryEntry *entry = &gallery->entries[index];
-        if (entry->texture_loaded)
-        {
-            UnloadTexture(entry->texture);
-            entry->texture_loaded = false;
-            entry->texture.id = 0;
-        }
+        detail_gallery_unload_thumbnail(gallery, &gallery->entries[index]);
     }
 }
 #endif
@@ -102,6 +168,7 @@ void detail_gallery_reset(DetailGallery *gallery)
     gallery->count = 0U;
     gallery->selected_index = -1;
     gallery->zoom = DETAIL_GALLERY_DEFAULT_ZOOM;
+    gallery->full_resolution = false;
 }
 
 bool detail_gallery_init(DetailGallery *gallery)
@@ -128,12 +195,18 @@ void detail_gallery_shutdown(DetailGallery *gallery)
     gallery->capacity = 0U;
 }
 
-static bool detail_gallery_path_exists(const char *path)
+static bool detail_gallery_path_exists(const DetailGallery *gallery, const char *path)
 {
     if (!path || path[0] == '\0')
     {
         return false;
     }
+    /* A decoded thumbnail or prefetch proves the file is there; anything else, failures included, is checked here. */
+    bool exists = false;
+    if (gallery->thumbnails && thumbnail_cache_lookup_exists(gallery->thumbnails, path, &exists))
+    {
+        return exists;
+    }
     FILE *file = fopen(path, "rb");
     if (file)
     {
@@ -180,10 +253,15 @@ static bool detail_gallery_add_path(DetailGallery *gallery, const char *path)
     }
     DetailGalleryEntry *entry = &gallery->entries[gallery->count];
     entry->path = copy;
-    entry->file_available = detail_gallery_path_exists(path);
+    entry->file_available = detail_gallery_path_exists(gallery, path);
 #if defined(ANCESTRYTREE_HAVE_RAYLIB)
     entry->texture_loaded = false;
     entry->texture.id = 0;
+    entry->thumbnail_loaded = false;
+    entry->thumbnail.id = 0;
+    entry->texture_handle = 0U;
+    entry->thumbnail_handle = 0U;
+    entry->texture_over_budget = false;
 #endif
     gallery->count += 1U;
     if (gallery->selected_index < 0)
@@ -193,15 +271,15 @@ static bool detail_gallery_add_path(DetailGallery *gallery, const char *path)
     return true;
 }
 
-static bool detail_gallery_collect_person_media(DetailGallery *gallery, const Person *person)
+bool detail_gallery_visit_person_media(const Person *person, DetailGalleryMediaVisitor visitor, void *user_data)
 {
-    if (!gallery || !person)
+    if (!person || !visitor)
     {
         return false;
     }
     if (person->profile_image_path && person->profile_image_path[0] != '\0')
     {
-        if (!detail_gallery_add_path(gallery, person->profile_image_path))
+        if (!visitor(person->profile_image_path, user_data))
         {
             return false;
         }
@@ -211,7 +289,7 @@ static bool detail_gallery_collect_person_media(DetailGallery *gallery, const Pe
         const char *path = person->certificate_paths[cert];
         if (path && path[0] != '\0')
         {
-            if (!detail_gallery_add_path(gallery, path))
+            if (!visitor(path, user_data))
             {
                 return false;
             }
@@ -225,7 +303,7 @@ static bool detail_gallery_collect_person_media(DetailGallery *gallery, const Pe
             const char *path = entry->media_paths[media_index];
             if (path && path[0] != '\0')
             {
-                if (!detail_gallery_add_path(gallery, path))
+                if (!visitor(path, user_data))
                 {
                     return false;
                 }
@@ -235,6 +313,11 @@ static bool detail_gallery_collect_person_media(DetailGallery *gallery, const Pe
     return true;
 }
 
+static bool detail_gallery_add_visited_path(const char *path, void *user_data)
+{
+    return detail_gallery_add_path((DetailGallery *)user_data, path);
+}
+
 bool detail_gallery_populate_from_person(DetailGallery *gallery, const Person *person)
 {
     if (!gallery)
@@ -246,7 +329,7 @@ bool detail_gallery_populate_from_person(DetailGallery *gallery, const Person *p
     {
         return true;
     }
-    if (!detail_gallery_collect_person_media(gallery, person))
+    if (!detail_gallery_visit_person_media(person, detail_gallery_add_visited_path, gallery))
     {
         detail_gallery_reset(gallery);
         return false;
@@ -341,6 +424,15 @@ void detail_gallery_set_zoom(DetailGallery *gallery, float zoom)
         return;
     }
     gallery->zoom = detail_gallery_clamp_zoom(zoom);
+    bool full_resolution = gallery->zoom >= DETAIL_GALLERY_FULL_RES_ZOOM;
+#if defined(ANCESTRYTREE_HAVE_RAYLIB)
+    if (gallery->full_resolution && !full_resolution)
+    {
+        /* Thumbnails stay resident, so zooming back out costs nothing but the full-size uploads it frees. */
+        detail_gallery_release_full_textures(gallery);
+    }
+#endif
+    gallery->full_resolution = full_resolution;
 }
 
 float detail_gallery_min_zoom(void)
@@ -353,7 +445,80 @@ float detail_gallery_max_zoom(void)
     return DETAIL_GALLERY_MAX_ZOOM;
 }
 
+float detail_gallery_full_resolution_zoom(void)
+{
+    return DETAIL_GALLERY_FULL_RES_ZOOM;
+}
+
+bool detail_gallery_uses_full_resolution(const DetailGallery *gallery)
+{
+    return gallery ? (gallery->full_resolution || !gallery->thumbnails) : false;
+}
+
+void detail_gallery_set_thumbnail_cache(DetailGallery *gallery, struct ThumbnailCache *cache)
+{
+    if (gallery)
+    {
+        gallery->thumbnails = cache;
+    }
+}
+
+void detail_gallery_set_texture_residency(DetailGallery *gallery, TextureResidency *residency)
+{
+    if (!gallery)
+    {
+        return;
+    }
 #if defined(ANCESTRYTREE_HAVE_RAYLIB)
+    /* Textures tracked by the previous manager must not outlive its handles. */
+    detail_gallery_release_textures(gallery);
+#endif
+    gallery->residency = residency;
+}
+
+#if defined(ANCESTRYTREE_HAVE_RAYLIB)
+static unsigned int detail_gallery_acquire_thumbnail(DetailGallery *gallery, size_t index)
+{
+    DetailGalleryEntry *entry = &gallery->entries[index];
+    if (entry->thumbnail_loaded)
+    {
+        texture_residency_touch(gallery->residency, entry->thumbnail_handle);
+        return entry->thumbnail.id;
+    }
+    ThumbnailImage image = {NULL, 0, 0};
+    ThumbnailStatus status = thumbnail_cache_fetch(gallery->thumbnails, entry->path, &image);
+    if (status == THUMBNAIL_STATUS_PENDING)
+    {
+        return 0U;
+    }
+    Texture2D texture = {0};
+    size_t bytes = 0U;
+    if (status == THUMBNAIL_STATUS_READY)
+    {
+        bytes = texture_residency_estimate_bytes(image.width, image.height, false);
+        if (!texture_residency_reserve(gallery->residency, bytes))
+        {
+            /* Everything resident was drawn this frame; the disk cache serves the retry next frame. */
+            thumbnail_image_reset(&image);
+            return 0U;
+        }
+        Image pixels = {image.pixels, image.width, image.height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+        texture = LoadTextureFromImage(pixels);
+        thumbnail_image_reset(&image);
+    }
+    if (texture.id == 0U)
+    {
+        entry->file_available = false;
+        return 0U;
+    }
+    entry->thumbnail = texture;
+    entry->thumbnail_loaded = true;
+    entry->thumbnail_handle =
+        texture_residency_track(gallery->residency, TEXTURE_RESIDENCY_GALLERY, bytes, detail_gallery_evict_texture,
+                                gallery, DETAIL_GALLERY_RESIDENCY_SLOT(index, true));
+    return texture.id;
+}
+
 unsigned int detail_gallery_acquire_texture(DetailGallery *gallery, size_t index)
 {
     if (!gallery || index >= gallery->count)
@@ -365,17 +530,45 @@ unsigned int detail_gallery_acquire_texture(DetailGallery *gallery, size_t index
     {
         return 0U;
     }
-    if (!entry->texture_loaded)
+    if (!detail_gallery_uses_full_resolution(gallery))
     {
-        Texture2D texture = LoadTexture(entry->path);
-        if (texture.id == 0U)
-        {
-            entry->file_available = false;
-            return 0U;
-        }
-        entry->texture = texture;
-        entry->texture_loaded = true;
+        return detail_gallery_acquire_thumbnail(gallery, index);
+    }
+    if (entry->texture_loaded)
+    {
+        texture_residency_touch(gallery->residency, entry->texture_handle);
+        return entry->texture.id;
+    }
+    if (entry->texture_over_budget)
+    {
+        return gallery->thumbnails ? detail_gallery_acquire_thumbnail(gallery, index) : 0U;
+    }
+    Image image = LoadImage(entry->path);
+    if (image.data == NULL)
+    {
+        entry->file_available = false;
+        return 0U;
+    }
+    size_t bytes = texture_residency_estimate_bytes(image.width, image.height, false);
+    if (!texture_residency_reserve(gallery->residency, bytes))
+    {
+        /* Over budget: keep showing the thumbnail rather than evicting what is on screen. */
+        UnloadImage(image);
+        entry->texture_over_budget = true;
+        return gallery->thumbnails ? detail_gallery_acquire_thumbnail(gallery, index) : 0U;
+    }
+    Texture2D texture = LoadTextureFromImage(image);
+    UnloadImage(image);
+    if (texture.id == 0U)
+    {
+        entry->file_available = false;
+        return 0U;
     }
-    return entry->texture.id;
+    entry->texture = texture;
+    entry->texture_loaded = true;
+    entry->texture_handle = texture_residency_track(gallery->residency, TEXTURE_RESIDENCY_GALLERY, bytes,
+                                                    detail_gallery_evict_texture, gallery,
+                                                    DETAIL_GALLERY_RESIDENCY_SLOT(index, false));
+    return texture.id;
 }
 #endif
@@ -0,0 +1,72 @@
+#include "detail_prefetch.h"
+
+#include "detail_gallery.h"
+#include "person.h"
+#include "thumbnail_cache.h"
+
+typedef struct DetailPrefetchWalk
+{
+    struct ThumbnailCache *thumbnails;
+    size_t queued;
+} DetailPrefetchWalk;
+
+static bool detail_prefetch_visit(const char *path, void *user_data)
+{
+    DetailPrefetchWalk *walk = (DetailPrefetchWalk *)user_data;
+    if (thumbnail_cache_prefetch(walk->thumbnails, path))
+    {
+        walk->queued += 1U;
+    }
+    return true;
+}
+
+static void detail_prefetch_person(DetailPrefetchWalk *walk, const Person *person)
+{
+    if (person)
+    {
+        (void)detail_gallery_visit_person_media(person, detail_prefetch_visit, walk);
+    }
+}
+
+void detail_prefetch_init(DetailPrefetch *prefetch, struct ThumbnailCache *thumbnails)
+{
+    if (!prefetch)
+    {
+        return;
+    }
+    prefetch->thumbnails = thumbnails;
+    prefetch->focus_id = 0U;
+    prefetch->has_focus = false;
+}
+
+size_t detail_prefetch_focus(DetailPrefetch *prefetch, const Person *person)
+{
+    if (!prefetch || !prefetch->thumbnails || !person)
+    {
+        return 0U;
+    }
+    if (prefetch->has_focus && prefetch->focus_id == person->id)
+    {
+        return 0U;
+    }
+    prefetch->focus_id = person->id;
+    prefetch->has_focus = true;
+    thumbnail_cache_cancel_prefetch(prefetch->thumbnails);
+
+    /* Queue order is decode order: the person itself first, then the closest relatives. */
+    DetailPrefetchWalk walk = {prefetch->thumbnails, 0U};
+    detail_prefetch_person(&walk, person);
+    for (size_t index = 0U; index < 2U; ++index)
+    {
+        detail_prefetch_person(&walk, person->parents[index]);
+    }
+    for (size_t index = 0U; index < person->spouses_count; ++index)
+    {
+        detail_prefetch_person(&walk, person->spouses[index].partner);
+    }
+    for (size_t index = 0U; index < person->children_count; ++index)
+    {
+        detail_prefetch_person(&walk, person->children[index]);
+    }
+    return walk.queued;
+}
@@ -1,6 +1,7 @@
 #include "detail_view.h"
 
 #include "person.h"
+#include "thumbnail_cache.h"
 #include "timeline.h"
 
 #include <math.h>
@@ -19,6 +20,7 @@
 #define DETAIL_VIEW_CERTIFICATE_COLS 3
 #define DETAIL_VIEW_MIN_PANEL_WIDTH 480.0f
 #define DETAIL_VIEW_MIN_PANEL_HEIGHT 460.0f
+#define DETAIL_VIEW_THUMBNAIL_DIRECTORY "assets/.thumbnails"
 
 static void detail_view_unload_profile(DetailViewState *state)
 {
@@ -29,10 +31,12 @@ static void detail_view_unload_profile(DetailViewState *state)
     }
     if (state->profile_texture_loaded)
     {
+        texture_residency_release(state->residency, state->profile_handle);
         UnloadTexture(state->profile_texture);
         state->profile_texture_loaded = false;
         state->profile_texture.id = 0;
     }
+    state->profile_handle = 0U;
 #else
     (void)state;
 #endif
@@ -47,16 +51,43 @@ static void detail_view_unload_certificate(DetailViewState *state)
     }
     if (state->certificate_preview_loaded)
     {
+        texture_residency_release(state->residency, state->certificate_preview_handle);
         UnloadTexture(state->certificate_preview_texture);
         state->certificate_preview_loaded = false;
         state->certificate_preview_texture.id = 0;
         state->certificate_preview_path[0] = '\0';
     }
+    state->certificate_preview_handle = 0U;
 #else
     (void)state;
 #endif
 }
 
+#if defined(ANCESTRYTREE_HAVE_RAYLIB)
+#define DETAIL_VIEW_RESIDENCY_PROFILE 0U
+#define DETAIL_VIEW_RESIDENCY_CERTIFICATE 1U
+
+/* Clearing the handle first keeps the unload helpers from releasing what the manager already dropped. */
+static void detail_view_evict_texture(void *owner, size_t slot)
+{
+    DetailViewState *state = (DetailViewState *)owner;
+    if (!state)
+    {
+        return;
+    }
+    if (slot == DETAIL_VIEW_RESIDENCY_PROFILE)
+    {
+        state->profile_handle = 0U;
+        detail_view_unload_profile(state);
+    }
+    else
+    {
+        state->certificate_preview_handle = 0U;
+        detail_view_unload_certificate(state);
+    }
+}
+#endif
+
 void detail_view_state_reset(DetailViewState *state)
 {
     if (!state)
@@ -66,6 +97,7 @@ void detail_view_state_reset(DetailViewState *state)
 #if defined(ANCESTRYTREE_HAVE_RAYLIB)
     detail_view_unload_profile(state);
     detail_view_unload_certificate(state);
+    state->profile_failed = false;
 #endif
     state->cached_person_id = 0U;
     state->selected_certificate_index = -1;
@@ -95,6 +127,13 @@ bool detail_view_init(DetailViewState *state)
         detail_gallery_shutdown(&state->gallery);
         return false;
     }
+#if defined(ANCESTRYTREE_HAVE_RAYLIB)
+    /* Without a cache (no decoder, or workers failed to start) images load synchronously as before. */
+    ThumbnailCacheConfig thumbnail_config = {DETAIL_VIEW_THUMBNAIL_DIRECTORY, 0, 0U, NULL, NULL, 0U};
+    state->thumbnails = thumbnail_cache_create(&thumbnail_config);
+    detail_gallery_set_thumbnail_cache(&state->gallery, state->thumbnails);
+#endif
+    detail_prefetch_init(&state->prefetch, state->thumbnails);
     state->initialized = true;
     return true;
 }
@@ -111,12 +150,36 @@ void detail_view_cleanup(DetailViewState *state)
 #endif
     detail_gallery_shutdown(&state->gallery);
     detail_timeline_shutdown(&state->timeline);
+    thumbnail_cache_destroy(state->thumbnails);
+    state->thumbnails = NULL;
+    detail_prefetch_init(&state->prefetch, NULL);
     state->initialized = false;
     state->cached_person_id = 0U;
     state->selected_certificate_index = -1;
     state->gallery_hover_index = -1;
 }
 
+void detail_view_set_texture_residency(DetailViewState *state, TextureResidency *residency)
+{
+    if (!state)
+    {
+        return;
+    }
+    detail_view_unload_profile(state);
+    detail_view_unload_certificate(state);
+    state->residency = residency;
+    detail_gallery_set_texture_residency(&state->gallery, residency);
+}
+
+void detail_view_prefetch(DetailViewState *state, const Person *person)
+{
+    if (!state || !state->initialized)
+    {
+        return;
+    }
+    (void)detail_prefetch_focus(&state->prefetch, person);
+}
+
 static const char *detail_view_event_type_label(TimelineEventType type)
 {
     switch (type)
@@ -214,13 +277,45 @@ static void detail_view_refresh_profile_texture(DetailViewState *state, const Pe
     {
         return;
     }
-    Texture2D texture = LoadTexture(person->profile_image_path);
+    Texture2D texture = {0};
+    size_t bytes = 0U;
+    if (state->thumbnails)
+    {
+        /* The profile is drawn at most 200px wide, so the thumbnail is all it ever needs. Until the worker
+         * delivers it, nothing is loaded and detail_view_ensure_profile_loaded asks again next frame. */
+        ThumbnailImage image = {NULL, 0, 0};
+        ThumbnailStatus status = thumbnail_cache_fetch(state->thumbnails, person->profile_image_path, &image);
+        if (status != THUMBNAIL_STATUS_READY)
+        {
+            state->profile_failed = status == THUMBNAIL_STATUS_FAILED;
+            return;
+        }
+        bytes = texture_residency_estimate_bytes(image.width, image.height, false);
+        if (texture_residency_reserve(state->residency, bytes))
+        {
+            Image pixels = {image.pixels, image.width, image.height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+            texture = LoadTextureFromImage(pixels);
+        }
+        thumbnail_image_reset(&image);
+    }
+    else
+    {
+        Image image = LoadImage(person->profile_image_path);
+        bytes = texture_residency_estimate_bytes(image.width, image.height, false);
+        if (image.data != NULL && texture_residency_reserve(state->residency, bytes))
+        {
+            texture = LoadTextureFromImage(image);
+        }
+        UnloadImage(image);
+    }
     if (texture.id == 0)
     {
         return;
     }
     state->profile_texture = texture;
     state->profile_texture_loaded = true;
+    state->profile_handle = texture_residency_track(state->residency, TEXTURE_RESIDENCY_DETAIL_VIEW, bytes,
+                                                    detail_view_evict_texture, state, DETAIL_VIEW_RESIDENCY_PROFILE);
 }
 
 static void detail_view_ensure_profile_loaded(DetailViewState *state, const Person *person)
@@ -229,7 +324,7 @@ static void detail_view_ensure_profile_loaded(DetailViewState *state, const Pers
     {
         return;
     }
-    if (!state->profile_texture_loaded)
+    if (!state->profile_texture_loaded && !state->profile_failed)
     {
         detail_view_refresh_profile_texture(state, person);
     }
@@ -256,13 +351,23 @@ static void detail_view_load_certificate_preview(DetailViewState *state, const c
     {
         return;
     }
-    Texture2D texture = LoadTexture(path);
+    Image image = LoadImage(path);
+    size_t bytes = texture_residency_estimate_bytes(image.width, image.height, false);
+    Texture2D texture = {0};
+    if (image.data != NULL && texture_residency_reserve(state->residency, bytes))
+    {
+        texture = LoadTextureFromImage(image);
+    }
+    UnloadImage(image);
     if (texture.id == 0)
     {
         return;
     }
     state->certificate_preview_texture = texture;
     state->certificate_preview_loaded = true;
+    state->certificate_preview_handle =
+        texture_residency_track(state->residency, TEXTURE_RESIDENCY_DETAIL_VIEW, bytes, detail_view_evict_texture,
+                                state, DETAIL_VIEW_RESIDENCY_CERTIFICATE);
     (void)snprintf(state->certificate_preview_path, sizeof(state->certificate_preview_path), "%s", path);
 }
 #endif
@@ -281,6 +386,7 @@ static void detail_view_render_profile_section(DetailViewState *state, struct nk
     detail_view_ensure_profile_loaded(state, person);
     if (state && state->profile_texture_loaded)
     {
+        texture_residency_touch(state->residency, state->profile_handle);
         float image_size = fminf(width, 200.0f);
         nk_layout_row_static(ctx, image_size, (int)image_size, 1);
         struct nk_image nk_tex = nk_image_id(state->profile_texture.id);
@@ -391,6 +497,7 @@ static void detail_view_render_certificates(DetailViewState *state, struct nk_co
 #if defined(ANCESTRYTREE_HAVE_RAYLIB) && defined(ANCESTRYTREE_HAVE_NUKLEAR)
     if (state->selected_certificate_index >= 0 && state->certificate_preview_loaded)
     {
+        texture_residency_touch(state->residency, state->certificate_preview_handle);
         float preview_height = 160.0f;
         nk_layout_row_static(ctx, preview_height, 180.0f, 1);
         struct nk_image image = nk_image_id(state->certificate_preview_texture.id);
@@ -3,10 +3,20 @@
 #include "persistence_internal.h"
 
 #include <ctype.h>
+#include <float.h>
+#include <locale.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define JSON_SCAN_SSE2 1
+#include <emmintrin.h>
+#else
+#define JSON_SCAN_SSE2 0
+#endif
+
 typedef struct JsonArray
 {
     JsonValue **items;
@@ -22,13 +32,21 @@ typedef struct JsonObject
     size_t capacity;
 } JsonObject;
 
+/* Integer tokens that fit int64 keep their exact value next to the double. */
+typedef struct JsonNumber
+{
+    double real;
+    int64_t integer;
+    bool is_integer;
+} JsonNumber;
+
 struct JsonValue
 {
     JsonValueType type;
     union
     {
         bool boolean;
-        double number;
+        JsonNumber number;
         char *string;
         JsonArray array;
         JsonObject object;
@@ -45,6 +63,7 @@ typedef struct StringBuilder
 typedef struct JsonParser
 {
     const char *cursor;
+    const char *end; /* Terminating NUL of the input, bounds block scans. */
     int line;
     int column;
 } JsonParser;
@@ -96,6 +115,18 @@ static bool string_builder_append_byte(StringBuilder *builder, unsigned char val
     return true;
 }
 
+static bool string_builder_append_bytes(StringBuilder *builder, const char *data, size_t length)
+{
+    if (!string_builder_reserve(builder, length))
+    {
+        return false;
+    }
+    memcpy(builder->data + builder->length, data, length);
+    builder->length += length;
+    builder->data[builder->length] = '\0';
+    return true;
+}
+
 static bool string_builder_append_utf8(StringBuilder *builder, unsigned int codepoint)
 {
     unsigned char buffer[4];
@@ -138,6 +169,60 @@ static bool string_builder_append_utf8(StringBuilder *builder, unsigned int code
     return true;
 }
 
+static bool json_byte_needs_escape(unsigned char value)
+{
+    return value < 0x20U || value == '"' || value == '\\';
+}
+
+size_t json_string_plain_prefix(const char *data, size_t length)
+{
+    if (!data)
+    {
+        return 0U;
+    }
+    size_t offset = 0U;
+#if JSON_SCAN_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control_limit = _mm_set1_epi8(0x1F);
+    while (length - offset >= 16U)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(const void *)(data + offset));
+        /* Unsigned "byte <= 0x1F" is min(byte, 0x1F) == byte. */
+        __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+                                    _mm_cmpeq_epi8(_mm_min_epu8(chunk, control_limit), chunk));
+        if (_mm_movemask_epi8(hits) != 0)
+        {
+            break;
+        }
+        offset += 16U;
+    }
+#else
+    const uint64_t ones = 0x0101010101010101ULL;
+    const uint64_t highs = 0x8080808080808080ULL;
+    while (length - offset >= 8U)
+    {
+        uint64_t word;
+        memcpy(&word, data + offset, sizeof(word));
+        uint64_t quote = word ^ (ones * (uint64_t)'"');
+        uint64_t backslash = word ^ (ones * (uint64_t)'\\');
+        uint64_t hits = (((word - ones * 0x20U) & ~word) | ((quote - ones) & ~quote) |
+                         ((backslash - ones) & ~backslash)) &
+                        highs;
+        if (hits != 0U)
+        {
+            break;
+        }
+        offset += 8U;
+    }
+#endif
+    while (offset < length && !json_byte_needs_escape((unsigned char)data[offset]))
+    {
+        offset++;
+    }
+    return offset;
+}
+
 static char parser_peek(const JsonParser *parser)
 {
     return parser->cursor[0];
@@ -254,12 +339,28 @@ static JsonValue *parser_parse_string(JsonParser *parser, char *error_buffer, si
     StringBuilder builder;
     string_builder_init(&builder);
     parser_next(parser);
-    while (parser_peek(parser) != '\0')
+    for (;;)
     {
+        size_t run = json_string_plain_prefix(parser->cursor, (size_t)(parser->end - parser->cursor));
+        if (run > 0U)
+        {
+            if (!string_builder_append_bytes(&builder, parser->cursor, run))
+            {
+                string_builder_free(&builder);
+                return NULL;
+            }
+            /* A plain run never contains a newline, so only the column moves. */
+            parser->cursor += run;
+            parser->column += (int)run;
+        }
+        if (parser_peek(parser) == '\0')
+        {
+            break;
+        }
         char ch = parser_next(parser);
         if (ch == '"')
         {
-            char *result = builder.data ? builder.data : strdup("");
+            char *result = builder.data ? builder.data : calloc(1U, 1U);
             if (!result)
             {
                 string_builder_free(&builder);
@@ -346,14 +447,6 @@ static JsonValue *parser_parse_string(JsonParser *parser, char *error_buffer, si
                 return NULL;
             }
         }
-        else
-        {
-            if (!string_builder_append_byte(&builder, (unsigned char)ch))
-            {
-                string_builder_free(&builder);
-                return NULL;
-            }
-        }
     }
     string_builder_free(&builder);
     parser_set_error(parser, error_buffer, error_buffer_size, "unterminated string");
@@ -385,21 +478,175 @@ static JsonValue *parser_parse_literal(JsonParser *parser, const char *literal,
     return value;
 }
 
+/* Exact powers of ten representable in a double; the bound of Clinger's fast path. */
+static const double g_json_exact_powers_of_ten[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                                    1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                                    1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+#define JSON_MAX_MANTISSA_DIGITS 19
+#define JSON_EXACT_MANTISSA_LIMIT (UINT64_C(1) << 53)
+
+/* Extended-precision evaluation (x87) would round twice, so only trust the fast path with plain doubles. */
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD != 0
+#define JSON_FAST_FLOAT_PATH 0
+#else
+#define JSON_FAST_FLOAT_PATH 1
+#endif
+
+/* strtod fallback for long mantissas and large exponents; swaps '.' for the locale's radix character. */
+static double json_parse_number_slow(const char *token, size_t length)
+{
+    char local[64];
+    char *buffer = length < sizeof(local) ? local : malloc(length + 1U);
+    if (!buffer)
+    {
+        return 0.0;
+    }
+    memcpy(buffer, token, length);
+    buffer[length] = '\0';
+    const struct lconv *conventions = localeconv();
+    char radix = conventions && conventions->decimal_point && conventions->decimal_point[0] != '\0'
+                     ? conventions->decimal_point[0]
+                     : '.';
+    if (radix != '.')
+    {
+        char *dot = strchr(buffer, '.');
+        if (dot)
+        {
+            *dot = radix;
+        }
+    }
+    double result = strtod(buffer, NULL);
+    if (buffer != local)
+    {
+        free(buffer);
+    }
+    return result;
+}
+
 static JsonValue *parser_parse_number(JsonParser *parser, char *error_buffer, size_t error_buffer_size)
 {
     const char *start = parser->cursor;
-    char *endptr = NULL;
-    double number = strtod(parser->cursor, &endptr);
-    if (endptr == start)
+    const char *cursor = start;
+    bool negative = false;
+    if (*cursor == '-' || *cursor == '+')
+    {
+        negative = *cursor == '-';
+        cursor++;
+    }
+
+    uint64_t mantissa = 0U;
+    int significant_digits = 0;
+    int decimal_exponent = 0;
+    bool truncated = false;
+    bool any_digit = false;
+    while (isdigit((unsigned char)*cursor))
+    {
+        unsigned int digit = (unsigned int)(*cursor - '0');
+        any_digit = true;
+        if (significant_digits < JSON_MAX_MANTISSA_DIGITS)
+        {
+            mantissa = mantissa * 10U + digit;
+            significant_digits += mantissa != 0U ? 1 : 0;
+        }
+        else
+        {
+            truncated = truncated || digit != 0U;
+            decimal_exponent++;
+        }
+        cursor++;
+    }
+    bool integer_token = true;
+    if (*cursor == '.')
+    {
+        integer_token = false;
+        cursor++;
+        while (isdigit((unsigned char)*cursor))
+        {
+            unsigned int digit = (unsigned int)(*cursor - '0');
+            any_digit = true;
+            if (significant_digits < JSON_MAX_MANTISSA_DIGITS)
+            {
+                mantissa = mantissa * 10U + digit;
+                significant_digits += mantissa != 0U ? 1 : 0;
+                decimal_exponent--;
+            }
+            else
+            {
+                truncated = truncated || digit != 0U;
+            }
+            cursor++;
+        }
+    }
+    if (!any_digit)
     {
         parser_set_error(parser, error_buffer, error_buffer_size, "invalid number");
         return NULL;
     }
-    size_t consumed = (size_t)(endptr - start);
-    for (size_t index = 0; index < consumed; ++index)
+    if (*cursor == 'e' || *cursor == 'E')
     {
-        parser_next(parser);
+        const char *exponent_cursor = cursor + 1;
+        bool exponent_negative = false;
+        if (*exponent_cursor == '-' || *exponent_cursor == '+')
+        {
+            exponent_negative = *exponent_cursor == '-';
+            exponent_cursor++;
+        }
+        if (isdigit((unsigned char)*exponent_cursor))
+        {
+            int exponent = 0;
+            while (isdigit((unsigned char)*exponent_cursor))
+            {
+                if (exponent < 100000)
+                {
+                    exponent = exponent * 10 + (*exponent_cursor - '0');
+                }
+                exponent_cursor++;
+            }
+            decimal_exponent += exponent_negative ? -exponent : exponent;
+            integer_token = false;
+            cursor = exponent_cursor;
+        }
+    }
+
+    JsonNumber number;
+    number.real = 0.0;
+    number.integer = 0;
+    number.is_integer = false;
+    if (integer_token && !truncated && decimal_exponent == 0)
+    {
+        if (!negative && mantissa <= (uint64_t)INT64_MAX)
+        {
+            number.integer = (int64_t)mantissa;
+            number.is_integer = true;
+        }
+        else if (negative && mantissa <= (uint64_t)INT64_MAX + 1U)
+        {
+            number.integer = mantissa == (uint64_t)INT64_MAX + 1U ? INT64_MIN : -(int64_t)mantissa;
+            number.is_integer = true;
+        }
+    }
+    if (number.is_integer)
+    {
+        number.real = (double)number.integer;
     }
+    else if (JSON_FAST_FLOAT_PATH && !truncated && mantissa <= JSON_EXACT_MANTISSA_LIMIT &&
+             decimal_exponent >= -22 && decimal_exponent <= 22)
+    {
+        /* Both operands are exact, so the single IEEE multiply/divide is correctly rounded. */
+        double real = (double)mantissa;
+        real = decimal_exponent < 0 ? real / g_json_exact_powers_of_ten[-decimal_exponent]
+                                    : real * g_json_exact_powers_of_ten[decimal_exponent];
+        number.real = negative ? -real : real;
+    }
+    else
+    {
+        number.real = json_parse_number_slow(start, (size_t)(cursor - start));
+    }
+
+    /* Numbers never span lines, so the column advances by the token length. */
+    parser->column += (int)(cursor - start);
+    parser->cursor = cursor;
     JsonValue *value = json_value_new(JSON_VALUE_NUMBER);
     if (!value)
     {
@@ -621,6 +868,7 @@ JsonValue *json_parse(const char *text, char *error_buffer, size_t error_buffer_
     }
     JsonParser parser;
     parser.cursor = text;
+    parser.end = text + strlen(text);
     parser.line = 1;
     parser.column = 1;
     JsonValue *root = parser_parse_value(&parser, error_buffer, error_buffer_size);
@@ -725,7 +973,43 @@ bool json_value_get_number(const JsonValue *value, double *out_value)
     }
     if (out_value)
     {
-        *out_value = value->data.number;
+        *out_value = value->data.number.real;
+    }
+    return true;
+}
+
+bool json_value_get_uint32(const JsonValue *value, uint32_t *out_value)
+{
+    if (!value || value->type != JSON_VALUE_NUMBER)
+    {
+        return false;
+    }
+    const JsonNumber *number = &value->data.number;
+    uint32_t result = 0U;
+    if (number->is_integer)
+    {
+        if (number->integer < 0 || number->integer > (int64_t)UINT32_MAX)
+        {
+            return false;
+        }
+        result = (uint32_t)number->integer;
+    }
+    else
+    {
+        /* Accept integral reals such as 12.0 or 1e3; reject fractions and anything out of range. */
+        if (!(number->real >= 0.0 && number->real <= (double)UINT32_MAX))
+        {
+            return false;
+        }
+        result = (uint32_t)number->real;
+        if ((double)result != number->real)
+        {
+            return false;
+        }
+    }
+    if (out_value)
+    {
+        *out_value = result;
     }
     return true;
 }
@@ -1,9 +1,11 @@
 #include "layout.h"
 
 #include "at_memory.h"
+#include "tree_hot.h"
 
 #include <math.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -94,88 +96,6 @@ static bool layout_allocate_nodes(LayoutResult *result, size_t count)
     return true;
 }
 
-static size_t layout_collect_generation(Person **buffer, size_t capacity, const Person *const *previous_generation,
-                                        size_t previous_count)
-{
-    size_t count = 0U;
-    for (size_t index = 0U; index < previous_count; ++index)
-    {
-        const Person *parent = previous_generation[index];
-        if (!parent)
-        {
-            continue;
-        }
-        for (size_t child_index = 0U; child_index < parent->children_count; ++child_index)
-        {
-            Person *child = parent->children[child_index];
-            if (!child)
-            {
-                continue;
-            }
-            bool already_collected = false;
-            for (size_t scan = 0U; scan < count; ++scan)
-            {
-                if (buffer[scan] == child)
-                {
-                    already_collected = true;
-                    break;
-                }
-            }
-            if (already_collected)
-            {
-                continue;
-            }
-            if (count < capacity)
-            {
-                buffer[count++] = child;
-            }
-        }
-    }
-    return count;
-}
-
-static int layout_find_person_index(Person *const *generation, size_t count, const Person *person)
-{
-    if (!generation || !person)
-    {
-        return -1;
-    }
-    for (size_t index = 0U; index < count; ++index)
-    {
-        if (generation[index] == person)
-        {
-            return (int)index;
-        }
-    }
-    return -1;
-}
-
-static const Person *layout_find_generation_spouse(Person *const *generation, size_t count, const Person *person,
-                                                   const bool *assigned)
-{
-    if (!generation || !person)
-    {
-        return NULL;
-    }
-    for (size_t spouse_index = 0U; spouse_index < person->spouses_count; ++spouse_index)
-    {
-        const Person *candidate = person->spouses[spouse_index].partner;
-        if (!candidate)
-        {
-            continue;
-        }
-        int index = layout_find_person_index(generation, count, candidate);
-        if (index >= 0)
-        {
-            if (!assigned || !assigned[index])
-            {
-                return candidate;
-            }
-        }
-    }
-    return NULL;
-}
-
 static const LayoutNode *layout_find_node(const LayoutResult *layout, const Person *person)
 {
     if (!layout || !layout->nodes || !person)
@@ -192,22 +112,6 @@ static const LayoutNode *layout_find_node(const LayoutResult *layout, const Pers
     return NULL;
 }
 
-static int layout_find_node_index(const LayoutResult *layout, const Person *person)
-{
-    if (!layout || !layout->nodes || !person)
-    {
-        return -1;
-    }
-    for (size_t index = 0U; index < layout->count; ++index)
-    {
-        if (layout->nodes[index].person == person)
-        {
-            return (int)index;
-        }
-    }
-    return -1;
-}
-
 static bool layout_nodes_contains(LayoutNode *nodes, size_t count, const Person *person)
 {
     if (!nodes || !person)
@@ -230,20 +134,45 @@ typedef struct LayoutEdge
     size_t end;
 } LayoutEdge;
 
-static bool layout_force_edge_exists(const LayoutEdge *edges, size_t count, size_t start, size_t end)
+/* Unordered node pairs already linked, so mirrored spouse records yield one spring. */
+typedef struct LayoutEdgeSet
 {
-    for (size_t index = 0U; index < count; ++index)
+    uint64_t *keys;
+    size_t capacity;
+} LayoutEdgeSet;
+
+static bool layout_edge_set_init(LayoutEdgeSet *set, size_t expected)
+{
+    set->capacity = 16U;
+    while (set->capacity < expected * 2U)
     {
-        if ((edges[index].start == start && edges[index].end == end) ||
-            (edges[index].start == end && edges[index].end == start))
+        set->capacity *= 2U;
+    }
+    set->keys = (uint64_t *)calloc(set->capacity, sizeof(uint64_t));
+    return set->keys != NULL;
+}
+
+/* Returns true when the pair was not present yet. */
+static bool layout_edge_set_insert(LayoutEdgeSet *set, size_t start, size_t end)
+{
+    uint64_t low = (uint64_t)(start < end ? start : end);
+    uint64_t high = (uint64_t)(start < end ? end : start);
+    uint64_t key = ((high << 32U) | low) + 1U;
+    size_t slot = (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 17U) & (set->capacity - 1U);
+    while (set->keys[slot] != 0U)
+    {
+        if (set->keys[slot] == key)
         {
-            return true;
+            return false;
         }
+        slot = (slot + 1U) & (set->capacity - 1U);
     }
-    return false;
+    set->keys[slot] = key;
+    return true;
 }
 
-static bool layout_force_add_edge(LayoutEdge **edges, size_t *count, size_t *capacity, size_t start, size_t end)
+static bool layout_force_add_edge(LayoutEdge **edges, size_t *count, size_t *capacity, LayoutEdgeSet *seen,
+                                  size_t start, size_t end)
 {
     if (!edges || !count || !capacity)
     {
@@ -253,7 +182,7 @@ static bool layout_force_add_edge(LayoutEdge **edges, size_t *count, size_t *cap
     {
         return true;
     }
-    if (layout_force_edge_exists(*edges, *count, start, end))
+    if (!layout_edge_set_insert(seen, start, end))
     {
         return true;
     }
@@ -274,184 +203,206 @@ static bool layout_force_add_edge(LayoutEdge **edges, size_t *count, size_t *cap
     return true;
 }
 
-static void layout_assign_generation(LayoutNode *nodes, size_t start_index, Person *const *generation, size_t count,
-                                     float vertical_level)
+/* Per-record scratch for one hierarchical pass; stamps avoid clearing between generations. */
+typedef struct LayoutGenerationScratch
 {
-    if (!nodes || !generation)
-    {
-        return;
+    uint32_t *current;
+    uint32_t *next;
+    uint32_t *ordered;
+    uint32_t *slot;           /* Position in the current generation, valid while slot_stamp matches. */
+    uint32_t *slot_stamp;
+    uint32_t *collected_stamp;
+    uint32_t stamp;
+} LayoutGenerationScratch;
+
+static void layout_generation_scratch_dispose(LayoutGenerationScratch *scratch)
+{
+    free(scratch->current);
+    free(scratch->next);
+    free(scratch->ordered);
+    free(scratch->slot);
+    free(scratch->slot_stamp);
+    free(scratch->collected_stamp);
+}
+
+static bool layout_generation_scratch_init(LayoutGenerationScratch *scratch, size_t count)
+{
+    scratch->current = (uint32_t *)calloc(count, sizeof(uint32_t));
+    scratch->next = (uint32_t *)calloc(count, sizeof(uint32_t));
+    scratch->ordered = (uint32_t *)calloc(count, sizeof(uint32_t));
+    scratch->slot = (uint32_t *)calloc(count, sizeof(uint32_t));
+    scratch->slot_stamp = (uint32_t *)calloc(count, sizeof(uint32_t));
+    scratch->collected_stamp = (uint32_t *)calloc(count, sizeof(uint32_t));
+    scratch->stamp = 0U;
+    if (!scratch->current || !scratch->next || !scratch->ordered || !scratch->slot || !scratch->slot_stamp ||
+        !scratch->collected_stamp)
+    {
+        layout_generation_scratch_dispose(scratch);
+        return false;
     }
-    if (count == 0U)
+    return true;
+}
+
+static size_t layout_collect_generation(const TreeHotIndex *index, LayoutGenerationScratch *scratch,
+                                        size_t previous_count)
+{
+    size_t count = 0U;
+    for (size_t position = 0U; position < previous_count; ++position)
     {
-        return;
+        const TreeHotRecord *parent = &index->records[scratch->current[position]];
+        for (uint32_t edge = 0U; edge < parent->child_count; ++edge)
+        {
+            uint32_t child = index->edges[parent->child_offset + edge];
+            if (scratch->collected_stamp[child] == scratch->stamp)
+            {
+                continue;
+            }
+            scratch->collected_stamp[child] = scratch->stamp;
+            if (count < index->count)
+            {
+                scratch->next[count++] = child;
+            }
+        }
     }
+    return count;
+}
 
-    Person **ordered = (Person **)calloc(count, sizeof(Person *));
-    bool *assigned = (bool *)calloc(count, sizeof(bool));
-    if (!ordered || !assigned)
+/* First spouse of record that sits in the current generation and has not been placed yet. */
+static uint32_t layout_find_generation_spouse(const TreeHotIndex *index, const LayoutGenerationScratch *scratch,
+                                              uint32_t record, const bool *assigned)
+{
+    const TreeHotRecord *hot = &index->records[record];
+    for (uint32_t edge = 0U; edge < hot->spouse_count; ++edge)
     {
-        free(ordered);
-        free(assigned);
-        const float total_width_fallback = (float)(count > 0U ? count - 1U : 0U) * LAYOUT_HORIZONTAL_SPACING;
-        const float origin_fallback = -total_width_fallback / 2.0f;
-        for (size_t index = 0U; index < count; ++index)
+        uint32_t candidate = index->edges[hot->spouse_offset + edge];
+        if (scratch->slot_stamp[candidate] == scratch->stamp && !assigned[scratch->slot[candidate]])
         {
-            LayoutNode *node = &nodes[start_index + index];
-            node->person = generation[index];
-            node->position[0] = origin_fallback + (float)index * LAYOUT_HORIZONTAL_SPACING;
-            node->position[1] = vertical_level;
-            node->position[2] = 0.0f;
+            return candidate;
         }
+    }
+    return TREE_HOT_NONE;
+}
+
+static void layout_assign_generation(LayoutNode *nodes, size_t start_index, const TreeHotIndex *index,
+                                     LayoutGenerationScratch *scratch, size_t count, float vertical_level)
+{
+    if (!nodes || count == 0U)
+    {
         return;
     }
+    for (size_t position = 0U; position < count; ++position)
+    {
+        scratch->slot[scratch->current[position]] = (uint32_t)position;
+        scratch->slot_stamp[scratch->current[position]] = scratch->stamp;
+    }
 
+    bool *assigned = (bool *)calloc(count, sizeof(bool));
     size_t ordered_count = 0U;
-    for (size_t index = 0U; index < count; ++index)
+    if (!assigned)
     {
-        if (assigned[index])
+        memcpy(scratch->ordered, scratch->current, count * sizeof(uint32_t));
+        ordered_count = count;
+    }
+    for (size_t position = 0U; assigned && position < count; ++position)
+    {
+        if (assigned[position])
         {
             continue;
         }
-        Person *person = generation[index];
-        ordered[ordered_count++] = person;
-        assigned[index] = true;
-
-        const Person *spouse = layout_find_generation_spouse(generation, count, person, assigned);
-        if (spouse)
-        {
-            int spouse_index = layout_find_person_index(generation, count, spouse);
-            if (spouse_index >= 0 && !assigned[spouse_index])
-            {
-                ordered[ordered_count++] = generation[spouse_index];
-                assigned[spouse_index] = true;
-            }
-        }
-    }
+        uint32_t record = scratch->current[position];
+        scratch->ordered[ordered_count++] = record;
+        assigned[position] = true;
 
-    if (ordered_count < count)
-    {
-        for (size_t index = 0U; index < count && ordered_count < count; ++index)
+        /* Keep couples side by side. */
+        uint32_t spouse = layout_find_generation_spouse(index, scratch, record, assigned);
+        if (spouse != TREE_HOT_NONE)
         {
-            Person *person = generation[index];
-            bool already_added = false;
-            for (size_t scan = 0U; scan < ordered_count; ++scan)
-            {
-                if (ordered[scan] == person)
-                {
-                    already_added = true;
-                    break;
-                }
-            }
-            if (!already_added)
-            {
-                ordered[ordered_count++] = person;
-            }
+            scratch->ordered[ordered_count++] = spouse;
+            assigned[scratch->slot[spouse]] = true;
         }
     }
 
     const float total_width = (float)(ordered_count > 0U ? ordered_count - 1U : 0U) * LAYOUT_HORIZONTAL_SPACING;
     const float origin = -total_width / 2.0f;
-    for (size_t index = 0U; index < ordered_count; ++index)
+    for (size_t position = 0U; position < ordered_count; ++position)
     {
-        LayoutNode *node = &nodes[start_index + index];
-        node->person = ordered[index];
-        node->position[0] = origin + (float)index * LAYOUT_HORIZONTAL_SPACING;
+        LayoutNode *node = &nodes[start_index + position];
+        node->person = index->cold[scratch->ordered[position]];
+        node->position[0] = origin + (float)position * LAYOUT_HORIZONTAL_SPACING;
         node->position[1] = vertical_level;
         node->position[2] = 0.0f;
     }
-
-    free(ordered);
     free(assigned);
 }
 
-static size_t layout_collect_all(Person **scratch, const FamilyTree *tree)
-{
-    if (!scratch || !tree)
-    {
-        return 0U;
-    }
-    size_t count = 0U;
-    for (size_t index = 0U; index < tree->person_count; ++index)
-    {
-        Person *person = tree->persons[index];
-        if (!person)
-        {
-            continue;
-        }
-        scratch[count++] = person;
-    }
-    return count;
-}
-
-static LayoutResult layout_calculate_hierarchical_internal(const FamilyTree *tree)
+static LayoutResult layout_calculate_hierarchical_indexed(const TreeHotIndex *index)
 {
     LayoutResult result;
     layout_result_init(&result);
-    if (!tree || tree->person_count == 0U)
-    {
-        return result;
-    }
-
-    if (!layout_allocate_nodes(&result, tree->person_count))
-    {
-        return result;
-    }
-
-    Person **scratch = calloc(tree->person_count, sizeof(Person *));
-    if (!scratch)
+    if (index->count == 0U || !layout_allocate_nodes(&result, index->count))
     {
-        layout_result_destroy(&result);
         return result;
     }
-
-    size_t node_index = 0U;
-    Person **current_generation = calloc(tree->person_count, sizeof(Person *));
-    Person **next_generation = calloc(tree->person_count, sizeof(Person *));
-    if (!current_generation || !next_generation)
+    LayoutGenerationScratch scratch;
+    if (!layout_generation_scratch_init(&scratch, index->count))
     {
-        free(scratch);
-        free(current_generation);
-        free(next_generation);
         layout_result_destroy(&result);
         return result;
     }
 
-    size_t root_count = 0U;
-    for (size_t index = 0U; index < tree->person_count; ++index)
+    size_t generation_count = 0U;
+    for (size_t record = 0U; record < index->count; ++record)
     {
-        Person *person = tree->persons[index];
-        if (!person)
-        {
-            continue;
-        }
-        if (!person->parents[PERSON_PARENT_FATHER] && !person->parents[PERSON_PARENT_MOTHER])
+        const TreeHotRecord *hot = &index->records[record];
+        if (hot->parents[PERSON_PARENT_FATHER] == TREE_HOT_NONE && hot->parents[PERSON_PARENT_MOTHER] == TREE_HOT_NONE)
         {
-            current_generation[root_count++] = person;
+            scratch.current[generation_count++] = (uint32_t)record;
         }
     }
-    if (root_count == 0U)
+    if (generation_count == 0U)
     {
-        root_count = layout_collect_all(current_generation, tree);
+        for (size_t record = 0U; record < index->count; ++record)
+        {
+            scratch.current[generation_count++] = (uint32_t)record;
+        }
     }
 
+    size_t node_index = 0U;
     float level = 0.0f;
-    while (root_count > 0U)
+    /* A person reachable at several depths is placed once per depth; stop rather than overrun the nodes. */
+    while (generation_count > 0U && node_index + generation_count <= result.count)
     {
-        layout_assign_generation(result.nodes, node_index, current_generation, root_count, level);
-        node_index += root_count;
+        scratch.stamp++;
+        layout_assign_generation(result.nodes, node_index, index, &scratch, generation_count, level);
+        node_index += generation_count;
         level -= LAYOUT_VERTICAL_SPACING;
 
-        size_t next_count = layout_collect_generation(next_generation, tree->person_count,
-                                                      (const Person *const *)current_generation, root_count);
-        memset(current_generation, 0, sizeof(Person *) * tree->person_count);
-        memcpy(current_generation, next_generation, sizeof(Person *) * next_count);
-        memset(next_generation, 0, sizeof(Person *) * tree->person_count);
-        root_count = next_count;
+        size_t next_count = layout_collect_generation(index, &scratch, generation_count);
+        uint32_t *swap = scratch.current;
+        scratch.current = scratch.next;
+        scratch.next = swap;
+        generation_count = next_count;
     }
 
-    free(scratch);
-    free(current_generation);
-    free(next_generation);
+    layout_generation_scratch_dispose(&scratch);
+    return result;
+}
+
+static LayoutResult layout_calculate_hierarchical_internal(const FamilyTree *tree)
+{
+    LayoutResult result;
+    layout_result_init(&result);
+    if (!tree || tree->person_count == 0U)
+    {
+        return result;
+    }
+    TreeHotIndex index;
+    tree_hot_index_init(&index);
+    if (tree_hot_index_build(&index, tree))
+    {
+        result = layout_calculate_hierarchical_indexed(&index);
+    }
+    tree_hot_index_reset(&index);
     return result;
 }
 
@@ -460,8 +411,8 @@ LayoutResult layout_calculate(const FamilyTree *tree)
     return layout_calculate_hierarchical_internal(tree);
 }
 
-static bool layout_force_prepare_edges(LayoutResult *layout, LayoutEdge **edges, size_t *edge_count,
-                                       size_t *edge_capacity)
+static bool layout_force_prepare_edges(const TreeHotIndex *index, LayoutResult *layout, LayoutEdge **edges,
+                                       size_t *edge_count, size_t *edge_capacity)
 {
     if (!layout || !edges || !edge_count || !edge_capacity)
     {
@@ -474,39 +425,44 @@ static bool layout_force_prepare_edges(LayoutResult *layout, LayoutEdge **edges,
         *edge_capacity = 8U;
     }
     *edges = (LayoutEdge *)calloc(*edge_capacity, sizeof(LayoutEdge));
-    if (!*edges)
+    uint32_t *node_of = (uint32_t *)malloc(index->count * sizeof(uint32_t));
+    LayoutEdgeSet seen;
+    seen.keys = NULL;
+    bool success = *edges && node_of && layout_edge_set_init(&seen, index->edge_count);
+    for (size_t record = 0U; success && record < index->count; ++record)
     {
-        *edge_capacity = 0U;
-        return false;
+        node_of[record] = TREE_HOT_NONE;
     }
-
-    bool success = true;
-    for (size_t index = 0U; index < layout->count && success; ++index)
+    /* Walk nodes backwards so each record maps to its first node, as a forward search would. */
+    for (size_t node = layout->count; success && node > 0U; --node)
     {
-        Person *person = layout->nodes[index].person;
-        if (!person)
+        uint32_t record = tree_hot_index_find(index, layout->nodes[node - 1U].person);
+        if (record != TREE_HOT_NONE)
         {
-            continue;
+            node_of[record] = (uint32_t)(node - 1U);
         }
-        for (size_t child_index = 0U; child_index < person->children_count && success; ++child_index)
+    }
+
+    for (size_t node = 0U; node < layout->count && success; ++node)
+    {
+        uint32_t record = tree_hot_index_find(index, layout->nodes[node].person);
+        if (record == TREE_HOT_NONE)
         {
-            Person *child = person->children[child_index];
-            int child_layout_index = layout_find_node_index(layout, child);
-            if (child_layout_index >= 0)
-            {
-                success = layout_force_add_edge(edges, edge_count, edge_capacity, index, (size_t)child_layout_index);
-            }
+            continue;
         }
-        for (size_t spouse_index = 0U; spouse_index < person->spouses_count && success; ++spouse_index)
+        const TreeHotRecord *hot = &index->records[record];
+        /* Children then spouses: the spans are adjacent in the edge array. */
+        for (uint32_t edge = 0U; edge < hot->child_count + hot->spouse_count && success; ++edge)
         {
-            const Person *partner = person->spouses[spouse_index].partner;
-            int partner_layout_index = layout_find_node_index(layout, partner);
-            if (partner_layout_index >= 0)
+            uint32_t target = node_of[index->edges[hot->child_offset + edge]];
+            if (target != TREE_HOT_NONE)
             {
-                success = layout_force_add_edge(edges, edge_count, edge_capacity, index, (size_t)partner_layout_index);
+                success = layout_force_add_edge(edges, edge_count, edge_capacity, &seen, node, (size_t)target);
             }
         }
     }
+    free(seen.keys);
+    free(node_of);
     if (!success)
     {
         free(*edges);
@@ -520,9 +476,22 @@ static bool layout_force_prepare_edges(LayoutResult *layout, LayoutEdge **edges,
 
 LayoutResult layout_calculate_force_directed(const FamilyTree *tree)
 {
-    LayoutResult result = layout_calculate_hierarchical_internal(tree);
-    if (!tree || tree->person_count == 0U || result.count <= 1U)
+    LayoutResult result;
+    layout_result_init(&result);
+    if (!tree || tree->person_count == 0U)
+    {
+        return result;
+    }
+    TreeHotIndex index;
+    tree_hot_index_init(&index);
+    if (!tree_hot_index_build(&index, tree))
+    {
+        return result;
+    }
+    result = layout_calculate_hierarchical_indexed(&index);
+    if (result.count <= 1U)
     {
+        tree_hot_index_reset(&index);
         return result;
     }
 
@@ -535,6 +504,7 @@ LayoutResult layout_calculate_force_directed(const FamilyTree *tree)
         free(velocity);
         free(forces);
         free(layer_targets);
+        tree_hot_index_reset(&index);
         return result;
     }
     for (size_t index = 0U; index < count; ++index)
@@ -545,11 +515,12 @@ LayoutResult layout_calculate_force_directed(const FamilyTree *tree)
     LayoutEdge *edges = NULL;
     size_t edge_count = 0U;
     size_t edge_capacity = 0U;
-    if (!layout_force_prepare_edges(&result, &edges, &edge_count, &edge_capacity))
+    if (!layout_force_prepare_edges(&index, &result, &edges, &edge_count, &edge_capacity))
     {
         edge_count = 0U;
         edges = NULL;
     }
+    tree_hot_index_reset(&index);
 
     const float epsilon = 0.0001f;
     for (unsigned int iteration = 0U; iteration < LAYOUT_FORCE_ITERATIONS; ++iteration)
@@ -13,6 +13,7 @@
 #include "settings.h"
 #include "settings_runtime.h"
 #include "shortcuts.h"
+#include "texture_residency.h"
 #include "tree.h"
 #include "ui.h"
 #include "expansion.h"
@@ -30,6 +31,9 @@
 #define APP_DEFAULT_SAVE_PATH "assets/manual_save.json"
 #define APP_SETTINGS_PATH "assets/settings.cfg"
 #define APP_AUTO_SAVE_PATH "assets/auto_save.json"
+#define APP_AUTO_SAVE_JOURNAL_PATH APP_AUTO_SAVE_PATH ".journal"
+#define APP_AUTO_SAVE_JOURNAL_COMPACTION 64U
+#define APP_RECOVERED_SESSION_PATH "assets/auto_save.recovered.json"
 #define APP_LOG_PATH "ancestrytree.log"
 
 #if defined(ANCESTRYTREE_HAVE_RAYLIB)
@@ -103,6 +107,8 @@ static bool layout_compute_center(const LayoutResult *layout, float out_center[3
 
 static FamilyTree *app_create_placeholder_tree(void);
 static FamilyTree *app_auto_save_tree_supplier(void *user_data);
+static void app_auto_save_person_changed(AppPersonChange change, const Person *person, void *user_data);
+static void app_person_changed(AppPersonChange change, const Person *person, void *user_data);
 static void app_apply_settings(const Settings *settings, RenderState *render_state, CameraController *camera,
                                PersistenceAutoSave *auto_save);
 
@@ -294,6 +300,7 @@ static void app_on_tree_changed(LayoutResult *layout, InteractionState *interact
         return;
     }
     interaction_clear_selection(interaction_state);
+    render_connections_invalidate(render_state);
     interaction_state_set_pick_radius(interaction_state, render_state->config.sphere_radius);
     app_focus_camera_on_layout(camera, layout);
     if (auto_save)
@@ -909,7 +916,7 @@ static FamilyTree *app_create_placeholder_tree(void)
     {
         return NULL;
     }
-    Person *person = person_create(1U);
+    Person *person = family_tree_create_person(tree, 1U);
     if (!person)
     {
         family_tree_destroy(tree);
@@ -937,6 +944,56 @@ static FamilyTree *app_auto_save_tree_supplier(void *user_data)
     return *tree_ref;
 }
 
+static void app_auto_save_person_changed(AppPersonChange change, const Person *person, void *user_data)
+{
+    PersistenceJournalOperation operation = PERSISTENCE_JOURNAL_EDIT;
+    if (change == APP_PERSON_CHANGE_ADDED)
+    {
+        operation = PERSISTENCE_JOURNAL_ADD;
+    }
+    else if (change == APP_PERSON_CHANGE_REMOVED)
+    {
+        operation = PERSISTENCE_JOURNAL_DELETE;
+    }
+    /* A failed record marks the auto-save for a full snapshot, so the change is never lost. */
+    (void)persistence_auto_save_record_change((PersistenceAutoSave *)user_data, operation, person, NULL, 0U);
+}
+
+/* Person changes feed the cached connection graph and, once its journal is up, the auto-save. */
+typedef struct AppPersonChangeSinks
+{
+    FamilyTree **tree;
+    RenderState *render_state;
+    PersistenceAutoSave *journal;
+} AppPersonChangeSinks;
+
+static void app_person_changed(AppPersonChange change, const Person *person, void *user_data)
+{
+    AppPersonChangeSinks *sinks = (AppPersonChangeSinks *)user_data;
+    if (!sinks || !person)
+    {
+        return;
+    }
+    if (change == APP_PERSON_CHANGE_ADDED)
+    {
+        /* The graph keeps mutable members; a person it cannot find just makes the next frame rebuild it. */
+        Person *member = (sinks->tree && *sinks->tree) ? family_tree_find_person(*sinks->tree, person->id) : NULL;
+        render_connections_person_added(sinks->render_state, member);
+    }
+    else if (change == APP_PERSON_CHANGE_REMOVED)
+    {
+        render_connections_person_removed(sinks->render_state, person);
+    }
+    else
+    {
+        render_connections_person_edited(sinks->render_state, person);
+    }
+    if (sinks->journal)
+    {
+        app_auto_save_person_changed(change, person, sinks->journal);
+    }
+}
+
 static void app_apply_settings(const Settings *settings, RenderState *render_state, CameraController *camera,
                                PersistenceAutoSave *auto_save)
 {
@@ -947,6 +1004,7 @@ static void app_apply_settings(const Settings *settings, RenderState *render_sta
     if (render_state)
     {
         settings_runtime_apply_render(settings, &render_state->config);
+        settings_runtime_apply_texture_budget(settings, render_state->texture_residency);
     }
     if (auto_save && settings)
     {
@@ -1171,6 +1229,29 @@ static int app_run(AtLogger *logger, const AppLaunchOptions *options)
     initial_warning[0] = '\0';
     bool warning_pending = false;
 
+    /* A journal next to the auto-save means the last session ended before compacting it. Replay it now: the
+     * auto-save's first snapshot would otherwise remove the journal along with the edits it holds. */
+    FamilyTree *recovered_tree = NULL;
+    size_t recovered_records = 0U;
+    bool tree_recovered = false;
+    /* Set while the last session's edits exist only in files the auto-save would overwrite or compact. */
+    bool auto_save_blocked = false;
+    if (!persistence_journal_recover_pending(APP_AUTO_SAVE_PATH, &recovered_tree, &recovered_records, error_buffer,
+                                             sizeof(error_buffer)))
+    {
+        AT_LOG(logger, AT_LOG_ERROR, "Auto-save recovery failed (%s).", error_buffer);
+        auto_save_blocked = FileExists(APP_AUTO_SAVE_JOURNAL_PATH);
+        (void)snprintf(initial_warning, sizeof(initial_warning), "%s: %s.%s",
+                       "Unsaved changes from the last session could not be recovered", error_buffer,
+                       auto_save_blocked ? " Auto-save is off for this session." : "");
+        warning_pending = true;
+    }
+    else if (recovered_tree)
+    {
+        AT_LOG(logger, AT_LOG_INFO, "Recovered %zu journaled change(s) into %s.", recovered_records,
+               APP_AUTO_SAVE_PATH);
+    }
+
     if (options && options->tree_path[0] != '\0')
     {
         AT_LOG(logger, AT_LOG_INFO, "Loading tree from %s", options->tree_path);
@@ -1190,6 +1271,37 @@ static int app_run(AtLogger *logger, const AppLaunchOptions *options)
         }
     }
 
+    if (recovered_tree && tree)
+    {
+        /* The explicit tree wins, but the recovered session must outlive the next auto-save of that tree. */
+        if (persistence_tree_save(recovered_tree, APP_RECOVERED_SESSION_PATH, error_buffer, sizeof(error_buffer)))
+        {
+            (void)snprintf(initial_status, sizeof(initial_status),
+                           "Loaded tree from %s. Recovered session saved to %s.", options->tree_path,
+                           APP_RECOVERED_SESSION_PATH);
+        }
+        else
+        {
+            /* The recovered edits now live only in the auto-save snapshot; keep it from being overwritten. */
+            AT_LOG(logger, AT_LOG_ERROR, "Failed to keep recovered session (%s).", error_buffer);
+            (void)snprintf(initial_warning, sizeof(initial_warning),
+                           "Recovered session is only in %s. Auto-save is off for this session.", APP_AUTO_SAVE_PATH);
+            warning_pending = true;
+            auto_save_blocked = true;
+        }
+        family_tree_destroy(recovered_tree);
+        recovered_tree = NULL;
+    }
+    else if (recovered_tree)
+    {
+        tree = recovered_tree;
+        recovered_tree = NULL;
+        tree_recovered = true;
+        app_file_state_clear(&file_state);
+        (void)snprintf(initial_status, sizeof(initial_status), "Recovered %zu unsaved change(s) from the last session.",
+                       recovered_records);
+    }
+
     if (!tree && (!options || !options->disable_sample_tree))
     {
         char tree_path[512];
@@ -1261,6 +1373,10 @@ static int app_run(AtLogger *logger, const AppLaunchOptions *options)
             render_target_warned = true;
         }
     }
+    /* One budget spans name panels, the detail view and the gallery; app_apply_settings sizes it. */
+    TextureResidency texture_residency;
+    texture_residency_init(&texture_residency, 0U);
+    render_set_texture_residency(&render_state, &texture_residency);
 
     InteractionState interaction_state;
     interaction_state_init(&interaction_state);
@@ -1284,6 +1400,11 @@ static int app_run(AtLogger *logger, const AppLaunchOptions *options)
 
     PersistenceAutoSave auto_save;
     memset(&auto_save, 0, sizeof(auto_save));
+    AppPersonChangeSinks person_change_sinks;
+    person_change_sinks.tree = &tree;
+    person_change_sinks.render_state = &render_state;
+    person_change_sinks.journal = NULL;
+    app_state_set_person_change_listener(&app_state, app_person_changed, &person_change_sinks);
     bool auto_save_ready = false;
     char auto_save_error[256];
     auto_save_error[0] = '\0';
@@ -1292,11 +1413,25 @@ static int app_run(AtLogger *logger, const AppLaunchOptions *options)
     auto_save_config.user_data = &tree;
     auto_save_config.path = APP_AUTO_SAVE_PATH;
     auto_save_config.interval_seconds = settings.auto_save_interval_seconds;
-    if (persistence_auto_save_init(&auto_save, &auto_save_config, auto_save_error, sizeof(auto_save_error)))
+    if (auto_save_blocked)
+    {
+        AT_LOG(logger, AT_LOG_WARN, "Auto-save disabled until the last session's edits are recovered.");
+    }
+    else if (persistence_auto_save_init(&auto_save, &auto_save_config, auto_save_error, sizeof(auto_save_error)))
     {
         auto_save_ready = true;
         persistence_auto_save_set_enabled(&auto_save, settings.auto_save_enabled);
         persistence_auto_save_mark_dirty(&auto_save);
+        if (persistence_auto_save_enable_journal(&auto_save, APP_AUTO_SAVE_JOURNAL_COMPACTION, auto_save_error,
+                                                 sizeof(auto_save_error)))
+        {
+            person_change_sinks.journal = &auto_save;
+        }
+        else
+        {
+            AT_LOG(logger, AT_LOG_WARN, "Auto-save journal unavailable (%s).", auto_save_error);
+            auto_save_error[0] = '\0';
+        }
     }
     else
     {
@@ -1309,12 +1444,16 @@ static int app_run(AtLogger *logger, const AppLaunchOptions *options)
     UIContext ui;
     bool ui_ready = ui_init(&ui, graphics_state.width, graphics_state.height);
     AT_LOG_WARN_IF(logger, !ui_ready, "UI overlay unavailable; Nuklear or raylib might be missing.");
+    if (ui_ready)
+    {
+        (void)ui_set_texture_residency(&ui, &texture_residency);
+    }
 
     if (tree_loaded_from_asset || tree_loaded_from_cli)
     {
         app_state_clear_tree_dirty(&app_state);
     }
-    else if (placeholder_used)
+    else if (placeholder_used || tree_recovered)
     {
         app_state_mark_tree_dirty(&app_state);
     }
@@ -1391,6 +1530,7 @@ static int app_run(AtLogger *logger, const AppLaunchOptions *options)
     while (!WindowShouldClose())
     {
         float delta_seconds = GetFrameTime();
+        texture_residency_begin_frame(&texture_residency);
         event_context.render_ready = render_ready;
         event_context.ui = ui_ready ? &ui : NULL;
         shortcut_payload.ui = event_context.ui;
@@ -1457,6 +1597,10 @@ static int app_run(AtLogger *logger, const AppLaunchOptions *options)
                 AT_LOG(logger, AT_LOG_WARN, "Auto-save tick failed: %s", auto_save_error);
                 auto_save_error[0] = '\0';
             }
+            else if (auto_save.last_event == PERSISTENCE_AUTO_SAVE_EVENT_COMPLETED)
+            {
+                AT_LOG(logger, AT_LOG_DEBUG, "Auto-save written to %s.", APP_AUTO_SAVE_PATH);
+            }
         }
     }
 
@@ -1473,6 +1617,7 @@ static int app_run(AtLogger *logger, const AppLaunchOptions *options)
     EnableCursor();
     ui_cleanup(&ui);
     render_cleanup(&render_state);
+    texture_residency_shutdown(&texture_residency);
     app_state_shutdown(&app_state);
     layout_result_destroy(&layout);
     family_tree_destroy(tree);
@@ -1,12 +1,159 @@
 #include "persistence.h"
 
+#include "at_memory.h"
 #include "at_string.h"
+#include "at_thread.h"
 #include "persistence_internal.h"
 
 #include <assert.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
-static bool persistence_auto_save_perform_save(PersistenceAutoSave *state, char *error_buffer, size_t error_buffer_size)
+struct PersistenceAutoSaveJob
+{
+    AtThread thread;
+    AtMutex mutex;
+    FamilyTree *snapshot;
+    char *path;
+    bool finished;
+    bool succeeded;
+    char error[256];
+};
+
+static void persistence_auto_save_job_destroy(PersistenceAutoSaveJob *job)
+{
+    if (!job)
+    {
+        return;
+    }
+    at_mutex_destroy(&job->mutex);
+    family_tree_destroy(job->snapshot);
+    AT_FREE(job->path);
+    AT_FREE(job);
+}
+
+/* Runs on the writer thread: only touches the immutable snapshot and job-owned buffers. */
+static void persistence_auto_save_job_run(void *user_data)
+{
+    PersistenceAutoSaveJob *job = (PersistenceAutoSaveJob *)user_data;
+    char error[256];
+    error[0] = '\0';
+    bool success = family_tree_validate(job->snapshot, error, sizeof(error)) &&
+                   persistence_tree_write_atomic(job->snapshot, job->path, error, sizeof(error));
+    at_mutex_lock(&job->mutex);
+    job->succeeded = success;
+    (void)snprintf(job->error, sizeof(job->error), "%s", error);
+    job->finished = true;
+    at_mutex_unlock(&job->mutex);
+}
+
+static PersistenceAutoSaveJob *persistence_auto_save_job_create(FamilyTree *snapshot, const char *path)
+{
+    PersistenceAutoSaveJob *job = AT_CALLOC(1U, sizeof(PersistenceAutoSaveJob));
+    if (!job)
+    {
+        return NULL;
+    }
+    at_mutex_init(&job->mutex);
+    job->path = at_string_dup(path);
+    if (!job->path)
+    {
+        persistence_auto_save_job_destroy(job);
+        return NULL;
+    }
+    job->snapshot = snapshot;
+    return job;
+}
+
+/* Joins the writer when it has finished (or unconditionally when blocking) and reports its outcome. */
+static bool persistence_auto_save_collect(PersistenceAutoSave *state, bool blocking, char *error_buffer,
+                                          size_t error_buffer_size)
+{
+    PersistenceAutoSaveJob *job = state->job;
+    if (!job)
+    {
+        return true;
+    }
+    if (!blocking)
+    {
+        at_mutex_lock(&job->mutex);
+        bool finished = job->finished;
+        at_mutex_unlock(&job->mutex);
+        if (!finished)
+        {
+            return true;
+        }
+    }
+    (void)at_thread_join(&job->thread);
+    bool succeeded = job->succeeded;
+    if (!succeeded)
+    {
+        (void)persistence_set_error_message(error_buffer, error_buffer_size,
+                                            job->error[0] != '\0' ? job->error : "background auto-save failed");
+        state->dirty = true;
+        state->snapshot_required = true;
+    }
+    else if (state->journal_enabled)
+    {
+        succeeded = persistence_journal_reset(&state->journal, error_buffer, error_buffer_size);
+    }
+    state->last_event = succeeded ? PERSISTENCE_AUTO_SAVE_EVENT_COMPLETED : PERSISTENCE_AUTO_SAVE_EVENT_FAILED;
+    state->job = NULL;
+    persistence_auto_save_job_destroy(job);
+    return succeeded;
+}
+
+static bool persistence_auto_save_start_job(PersistenceAutoSave *state, FamilyTree *tree, char *error_buffer,
+                                            size_t error_buffer_size)
+{
+    FamilyTree *snapshot = family_tree_clone(tree);
+    if (!snapshot)
+    {
+        return persistence_set_error_message(error_buffer, error_buffer_size,
+                                             "failed to snapshot tree for auto-save");
+    }
+    PersistenceAutoSaveJob *job = persistence_auto_save_job_create(snapshot, state->path);
+    if (!job)
+    {
+        family_tree_destroy(snapshot);
+        return persistence_set_error_message(error_buffer, error_buffer_size, "failed to allocate auto-save job");
+    }
+    if (!at_thread_start(&job->thread, persistence_auto_save_job_run, job))
+    {
+        persistence_auto_save_job_destroy(job);
+        return persistence_set_error_message(error_buffer, error_buffer_size, "failed to start auto-save writer");
+    }
+    state->job = job;
+    state->dirty = false;
+    state->snapshot_required = false;
+    state->elapsed_seconds = 0.0;
+    state->last_event = PERSISTENCE_AUTO_SAVE_EVENT_STARTED;
+    return true;
+}
+
+/*
+ * Brings the journal in line with the snapshot about to be written. When the journal fully describes the
+ * dirty state it is flushed first, so a crash after the snapshot lands replays only records it already
+ * contains; otherwise it no longer matches the tree and is dropped before the snapshot replaces the old one.
+ */
+static bool persistence_auto_save_prepare_compaction(PersistenceAutoSave *state, char *error_buffer,
+                                                     size_t error_buffer_size)
+{
+    if (!state->journal_enabled)
+    {
+        return true;
+    }
+    if (state->snapshot_required)
+    {
+        persistence_journal_discard_pending(&state->journal);
+        return persistence_journal_reset(&state->journal, error_buffer, error_buffer_size);
+    }
+    return persistence_journal_flush(&state->journal, error_buffer, error_buffer_size);
+}
+
+static bool persistence_auto_save_perform_save(PersistenceAutoSave *state, bool allow_background,
+                                               char *error_buffer, size_t error_buffer_size)
 {
     if (!state)
     {
@@ -25,12 +172,43 @@ static bool persistence_auto_save_perform_save(PersistenceAutoSave *state, char
     {
         return persistence_set_error_message(error_buffer, error_buffer_size, "tree supplier returned NULL");
     }
+    if (state->journal_enabled && !state->snapshot_required &&
+        state->journal.committed_records + state->journal.pending_records < state->compaction_threshold)
+    {
+        if (!persistence_journal_flush(&state->journal, error_buffer, error_buffer_size))
+        {
+            state->last_event = PERSISTENCE_AUTO_SAVE_EVENT_FAILED;
+            return false;
+        }
+        state->dirty = false;
+        state->elapsed_seconds = 0.0;
+        state->last_event = PERSISTENCE_AUTO_SAVE_EVENT_COMPLETED;
+        return true;
+    }
+    if (!persistence_auto_save_prepare_compaction(state, error_buffer, error_buffer_size))
+    {
+        state->last_event = PERSISTENCE_AUTO_SAVE_EVENT_FAILED;
+        return false;
+    }
+    if (allow_background && state->background)
+    {
+        return persistence_auto_save_start_job(state, tree, error_buffer, error_buffer_size);
+    }
     if (!persistence_tree_save(tree, state->path, error_buffer, error_buffer_size))
     {
+        state->snapshot_required = true;
+        state->last_event = PERSISTENCE_AUTO_SAVE_EVENT_FAILED;
+        return false;
+    }
+    if (state->journal_enabled && !persistence_journal_reset(&state->journal, error_buffer, error_buffer_size))
+    {
+        state->last_event = PERSISTENCE_AUTO_SAVE_EVENT_FAILED;
         return false;
     }
     state->dirty = false;
+    state->snapshot_required = false;
     state->elapsed_seconds = 0.0;
+    state->last_event = PERSISTENCE_AUTO_SAVE_EVENT_COMPLETED;
     return true;
 }
 
@@ -67,6 +245,13 @@ bool persistence_auto_save_init(PersistenceAutoSave *state, const PersistenceAut
     state->elapsed_seconds = 0.0;
     state->enabled = true;
     state->dirty = false;
+    state->background = true;
+    state->job = NULL;
+    state->last_event = PERSISTENCE_AUTO_SAVE_EVENT_NONE;
+    memset(&state->journal, 0, sizeof(state->journal));
+    state->journal_enabled = false;
+    state->snapshot_required = false;
+    state->compaction_threshold = 0U;
     return true;
 }
 
@@ -76,6 +261,9 @@ void persistence_auto_save_shutdown(PersistenceAutoSave *state)
     {
         return;
     }
+    (void)persistence_auto_save_collect(state, true, NULL, 0U);
+    persistence_journal_shutdown(&state->journal);
+    state->journal_enabled = false;
     free(state->path);
     state->path = NULL;
     state->tree_supplier = NULL;
@@ -93,7 +281,56 @@ void persistence_auto_save_mark_dirty(PersistenceAutoSave *state)
         return;
     }
     state->dirty = true;
+    state->snapshot_required = true;
+    state->elapsed_seconds = 0.0;
+}
+
+bool persistence_auto_save_enable_journal(PersistenceAutoSave *state, size_t compaction_threshold,
+                                          char *error_buffer, size_t error_buffer_size)
+{
+    if (!state)
+    {
+        return persistence_set_error_message(error_buffer, error_buffer_size, "auto-save state pointer is NULL");
+    }
+    if (compaction_threshold == 0U)
+    {
+        return persistence_set_error_message(error_buffer, error_buffer_size,
+                                             "compaction threshold must be positive");
+    }
+    PersistenceJournal journal;
+    if (!persistence_journal_init(&journal, state->path, error_buffer, error_buffer_size))
+    {
+        return false;
+    }
+    persistence_journal_shutdown(&state->journal);
+    state->journal = journal;
+    state->journal_enabled = true;
+    state->compaction_threshold = compaction_threshold;
+    /* A journal left on disk belongs to whatever snapshot was there before; only a fresh one is trusted. */
+    state->snapshot_required = true;
+    return true;
+}
+
+bool persistence_auto_save_record_change(PersistenceAutoSave *state, PersistenceJournalOperation operation,
+                                         const Person *person, char *error_buffer, size_t error_buffer_size)
+{
+    if (!state)
+    {
+        return persistence_set_error_message(error_buffer, error_buffer_size, "auto-save state pointer is NULL");
+    }
+    if (!state->journal_enabled || state->snapshot_required)
+    {
+        persistence_auto_save_mark_dirty(state);
+        return true;
+    }
+    if (!persistence_journal_record(&state->journal, operation, person, error_buffer, error_buffer_size))
+    {
+        persistence_auto_save_mark_dirty(state);
+        return false;
+    }
+    state->dirty = true;
     state->elapsed_seconds = 0.0;
+    return true;
 }
 
 bool persistence_auto_save_tick(PersistenceAutoSave *state, double delta_seconds, char *error_buffer,
@@ -107,6 +344,12 @@ bool persistence_auto_save_tick(PersistenceAutoSave *state, double delta_seconds
     {
         return persistence_set_error_message(error_buffer, error_buffer_size, "delta time cannot be negative");
     }
+    state->last_event = PERSISTENCE_AUTO_SAVE_EVENT_NONE;
+    if (state->job)
+    {
+        /* A snapshot is still being written; never queue a second one behind it. */
+        return persistence_auto_save_collect(state, false, error_buffer, error_buffer_size);
+    }
     if (!state->enabled)
     {
         return true;
@@ -125,7 +368,7 @@ bool persistence_auto_save_tick(PersistenceAutoSave *state, double delta_seconds
     {
         return true;
     }
-    return persistence_auto_save_perform_save(state, error_buffer, error_buffer_size);
+    return persistence_auto_save_perform_save(state, true, error_buffer, error_buffer_size);
 }
 
 bool persistence_auto_save_flush(PersistenceAutoSave *state, char *error_buffer, size_t error_buffer_size)
@@ -134,11 +377,35 @@ bool persistence_auto_save_flush(PersistenceAutoSave *state, char *error_buffer,
     {
         return persistence_set_error_message(error_buffer, error_buffer_size, "auto-save state pointer is NULL");
     }
+    bool pending_ok = persistence_auto_save_collect(state, true, error_buffer, error_buffer_size);
     if (!state->dirty)
     {
-        return true;
+        return pending_ok;
+    }
+    return persistence_auto_save_perform_save(state, false, error_buffer, error_buffer_size);
+}
+
+bool persistence_auto_save_wait(PersistenceAutoSave *state, char *error_buffer, size_t error_buffer_size)
+{
+    if (!state)
+    {
+        return persistence_set_error_message(error_buffer, error_buffer_size, "auto-save state pointer is NULL");
+    }
+    return persistence_auto_save_collect(state, true, error_buffer, error_buffer_size);
+}
+
+bool persistence_auto_save_is_busy(const PersistenceAutoSave *state)
+{
+    return state && state->job != NULL;
+}
+
+void persistence_auto_save_set_background(PersistenceAutoSave *state, bool background)
+{
+    if (!state)
+    {
+        return;
     }
-    return persistence_auto_save_perform_save(state, error_buffer, error_buffer_size);
+    state->background = background;
 }
 
 bool persistence_auto_save_update_path(PersistenceAutoSave *state, const char *path, char *error_buffer,
@@ -157,6 +424,18 @@ bool persistence_auto_save_update_path(PersistenceAutoSave *state, const char *p
     {
         return persistence_set_error_message(error_buffer, error_buffer_size, "failed to duplicate auto-save path");
     }
+    if (state->journal_enabled)
+    {
+        PersistenceJournal journal;
+        if (!persistence_journal_init(&journal, copy, error_buffer, error_buffer_size))
+        {
+            free(copy);
+            return false;
+        }
+        persistence_journal_shutdown(&state->journal);
+        state->journal = journal;
+        state->snapshot_required = true;
+    }
     free(state->path);
     state->path = copy;
     state->elapsed_seconds = 0.0;
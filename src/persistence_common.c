@@ -1,3 +1,7 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include "persistence_internal.h"
 #include "at_memory.h"
 
@@ -6,9 +10,15 @@
 #include <stdlib.h>
 #include <string.h>
 
-#if defined(_MSC_VER)
+#if defined(_WIN32)
 #include <io.h>
 #endif
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 bool persistence_set_error_message(char *buffer, size_t buffer_size, const char *message)
 {
@@ -21,71 +31,6 @@ bool persistence_set_error_message(char *buffer, size_t buffer_size, const char
     return false;
 }
 
-bool persistence_utf8_validate(const char *value)
-{
-    if (!value)
-    {
-        return true;
-    }
-    const unsigned char *cursor = (const unsigned char *)value;
-    while (*cursor != '\0')
-    {
-        unsigned char byte = *cursor;
-        if (byte < 0x80U)
-        {
-            cursor++;
-            continue;
-        }
-        if ((byte & 0xE0U) == 0xC0U)
-        {
-            unsigned char b1 = cursor[1];
-            if (b1 == '\0' || byte < 0xC2U || (b1 & 0xC0U) != 0x80U)
-            {
-                return false;
-            }
-            cursor += 2U;
-            continue;
-        }
-        if ((byte & 0xF0U) == 0xE0U)
-        {
-            unsigned char b1 = cursor[1];
-            unsigned char b2 = cursor[2];
-            if (b1 == '\0' || b2 == '\0' || (b1 & 0xC0U) != 0x80U || (b2 & 0xC0U) != 0x80U)
-            {
-                return false;
-            }
-            unsigned int codepoint = ((byte & 0x0FU) << 12) | ((b1 & 0x3FU) << 6) | (b2 & 0x3FU);
-            if (codepoint < 0x800U || (codepoint >= 0xD800U && codepoint <= 0xDFFFU))
-            {
-                return false;
-            }
-            cursor += 3U;
-            continue;
-        }
-        if ((byte & 0xF8U) == 0xF0U)
-        {
-            unsigned char b1 = cursor[1];
-            unsigned char b2 = cursor[2];
-            unsigned char b3 = cursor[3];
-            if (b1 == '\0' || b2 == '\0' || b3 == '\0' || (b1 & 0xC0U) != 0x80U ||
-                (b2 & 0xC0U) != 0x80U || (b3 & 0xC0U) != 0x80U)
-            {
-                return false;
-            }
-            unsigned int codepoint = ((byte & 0x07U) << 18) | ((b1 & 0x3FU) << 12) | ((b2 & 0x3FU) << 6) |
-                                     (b3 & 0x3FU);
-            if (codepoint < 0x10000U || codepoint > 0x10FFFFU)
-            {
-                return false;
-            }
-            cursor += 4U;
-            continue;
-        }
-        return false;
-    }
-    return true;
-}
-
 void persistence_format_errno(char *buffer, size_t buffer_size, const char *prefix, const char *path)
 {
     if (!buffer || buffer_size == 0U)
@@ -128,6 +73,25 @@ int persistence_portable_fopen(FILE **stream, const char *path, const char *mode
 #endif
 }
 
+char *persistence_path_with_suffix(const char *path, const char *suffix)
+{
+    size_t path_length = strlen(path);
+    size_t suffix_length = strlen(suffix);
+    char *result = (char *)AT_MALLOC(path_length + suffix_length + 1U);
+    if (!result)
+    {
+        return NULL;
+    }
+    memcpy(result, path, path_length);
+    memcpy(result + path_length, suffix, suffix_length + 1U);
+    return result;
+}
+
+/*
+ * Preserves the current file as "<path>.bak" without copying its bytes: a hard link shares the existing data
+ * and survives the rename that replaces path. Filesystems without hard links fall back to moving the file
+ * aside, which callers immediately follow with persistence_replace_file.
+ */
 bool persistence_create_backup_if_needed(const char *path, char *error_buffer, size_t error_buffer_size)
 {
     if (!path)
@@ -135,75 +99,196 @@ bool persistence_create_backup_if_needed(const char *path, char *error_buffer, s
         return persistence_set_error_message(error_buffer, error_buffer_size, "path pointer is NULL");
     }
 
-    FILE *source = NULL;
-    int open_result = persistence_portable_fopen(&source, path, "rb");
-    if (open_result != 0)
+    char *backup_path = persistence_path_with_suffix(path, ".bak");
+    if (!backup_path)
     {
-        if (open_result == ENOENT)
+        return persistence_set_error_message(error_buffer, error_buffer_size, "failed to allocate backup path");
+    }
+    if (remove(backup_path) != 0 && errno != ENOENT)
+    {
+        persistence_format_errno(error_buffer, error_buffer_size, "failed to remove stale backup", backup_path);
+        AT_FREE(backup_path);
+        return false;
+    }
+
+    bool success = true;
+#if defined(_WIN32)
+    if (!CreateHardLinkA(backup_path, path, NULL))
+    {
+        DWORD link_error = GetLastError();
+        if (link_error != ERROR_FILE_NOT_FOUND && link_error != ERROR_PATH_NOT_FOUND &&
+            !MoveFileExA(path, backup_path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
         {
-            return true;
+            char message[512];
+            (void)snprintf(message, sizeof(message), "failed to create backup %s (error %lu)", backup_path,
+                           (unsigned long)GetLastError());
+            success = persistence_set_error_message(error_buffer, error_buffer_size, message);
         }
-        persistence_format_errno(error_buffer, error_buffer_size, "failed to open for backup", path);
+    }
+#else
+    if (link(path, backup_path) != 0 && errno != ENOENT && rename(path, backup_path) != 0)
+    {
+        persistence_format_errno(error_buffer, error_buffer_size, "failed to create backup", backup_path);
+        success = false;
+    }
+#endif
+    AT_FREE(backup_path);
+    return success;
+}
+
+bool persistence_replace_file(const char *source_path, const char *destination_path, char *error_buffer,
+                              size_t error_buffer_size)
+{
+    if (!source_path || !destination_path)
+    {
+        return persistence_set_error_message(error_buffer, error_buffer_size, "path pointer is NULL");
+    }
+#if defined(_WIN32)
+    if (!MoveFileExA(source_path, destination_path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+    {
+        char message[512];
+        (void)snprintf(message, sizeof(message), "failed to replace %s (error %lu)", destination_path,
+                       (unsigned long)GetLastError());
+        return persistence_set_error_message(error_buffer, error_buffer_size, message);
+    }
+#else
+    if (rename(source_path, destination_path) != 0)
+    {
+        persistence_format_errno(error_buffer, error_buffer_size, "failed to replace", destination_path);
         return false;
     }
+#endif
+    return true;
+}
 
-    size_t path_length = strlen(path);
-    const char *suffix = ".bak";
-    size_t suffix_length = strlen(suffix);
-    char *backup_path = (char *)AT_MALLOC(path_length + suffix_length + 1U);
-    if (!backup_path)
+bool persistence_read_file(const char *path, char **out_contents, size_t *out_length, char *error_buffer,
+                           size_t error_buffer_size)
+{
+    if (!path || !out_contents)
     {
-        fclose(source);
-        return persistence_set_error_message(error_buffer, error_buffer_size, "failed to allocate backup path");
+        return persistence_set_error_message(error_buffer, error_buffer_size, "invalid read arguments");
+    }
+    FILE *stream = NULL;
+    if (persistence_portable_fopen(&stream, path, "rb") != 0)
+    {
+        persistence_format_errno(error_buffer, error_buffer_size, "failed to open", path);
+        return false;
     }
-    memcpy(backup_path, path, path_length);
-    memcpy(backup_path + path_length, suffix, suffix_length + 1U);
+    if (fseek(stream, 0L, SEEK_END) != 0)
+    {
+        persistence_format_errno(error_buffer, error_buffer_size, "failed to seek", path);
+        fclose(stream);
+        return false;
+    }
+    long size = ftell(stream);
+    if (size < 0L)
+    {
+        persistence_format_errno(error_buffer, error_buffer_size, "failed to tell", path);
+        fclose(stream);
+        return false;
+    }
+    rewind(stream);
+    char *contents = malloc((size_t)size + 1U);
+    if (!contents)
+    {
+        persistence_set_error_message(error_buffer, error_buffer_size, "failed to allocate buffer");
+        fclose(stream);
+        return false;
+    }
+    size_t read = fread(contents, 1U, (size_t)size, stream);
+    fclose(stream);
+    if (read != (size_t)size)
+    {
+        free(contents);
+        persistence_set_error_message(error_buffer, error_buffer_size, "failed to read file");
+        return false;
+    }
+    contents[size] = '\0';
+    *out_contents = contents;
+    if (out_length)
+    {
+        *out_length = (size_t)size;
+    }
+    return true;
+}
 
-    FILE *destination = NULL;
-    int dest_result = persistence_portable_fopen(&destination, backup_path, "wb");
-    if (dest_result != 0)
+bool persistence_sync_stream(FILE *stream, const char *path, char *error_buffer, size_t error_buffer_size)
+{
+    if (!stream)
     {
-        persistence_format_errno(error_buffer, error_buffer_size, "failed to create backup", backup_path);
-        AT_FREE(backup_path);
-        fclose(source);
+        return persistence_set_error_message(error_buffer, error_buffer_size, "stream pointer is NULL");
+    }
+    if (fflush(stream) != 0)
+    {
+        persistence_format_errno(error_buffer, error_buffer_size, "failed to flush", path);
         return false;
     }
+#if defined(_WIN32)
+    if (_commit(_fileno(stream)) != 0)
+#else
+    if (fsync(fileno(stream)) != 0)
+#endif
+    {
+        persistence_format_errno(error_buffer, error_buffer_size, "failed to sync", path);
+        return false;
+    }
+    return true;
+}
 
-    unsigned char buffer[4096];
-    bool success = true;
-    while (success)
+/* Best effort: makes a completed rename durable by syncing the directory entry that points at the new file. */
+static void persistence_sync_parent_directory(const char *path)
+{
+#if defined(_WIN32)
+    (void)path;
+#else
+    const char *separator = strrchr(path, '/');
+    char directory[1024];
+    if (!separator)
     {
-        size_t read_bytes = fread(buffer, 1U, sizeof(buffer), source);
-        if (read_bytes > 0U)
-        {
-            if (fwrite(buffer, 1U, read_bytes, destination) != read_bytes)
-            {
-                persistence_format_errno(error_buffer, error_buffer_size, "failed to write backup", backup_path);
-                success = false;
-                break;
-            }
-        }
-        if (read_bytes < sizeof(buffer))
-        {
-            if (ferror(source))
-            {
-                persistence_format_errno(error_buffer, error_buffer_size, "failed to read source for backup", path);
-                success = false;
-            }
-            break;
-        }
+        (void)snprintf(directory, sizeof(directory), ".");
+    }
+    else if ((size_t)(separator - path) < sizeof(directory))
+    {
+        size_t length = separator == path ? 1U : (size_t)(separator - path);
+        memcpy(directory, path, length);
+        directory[length] = '\0';
     }
+    else
+    {
+        return;
+    }
+    int descriptor = open(directory, O_RDONLY);
+    if (descriptor >= 0)
+    {
+        (void)fsync(descriptor);
+        (void)close(descriptor);
+    }
+#endif
+}
 
-    if (fclose(destination) != 0)
+bool persistence_tree_write_atomic(const struct FamilyTree *tree, const char *path, char *error_buffer,
+                                   size_t error_buffer_size)
+{
+    if (!tree || !path)
     {
-        persistence_format_errno(error_buffer, error_buffer_size, "failed to close backup", backup_path);
-        success = false;
+        return persistence_set_error_message(error_buffer, error_buffer_size, "invalid save arguments");
     }
-    if (fclose(source) != 0)
+    char *temp_path = persistence_path_with_suffix(path, ".tmp");
+    if (!temp_path)
     {
-        persistence_format_errno(error_buffer, error_buffer_size, "failed to close source", path);
-        success = false;
+        return persistence_set_error_message(error_buffer, error_buffer_size, "failed to allocate temp path");
     }
-    AT_FREE(backup_path);
+    bool success = persistence_tree_write_file(tree, temp_path, error_buffer, error_buffer_size) &&
+                   persistence_create_backup_if_needed(path, error_buffer, error_buffer_size) &&
+                   persistence_replace_file(temp_path, path, error_buffer, error_buffer_size);
+    if (success)
+    {
+        persistence_sync_parent_directory(path);
+    }
+    else
+    {
+        (void)remove(temp_path);
+    }
+    AT_FREE(temp_path);
     return success;
 }
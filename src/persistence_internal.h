@@ -5,16 +5,41 @@
 #include <stddef.h>
 #include <stdio.h>
 
+#include "persistence_utf8.h"
+
+struct FamilyTree;
+struct JsonValue;
+struct Person;
+
 #ifdef __cplusplus
 extern "C"
 {
 #endif
 
     bool persistence_set_error_message(char *buffer, size_t buffer_size, const char *message);
-    bool persistence_utf8_validate(const char *value);
     void persistence_format_errno(char *buffer, size_t buffer_size, const char *prefix, const char *path);
     int persistence_portable_fopen(FILE **stream, const char *path, const char *mode);
+    /* Returns "<path><suffix>" in an AT_MALLOC'd buffer (release with AT_FREE). */
+    char *persistence_path_with_suffix(const char *path, const char *suffix);
     bool persistence_create_backup_if_needed(const char *path, char *error_buffer, size_t error_buffer_size);
+    bool persistence_replace_file(const char *source_path, const char *destination_path, char *error_buffer,
+                                  size_t error_buffer_size);
+    bool persistence_tree_write_file(const struct FamilyTree *tree, const char *path, char *error_buffer,
+                                     size_t error_buffer_size);
+    /* Writes "<path>.tmp", syncs it, keeps the previous file as "<path>.bak" and renames the temp over path. */
+    bool persistence_tree_write_atomic(const struct FamilyTree *tree, const char *path, char *error_buffer,
+                                       size_t error_buffer_size);
+    /* Reads a whole file into a NUL-terminated malloc'd buffer (release with free). */
+    bool persistence_read_file(const char *path, char **out_contents, size_t *out_length, char *error_buffer,
+                               size_t error_buffer_size);
+    /* Flushes stdio buffers and forces the file contents to stable storage. */
+    bool persistence_sync_stream(FILE *stream, const char *path, char *error_buffer, size_t error_buffer_size);
+    /* Serialises a single person object into an AT_MALLOC'd buffer (release with AT_FREE). */
+    bool persistence_person_serialize(const struct Person *person, char **out_text, size_t *out_length,
+                                      char *error_buffer, size_t error_buffer_size);
+    /* Builds a detached person from its archive object; relationship arrays are left empty. */
+    struct Person *persistence_person_from_json(const struct JsonValue *person_object, char *error_buffer,
+                                                size_t error_buffer_size);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,572 @@
+#include "persistence.h"
+
+#include "json_parser.h"
+#include "persistence_internal.h"
+
+#include "at_memory.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Journal layout: a sequence of framed records, each "@<length> <fnv1a32>\n<json>\n". Every record carries
+ * the full state it assigns (a whole person for add, the editable fields for edit, an id for delete), so
+ * replaying a journal over a snapshot that already contains some of its records converges on the same
+ * tree. A torn tail left by a crash fails its frame check and ends the replay.
+ */
+
+#define PERSISTENCE_JOURNAL_SUFFIX ".journal"
+
+static uint32_t persistence_journal_checksum(const char *data, size_t length)
+{
+    uint32_t hash = 2166136261U;
+    for (size_t index = 0U; index < length; ++index)
+    {
+        hash ^= (unsigned char)data[index];
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+static bool persistence_journal_reserve(PersistenceJournal *journal, size_t additional)
+{
+    size_t required = journal->pending_length + additional;
+    if (required <= journal->pending_capacity)
+    {
+        return true;
+    }
+    size_t capacity = journal->pending_capacity == 0U ? 1024U : journal->pending_capacity;
+    while (capacity < required)
+    {
+        capacity *= 2U;
+    }
+    char *resized = at_secure_realloc(journal->pending, capacity, sizeof(char));
+    if (!resized)
+    {
+        return false;
+    }
+    journal->pending = resized;
+    journal->pending_capacity = capacity;
+    return true;
+}
+
+static bool persistence_journal_append(PersistenceJournal *journal, const char *data, size_t length)
+{
+    if (!persistence_journal_reserve(journal, length))
+    {
+        return false;
+    }
+    memcpy(journal->pending + journal->pending_length, data, length);
+    journal->pending_length += length;
+    return true;
+}
+
+static bool persistence_journal_append_text(PersistenceJournal *journal, const char *text)
+{
+    return persistence_journal_append(journal, text, strlen(text));
+}
+
+bool persistence_journal_init(PersistenceJournal *journal, const char *snapshot_path, char *error_buffer,
+                              size_t error_buffer_size)
+{
+    if (!journal)
+    {
+        return persistence_set_error_message(error_buffer, error_buffer_size, "journal pointer is NULL");
+    }
+    if (!snapshot_path || snapshot_path[0] == '\0')
+    {
+        return persistence_set_error_message(error_buffer, error_buffer_size, "snapshot path must be provided");
+    }
+    memset(journal, 0, sizeof(PersistenceJournal));
+    size_t path_length = strlen(snapshot_path);
+    size_t suffix_length = strlen(PERSISTENCE_JOURNAL_SUFFIX);
+    journal->path = AT_MALLOC(path_length + suffix_length + 1U);
+    if (!journal->path)
+    {
+        return persistence_set_error_message(error_buffer, error_buffer_size, "failed to allocate journal path");
+    }
+    memcpy(journal->path, snapshot_path, path_length);
+    memcpy(journal->path + path_length, PERSISTENCE_JOURNAL_SUFFIX, suffix_length + 1U);
+    return true;
+}
+
+void persistence_journal_shutdown(PersistenceJournal *journal)
+{
+    if (!journal)
+    {
+        return;
+    }
+    AT_FREE(journal->path);
+    AT_FREE(journal->pending);
+    memset(journal, 0, sizeof(PersistenceJournal));
+}
+
+bool persistence_journal_record(PersistenceJournal *journal, PersistenceJournalOperation operation,
+                                const Person *person, char *error_buffer, size_t error_buffer_size)
+{
+    if (!journal || !journal->path)
+    {
+        return persistence_set_error_message(error_buffer, error_buffer_size, "journal is not initialised");
+    }
+    if (!person)
+    {
+        return persistence_set_error_message(error_buffer, error_buffer_size, "person pointer is NULL");
+    }
+
+    char *person_text = NULL;
+    size_t person_length = 0U;
+    char prefix[64];
+    switch (operation)
+    {
+    case PERSISTENCE_JOURNAL_ADD:
+    case PERSISTENCE_JOURNAL_EDIT:
+        if (!persistence_person_serialize(person, &person_text, &person_length, error_buffer, error_buffer_size))
+        {
+            return false;
+        }
+        (void)snprintf(prefix, sizeof(prefix), "{\"op\": \"%s\", \"person\": ",
+                       operation == PERSISTENCE_JOURNAL_ADD ? "add" : "edit");
+        break;
+    case PERSISTENCE_JOURNAL_DELETE:
+        (void)snprintf(prefix, sizeof(prefix), "{\"op\": \"delete\", \"id\": %u", person->id);
+        break;
+    default:
+        return persistence_set_error_message(error_buffer, error_buffer_size, "unknown journal operation");
+    }
+
+    size_t prefix_length = strlen(prefix);
+    size_t payload_length = prefix_length + person_length + 1U;
+    char *payload = AT_MALLOC(payload_length);
+    if (!payload)
+    {
+        AT_FREE(person_text);
+        return persistence_set_error_message(error_buffer, error_buffer_size, "failed to allocate journal record");
+    }
+    memcpy(payload, prefix, prefix_length);
+    if (person_text)
+    {
+        memcpy(payload + prefix_length, person_text, person_length);
+    }
+    payload[payload_length - 1U] = '}';
+    AT_FREE(person_text);
+
+    char header[48];
+    (void)snprintf(header, sizeof(header), "@%lu %08lx\n", (unsigned long)payload_length,
+                   (unsigned long)persistence_journal_checksum(payload, payload_length));
+    size_t rollback_length = journal->pending_length;
+    bool appended = persistence_journal_append_text(journal, header) &&
+                    persistence_journal_append(journal, payload, payload_length) &&
+                    persistence_journal_append_text(journal, "\n");
+    AT_FREE(payload);
+    if (!appended)
+    {
+        journal->pending_length = rollback_length;
+        return persistence_set_error_message(error_buffer, error_buffer_size, "failed to buffer journal record");
+    }
+    journal->pending_records++;
+    return true;
+}
+
+bool persistence_journal_flush(PersistenceJournal *journal, char *error_buffer, size_t error_buffer_size)
+{
+    if (!journal || !journal->path)
+    {
+        return persistence_set_error_message(error_buffer, error_buffer_size, "journal is not initialised");
+    }
+    if (journal->pending_records == 0U)
+    {
+        return true;
+    }
+    FILE *stream = NULL;
+    if (persistence_portable_fopen(&stream, journal->path, "ab") != 0)
+    {
+        persistence_format_errno(error_buffer, error_buffer_size, "failed to open", journal->path);
+        return false;
+    }
+    bool success = fwrite(journal->pending, 1U, journal->pending_length, stream) == journal->pending_length;
+    if (!success)
+    {
+        persistence_format_errno(error_buffer, error_buffer_size, "failed to append", journal->path);
+    }
+    else
+    {
+        success = persistence_sync_stream(stream, journal->path, error_buffer, error_buffer_size);
+    }
+    if (fclose(stream) != 0 && success)
+    {
+        persistence_format_errno(error_buffer, error_buffer_size, "failed to close", journal->path);
+        success = false;
+    }
+    if (!success)
+    {
+        return false;
+    }
+    journal->committed_records += journal->pending_records;
+    journal->pending_records = 0U;
+    journal->pending_length = 0U;
+    return true;
+}
+
+void persistence_journal_discard_pending(PersistenceJournal *journal)
+{
+    if (!journal)
+    {
+        return;
+    }
+    journal->pending_records = 0U;
+    journal->pending_length = 0U;
+}
+
+bool persistence_journal_reset(PersistenceJournal *journal, char *error_buffer, size_t error_buffer_size)
+{
+    if (!journal || !journal->path)
+    {
+        return persistence_set_error_message(error_buffer, error_buffer_size, "journal is not initialised");
+    }
+    if (remove(journal->path) != 0 && errno != ENOENT)
+    {
+        persistence_format_errno(error_buffer, error_buffer_size, "failed to remove", journal->path);
+        return false;
+    }
+    journal->committed_records = 0U;
+    return true;
+}
+
+static Person *persistence_journal_find_reference(FamilyTree *tree, const JsonValue *value)
+{
+    uint32_t identifier = 0U;
+    if (!value || !json_value_get_uint32(value, &identifier) || identifier == 0U)
+    {
+        return NULL;
+    }
+    return family_tree_find_person(tree, identifier);
+}
+
+static void persistence_journal_drop_person(FamilyTree *tree, uint32_t id)
+{
+    Person *existing = family_tree_find_person(tree, id);
+    if (!existing)
+    {
+        return;
+    }
+    family_tree_unlink_person(tree, existing);
+    if (family_tree_extract_person(tree, id))
+    {
+        person_destroy(existing);
+    }
+}
+
+/* Links only to people present in the tree; references to absent people are dropped like a delete would. */
+static bool persistence_journal_link_person(FamilyTree *tree, Person *person, const JsonValue *person_object)
+{
+    const JsonValue *parents_array = json_value_object_get(person_object, "parents");
+    if (parents_array && json_value_type(parents_array) == JSON_VALUE_ARRAY)
+    {
+        size_t count = json_value_array_size(parents_array);
+        for (size_t index = 0U; index < count && index < 2U; ++index)
+        {
+            Person *parent = persistence_journal_find_reference(tree, json_value_array_get(parents_array, index));
+            if (!parent || parent == person)
+            {
+                continue;
+            }
+            if (!person_set_parent(person, parent, (PersonParentSlot)index) || !person_add_child(parent, person))
+            {
+                return false;
+            }
+        }
+    }
+    const JsonValue *children_array = json_value_object_get(person_object, "children");
+    if (children_array && json_value_type(children_array) == JSON_VALUE_ARRAY)
+    {
+        size_t count = json_value_array_size(children_array);
+        for (size_t index = 0U; index < count; ++index)
+        {
+            Person *child = persistence_journal_find_reference(tree, json_value_array_get(children_array, index));
+            if (child && child != person && !person_add_child(person, child))
+            {
+                return false;
+            }
+        }
+    }
+    const JsonValue *spouses_array = json_value_object_get(person_object, "spouses");
+    if (spouses_array && json_value_type(spouses_array) == JSON_VALUE_ARRAY)
+    {
+        size_t count = json_value_array_size(spouses_array);
+        for (size_t index = 0U; index < count; ++index)
+        {
+            const JsonValue *entry = json_value_array_get(spouses_array, index);
+            Person *spouse = persistence_journal_find_reference(tree, json_value_object_get(entry, "id"));
+            if (!spouse || spouse == person)
+            {
+                continue;
+            }
+            const char *marriage_date = json_value_get_string(json_value_object_get(entry, "marriage_date"));
+            const char *marriage_location = json_value_get_string(json_value_object_get(entry, "marriage_location"));
+            if (!person_add_spouse(person, spouse) ||
+                !person_set_marriage(person, spouse, marriage_date, marriage_location))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool persistence_journal_apply_add(FamilyTree *tree, const JsonValue *person_object, char *error_buffer,
+                                          size_t error_buffer_size)
+{
+    Person *person = persistence_person_from_json(person_object, error_buffer, error_buffer_size);
+    if (!person)
+    {
+        return false;
+    }
+    persistence_journal_drop_person(tree, person->id);
+    if (!family_tree_add_person(tree, person))
+    {
+        person_destroy(person);
+        return persistence_set_error_message(error_buffer, error_buffer_size, "failed to add journaled person");
+    }
+    if (!persistence_journal_link_person(tree, person, person_object))
+    {
+        return persistence_set_error_message(error_buffer, error_buffer_size, "failed to link journaled person");
+    }
+    return true;
+}
+
+static bool persistence_journal_apply_edit(FamilyTree *tree, const JsonValue *person_object, char *error_buffer,
+                                           size_t error_buffer_size)
+{
+    Person *edited = persistence_person_from_json(person_object, error_buffer, error_buffer_size);
+    if (!edited)
+    {
+        return false;
+    }
+    Person *target = family_tree_find_person(tree, edited->id);
+    bool success = true;
+    if (target)
+    {
+        success = person_set_name(target, edited->name.first, edited->name.middle, edited->name.last) &&
+                  person_set_birth(target, edited->dates.birth_date, edited->dates.birth_location) &&
+                  person_set_death(target, edited->dates.death_date, edited->dates.death_location);
+        family_tree_note_person_edited(tree, target);
+    }
+    person_destroy(edited);
+    if (!success)
+    {
+        return persistence_set_error_message(error_buffer, error_buffer_size, "failed to apply journaled edit");
+    }
+    return true;
+}
+
+static bool persistence_journal_apply(FamilyTree *tree, const JsonValue *record, char *error_buffer,
+                                      size_t error_buffer_size)
+{
+    const char *operation = json_value_get_string(json_value_object_get(record, "op"));
+    if (!operation)
+    {
+        return persistence_set_error_message(error_buffer, error_buffer_size, "journal record lacks operation");
+    }
+    if (strcmp(operation, "add") == 0)
+    {
+        return persistence_journal_apply_add(tree, json_value_object_get(record, "person"), error_buffer,
+                                             error_buffer_size);
+    }
+    if (strcmp(operation, "edit") == 0)
+    {
+        return persistence_journal_apply_edit(tree, json_value_object_get(record, "person"), error_buffer,
+                                              error_buffer_size);
+    }
+    if (strcmp(operation, "delete") == 0)
+    {
+        uint32_t identifier = 0U;
+        if (!json_value_get_uint32(json_value_object_get(record, "id"), &identifier) || identifier == 0U)
+        {
+            return persistence_set_error_message(error_buffer, error_buffer_size, "journal delete lacks id");
+        }
+        persistence_journal_drop_person(tree, identifier);
+        return true;
+    }
+    return persistence_set_error_message(error_buffer, error_buffer_size, "unknown journal operation");
+}
+
+bool persistence_journal_replay(FamilyTree *tree, const char *journal_path, size_t *out_applied,
+                                char *error_buffer, size_t error_buffer_size)
+{
+    if (out_applied)
+    {
+        *out_applied = 0U;
+    }
+    if (!tree || !journal_path)
+    {
+        return persistence_set_error_message(error_buffer, error_buffer_size, "invalid replay arguments");
+    }
+    FILE *probe = NULL;
+    int open_result = persistence_portable_fopen(&probe, journal_path, "rb");
+    if (open_result != 0)
+    {
+        if (open_result == ENOENT)
+        {
+            return true;
+        }
+        persistence_format_errno(error_buffer, error_buffer_size, "failed to open", journal_path);
+        return false;
+    }
+    fclose(probe);
+
+    char *contents = NULL;
+    size_t length = 0U;
+    if (!persistence_read_file(journal_path, &contents, &length, error_buffer, error_buffer_size))
+    {
+        return false;
+    }
+
+    size_t applied = 0U;
+    size_t offset = 0U;
+    bool success = true;
+    while (offset < length && contents[offset] == '@')
+    {
+        char *cursor = NULL;
+        unsigned long payload_length = strtoul(contents + offset + 1U, &cursor, 10);
+        if (!cursor || *cursor != ' ')
+        {
+            break;
+        }
+        unsigned long expected_checksum = strtoul(cursor + 1, &cursor, 16);
+        if (!cursor || *cursor != '\n')
+        {
+            break;
+        }
+        char *payload = cursor + 1;
+        size_t payload_offset = (size_t)(payload - contents);
+        if (payload_length > length - payload_offset || length - payload_offset - payload_length < 1U ||
+            payload[payload_length] != '\n' ||
+            persistence_journal_checksum(payload, (size_t)payload_length) != (uint32_t)expected_checksum)
+        {
+            break;
+        }
+        payload[payload_length] = '\0';
+        JsonValue *record = json_parse(payload, error_buffer, error_buffer_size, NULL, NULL);
+        if (!record)
+        {
+            success = false;
+            break;
+        }
+        success = persistence_journal_apply(tree, record, error_buffer, error_buffer_size);
+        json_value_destroy(record);
+        if (!success)
+        {
+            break;
+        }
+        applied++;
+        offset = payload_offset + (size_t)payload_length + 1U;
+    }
+    free(contents);
+    if (out_applied)
+    {
+        *out_applied = applied;
+    }
+    return success;
+}
+
+FamilyTree *persistence_tree_recover(const char *path, size_t *out_replayed, char *error_buffer,
+                                     size_t error_buffer_size)
+{
+    if (out_replayed)
+    {
+        *out_replayed = 0U;
+    }
+    FamilyTree *tree = persistence_tree_load(path, error_buffer, error_buffer_size);
+    if (!tree)
+    {
+        return NULL;
+    }
+    PersistenceJournal journal;
+    if (!persistence_journal_init(&journal, path, error_buffer, error_buffer_size))
+    {
+        family_tree_destroy(tree);
+        return NULL;
+    }
+    bool replayed = persistence_journal_replay(tree, journal.path, out_replayed, error_buffer, error_buffer_size) &&
+                    family_tree_validate(tree, error_buffer, error_buffer_size);
+    persistence_journal_shutdown(&journal);
+    if (!replayed)
+    {
+        family_tree_destroy(tree);
+        return NULL;
+    }
+    return tree;
+}
+
+/* Moves the journal to "<journal>.unrecovered", where no auto-save touches it, and says in error_buffer where it
+ * ended up after the reason already there. */
+static void persistence_journal_set_aside(const PersistenceJournal *journal, char *error_buffer,
+                                          size_t error_buffer_size)
+{
+    char reason[256];
+    (void)snprintf(reason, sizeof(reason), "%s", (error_buffer && error_buffer_size > 0U) ? error_buffer : "");
+    char *aside = persistence_path_with_suffix(journal->path, ".unrecovered");
+    char ignored[128];
+    bool moved = aside && persistence_replace_file(journal->path, aside, ignored, sizeof(ignored));
+    if (error_buffer && error_buffer_size > 0U)
+    {
+        (void)snprintf(error_buffer, error_buffer_size, "%s; journal %s %s", reason, moved ? "kept as" : "left at",
+                       moved ? aside : journal->path);
+    }
+    AT_FREE(aside);
+}
+
+bool persistence_journal_recover_pending(const char *path, FamilyTree **out_tree, size_t *out_replayed,
+                                         char *error_buffer, size_t error_buffer_size)
+{
+    if (out_replayed)
+    {
+        *out_replayed = 0U;
+    }
+    if (!out_tree)
+    {
+        return persistence_set_error_message(error_buffer, error_buffer_size, "tree output pointer is NULL");
+    }
+    *out_tree = NULL;
+    PersistenceJournal journal;
+    if (!persistence_journal_init(&journal, path, error_buffer, error_buffer_size))
+    {
+        return false;
+    }
+    FILE *stream = NULL;
+    if (persistence_portable_fopen(&stream, journal.path, "rb") != 0)
+    {
+        persistence_journal_shutdown(&journal);
+        return true;
+    }
+    fclose(stream);
+
+    size_t replayed = 0U;
+    FamilyTree *tree = persistence_tree_recover(path, &replayed, error_buffer, error_buffer_size);
+    if (!tree || (replayed > 0U && !persistence_tree_save(tree, path, error_buffer, error_buffer_size)))
+    {
+        /* Left in place, the journal would be compacted away by the first auto-save snapshot. */
+        persistence_journal_set_aside(&journal, error_buffer, error_buffer_size);
+        family_tree_destroy(tree);
+        persistence_journal_shutdown(&journal);
+        return false;
+    }
+    /* Replay is idempotent, so a journal that survives this removal only costs a redundant replay next time. */
+    char ignored[128];
+    (void)persistence_journal_reset(&journal, ignored, sizeof(ignored));
+    persistence_journal_shutdown(&journal);
+    if (replayed == 0U)
+    {
+        family_tree_destroy(tree);
+        return true;
+    }
+    if (out_replayed)
+    {
+        *out_replayed = replayed;
+    }
+    *out_tree = tree;
+    return true;
+}
@@ -5,6 +5,7 @@
 
 #include "at_memory.h"
 #include "at_string.h"
+#include "tree_builder.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -14,6 +15,7 @@ typedef struct LoadContext
     char *error_buffer;
     size_t error_buffer_size;
     FamilyTree *tree;
+    FamilyTreeBuilder *builder; /* Set while loading a whole tree; links are queued on it by id. */
 } LoadContext;
 
 static bool assign_string(char **target, const char *value)
@@ -230,8 +232,7 @@ static bool load_person_timeline(Person *person, const JsonValue *timeline_array
     return true;
 }
 
-static bool populate_person_relationships(const JsonValue *person_object, Person *person, FamilyTree *tree,
-                                          LoadContext *ctx)
+static bool populate_person_relationships(const JsonValue *person_object, const Person *person, LoadContext *ctx)
 {
     const JsonValue *children_array = json_value_object_get(person_object, "children");
     if (children_array && json_value_type(children_array) == JSON_VALUE_ARRAY)
@@ -240,13 +241,12 @@ static bool populate_person_relationships(const JsonValue *person_object, Person
         for (size_t index = 0; index < count; ++index)
         {
             const JsonValue *child_value = json_value_array_get(children_array, index);
-            double child_id = 0.0;
-            if (!child_value || !json_value_get_number(child_value, &child_id))
+            uint32_t child_id = 0U;
+            if (!child_value || !json_value_get_uint32(child_value, &child_id))
             {
                 return ctx_set_error(ctx, "child ID must be numeric");
             }
-            Person *child = family_tree_find_person(tree, (uint32_t)child_id);
-            if (!child || !person_add_child(person, child))
+            if (!family_tree_builder_add_child(ctx->builder, person->id, child_id))
             {
                 return ctx_set_error(ctx, "invalid child reference");
             }
@@ -270,16 +270,14 @@ static bool populate_person_relationships(const JsonValue *person_object, Person
             }
             if (json_value_type(parent_value) == JSON_VALUE_NULL)
             {
-                person->parents[index] = NULL;
                 continue;
             }
-            double parent_id = 0.0;
-            if (!json_value_get_number(parent_value, &parent_id))
+            uint32_t parent_id = 0U;
+            if (!json_value_get_uint32(parent_value, &parent_id))
             {
                 return ctx_set_error(ctx, "parent ID must be numeric");
             }
-            Person *parent = family_tree_find_person(tree, (uint32_t)parent_id);
-            if (!parent || !person_set_parent(person, parent, (PersonParentSlot)index))
+            if (!family_tree_builder_set_parent(ctx->builder, person->id, parent_id, (PersonParentSlot)index))
             {
                 return ctx_set_error(ctx, "invalid parent reference");
             }
@@ -297,16 +295,11 @@ static bool populate_person_relationships(const JsonValue *person_object, Person
             {
                 return ctx_set_error(ctx, "spouse entry must be object");
             }
-            double spouse_id = 0.0;
-            if (!json_value_get_number(json_value_object_get(spouse_entry, "id"), &spouse_id))
+            uint32_t spouse_id = 0U;
+            if (!json_value_get_uint32(json_value_object_get(spouse_entry, "id"), &spouse_id))
             {
                 return ctx_set_error(ctx, "spouse ID must be numeric");
             }
-            Person *spouse = family_tree_find_person(tree, (uint32_t)spouse_id);
-            if (!spouse || !person_add_spouse(person, spouse))
-            {
-                return ctx_set_error(ctx, "invalid spouse reference");
-            }
             const char *marriage_date = json_value_get_string(json_value_object_get(spouse_entry, "marriage_date"));
             const char *marriage_location = json_value_get_string(json_value_object_get(spouse_entry, "marriage_location"));
             if ((marriage_date && !persistence_utf8_validate(marriage_date)) ||
@@ -314,9 +307,10 @@ static bool populate_person_relationships(const JsonValue *person_object, Person
             {
                 return ctx_set_error(ctx, "spouse metadata contains invalid UTF-8");
             }
-            if (!person_set_marriage(person, spouse, marriage_date, marriage_location))
+            if (!family_tree_builder_add_spouse(ctx->builder, person->id, spouse_id, marriage_date,
+                                                marriage_location))
             {
-                return ctx_set_error(ctx, "failed to assign marriage metadata");
+                return ctx_set_error(ctx, "invalid spouse reference");
             }
         }
     }
@@ -348,7 +342,7 @@ static bool populate_person_asset_lists(Person *person, const JsonValue *person_
         {
             return ctx_set_error(ctx, "profile image contains invalid UTF-8");
         }
-        if (!assign_string(&person->profile_image_path, profile_image))
+        if (!person_set_profile_image(person, profile_image))
         {
             return ctx_set_error(ctx, "failed to assign profile image");
         }
@@ -356,17 +350,19 @@ static bool populate_person_asset_lists(Person *person, const JsonValue *person_
     return true;
 }
 
-static bool populate_person(const JsonValue *person_object, LoadContext *ctx)
+static Person *build_person(const JsonValue *person_object, LoadContext *ctx)
 {
-    double identifier = 0.0;
-    if (!json_value_get_number(json_value_object_get(person_object, "id"), &identifier))
+    uint32_t identifier = 0U;
+    if (!json_value_get_uint32(json_value_object_get(person_object, "id"), &identifier))
     {
-        return ctx_set_error(ctx, "person id must be numeric");
+        (void)ctx_set_error(ctx, "person id must be numeric");
+        return NULL;
     }
-    Person *person = person_create((uint32_t)identifier);
+    Person *person = ctx->tree ? family_tree_create_person(ctx->tree, identifier) : person_create(identifier);
     if (!person)
     {
-        return ctx_set_error(ctx, "failed to allocate person");
+        (void)ctx_set_error(ctx, "failed to allocate person");
+        return NULL;
     }
 
     const JsonValue *name_object = json_value_object_get(person_object, "name");
@@ -374,7 +370,7 @@ static bool populate_person(const JsonValue *person_object, LoadContext *ctx)
         !load_person_name(person, name_object, ctx))
     {
         person_destroy(person);
-        return false;
+        return NULL;
     }
 
     const JsonValue *dates_object = json_value_object_get(person_object, "dates");
@@ -382,27 +378,27 @@ static bool populate_person(const JsonValue *person_object, LoadContext *ctx)
         !load_person_dates(person, dates_object, ctx))
     {
         person_destroy(person);
-        return false;
+        return NULL;
     }
 
     const JsonValue *timeline_array = json_value_object_get(person_object, "timeline");
     if (timeline_array && !load_person_timeline(person, timeline_array, ctx))
     {
         person_destroy(person);
-        return false;
+        return NULL;
     }
 
     const JsonValue *metadata_object = json_value_object_get(person_object, "metadata");
     if (metadata_object && !load_person_metadata(person, metadata_object, ctx))
     {
         person_destroy(person);
-        return false;
+        return NULL;
     }
 
     if (!populate_person_asset_lists(person, person_object, ctx))
     {
         person_destroy(person);
-        return false;
+        return NULL;
     }
 
     const JsonValue *is_alive_value = json_value_object_get(person_object, "is_alive");
@@ -412,10 +408,21 @@ static bool populate_person(const JsonValue *person_object, LoadContext *ctx)
         if (!is_alive && !person_set_death(person, person->dates.death_date, person->dates.death_location))
         {
             person_destroy(person);
-            return ctx_set_error(ctx, "invalid death information");
+            (void)ctx_set_error(ctx, "invalid death information");
+            return NULL;
         }
     }
-    if (!family_tree_add_person(ctx->tree, person))
+    return person;
+}
+
+static bool populate_person(const JsonValue *person_object, LoadContext *ctx)
+{
+    Person *person = build_person(person_object, ctx);
+    if (!person)
+    {
+        return false;
+    }
+    if (!family_tree_builder_add_person(ctx->builder, person))
     {
         person_destroy(person);
         return ctx_set_error(ctx, "failed to add person to tree");
@@ -423,6 +430,21 @@ static bool populate_person(const JsonValue *person_object, LoadContext *ctx)
     return true;
 }
 
+Person *persistence_person_from_json(const JsonValue *person_object, char *error_buffer, size_t error_buffer_size)
+{
+    if (!person_object || json_value_type(person_object) != JSON_VALUE_OBJECT)
+    {
+        (void)persistence_set_error_message(error_buffer, error_buffer_size, "person entry must be object");
+        return NULL;
+    }
+    LoadContext ctx;
+    ctx.error_buffer = error_buffer;
+    ctx.error_buffer_size = error_buffer_size;
+    ctx.tree = NULL;
+    ctx.builder = NULL;
+    return build_person(person_object, &ctx);
+}
+
 static bool load_tree_metadata(const JsonValue *metadata_object, LoadContext *ctx)
 {
     if (!metadata_object || json_value_type(metadata_object) != JSON_VALUE_OBJECT)
@@ -449,42 +471,11 @@ static bool load_tree_metadata(const JsonValue *metadata_object, LoadContext *ct
 
 FamilyTree *persistence_tree_load(const char *path, char *error_buffer, size_t error_buffer_size)
 {
-    FILE *stream = NULL;
-    if (persistence_portable_fopen(&stream, path, "rb") != 0)
-    {
-        persistence_format_errno(error_buffer, error_buffer_size, "failed to open", path);
-        return NULL;
-    }
-    if (fseek(stream, 0L, SEEK_END) != 0)
-    {
-        persistence_format_errno(error_buffer, error_buffer_size, "failed to seek", path);
-        fclose(stream);
-        return NULL;
-    }
-    long size = ftell(stream);
-    if (size < 0L)
+    char *contents = NULL;
+    if (!persistence_read_file(path, &contents, NULL, error_buffer, error_buffer_size))
     {
-        persistence_format_errno(error_buffer, error_buffer_size, "failed to tell", path);
-        fclose(stream);
         return NULL;
     }
-    rewind(stream);
-    char *contents = malloc((size_t)size + 1U);
-    if (!contents)
-    {
-        persistence_set_error_message(error_buffer, error_buffer_size, "failed to allocate buffer");
-        fclose(stream);
-        return NULL;
-    }
-    size_t read = fread(contents, 1U, (size_t)size, stream);
-    fclose(stream);
-    if (read != (size_t)size)
-    {
-        free(contents);
-        persistence_set_error_message(error_buffer, error_buffer_size, "failed to read file");
-        return NULL;
-    }
-    contents[size] = '\0';
 
     int error_line = 0;
     int error_column = 0;
@@ -495,13 +486,19 @@ FamilyTree *persistence_tree_load(const char *path, char *error_buffer, size_t e
         return NULL;
     }
 
+    const JsonValue *persons_array = json_value_object_get(root, "persons");
+    size_t person_count = persons_array && json_value_type(persons_array) == JSON_VALUE_ARRAY
+                              ? json_value_array_size(persons_array)
+                              : 0U;
     LoadContext ctx;
     ctx.error_buffer = error_buffer;
     ctx.error_buffer_size = error_buffer_size;
-    ctx.tree = family_tree_create(NULL);
+    ctx.builder = family_tree_builder_create(NULL, person_count, person_count * 2U);
+    ctx.tree = family_tree_builder_tree(ctx.builder);
     if (!ctx.tree)
     {
         json_value_destroy(root);
+        family_tree_builder_destroy(ctx.builder);
         persistence_set_error_message(error_buffer, error_buffer_size, "failed to allocate tree");
         return NULL;
     }
@@ -510,20 +507,18 @@ FamilyTree *persistence_tree_load(const char *path, char *error_buffer, size_t e
     if (!load_tree_metadata(metadata_object, &ctx))
     {
         json_value_destroy(root);
-        family_tree_destroy(ctx.tree);
+        family_tree_builder_destroy(ctx.builder);
         return NULL;
     }
 
-    const JsonValue *persons_array = json_value_object_get(root, "persons");
     if (!persons_array || json_value_type(persons_array) != JSON_VALUE_ARRAY)
     {
         json_value_destroy(root);
-        family_tree_destroy(ctx.tree);
+        family_tree_builder_destroy(ctx.builder);
         persistence_set_error_message(error_buffer, error_buffer_size, "persons section missing");
         return NULL;
     }
 
-    size_t person_count = json_value_array_size(persons_array);
     for (size_t index = 0; index < person_count; ++index)
     {
         const JsonValue *person_object = json_value_array_get(persons_array, index);
@@ -531,30 +526,23 @@ FamilyTree *persistence_tree_load(const char *path, char *error_buffer, size_t e
             !populate_person(person_object, &ctx))
         {
             json_value_destroy(root);
-            family_tree_destroy(ctx.tree);
+            family_tree_builder_destroy(ctx.builder);
             return NULL;
         }
     }
 
+    /* Links are queued by id and resolved in one pass by the builder, which also validates once. */
     for (size_t index = 0; index < person_count; ++index)
     {
         const JsonValue *person_object = json_value_array_get(persons_array, index);
-        Person *person = ctx.tree->persons[index];
-        if (!populate_person_relationships(person_object, person, ctx.tree, &ctx))
+        if (!populate_person_relationships(person_object, ctx.tree->persons[index], &ctx))
         {
             json_value_destroy(root);
-            family_tree_destroy(ctx.tree);
+            family_tree_builder_destroy(ctx.builder);
             return NULL;
         }
     }
 
     json_value_destroy(root);
-
-    if (!family_tree_validate(ctx.tree, error_buffer, error_buffer_size))
-    {
-        family_tree_destroy(ctx.tree);
-        return NULL;
-    }
-
-    return ctx.tree;
+    return family_tree_builder_finish(ctx.builder, NULL, error_buffer, error_buffer_size);
 }
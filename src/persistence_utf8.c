@@ -0,0 +1,381 @@
+#include "persistence_utf8.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define PERSISTENCE_UTF8_X86 1
+#define PERSISTENCE_UTF8_TARGET(isa) __attribute__((target(isa)))
+#include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define PERSISTENCE_UTF8_X86 1
+#define PERSISTENCE_UTF8_TARGET(isa)
+#include <immintrin.h>
+#include <intrin.h>
+#else
+#define PERSISTENCE_UTF8_X86 0
+#endif
+
+bool persistence_utf8_validate_scalar(const char *data, size_t length)
+{
+    if (!data)
+    {
+        return length == 0U;
+    }
+    const unsigned char *cursor = (const unsigned char *)data;
+    const unsigned char *end = cursor + length;
+    while (cursor < end)
+    {
+        unsigned char byte = *cursor;
+        if (byte < 0x80U)
+        {
+            cursor++;
+            continue;
+        }
+        size_t remaining = (size_t)(end - cursor);
+        if ((byte & 0xE0U) == 0xC0U)
+        {
+            if (remaining < 2U || byte < 0xC2U || (cursor[1] & 0xC0U) != 0x80U)
+            {
+                return false;
+            }
+            cursor += 2U;
+            continue;
+        }
+        if ((byte & 0xF0U) == 0xE0U)
+        {
+            if (remaining < 3U || (cursor[1] & 0xC0U) != 0x80U || (cursor[2] & 0xC0U) != 0x80U)
+            {
+                return false;
+            }
+            unsigned int codepoint = ((byte & 0x0FU) << 12) | ((cursor[1] & 0x3FU) << 6) | (cursor[2] & 0x3FU);
+            if (codepoint < 0x800U || (codepoint >= 0xD800U && codepoint <= 0xDFFFU))
+            {
+                return false;
+            }
+            cursor += 3U;
+            continue;
+        }
+        if ((byte & 0xF8U) == 0xF0U)
+        {
+            if (remaining < 4U || (cursor[1] & 0xC0U) != 0x80U || (cursor[2] & 0xC0U) != 0x80U ||
+                (cursor[3] & 0xC0U) != 0x80U)
+            {
+                return false;
+            }
+            unsigned int codepoint = ((byte & 0x07U) << 18) | ((cursor[1] & 0x3FU) << 12) |
+                                     ((cursor[2] & 0x3FU) << 6) | (cursor[3] & 0x3FU);
+            if (codepoint < 0x10000U || codepoint > 0x10FFFFU)
+            {
+                return false;
+            }
+            cursor += 4U;
+            continue;
+        }
+        return false;
+    }
+    return true;
+}
+
+#if PERSISTENCE_UTF8_X86
+
+/*
+ * Block validator after Keiser & Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte" (2021).
+ * Each byte is classified by three nibble lookups over (previous byte high, previous byte low, current byte
+ * high); the AND of the three yields the error bits for that two-byte window. Continuations owed to 3- and
+ * 4-byte leads further back are checked separately. Pure-ASCII blocks only need the carried-over check.
+ */
+#define UTF8_TOO_SHORT (1U << 0)
+#define UTF8_TOO_LONG (1U << 1)
+#define UTF8_OVERLONG_3 (1U << 2)
+#define UTF8_TOO_LARGE (1U << 3)
+#define UTF8_SURROGATE (1U << 4)
+#define UTF8_OVERLONG_2 (1U << 5)
+#define UTF8_TOO_LARGE_1000 (1U << 6)
+#define UTF8_OVERLONG_4 (1U << 6)
+#define UTF8_TWO_CONTS (1U << 7)
+#define UTF8_CARRY (UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS)
+
+#define UTF8_BYTE_1_HIGH_TABLE                                                                                     \
+    (char)UTF8_TOO_LONG, (char)UTF8_TOO_LONG, (char)UTF8_TOO_LONG, (char)UTF8_TOO_LONG, (char)UTF8_TOO_LONG,     \
+        (char)UTF8_TOO_LONG, (char)UTF8_TOO_LONG, (char)UTF8_TOO_LONG, (char)UTF8_TWO_CONTS,                    \
+        (char)UTF8_TWO_CONTS, (char)UTF8_TWO_CONTS, (char)UTF8_TWO_CONTS,                                        \
+        (char)(UTF8_TOO_SHORT | UTF8_OVERLONG_2), (char)UTF8_TOO_SHORT,                                          \
+        (char)(UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE),                                               \
+        (char)(UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4)
+
+#define UTF8_BYTE_1_LOW_TABLE                                                                                      \
+    (char)(UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4), (char)(UTF8_CARRY | UTF8_OVERLONG_2), \
+        (char)UTF8_CARRY, (char)UTF8_CARRY, (char)(UTF8_CARRY | UTF8_TOO_LARGE),                                 \
+        (char)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),                                               \
+        (char)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),                                               \
+        (char)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),                                               \
+        (char)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),                                               \
+        (char)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),                                               \
+        (char)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),                                               \
+        (char)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),                                               \
+        (char)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),                                               \
+        (char)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE),                              \
+        (char)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),                                               \
+        (char)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000)
+
+#define UTF8_BYTE_2_HIGH_TABLE                                                                                     \
+    (char)UTF8_TOO_SHORT, (char)UTF8_TOO_SHORT, (char)UTF8_TOO_SHORT, (char)UTF8_TOO_SHORT,                      \
+        (char)UTF8_TOO_SHORT, (char)UTF8_TOO_SHORT, (char)UTF8_TOO_SHORT, (char)UTF8_TOO_SHORT,                  \
+        (char)(UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE_1000 |        \
+               UTF8_OVERLONG_4),                                                                                 \
+        (char)(UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE),             \
+        (char)(UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE),              \
+        (char)(UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE),              \
+        (char)UTF8_TOO_SHORT, (char)UTF8_TOO_SHORT, (char)UTF8_TOO_SHORT, (char)UTF8_TOO_SHORT
+
+/* Bytes at the end of a block that still expect continuations: any lead of a sequence cut off by the edge. */
+#define UTF8_INCOMPLETE_TAIL_16                                                                                    \
+    (char)0xFF, (char)0xFF, (char)0xFF, (char)0xFF, (char)0xFF, (char)0xFF, (char)0xFF, (char)0xFF, (char)0xFF,  \
+        (char)0xFF, (char)0xFF, (char)0xFF, (char)0xFF, (char)(0xF0U - 1U), (char)(0xE0U - 1U),                 \
+        (char)(0xC0U - 1U)
+
+PERSISTENCE_UTF8_TARGET("sse4.1")
+static __m128i utf8_sse_check_block(__m128i input, __m128i previous)
+{
+    const __m128i low_nibble = _mm_set1_epi8(0x0F);
+    const __m128i byte_1_high_table = _mm_setr_epi8(UTF8_BYTE_1_HIGH_TABLE);
+    const __m128i byte_1_low_table = _mm_setr_epi8(UTF8_BYTE_1_LOW_TABLE);
+    const __m128i byte_2_high_table = _mm_setr_epi8(UTF8_BYTE_2_HIGH_TABLE);
+
+    __m128i prev1 = _mm_alignr_epi8(input, previous, 15);
+    __m128i byte_1_high = _mm_shuffle_epi8(byte_1_high_table, _mm_and_si128(_mm_srli_epi16(prev1, 4), low_nibble));
+    __m128i byte_1_low = _mm_shuffle_epi8(byte_1_low_table, _mm_and_si128(prev1, low_nibble));
+    __m128i byte_2_high = _mm_shuffle_epi8(byte_2_high_table, _mm_and_si128(_mm_srli_epi16(input, 4), low_nibble));
+    __m128i special_cases = _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+
+    __m128i prev2 = _mm_alignr_epi8(input, previous, 14);
+    __m128i prev3 = _mm_alignr_epi8(input, previous, 13);
+    __m128i is_third_byte = _mm_subs_epu8(prev2, _mm_set1_epi8((char)(0xE0U - 0x80U)));
+    __m128i is_fourth_byte = _mm_subs_epu8(prev3, _mm_set1_epi8((char)(0xF0U - 0x80U)));
+    __m128i must_be_continuation = _mm_and_si128(_mm_or_si128(is_third_byte, is_fourth_byte),
+                                                 _mm_set1_epi8((char)0x80));
+    return _mm_xor_si128(must_be_continuation, special_cases);
+}
+
+PERSISTENCE_UTF8_TARGET("sse4.1")
+static bool utf8_validate_sse(const char *data, size_t length)
+{
+    const __m128i incomplete_tail = _mm_setr_epi8(UTF8_INCOMPLETE_TAIL_16);
+    __m128i error = _mm_setzero_si128();
+    __m128i previous = _mm_setzero_si128();
+    __m128i previous_incomplete = _mm_setzero_si128();
+    size_t offset = 0U;
+    unsigned char tail[16];
+    while (offset < length)
+    {
+        __m128i input;
+        if (length - offset >= 16U)
+        {
+            input = _mm_loadu_si128((const __m128i *)(const void *)(data + offset));
+        }
+        else
+        {
+            memset(tail, 0, sizeof(tail));
+            memcpy(tail, data + offset, length - offset);
+            input = _mm_loadu_si128((const __m128i *)(const void *)tail);
+        }
+        if (_mm_movemask_epi8(input) == 0)
+        {
+            error = _mm_or_si128(error, previous_incomplete);
+            previous_incomplete = _mm_setzero_si128();
+        }
+        else
+        {
+            error = _mm_or_si128(error, utf8_sse_check_block(input, previous));
+            previous_incomplete = _mm_subs_epu8(input, incomplete_tail);
+        }
+        previous = input;
+        offset += 16U;
+    }
+    error = _mm_or_si128(error, previous_incomplete);
+    return _mm_testz_si128(error, error) != 0;
+}
+
+PERSISTENCE_UTF8_TARGET("avx2")
+static __m256i utf8_avx2_prev(__m256i input, __m256i previous, int count)
+{
+    __m256i shifted = _mm256_permute2x128_si256(previous, input, 0x21);
+    switch (count)
+    {
+    case 1:
+        return _mm256_alignr_epi8(input, shifted, 15);
+    case 2:
+        return _mm256_alignr_epi8(input, shifted, 14);
+    default:
+        return _mm256_alignr_epi8(input, shifted, 13);
+    }
+}
+
+PERSISTENCE_UTF8_TARGET("avx2")
+static __m256i utf8_avx2_check_block(__m256i input, __m256i previous)
+{
+    const __m256i low_nibble = _mm256_set1_epi8(0x0F);
+    const __m256i byte_1_high_table = _mm256_setr_epi8(UTF8_BYTE_1_HIGH_TABLE, UTF8_BYTE_1_HIGH_TABLE);
+    const __m256i byte_1_low_table = _mm256_setr_epi8(UTF8_BYTE_1_LOW_TABLE, UTF8_BYTE_1_LOW_TABLE);
+    const __m256i byte_2_high_table = _mm256_setr_epi8(UTF8_BYTE_2_HIGH_TABLE, UTF8_BYTE_2_HIGH_TABLE);
+
+    __m256i prev1 = utf8_avx2_prev(input, previous, 1);
+    __m256i byte_1_high =
+        _mm256_shuffle_epi8(byte_1_high_table, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), low_nibble));
+    __m256i byte_1_low = _mm256_shuffle_epi8(byte_1_low_table, _mm256_and_si256(prev1, low_nibble));
+    __m256i byte_2_high =
+        _mm256_shuffle_epi8(byte_2_high_table, _mm256_and_si256(_mm256_srli_epi16(input, 4), low_nibble));
+    __m256i special_cases = _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+    __m256i prev2 = utf8_avx2_prev(input, previous, 2);
+    __m256i prev3 = utf8_avx2_prev(input, previous, 3);
+    __m256i is_third_byte = _mm256_subs_epu8(prev2, _mm256_set1_epi8((char)(0xE0U - 0x80U)));
+    __m256i is_fourth_byte = _mm256_subs_epu8(prev3, _mm256_set1_epi8((char)(0xF0U - 0x80U)));
+    __m256i must_be_continuation = _mm256_and_si256(_mm256_or_si256(is_third_byte, is_fourth_byte),
+                                                    _mm256_set1_epi8((char)0x80));
+    return _mm256_xor_si256(must_be_continuation, special_cases);
+}
+
+PERSISTENCE_UTF8_TARGET("avx2")
+static bool utf8_validate_avx2(const char *data, size_t length)
+{
+    const __m256i incomplete_tail =
+        _mm256_setr_epi8((char)0xFF, (char)0xFF, (char)0xFF, (char)0xFF, (char)0xFF, (char)0xFF, (char)0xFF,
+                         (char)0xFF, (char)0xFF, (char)0xFF, (char)0xFF, (char)0xFF, (char)0xFF, (char)0xFF,
+                         (char)0xFF, (char)0xFF, UTF8_INCOMPLETE_TAIL_16);
+    __m256i error = _mm256_setzero_si256();
+    __m256i previous = _mm256_setzero_si256();
+    __m256i previous_incomplete = _mm256_setzero_si256();
+    size_t offset = 0U;
+    unsigned char tail[32];
+    while (offset < length)
+    {
+        __m256i input;
+        if (length - offset >= 32U)
+        {
+            input = _mm256_loadu_si256((const __m256i *)(const void *)(data + offset));
+        }
+        else
+        {
+            memset(tail, 0, sizeof(tail));
+            memcpy(tail, data + offset, length - offset);
+            input = _mm256_loadu_si256((const __m256i *)(const void *)tail);
+        }
+        if (_mm256_movemask_epi8(input) == 0)
+        {
+            error = _mm256_or_si256(error, previous_incomplete);
+            previous_incomplete = _mm256_setzero_si256();
+        }
+        else
+        {
+            error = _mm256_or_si256(error, utf8_avx2_check_block(input, previous));
+            previous_incomplete = _mm256_subs_epu8(input, incomplete_tail);
+        }
+        previous = input;
+        offset += 32U;
+    }
+    error = _mm256_or_si256(error, previous_incomplete);
+    return _mm256_testz_si256(error, error) != 0;
+}
+
+static bool utf8_cpu_supports(PersistenceUtf8Kernel kernel)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    static int cached_features = -1;
+    if (cached_features < 0)
+    {
+        int features = 0;
+        int info[4];
+        __cpuid(info, 1);
+        bool sse41 = (info[2] & (1 << 19)) != 0;
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        bool avx = (info[2] & (1 << 28)) != 0;
+        __cpuidex(info, 7, 0);
+        bool avx2 = (info[1] & (1 << 5)) != 0;
+        if (sse41)
+        {
+            features |= 1;
+        }
+        if (osxsave && avx && avx2 && (_xgetbv(0) & 0x6U) == 0x6U)
+        {
+            features |= 2;
+        }
+        cached_features = features;
+    }
+    return kernel == PERSISTENCE_UTF8_KERNEL_SSE4 ? (cached_features & 1) != 0 : (cached_features & 2) != 0;
+#else
+    return kernel == PERSISTENCE_UTF8_KERNEL_SSE4 ? __builtin_cpu_supports("sse4.1") != 0
+                                                  : __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif /* PERSISTENCE_UTF8_X86 */
+
+bool persistence_utf8_kernel_supported(PersistenceUtf8Kernel kernel)
+{
+    switch (kernel)
+    {
+    case PERSISTENCE_UTF8_KERNEL_SCALAR:
+        return true;
+#if PERSISTENCE_UTF8_X86
+    case PERSISTENCE_UTF8_KERNEL_SSE4:
+    case PERSISTENCE_UTF8_KERNEL_AVX2:
+        return utf8_cpu_supports(kernel);
+#endif
+    default:
+        return false;
+    }
+}
+
+bool persistence_utf8_validate_with(PersistenceUtf8Kernel kernel, const char *data, size_t length)
+{
+    if (!data)
+    {
+        return length == 0U;
+    }
+    switch (kernel)
+    {
+#if PERSISTENCE_UTF8_X86
+    case PERSISTENCE_UTF8_KERNEL_SSE4:
+        return utf8_validate_sse(data, length);
+    case PERSISTENCE_UTF8_KERNEL_AVX2:
+        return utf8_validate_avx2(data, length);
+#endif
+    case PERSISTENCE_UTF8_KERNEL_SCALAR:
+    default:
+        return persistence_utf8_validate_scalar(data, length);
+    }
+}
+
+PersistenceUtf8Kernel persistence_utf8_best_kernel(void)
+{
+    if (persistence_utf8_kernel_supported(PERSISTENCE_UTF8_KERNEL_AVX2))
+    {
+        return PERSISTENCE_UTF8_KERNEL_AVX2;
+    }
+    if (persistence_utf8_kernel_supported(PERSISTENCE_UTF8_KERNEL_SSE4))
+    {
+        return PERSISTENCE_UTF8_KERNEL_SSE4;
+    }
+    return PERSISTENCE_UTF8_KERNEL_SCALAR;
+}
+
+bool persistence_utf8_validate_length(const char *data, size_t length)
+{
+    /* Short strings (most names and dates) finish faster in the scalar loop than a vector setup. */
+    if (length < 16U)
+    {
+        return persistence_utf8_validate_scalar(data, length);
+    }
+    return persistence_utf8_validate_with(persistence_utf8_best_kernel(), data, length);
+}
+
+bool persistence_utf8_validate(const char *value)
+{
+    if (!value)
+    {
+        return true;
+    }
+    return persistence_utf8_validate_length(value, strlen(value));
+}
@@ -2,6 +2,8 @@
 
 #include "persistence_internal.h"
 
+#include "at_memory.h"
+#include "json_parser.h"
 #include "person.h"
 #include "timeline.h"
 #include "tree.h"
@@ -12,6 +14,9 @@
 typedef struct WriteContext
 {
     FILE *stream;
+    char *buffer; /* Used instead of stream when serialising into memory. */
+    size_t length;
+    size_t capacity;
     char *error_buffer;
     size_t error_buffer_size;
 } WriteContext;
@@ -23,33 +28,59 @@ static bool ctx_set_error(WriteContext *ctx, const char *message)
                                          message);
 }
 
-static bool write_indent(WriteContext *ctx, size_t indent)
+static bool write_bytes(WriteContext *ctx, const char *data, size_t length)
 {
-    if (!ctx || !ctx->stream)
+    if (!ctx)
     {
         return false;
     }
-    for (size_t index = 0; index < indent; ++index)
+    if (ctx->stream)
     {
-        if (fputc(' ', ctx->stream) == EOF)
+        if (length > 0U && fwrite(data, 1U, length, ctx->stream) != length)
         {
-            return ctx_set_error(ctx, "failed to write indent");
+            return ctx_set_error(ctx, "failed to write output");
+        }
+        return true;
+    }
+    if (ctx->length + length + 1U > ctx->capacity)
+    {
+        size_t capacity = ctx->capacity == 0U ? 1024U : ctx->capacity;
+        while (capacity < ctx->length + length + 1U)
+        {
+            capacity *= 2U;
+        }
+        char *resized = at_secure_realloc(ctx->buffer, capacity, sizeof(char));
+        if (!resized)
+        {
+            return ctx_set_error(ctx, "failed to grow output buffer");
         }
+        ctx->buffer = resized;
+        ctx->capacity = capacity;
     }
+    memcpy(ctx->buffer + ctx->length, data, length);
+    ctx->length += length;
+    ctx->buffer[ctx->length] = '\0';
     return true;
 }
 
-static bool write_raw(WriteContext *ctx, const char *text)
+static bool write_indent(WriteContext *ctx, size_t indent)
 {
-    if (!ctx || !ctx->stream)
-    {
-        return false;
-    }
-    if (fputs(text, ctx->stream) == EOF)
+    static const char spaces[] = "                                ";
+    while (indent > 0U)
     {
-        return ctx_set_error(ctx, "failed to write output");
+        size_t chunk = indent < sizeof(spaces) - 1U ? indent : sizeof(spaces) - 1U;
+        if (!write_bytes(ctx, spaces, chunk))
+        {
+            return ctx_set_error(ctx, "failed to write indent");
+        }
+        indent -= chunk;
     }
-    return true;
+    return ctx != NULL;
+}
+
+static bool write_raw(WriteContext *ctx, const char *text)
+{
+    return write_bytes(ctx, text, strlen(text));
 }
 
 static bool write_escaped_string(WriteContext *ctx, const char *value)
@@ -60,13 +91,26 @@ static bool write_escaped_string(WriteContext *ctx, const char *value)
     }
     if (value)
     {
-        if (!persistence_utf8_validate(value))
+        size_t length = strlen(value);
+        if (!persistence_utf8_validate_length(value, length))
         {
             return ctx_set_error(ctx, "invalid UTF-8 string");
         }
-        for (const unsigned char *cursor = (const unsigned char *)value; *cursor != '\0'; ++cursor)
+        const char *cursor = value;
+        const char *end = value + length;
+        while (cursor < end)
         {
-            unsigned char character = *cursor;
+            size_t run = json_string_plain_prefix(cursor, (size_t)(end - cursor));
+            if (run > 0U && !write_bytes(ctx, cursor, run))
+            {
+                return ctx_set_error(ctx, "failed to write string");
+            }
+            cursor += run;
+            if (cursor == end)
+            {
+                break;
+            }
+            unsigned char character = (unsigned char)*cursor++;
             switch (character)
             {
             case '"':
@@ -112,24 +156,19 @@ static bool write_escaped_string(WriteContext *ctx, const char *value)
                 }
                 break;
             default:
-                if (character < 0x20U)
-                {
-                    char buffer[7];
-                    (void)snprintf(buffer, sizeof(buffer), "\\u%04x", (unsigned int)character);
-                    if (!write_raw(ctx, buffer))
-                    {
-                        return false;
-                    }
-                }
-                else if (fputc(character, ctx->stream) == EOF)
+            {
+                char buffer[7];
+                (void)snprintf(buffer, sizeof(buffer), "\\u%04x", (unsigned int)character);
+                if (!write_raw(ctx, buffer))
                 {
-                    return ctx_set_error(ctx, "failed to write string");
+                    return false;
                 }
                 break;
             }
+            }
         }
     }
-    if (fputc('"', ctx->stream) == EOF)
+    if (!write_bytes(ctx, "\"", 1U))
     {
         return ctx_set_error(ctx, "failed to close string");
     }
@@ -612,32 +651,62 @@ static bool write_tree_roots(WriteContext *ctx, const FamilyTree *tree)
     return write_raw(ctx, "]");
 }
 
-bool persistence_tree_save(const FamilyTree *tree, const char *path, char *error_buffer, size_t error_buffer_size)
+static bool write_tree_document(WriteContext *ctx, const FamilyTree *tree)
 {
-    WriteContext ctx;
-    ctx.stream = NULL;
-    ctx.error_buffer = error_buffer;
-    ctx.error_buffer_size = error_buffer_size;
-
-    if (!tree)
+    if (!write_raw(ctx, "{\n"))
     {
-        return ctx_set_error(&ctx, "tree pointer is NULL");
+        return false;
     }
-    if (!path)
+    if (!write_indent(ctx, 2U) || !write_raw(ctx, "\"metadata\": {\n"))
     {
-        return ctx_set_error(&ctx, "path pointer is NULL");
+        return false;
     }
-
-    char validation_error[256];
-    if (!family_tree_validate(tree, validation_error, sizeof(validation_error)))
+    if (!write_indent(ctx, 4U) || !write_raw(ctx, "\"version\": ") ||
+        !write_escaped_string(ctx, PERSISTENCE_SCHEMA_VERSION) || !write_raw(ctx, ",\n"))
     {
-        return ctx_set_error(&ctx, validation_error);
+        return false;
     }
-
-    if (!persistence_create_backup_if_needed(path, error_buffer, error_buffer_size))
+    if (!write_indent(ctx, 4U) || !write_raw(ctx, "\"name\": ") ||
+        !write_escaped_string(ctx, tree->name ? tree->name : "") || !write_raw(ctx, ",\n"))
+    {
+        return false;
+    }
+    if (!write_indent(ctx, 4U) || !write_raw(ctx, "\"creation_date\": ") ||
+        !write_escaped_string(ctx, tree->creation_date ? tree->creation_date : "") ||
+        !write_raw(ctx, ",\n"))
+    {
+        return false;
+    }
+    if (!write_indent(ctx, 4U) || !write_raw(ctx, "\"root_ids\": "))
+    {
+        return false;
+    }
+    if (!write_tree_roots(ctx, tree) || !write_raw(ctx, "\n"))
+    {
+        return false;
+    }
+    if (!write_indent(ctx, 2U) || !write_raw(ctx, "},\n"))
+    {
+        return false;
+    }
+    if (!write_indent(ctx, 2U) || !write_raw(ctx, "\"persons\": "))
     {
         return false;
     }
+    if (!write_persons_array(ctx, tree, 2U) || !write_raw(ctx, "\n"))
+    {
+        return false;
+    }
+    return write_raw(ctx, "}\n");
+}
+
+bool persistence_tree_write_file(const FamilyTree *tree, const char *path, char *error_buffer,
+                                 size_t error_buffer_size)
+{
+    WriteContext ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.error_buffer = error_buffer;
+    ctx.error_buffer_size = error_buffer_size;
 
     if (persistence_portable_fopen(&ctx.stream, path, "wb") != 0)
     {
@@ -645,59 +714,8 @@ bool persistence_tree_save(const FamilyTree *tree, const char *path, char *error
         return false;
     }
 
-    bool result = false;
-    do
-    {
-        if (!write_raw(&ctx, "{\n"))
-        {
-            break;
-        }
-        if (!write_indent(&ctx, 2U) || !write_raw(&ctx, "\"metadata\": {\n"))
-        {
-            break;
-        }
-        if (!write_indent(&ctx, 4U) || !write_raw(&ctx, "\"version\": ") ||
-            !write_escaped_string(&ctx, PERSISTENCE_SCHEMA_VERSION) || !write_raw(&ctx, ",\n"))
-        {
-            break;
-        }
-        if (!write_indent(&ctx, 4U) || !write_raw(&ctx, "\"name\": ") ||
-            !write_escaped_string(&ctx, tree->name ? tree->name : "") || !write_raw(&ctx, ",\n"))
-        {
-            break;
-        }
-        if (!write_indent(&ctx, 4U) || !write_raw(&ctx, "\"creation_date\": ") ||
-            !write_escaped_string(&ctx, tree->creation_date ? tree->creation_date : "") ||
-            !write_raw(&ctx, ",\n"))
-        {
-            break;
-        }
-        if (!write_indent(&ctx, 4U) || !write_raw(&ctx, "\"root_ids\": "))
-        {
-            break;
-        }
-        if (!write_tree_roots(&ctx, tree) || !write_raw(&ctx, "\n"))
-        {
-            break;
-        }
-        if (!write_indent(&ctx, 2U) || !write_raw(&ctx, "},\n"))
-        {
-            break;
-        }
-        if (!write_indent(&ctx, 2U) || !write_raw(&ctx, "\"persons\": "))
-        {
-            break;
-        }
-        if (!write_persons_array(&ctx, tree, 2U) || !write_raw(&ctx, "\n"))
-        {
-            break;
-        }
-        if (!write_raw(&ctx, "}\n"))
-        {
-            break;
-        }
-        result = true;
-    } while (0);
+    bool result = write_tree_document(&ctx, tree) &&
+                  persistence_sync_stream(ctx.stream, path, error_buffer, error_buffer_size);
 
     if (fclose(ctx.stream) != 0)
     {
@@ -707,3 +725,47 @@ bool persistence_tree_save(const FamilyTree *tree, const char *path, char *error
 
     return result;
 }
+
+bool persistence_person_serialize(const Person *person, char **out_text, size_t *out_length, char *error_buffer,
+                                  size_t error_buffer_size)
+{
+    if (!person || !out_text)
+    {
+        return persistence_set_error_message(error_buffer, error_buffer_size, "invalid serialise arguments");
+    }
+    WriteContext ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.error_buffer = error_buffer;
+    ctx.error_buffer_size = error_buffer_size;
+    if (!write_person(&ctx, person, 0U))
+    {
+        AT_FREE(ctx.buffer);
+        return false;
+    }
+    *out_text = ctx.buffer;
+    if (out_length)
+    {
+        *out_length = ctx.length;
+    }
+    return true;
+}
+
+bool persistence_tree_save(const FamilyTree *tree, const char *path, char *error_buffer, size_t error_buffer_size)
+{
+    if (!tree)
+    {
+        return persistence_set_error_message(error_buffer, error_buffer_size, "tree pointer is NULL");
+    }
+    if (!path)
+    {
+        return persistence_set_error_message(error_buffer, error_buffer_size, "path pointer is NULL");
+    }
+
+    char validation_error[256];
+    if (!family_tree_validate(tree, validation_error, sizeof(validation_error)))
+    {
+        return persistence_set_error_message(error_buffer, error_buffer_size, validation_error);
+    }
+
+    return persistence_tree_write_atomic(tree, path, error_buffer, error_buffer_size);
+}
@@ -3,13 +3,14 @@
 #include "at_date.h"
 #include "at_memory.h"
 #include "at_string.h"
+#include "at_string_pool.h"
+#include "person_slab.h"
+#include "tree_graph.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-#define PERSON_VALIDATION_MAX_DEPTH 1024U
-
 static bool ensure_children_capacity(Person *person)
 {
     if (!person)
@@ -122,15 +123,40 @@ static bool ensure_metadata_capacity(Person *person)
     return true;
 }
 
+static char *person_string_acquire(AtStringPool *pool, const char *value)
+{
+    if (!value)
+    {
+        return NULL;
+    }
+    return pool ? (char *)at_string_pool_intern(pool, value) : at_string_dup(value);
+}
+
+static void person_string_release(AtStringPool *pool, char *value)
+{
+    if (!value)
+    {
+        return;
+    }
+    if (pool)
+    {
+        at_string_pool_release(pool, value);
+    }
+    else
+    {
+        AT_FREE(value);
+    }
+}
+
 static void person_clear_name(Person *person)
 {
     if (!person)
     {
         return;
     }
-    AT_FREE(person->name.first);
-    AT_FREE(person->name.middle);
-    AT_FREE(person->name.last);
+    person_string_release(person->string_pool, person->name.first);
+    person_string_release(person->string_pool, person->name.middle);
+    person_string_release(person->string_pool, person->name.last);
     person->name.first = NULL;
     person->name.middle = NULL;
     person->name.last = NULL;
@@ -142,10 +168,10 @@ static void person_clear_dates(Person *person)
     {
         return;
     }
-    AT_FREE(person->dates.birth_date);
-    AT_FREE(person->dates.birth_location);
-    AT_FREE(person->dates.death_date);
-    AT_FREE(person->dates.death_location);
+    person_string_release(person->string_pool, person->dates.birth_date);
+    person_string_release(person->string_pool, person->dates.birth_location);
+    person_string_release(person->string_pool, person->dates.death_date);
+    person_string_release(person->string_pool, person->dates.death_location);
     person->dates.birth_date = NULL;
     person->dates.birth_location = NULL;
     person->dates.death_date = NULL;
@@ -160,7 +186,7 @@ static void person_clear_certificates(Person *person)
     }
     for (size_t index = 0U; index < person->certificate_count; ++index)
     {
-        AT_FREE(person->certificate_paths[index]);
+        person_string_release(person->string_pool, person->certificate_paths[index]);
     }
     AT_FREE(person->certificate_paths);
     person->certificate_paths = NULL;
@@ -192,8 +218,8 @@ static void person_clear_metadata(Person *person)
     }
     for (size_t index = 0; index < person->metadata_count; ++index)
     {
-        AT_FREE(person->metadata[index].key);
-        AT_FREE(person->metadata[index].value);
+        person_string_release(person->string_pool, person->metadata[index].key);
+        person_string_release(person->string_pool, person->metadata[index].value);
     }
     AT_FREE(person->metadata);
     person->metadata = NULL;
@@ -201,6 +227,43 @@ static void person_clear_metadata(Person *person)
     person->metadata_capacity = 0U;
 }
 
+void person_remove_links(Person *person, bool (*is_removed)(const Person *other, void *context), void *context)
+{
+    if (!person || !is_removed)
+    {
+        return;
+    }
+    for (size_t slot = 0U; slot < 2U; ++slot)
+    {
+        if (person->parents[slot] && is_removed(person->parents[slot], context))
+        {
+            person->parents[slot] = NULL;
+        }
+    }
+    size_t kept = 0U;
+    for (size_t index = 0U; index < person->children_count; ++index)
+    {
+        if (!person->children[index] || !is_removed(person->children[index], context))
+        {
+            person->children[kept++] = person->children[index];
+        }
+    }
+    person->children_count = kept;
+    kept = 0U;
+    for (size_t index = 0U; index < person->spouses_count; ++index)
+    {
+        PersonSpouseRecord *record = &person->spouses[index];
+        if (record->partner && is_removed(record->partner, context))
+        {
+            person_string_release(person->string_pool, record->marriage_date);
+            person_string_release(person->string_pool, record->marriage_location);
+            continue;
+        }
+        person->spouses[kept++] = *record;
+    }
+    person->spouses_count = kept;
+}
+
 static void person_clear_spouses(Person *person)
 {
     if (!person)
@@ -209,8 +272,8 @@ static void person_clear_spouses(Person *person)
     }
     for (size_t index = 0; index < person->spouses_count; ++index)
     {
-        AT_FREE(person->spouses[index].marriage_date);
-        AT_FREE(person->spouses[index].marriage_location);
+        person_string_release(person->string_pool, person->spouses[index].marriage_date);
+        person_string_release(person->string_pool, person->spouses[index].marriage_location);
     }
     AT_FREE(person->spouses);
     person->spouses = NULL;
@@ -218,13 +281,37 @@ static void person_clear_spouses(Person *person)
     person->spouses_capacity = 0U;
 }
 
+void person_release_arrays(Person *person)
+{
+    if (!person)
+    {
+        return;
+    }
+    AT_FREE(person->children);
+    AT_FREE(person->spouses);
+    AT_FREE(person->certificate_paths);
+    AT_FREE(person->metadata);
+    for (size_t index = 0; index < person->timeline_count; ++index)
+    {
+        timeline_entry_reset(&person->timeline_entries[index]);
+    }
+    AT_FREE(person->timeline_entries);
+}
+
 Person *person_create(uint32_t id)
 {
-    Person *person = AT_CALLOC(1U, sizeof(Person));
+    return person_create_in(id, NULL, NULL);
+}
+
+Person *person_create_in(uint32_t id, PersonSlab *slab, AtStringPool *pool)
+{
+    Person *person = slab ? person_slab_acquire(slab) : AT_CALLOC(1U, sizeof(Person));
     if (!person)
     {
         return NULL;
     }
+    person->slab = slab;
+    person->string_pool = pool;
     person->id = id;
     person->is_alive = true;
     person->parents[0] = NULL;
@@ -241,16 +328,162 @@ void person_destroy(Person *person)
     }
     person_clear_name(person);
     person_clear_dates(person);
-    AT_FREE(person->profile_image_path);
+    person_string_release(person->string_pool, person->profile_image_path);
     AT_FREE(person->children);
     person_clear_spouses(person);
     person_clear_certificates(person);
     person_clear_timeline(person);
     person_clear_metadata(person);
+    if (person->slab)
+    {
+        person_slab_release(person->slab, person);
+        return;
+    }
     AT_FREE(person);
 }
 
-static bool person_assign_string(char **target, const char *value)
+static bool person_clone_string(const Person *clone, char **target, const char *value)
+{
+    *target = NULL;
+    if (!value)
+    {
+        return true;
+    }
+    *target = person_string_acquire(clone->string_pool, value);
+    return *target != NULL;
+}
+
+static bool person_clone_relationships(Person *clone, const Person *source)
+{
+    if (source->children_count > 0U)
+    {
+        clone->children = at_secure_realloc(NULL, source->children_count, sizeof(Person *));
+        if (!clone->children)
+        {
+            return false;
+        }
+        memcpy(clone->children, source->children, source->children_count * sizeof(Person *));
+        clone->children_count = source->children_count;
+        clone->children_capacity = source->children_count;
+    }
+    if (source->spouses_count > 0U)
+    {
+        clone->spouses = AT_CALLOC(source->spouses_count, sizeof(PersonSpouseRecord));
+        if (!clone->spouses)
+        {
+            return false;
+        }
+        clone->spouses_capacity = source->spouses_count;
+        for (size_t index = 0U; index < source->spouses_count; ++index)
+        {
+            const PersonSpouseRecord *record = &source->spouses[index];
+            PersonSpouseRecord *target = &clone->spouses[index];
+            target->partner = record->partner;
+            clone->spouses_count = index + 1U;
+            if (!person_clone_string(clone, &target->marriage_date, record->marriage_date) ||
+                !person_clone_string(clone, &target->marriage_location, record->marriage_location))
+            {
+                return false;
+            }
+        }
+    }
+    clone->parents[0] = source->parents[0];
+    clone->parents[1] = source->parents[1];
+    return true;
+}
+
+static bool person_clone_collections(Person *clone, const Person *source)
+{
+    if (source->certificate_count > 0U)
+    {
+        clone->certificate_paths = AT_CALLOC(source->certificate_count, sizeof(char *));
+        if (!clone->certificate_paths)
+        {
+            return false;
+        }
+        clone->certificate_capacity = source->certificate_count;
+        for (size_t index = 0U; index < source->certificate_count; ++index)
+        {
+            clone->certificate_count = index + 1U;
+            if (!person_clone_string(clone, &clone->certificate_paths[index], source->certificate_paths[index]))
+            {
+                return false;
+            }
+        }
+    }
+    if (source->timeline_count > 0U)
+    {
+        clone->timeline_entries = AT_CALLOC(source->timeline_count, sizeof(TimelineEntry));
+        if (!clone->timeline_entries)
+        {
+            return false;
+        }
+        clone->timeline_capacity = source->timeline_count;
+        for (size_t index = 0U; index < source->timeline_count; ++index)
+        {
+            if (!timeline_entry_clone(&source->timeline_entries[index], &clone->timeline_entries[index]))
+            {
+                return false;
+            }
+            clone->timeline_count = index + 1U;
+        }
+    }
+    if (source->metadata_count > 0U)
+    {
+        clone->metadata = AT_CALLOC(source->metadata_count, sizeof(PersonMetadataEntry));
+        if (!clone->metadata)
+        {
+            return false;
+        }
+        clone->metadata_capacity = source->metadata_count;
+        for (size_t index = 0U; index < source->metadata_count; ++index)
+        {
+            clone->metadata_count = index + 1U;
+            if (!person_clone_string(clone, &clone->metadata[index].key, source->metadata[index].key) ||
+                !person_clone_string(clone, &clone->metadata[index].value, source->metadata[index].value))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+Person *person_clone(const Person *source)
+{
+    return person_clone_into(source, NULL, NULL);
+}
+
+Person *person_clone_into(const Person *source, PersonSlab *slab, AtStringPool *pool)
+{
+    if (!source)
+    {
+        return NULL;
+    }
+    Person *clone = person_create_in(source->id, slab, pool);
+    if (!clone)
+    {
+        return NULL;
+    }
+    clone->is_alive = source->is_alive;
+    bool ok = person_clone_string(clone, &clone->name.first, source->name.first) &&
+              person_clone_string(clone, &clone->name.middle, source->name.middle) &&
+              person_clone_string(clone, &clone->name.last, source->name.last) &&
+              person_clone_string(clone, &clone->dates.birth_date, source->dates.birth_date) &&
+              person_clone_string(clone, &clone->dates.birth_location, source->dates.birth_location) &&
+              person_clone_string(clone, &clone->dates.death_date, source->dates.death_date) &&
+              person_clone_string(clone, &clone->dates.death_location, source->dates.death_location) &&
+              person_clone_string(clone, &clone->profile_image_path, source->profile_image_path) &&
+              person_clone_collections(clone, source) && person_clone_relationships(clone, source);
+    if (!ok)
+    {
+        person_destroy(clone);
+        return NULL;
+    }
+    return clone;
+}
+
+static bool person_assign_string(Person *person, char **target, const char *value)
 {
     if (!target)
     {
@@ -258,16 +491,16 @@ static bool person_assign_string(char **target, const char *value)
     }
     if (!value)
     {
-        AT_FREE(*target);
+        person_string_release(person->string_pool, *target);
         *target = NULL;
         return true;
     }
-    char *copy = at_string_dup(value);
+    char *copy = person_string_acquire(person->string_pool, value);
     if (!copy)
     {
         return false;
     }
-    AT_FREE(*target);
+    person_string_release(person->string_pool, *target);
     *target = copy;
     return true;
 }
@@ -282,24 +515,24 @@ bool person_set_name(Person *person, const char *first, const char *middle, cons
     {
         return false;
     }
-    char *first_copy = at_string_dup(first);
+    char *first_copy = person_string_acquire(person->string_pool, first);
     char *middle_copy = NULL;
-    char *last_copy = at_string_dup(last);
+    char *last_copy = person_string_acquire(person->string_pool, last);
     if (middle && middle[0] != '\0')
     {
-        middle_copy = at_string_dup(middle);
+        middle_copy = person_string_acquire(person->string_pool, middle);
         if (!middle_copy)
         {
-            free(first_copy);
-            free(last_copy);
+            person_string_release(person->string_pool, first_copy);
+            person_string_release(person->string_pool, last_copy);
             return false;
         }
     }
     if (!first_copy || !last_copy)
     {
-        free(first_copy);
-        free(middle_copy);
-        free(last_copy);
+        person_string_release(person->string_pool, first_copy);
+        person_string_release(person->string_pool, middle_copy);
+        person_string_release(person->string_pool, last_copy);
         return false;
     }
     person_clear_name(person);
@@ -319,7 +552,7 @@ bool person_set_birth(Person *person, const char *date, const char *location)
     {
         return false;
     }
-    char *date_copy = at_string_dup(date);
+    char *date_copy = person_string_acquire(person->string_pool, date);
     if (!date_copy)
     {
         return false;
@@ -327,15 +560,15 @@ bool person_set_birth(Person *person, const char *date, const char *location)
     char *location_copy = NULL;
     if (location && location[0] != '\0')
     {
-        location_copy = at_string_dup(location);
+        location_copy = person_string_acquire(person->string_pool, location);
         if (!location_copy)
         {
-            free(date_copy);
+            person_string_release(person->string_pool, date_copy);
             return false;
         }
     }
-    free(person->dates.birth_date);
-    free(person->dates.birth_location);
+    person_string_release(person->string_pool, person->dates.birth_date);
+    person_string_release(person->string_pool, person->dates.birth_location);
     person->dates.birth_date = date_copy;
     person->dates.birth_location = location_copy;
     return true;
@@ -350,8 +583,8 @@ bool person_set_death(Person *person, const char *date, const char *location)
     if (!date || date[0] == '\0')
     {
         person->is_alive = true;
-        free(person->dates.death_date);
-        free(person->dates.death_location);
+        person_string_release(person->string_pool, person->dates.death_date);
+        person_string_release(person->string_pool, person->dates.death_location);
         person->dates.death_date = NULL;
         person->dates.death_location = NULL;
         return true;
@@ -360,7 +593,7 @@ bool person_set_death(Person *person, const char *date, const char *location)
     {
         return false;
     }
-    char *date_copy = at_string_dup(date);
+    char *date_copy = person_string_acquire(person->string_pool, date);
     if (!date_copy)
     {
         return false;
@@ -368,15 +601,15 @@ bool person_set_death(Person *person, const char *date, const char *location)
     char *location_copy = NULL;
     if (location && location[0] != '\0')
     {
-        location_copy = at_string_dup(location);
+        location_copy = person_string_acquire(person->string_pool, location);
         if (!location_copy)
         {
-            free(date_copy);
+            person_string_release(person->string_pool, date_copy);
             return false;
         }
     }
-    free(person->dates.death_date);
-    free(person->dates.death_location);
+    person_string_release(person->string_pool, person->dates.death_date);
+    person_string_release(person->string_pool, person->dates.death_location);
     person->dates.death_date = date_copy;
     person->dates.death_location = location_copy;
     person->is_alive = false;
@@ -465,44 +698,6 @@ static bool person_find_spouse_index(const Person *person, const Person *spouse,
     return false;
 }
 
-static bool person_relationship_cycle_detect(const Person *root, const Person *current, const Person **path,
-                                             size_t depth)
-{
-    if (!current)
-    {
-        return false;
-    }
-    if (depth >= PERSON_VALIDATION_MAX_DEPTH)
-    {
-        return true;
-    }
-    for (size_t index = 0; index < current->children_count; ++index)
-    {
-        const Person *child = current->children[index];
-        if (!child)
-        {
-            continue;
-        }
-        if (child == root)
-        {
-            return true;
-        }
-        for (size_t path_index = 0; path_index < depth; ++path_index)
-        {
-            if (path[path_index] == child)
-            {
-                return true;
-            }
-        }
-        path[depth] = child;
-        if (person_relationship_cycle_detect(root, child, path, depth + 1U))
-        {
-            return true;
-        }
-    }
-    return false;
-}
-
 static bool person_add_spouse_internal(Person *person, Person *spouse, bool reciprocal)
 {
     if (!person || !spouse || person == spouse)
@@ -563,7 +758,7 @@ static bool person_set_marriage_internal(Person *person, Person *spouse, const c
 
     if (date && date[0] != '\0')
     {
-        date_copy = at_string_dup(date);
+        date_copy = person_string_acquire(person->string_pool, date);
         if (!date_copy)
         {
             return false;
@@ -571,10 +766,10 @@ static bool person_set_marriage_internal(Person *person, Person *spouse, const c
     }
     if (location && location[0] != '\0')
     {
-        location_copy = at_string_dup(location);
+        location_copy = person_string_acquire(person->string_pool, location);
         if (!location_copy)
         {
-            free(date_copy);
+            person_string_release(person->string_pool, date_copy);
             return false;
         }
     }
@@ -583,14 +778,14 @@ static bool person_set_marriage_internal(Person *person, Person *spouse, const c
     {
         if (!person_set_marriage_internal(spouse, person, date, location, false))
         {
-            free(date_copy);
-            free(location_copy);
+            person_string_release(person->string_pool, date_copy);
+            person_string_release(person->string_pool, location_copy);
             return false;
         }
     }
 
-    free(person->spouses[index].marriage_date);
-    free(person->spouses[index].marriage_location);
+    person_string_release(person->string_pool, person->spouses[index].marriage_date);
+    person_string_release(person->string_pool, person->spouses[index].marriage_location);
     person->spouses[index].marriage_date = date_copy;
     person->spouses[index].marriage_location = location_copy;
     return true;
@@ -618,7 +813,7 @@ bool person_add_certificate(Person *person, const char *path)
     {
         return false;
     }
-    char *copy = at_string_dup(path);
+    char *copy = person_string_acquire(person->string_pool, path);
     if (!copy)
     {
         return false;
@@ -627,6 +822,15 @@ bool person_add_certificate(Person *person, const char *path)
     return true;
 }
 
+bool person_set_profile_image(Person *person, const char *path)
+{
+    if (!person)
+    {
+        return false;
+    }
+    return person_assign_string(person, &person->profile_image_path, (path && path[0] != '\0') ? path : NULL);
+}
+
 bool person_add_timeline_entry(Person *person, const TimelineEntry *entry)
 {
     if (!person || !entry)
@@ -656,19 +860,19 @@ bool person_metadata_set(Person *person, const char *key, const char *value)
     {
         if (strcmp(person->metadata[index].key, key) == 0)
         {
-            return person_assign_string(&person->metadata[index].value, value);
+            return person_assign_string(person, &person->metadata[index].value, value);
         }
     }
     if (!ensure_metadata_capacity(person))
     {
         return false;
     }
-    char *key_copy = at_string_dup(key);
-    char *value_copy = value ? at_string_dup(value) : NULL;
+    char *key_copy = person_string_acquire(person->string_pool, key);
+    char *value_copy = value ? person_string_acquire(person->string_pool, value) : NULL;
     if (!key_copy || (value && !value_copy))
     {
-        free(key_copy);
-        free(value_copy);
+        person_string_release(person->string_pool, key_copy);
+        person_string_release(person->string_pool, value_copy);
         return false;
     }
     person->metadata[person->metadata_count].key = key_copy;
@@ -682,7 +886,7 @@ static bool string_is_null_or_empty(const char *value)
     return value == NULL || value[0] == '\0';
 }
 
-bool person_validate(const Person *person, char *error_buffer, size_t error_buffer_size)
+bool person_validate_record(const Person *person, char *error_buffer, size_t error_buffer_size)
 {
     if (!person)
     {
@@ -743,16 +947,6 @@ bool person_validate(const Person *person, char *error_buffer, size_t error_buff
             return false;
         }
     }
-    const Person *path[PERSON_VALIDATION_MAX_DEPTH];
-    if (person_relationship_cycle_detect(person, person, path, 0U))
-    {
-        if (error_buffer && error_buffer_size > 0U)
-        {
-            (void)snprintf(error_buffer, error_buffer_size, "Person %u participates in a relationship cycle",
-                           person->id);
-        }
-        return false;
-    }
     for (size_t index = 0; index < person->spouses_count; ++index)
     {
         const PersonSpouseRecord *record = &person->spouses[index];
@@ -792,6 +986,40 @@ bool person_validate(const Person *person, char *error_buffer, size_t error_buff
     return true;
 }
 
+bool person_validate(const Person *person, char *error_buffer, size_t error_buffer_size)
+{
+    if (!person_validate_record(person, error_buffer, error_buffer_size))
+    {
+        return false;
+    }
+    /* Any cycle among the descendants fails, found by one iterative walk rather than per-path scans. */
+    TreeGraph graph;
+    tree_graph_init(&graph);
+    uint32_t *path = NULL;
+    size_t length = 0U;
+    if (!tree_graph_build_descendants(&graph, person) || !tree_graph_find_cycle(&graph, &path, &length))
+    {
+        if (error_buffer && error_buffer_size > 0U)
+        {
+            (void)snprintf(error_buffer, error_buffer_size, "Insufficient memory to validate person %u", person->id);
+        }
+        tree_graph_reset(&graph);
+        return false;
+    }
+    AT_FREE(path);
+    tree_graph_reset(&graph);
+    if (length > 0U)
+    {
+        if (error_buffer && error_buffer_size > 0U)
+        {
+            (void)snprintf(error_buffer, error_buffer_size, "Person %u participates in a relationship cycle",
+                           person->id);
+        }
+        return false;
+    }
+    return true;
+}
+
 bool person_format_display_name(const Person *person, char *buffer, size_t capacity)
 {
     if (!person || !buffer || capacity == 0U)
@@ -847,3 +1075,104 @@ bool person_format_display_name(const Person *person, char *buffer, size_t capac
     }
     return true;
 }
+
+static void person_push_string_slot(char ***slots, size_t *count, char **slot)
+{
+    if (slots)
+    {
+        slots[*count] = slot;
+    }
+    (*count)++;
+}
+
+/* Every owned string slot except timeline entries, whose strings timeline.c manages on its own. */
+static size_t person_collect_string_slots(Person *person, char ***slots)
+{
+    size_t count = 0U;
+    person_push_string_slot(slots, &count, &person->name.first);
+    person_push_string_slot(slots, &count, &person->name.middle);
+    person_push_string_slot(slots, &count, &person->name.last);
+    person_push_string_slot(slots, &count, &person->dates.birth_date);
+    person_push_string_slot(slots, &count, &person->dates.birth_location);
+    person_push_string_slot(slots, &count, &person->dates.death_date);
+    person_push_string_slot(slots, &count, &person->dates.death_location);
+    person_push_string_slot(slots, &count, &person->profile_image_path);
+    for (size_t index = 0U; index < person->certificate_count; ++index)
+    {
+        person_push_string_slot(slots, &count, &person->certificate_paths[index]);
+    }
+    for (size_t index = 0U; index < person->metadata_count; ++index)
+    {
+        person_push_string_slot(slots, &count, &person->metadata[index].key);
+        person_push_string_slot(slots, &count, &person->metadata[index].value);
+    }
+    for (size_t index = 0U; index < person->spouses_count; ++index)
+    {
+        person_push_string_slot(slots, &count, &person->spouses[index].marriage_date);
+        person_push_string_slot(slots, &count, &person->spouses[index].marriage_location);
+    }
+    return count;
+}
+
+bool person_bind_string_pool(Person *person, AtStringPool *pool)
+{
+    if (!person)
+    {
+        return false;
+    }
+    if (person->string_pool == pool)
+    {
+        return true;
+    }
+    char **inline_slots[32];
+    char *inline_copies[32];
+    size_t count = person_collect_string_slots(person, NULL);
+    char ***slots = inline_slots;
+    char **copies = inline_copies;
+    if (count > sizeof(inline_slots) / sizeof(inline_slots[0]))
+    {
+        slots = AT_MALLOC(count * sizeof(char **));
+        copies = AT_MALLOC(count * sizeof(char *));
+        if (!slots || !copies)
+        {
+            AT_FREE(slots);
+            AT_FREE(copies);
+            return false;
+        }
+    }
+    (void)person_collect_string_slots(person, slots);
+    /* Acquire every copy first so a failure leaves the person untouched. */
+    bool ok = true;
+    size_t acquired = 0U;
+    for (; acquired < count; ++acquired)
+    {
+        copies[acquired] = person_string_acquire(pool, *slots[acquired]);
+        if (*slots[acquired] && !copies[acquired])
+        {
+            ok = false;
+            break;
+        }
+    }
+    for (size_t index = 0U; index < acquired; ++index)
+    {
+        if (ok)
+        {
+            person_string_release(person->string_pool, *slots[index]);
+            *slots[index] = copies[index];
+        }
+        else
+        {
+            person_string_release(pool, copies[index]);
+        }
+    }
+    if (ok)
+    {
+        person->string_pool = pool;
+    }
+    if (slots != inline_slots)
+    {
+        AT_FREE(slots);
+        AT_FREE(copies);
+    }
+    return ok;
+}
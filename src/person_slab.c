@@ -0,0 +1,154 @@
+#include "person_slab.h"
+
+#include "at_memory.h"
+#include "person.h"
+
+#include <string.h>
+
+#define PERSON_SLAB_FIRST_BLOCK 64U
+#define PERSON_SLAB_MAX_BLOCK 4096U
+
+typedef union PersonSlabRecord
+{
+    Person person;
+    union PersonSlabRecord *next_free;
+} PersonSlabRecord;
+
+typedef struct PersonSlabBlock
+{
+    struct PersonSlabBlock *next;
+    size_t used;
+    size_t capacity;
+    PersonSlabRecord records[];
+} PersonSlabBlock;
+
+struct PersonSlab
+{
+    PersonSlabBlock *blocks;
+    PersonSlabRecord *free_list;
+    PersonSlabStats stats;
+    bool orphaned;
+};
+
+static void person_slab_free(PersonSlab *slab)
+{
+    PersonSlabBlock *block = slab->blocks;
+    while (block)
+    {
+        PersonSlabBlock *next = block->next;
+        AT_FREE(block);
+        block = next;
+    }
+    AT_FREE(slab);
+}
+
+static bool person_slab_add_block(PersonSlab *slab)
+{
+    /* Blocks double up to a cap so small trees stay small and large ones need few allocations. */
+    size_t capacity = slab->blocks ? slab->blocks->capacity * 2U : PERSON_SLAB_FIRST_BLOCK;
+    if (capacity > PERSON_SLAB_MAX_BLOCK)
+    {
+        capacity = PERSON_SLAB_MAX_BLOCK;
+    }
+    size_t bytes = 0U;
+    if (at_check_mul_overflow_size(capacity, sizeof(PersonSlabRecord), &bytes))
+    {
+        return false;
+    }
+    PersonSlabBlock *block = AT_MALLOC(sizeof(PersonSlabBlock) + bytes);
+    if (!block)
+    {
+        return false;
+    }
+    block->next = slab->blocks;
+    block->used = 0U;
+    block->capacity = capacity;
+    slab->blocks = block;
+    slab->stats.block_count++;
+    slab->stats.capacity += capacity;
+    return true;
+}
+
+PersonSlab *person_slab_create(void)
+{
+    return AT_CALLOC(1U, sizeof(PersonSlab));
+}
+
+Person *person_slab_acquire(PersonSlab *slab)
+{
+    if (!slab || slab->orphaned)
+    {
+        return NULL;
+    }
+    PersonSlabRecord *record = slab->free_list;
+    if (record)
+    {
+        slab->free_list = record->next_free;
+        slab->stats.free_records--;
+    }
+    else
+    {
+        if ((!slab->blocks || slab->blocks->used == slab->blocks->capacity) && !person_slab_add_block(slab))
+        {
+            return NULL;
+        }
+        record = &slab->blocks->records[slab->blocks->used++];
+    }
+    memset(record, 0, sizeof(*record));
+    slab->stats.live_records++;
+    return &record->person;
+}
+
+void person_slab_release(PersonSlab *slab, Person *person)
+{
+    if (!slab || !person)
+    {
+        return;
+    }
+    PersonSlabRecord *record = (PersonSlabRecord *)(void *)person;
+    record->next_free = slab->free_list;
+    slab->free_list = record;
+    slab->stats.free_records++;
+    slab->stats.live_records--;
+    if (slab->orphaned && slab->stats.live_records == 0U)
+    {
+        person_slab_free(slab);
+    }
+}
+
+void person_slab_orphan(PersonSlab *slab)
+{
+    if (!slab)
+    {
+        return;
+    }
+    slab->orphaned = true;
+    if (slab->stats.live_records == 0U)
+    {
+        person_slab_free(slab);
+    }
+}
+
+void person_slab_abandon(PersonSlab *slab, size_t abandoned)
+{
+    if (!slab)
+    {
+        return;
+    }
+    slab->stats.live_records -= abandoned < slab->stats.live_records ? abandoned : slab->stats.live_records;
+    person_slab_orphan(slab);
+}
+
+void person_slab_get_stats(const PersonSlab *slab, PersonSlabStats *out_stats)
+{
+    if (!out_stats)
+    {
+        return;
+    }
+    if (!slab)
+    {
+        memset(out_stats, 0, sizeof(*out_stats));
+        return;
+    }
+    *out_stats = slab->stats;
+}
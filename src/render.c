@@ -6,6 +6,7 @@
 #include "expansion.h"
 #include "layout.h"
 #include "person.h"
+#include "tree_graph.h"
 
 #include <float.h>
 #include <math.h>
@@ -19,6 +20,8 @@
 #include <rlgl.h>
 #endif
 
+static void render_connection_cache_destroy(struct RenderConnectionCache *cache);
+
 static RenderColor render_color_make(unsigned char r, unsigned char g, unsigned char b, unsigned char a)
 {
     RenderColor color = {r, g, b, a};
@@ -102,6 +105,7 @@ void render_state_init(RenderState *state)
     state->scene_target.id = 0;
     state->label_system = NULL;
     state->label_system_ready = false;
+    state->texture_residency = NULL;
 #endif
 }
 
@@ -829,6 +833,8 @@ void render_cleanup(RenderState *state)
     state->batch_alive_nodes = NULL;
     state->batch_deceased_nodes = NULL;
     state->batch_capacity = 0U;
+    render_connection_cache_destroy(state->connection_cache);
+    state->connection_cache = NULL;
     render_state_init(state);
 }
 
@@ -883,6 +889,20 @@ bool render_has_render_target(const RenderState *state)
     return (state && state->render_target_ready);
 }
 
+void render_set_texture_residency(RenderState *state, struct TextureResidency *residency)
+{
+    if (!state)
+    {
+        return;
+    }
+#if defined(ANCESTRYTREE_HAVE_RAYLIB)
+    state->texture_residency = residency;
+    render_labels_set_texture_residency(state->label_system, residency);
+#else
+    (void)residency;
+#endif
+}
+
 bool render_find_person_position(const LayoutResult *layout, const Person *person, float out_position[3])
 {
     if (!layout || !person || !out_position)
@@ -902,80 +922,239 @@ bool render_find_person_position(const LayoutResult *layout, const Person *perso
     return false;
 }
 
-size_t render_collect_parent_child_segments(const LayoutResult *layout, RenderConnectionSegment *segments,
-                                            size_t segment_capacity)
+/* Relationship rows of the laid-out persons, kept across frames. Person changes patch the graph through the
+ * incremental tree_graph calls; a new layout only re-maps graph nodes to layout nodes unless it shows someone the
+ * graph does not know, which rebuilds it from the layout. */
+typedef struct RenderConnectionCache
 {
-    if (!layout || !segments || segment_capacity == 0U)
+    TreeGraph graph;
+    bool graph_ready;
+    Person **layout_persons; /* Person of each layout node when the map was last built. */
+    size_t layout_count;
+    size_t layout_capacity;
+    uint32_t *layout_slots; /* Graph node -> first layout node showing it, TREE_GRAPH_NONE when not laid out. */
+    size_t slot_count;
+    size_t slot_capacity;
+} RenderConnectionCache;
+
+static void render_connection_cache_destroy(RenderConnectionCache *cache)
+{
+    if (!cache)
     {
-        return 0U;
+        return;
+    }
+    tree_graph_reset(&cache->graph);
+    free(cache->layout_persons);
+    free(cache->layout_slots);
+    free(cache);
+}
+
+static RenderConnectionCache *render_connection_cache(RenderState *state)
+{
+    if (!state->connection_cache)
+    {
+        state->connection_cache = (RenderConnectionCache *)calloc(1U, sizeof(RenderConnectionCache));
+        if (state->connection_cache)
+        {
+            tree_graph_init(&state->connection_cache->graph);
+        }
+    }
+    return state->connection_cache;
+}
+
+static bool render_connection_cache_is_current(const RenderConnectionCache *cache, const LayoutResult *layout)
+{
+    if (!cache->graph_ready || cache->layout_count != layout->count || cache->slot_count != cache->graph.count)
+    {
+        return false;
     }
-    size_t count = 0U;
     for (size_t index = 0; index < layout->count; ++index)
     {
-        const LayoutNode *node = &layout->nodes[index];
-        const Person *person = node->person;
-        if (!person || person->children_count == 0U)
+        if (cache->layout_persons[index] != layout->nodes[index].person)
         {
-            continue;
+            return false;
         }
-        for (size_t child_index = 0; child_index < person->children_count; ++child_index)
+    }
+    return true;
+}
+
+static bool render_connection_cache_sync(RenderConnectionCache *cache, const LayoutResult *layout)
+{
+    if (render_connection_cache_is_current(cache, layout))
+    {
+        return true;
+    }
+    if (layout->count > cache->layout_capacity)
+    {
+        Person **persons = (Person **)realloc(cache->layout_persons, layout->count * sizeof(Person *));
+        if (!persons)
         {
-            const Person *child = person->children[child_index];
-            if (!child)
-            {
-                continue;
-            }
-            if (count >= segment_capacity)
-            {
-                return count;
-            }
-            if (!render_find_person_position(layout, child, segments[count].end))
+            return false;
+        }
+        cache->layout_persons = persons;
+        cache->layout_capacity = layout->count;
+    }
+    bool known = cache->graph_ready;
+    for (size_t index = 0; index < layout->count; ++index)
+    {
+        cache->layout_persons[index] = layout->nodes[index].person;
+        known = known && tree_graph_find(&cache->graph, layout->nodes[index].person) != TREE_GRAPH_NONE;
+    }
+    cache->layout_count = layout->count;
+    if (!known)
+    {
+        cache->graph_ready = tree_graph_build(&cache->graph, cache->layout_persons, layout->count);
+        if (!cache->graph_ready)
+        {
+            return false;
+        }
+    }
+    if (cache->graph.count > cache->slot_capacity)
+    {
+        uint32_t *slots = (uint32_t *)realloc(cache->layout_slots, cache->graph.count * sizeof(uint32_t));
+        if (!slots)
+        {
+            cache->slot_count = 0U;
+            return false;
+        }
+        cache->layout_slots = slots;
+        cache->slot_capacity = cache->graph.count;
+    }
+    for (size_t node = 0; node < cache->graph.count; ++node)
+    {
+        cache->layout_slots[node] = TREE_GRAPH_NONE;
+    }
+    for (size_t index = layout->count; index > 0U; --index)
+    {
+        uint32_t node = tree_graph_find(&cache->graph, layout->nodes[index - 1U].person);
+        cache->layout_slots[node] = (uint32_t)(index - 1U);
+    }
+    cache->slot_count = cache->graph.count;
+    return true;
+}
+
+/* The cache brought in line with layout, or NULL when there is nothing to connect or it cannot be built. */
+static RenderConnectionCache *render_connections_prepare(RenderState *state, const LayoutResult *layout)
+{
+    RenderConnectionCache *cache = render_connection_cache(state);
+    if (!cache || layout->count == 0U || !render_connection_cache_sync(cache, layout))
+    {
+        return NULL;
+    }
+    return cache;
+}
+
+/* Position of the first layout node showing graph node, matching render_find_person_position. */
+static const float *render_connection_end(const RenderConnectionCache *cache, const LayoutResult *layout,
+                                          uint32_t node)
+{
+    uint32_t slot = cache->layout_slots[node];
+    return slot == TREE_GRAPH_NONE ? NULL : layout->nodes[slot].position;
+}
+
+static void render_copy_position(float dst[3], const float src[3])
+{
+    dst[0] = src[0];
+    dst[1] = src[1];
+    dst[2] = src[2];
+}
+
+void render_connections_person_added(RenderState *state, Person *person)
+{
+    RenderConnectionCache *cache = state ? state->connection_cache : NULL;
+    if (cache && cache->graph_ready && !tree_graph_add_person(&cache->graph, person))
+    {
+        cache->graph_ready = false;
+    }
+}
+
+void render_connections_person_edited(RenderState *state, const Person *person)
+{
+    RenderConnectionCache *cache = state ? state->connection_cache : NULL;
+    if (cache && cache->graph_ready && !tree_graph_update_person(&cache->graph, person))
+    {
+        cache->graph_ready = false;
+    }
+}
+
+void render_connections_person_removed(RenderState *state, const Person *person)
+{
+    RenderConnectionCache *cache = state ? state->connection_cache : NULL;
+    if (cache && cache->graph_ready && !tree_graph_remove_person(&cache->graph, person))
+    {
+        cache->graph_ready = false;
+    }
+}
+
+void render_connections_invalidate(RenderState *state)
+{
+    if (state && state->connection_cache)
+    {
+        state->connection_cache->graph_ready = false;
+    }
+}
+
+size_t render_collect_parent_child_segments(RenderState *state, const LayoutResult *layout,
+                                            RenderConnectionSegment *segments, size_t segment_capacity)
+{
+    if (!state || !layout || !segments || segment_capacity == 0U)
+    {
+        return 0U;
+    }
+    const RenderConnectionCache *cache = render_connections_prepare(state, layout);
+    if (!cache)
+    {
+        return 0U;
+    }
+    size_t count = 0U;
+    for (size_t index = 0; index < layout->count && count < segment_capacity; ++index)
+    {
+        uint32_t source = tree_graph_find(&cache->graph, layout->nodes[index].person);
+        uint32_t child_count = 0U;
+        const uint32_t *children = tree_graph_children(&cache->graph, source, &child_count);
+        for (uint32_t edge = 0U; edge < child_count && count < segment_capacity; ++edge)
+        {
+            const float *end = render_connection_end(cache, layout, children[edge]);
+            if (!end)
             {
                 continue;
             }
-            segments[count].start[0] = node->position[0];
-            segments[count].start[1] = node->position[1];
-            segments[count].start[2] = node->position[2];
+            render_copy_position(segments[count].start, layout->nodes[index].position);
+            render_copy_position(segments[count].end, end);
             ++count;
         }
     }
     return count;
 }
 
-size_t render_collect_spouse_segments(const LayoutResult *layout, RenderConnectionSegment *segments,
-                                      size_t segment_capacity)
+size_t render_collect_spouse_segments(RenderState *state, const LayoutResult *layout,
+                                      RenderConnectionSegment *segments, size_t segment_capacity)
 {
-    if (!layout || !segments || segment_capacity == 0U)
+    if (!state || !layout || !segments || segment_capacity == 0U)
+    {
+        return 0U;
+    }
+    const RenderConnectionCache *cache = render_connections_prepare(state, layout);
+    if (!cache)
     {
         return 0U;
     }
     size_t count = 0U;
-    for (size_t index = 0; index < layout->count; ++index)
+    for (size_t index = 0; index < layout->count && count < segment_capacity; ++index)
     {
-        const LayoutNode *node = &layout->nodes[index];
-        const Person *person = node->person;
-        if (!person || person->spouses_count == 0U)
-        {
-            continue;
-        }
-        for (size_t spouse_index = 0; spouse_index < person->spouses_count; ++spouse_index)
+        const Person *person = layout->nodes[index].person;
+        uint32_t source = tree_graph_find(&cache->graph, person);
+        uint32_t spouse_count = 0U;
+        const uint32_t *spouses = tree_graph_spouses(&cache->graph, source, &spouse_count);
+        for (uint32_t edge = 0U; edge < spouse_count && count < segment_capacity; ++edge)
         {
-            const Person *partner = person->spouses[spouse_index].partner;
-            if (!partner || partner->id <= person->id)
+            const float *end = render_connection_end(cache, layout, spouses[edge]);
+            if (!end || cache->graph.persons[spouses[edge]]->id <= person->id)
             {
                 continue;
             }
-            if (count >= segment_capacity)
-            {
-                return count;
-            }
-            if (!render_find_person_position(layout, partner, segments[count].end))
-            {
-                continue;
-            }
-            segments[count].start[0] = node->position[0];
-            segments[count].start[1] = node->position[1];
-            segments[count].start[2] = node->position[2];
+            render_copy_position(segments[count].start, layout->nodes[index].position);
+            render_copy_position(segments[count].end, end);
             ++count;
         }
     }
@@ -993,43 +1172,45 @@ bool render_connections_render(RenderState *state, const LayoutResult *layout)
     (void)layout;
     return false;
 #else
+    if (layout->count == 0U)
+    {
+        return true;
+    }
+    const RenderConnectionCache *cache = render_connections_prepare(state, layout);
+    if (!cache)
+    {
+        return false;
+    }
     for (size_t index = 0; index < layout->count; ++index)
     {
-        const LayoutNode *node = &layout->nodes[index];
-        const Person *person = node->person;
-        if (!person)
+        const Person *person = layout->nodes[index].person;
+        uint32_t source = tree_graph_find(&cache->graph, person);
+        if (source == TREE_GRAPH_NONE)
         {
             continue;
         }
-        for (size_t child_index = 0; child_index < person->children_count; ++child_index)
+        uint32_t edge_count = 0U;
+        const uint32_t *children = tree_graph_children(&cache->graph, source, &edge_count);
+        for (uint32_t edge = 0U; edge < edge_count; ++edge)
         {
-            const Person *child = person->children[child_index];
-            if (!child)
-            {
-                continue;
-            }
-            float child_position[3];
-            if (render_find_person_position(layout, child, child_position))
+            const float *end = render_connection_end(cache, layout, children[edge]);
+            if (end)
             {
-                render_draw_connection(state, node->position, child_position,
+                render_draw_connection(state, layout->nodes[index].position, end,
                                        state->config.connection_color_parent_child,
                                        state->config.connection_style_parent_child);
             }
         }
-        for (size_t spouse_index = 0; spouse_index < person->spouses_count; ++spouse_index)
+        const uint32_t *spouses = tree_graph_spouses(&cache->graph, source, &edge_count);
+        for (uint32_t edge = 0U; edge < edge_count; ++edge)
         {
-            const Person *partner = person->spouses[spouse_index].partner;
-            if (!partner || partner->id <= person->id)
+            const float *end = render_connection_end(cache, layout, spouses[edge]);
+            if (!end || cache->graph.persons[spouses[edge]]->id <= person->id)
             {
                 continue;
             }
-            float partner_position[3];
-            if (render_find_person_position(layout, partner, partner_position))
-            {
-                render_draw_connection(state, node->position, partner_position,
-                                       state->config.connection_color_spouse,
-                                       state->config.connection_style_spouse);
-            }
+            render_draw_connection(state, layout->nodes[index].position, end, state->config.connection_color_spouse,
+                                   state->config.connection_style_spouse);
         }
     }
     return true;
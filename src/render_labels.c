@@ -13,6 +13,36 @@
 #include <raymath.h>
 #endif
 
+#if defined(ANCESTRYTREE_HAVE_RAYLIB)
+static void render_labels_unload_entry(RenderLabelSystem *system, RenderLabelEntry *entry)
+{
+    if (entry->texture.id != 0)
+    {
+        texture_residency_release(system->residency, entry->residency_handle);
+        UnloadTexture(entry->texture);
+        entry->texture.id = 0;
+    }
+    entry->residency_handle = 0U;
+}
+
+/* Slot is the entry index; the handle is cleared first because the manager has already dropped it. */
+static void render_labels_evict_entry(void *owner, size_t slot)
+{
+    RenderLabelSystem *system = (RenderLabelSystem *)owner;
+    if (!system || slot >= system->count)
+    {
+        return;
+    }
+    RenderLabelEntry *entry = &system->entries[slot];
+    entry->residency_handle = 0U;
+    render_labels_unload_entry(system, entry);
+    entry->signature[0] = '\0';
+    entry->person_id = 0U;
+    entry->width_pixels = 0.0f;
+    entry->height_pixels = 0.0f;
+}
+#endif
+
 static bool render_labels_reset(RenderLabelSystem *system)
 {
     if (!system)
@@ -23,11 +53,7 @@ static bool render_labels_reset(RenderLabelSystem *system)
     for (size_t index = 0U; index < system->count; ++index)
     {
         RenderLabelEntry *entry = &system->entries[index];
-        if (entry->texture.id != 0)
-        {
-            UnloadTexture(entry->texture);
-            entry->texture.id = 0;
-        }
+        render_labels_unload_entry(system, entry);
         entry->in_use = false;
         entry->signature[0] = '\0';
         entry->width_pixels = 0.0f;
@@ -85,6 +111,7 @@ static bool render_labels_ensure_capacity(RenderLabelSystem *system)
         entries[index].height_pixels = 0.0f;
         entries[index].font_size = 0.0f;
         entries[index].in_use = false;
+        entries[index].residency_handle = 0U;
     }
     system->entries = entries;
     system->capacity = new_capacity;
@@ -134,8 +161,7 @@ void render_labels_end_frame(RenderLabelSystem *system)
         RenderLabelEntry *entry = &system->entries[index];
         if (!entry->in_use && entry->texture.id != 0)
         {
-            UnloadTexture(entry->texture);
-            entry->texture.id = 0;
+            render_labels_unload_entry(system, entry);
             entry->width_pixels = 0.0f;
             entry->height_pixels = 0.0f;
             entry->signature[0] = '\0';
@@ -209,22 +235,32 @@ static bool render_labels_build_texture(RenderLabelSystem *system, RenderLabelEn
     int portrait_pixels = 0;
     Image profile_image = {0};
     bool profile_loaded = false;
+    bool profile_available = include_profile && person && person->profile_image_path &&
+                             person->profile_image_path[0] != '\0' && FileExists(person->profile_image_path);
+    int portrait_limit = (int)(font_size * 2.0f);
+    if (portrait_limit < 48)
+    {
+        portrait_limit = 48;
+    }
+
+    /* Reserve for the largest label this can become before decoding the portrait, so a refusal costs no I/O. */
+    int max_width = (int)ceilf(text_size.x) + padding * 2 + (profile_available ? portrait_limit : 0);
+    int max_height = (int)fmaxf(ceilf(text_size.y), profile_available ? (float)portrait_limit : 0.0f) + padding * 2;
+    if (!texture_residency_reserve(system->residency,
+                                   texture_residency_estimate_bytes(max_width < 64 ? 64 : max_width,
+                                                                    max_height < 32 ? 32 : max_height, true)))
+    {
+        return false;
+    }
 
-    if (include_profile && person && person->profile_image_path && person->profile_image_path[0] != '\0')
+    if (profile_available)
     {
-        if (FileExists(person->profile_image_path))
+        profile_image = LoadImage(person->profile_image_path);
+        if (profile_image.data != NULL)
         {
-            profile_image = LoadImage(person->profile_image_path);
-            if (profile_image.data != NULL)
-            {
-                portrait_pixels = (int)(font_size * 2.0f);
-                if (portrait_pixels < 48)
-                {
-                    portrait_pixels = 48;
-                }
-                ImageResize(&profile_image, portrait_pixels, portrait_pixels);
-                profile_loaded = true;
-            }
+            portrait_pixels = portrait_limit;
+            ImageResize(&profile_image, portrait_pixels, portrait_pixels);
+            profile_loaded = true;
         }
     }
 
@@ -272,6 +308,10 @@ static bool render_labels_build_texture(RenderLabelSystem *system, RenderLabelEn
     GenTextureMipmaps(&texture);
     SetTextureFilter(texture, TEXTURE_FILTER_BILINEAR);
     entry->texture = texture;
+    entry->residency_handle =
+        texture_residency_track(system->residency, TEXTURE_RESIDENCY_LABEL,
+                                texture_residency_estimate_bytes(texture.width, texture.height, true),
+                                render_labels_evict_entry, system, (size_t)(entry - system->entries));
     entry->width_pixels = (float)texture.width;
     entry->height_pixels = (float)texture.height;
     entry->font_size = font_size;
@@ -312,6 +352,7 @@ bool render_labels_acquire(RenderLabelSystem *system, const Person *person, bool
             strcmp(entry->signature, signature) == 0 && fabsf(entry->font_size - font_size) < 0.05f)
         {
             entry->in_use = true;
+            texture_residency_touch(system->residency, entry->residency_handle);
             out_info->texture = entry->texture;
             out_info->width_pixels = entry->width_pixels;
             out_info->height_pixels = entry->height_pixels;
@@ -377,3 +418,17 @@ void render_labels_set_base_font_size(RenderLabelSystem *system, float font_size
     (void)font_size;
 #endif
 }
+
+void render_labels_set_texture_residency(RenderLabelSystem *system, TextureResidency *residency)
+{
+    if (!system)
+    {
+        return;
+    }
+#if defined(ANCESTRYTREE_HAVE_RAYLIB)
+    (void)render_labels_reset(system);
+    system->residency = residency;
+#else
+    (void)residency;
+#endif
+}
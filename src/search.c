@@ -1,10 +1,12 @@
 #include "search.h"
 
+#include "at_memory.h"
 #include "person.h"
+#include "search_index.h"
+#include "tree_hot.h"
 
 #include <ctype.h>
 #include <stddef.h>
-#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -28,53 +30,6 @@ static void lowercase_copy(char *destination, size_t capacity, const char *sourc
     destination[index] = '\0';
 }
 
-static bool extract_year(const char *value, int *out_year)
-{
-    if (!value)
-    {
-        return false;
-    }
-    int digits = 0;
-    int year = 0;
-    for (size_t index = 0U; value[index] != '\0'; ++index)
-    {
-        unsigned char ch = (unsigned char)value[index];
-        if (isdigit(ch))
-        {
-            year = year * 10 + (ch - '0');
-            digits++;
-            if (digits == 4)
-            {
-                if (out_year)
-                {
-                    *out_year = year;
-                }
-                return true;
-            }
-        }
-        else if (digits > 0)
-        {
-            break;
-        }
-    }
-    return false;
-}
-
-static int string_casefold_compare(const char *lhs, const char *rhs)
-{
-    size_t index = 0U;
-    while (lhs[index] != '\0' && rhs[index] != '\0')
-    {
-        int diff = tolower((unsigned char)lhs[index]) - tolower((unsigned char)rhs[index]);
-        if (diff != 0)
-        {
-            return diff;
-        }
-        index++;
-    }
-    return tolower((unsigned char)lhs[index]) - tolower((unsigned char)rhs[index]);
-}
-
 static bool filter_allows_alive(const SearchFilter *filter)
 {
     if (!filter)
@@ -101,98 +56,112 @@ static bool filter_allows_deceased(const SearchFilter *filter)
     return true;
 }
 
-static bool search_matches_person(const Person *person, const SearchFilter *filter)
+static bool search_matches_person(const Person *person, const SearchFilter *filter, int min_year, int max_year)
 {
-    if (!person)
-    {
-        return false;
-    }
-    if (!filter)
-    {
-        return true;
-    }
-
-    bool is_alive = person->is_alive;
-    if (is_alive && !filter_allows_alive(filter))
-    {
-        return false;
-    }
-    if (!is_alive && !filter_allows_deceased(filter))
+    if (person->is_alive ? !filter_allows_alive(filter) : !filter_allows_deceased(filter))
     {
         return false;
     }
-
-    if (filter->name_substring && filter->name_substring[0] != '\0')
-    {
-        char name_buffer[160];
-        if (!person_format_display_name(person, name_buffer, sizeof(name_buffer)))
-        {
-            (void)snprintf(name_buffer, sizeof(name_buffer), "Person %u", person->id);
-        }
-        char haystack[160];
-        char needle[96];
-        lowercase_copy(haystack, sizeof(haystack), name_buffer);
-        lowercase_copy(needle, sizeof(needle), filter->name_substring);
-        if (strstr(haystack, needle) == NULL)
-        {
-            return false;
-        }
-    }
-
     if (filter->use_birth_year_range)
     {
         int birth_year = 0;
-        if (!extract_year(person->dates.birth_date, &birth_year))
+        if (!tree_hot_parse_year(person->dates.birth_date, &birth_year))
         {
             return false;
         }
-        int min_year = filter->birth_year_min;
-        int max_year = filter->birth_year_max;
-        if (min_year > max_year)
-        {
-            int swap = min_year;
-            min_year = max_year;
-            max_year = swap;
-        }
         if (birth_year < min_year || birth_year > max_year)
         {
             return false;
         }
     }
-
     return true;
 }
 
-static int search_compare_persons(const void *lhs, const void *rhs)
+/* A match with its cached case-folded name; ordered by name, then id. */
+typedef struct SearchCandidate
+{
+    const Person *person;
+    const char *key;
+} SearchCandidate;
+
+static int search_compare_candidates(const void *lhs, const void *rhs)
 {
-    const Person *const *left = (const Person *const *)lhs;
-    const Person *const *right = (const Person *const *)rhs;
-    const Person *left_person = *left;
-    const Person *right_person = *right;
-    char left_name[160];
-    char right_name[160];
-    if (!person_format_display_name(left_person, left_name, sizeof(left_name)))
+    const SearchCandidate *left = (const SearchCandidate *)lhs;
+    const SearchCandidate *right = (const SearchCandidate *)rhs;
+    int diff = strcmp(left->key, right->key);
+    if (diff != 0)
     {
-        (void)snprintf(left_name, sizeof(left_name), "Person %u", left_person->id);
+        return diff;
     }
-    if (!person_format_display_name(right_person, right_name, sizeof(right_name)))
+    return (left->person->id > right->person->id) - (left->person->id < right->person->id);
+}
+
+/* Max-heap holding the capacity smallest matches seen so far; its root is the one to evict next. */
+typedef struct SearchCollect
+{
+    const SearchFilter *filter;
+    int min_year;
+    int max_year;
+    SearchCandidate *heap;
+    size_t count;
+    size_t capacity;
+} SearchCollect;
+
+static void search_heap_sift_down(SearchCandidate *heap, size_t count, size_t position)
+{
+    for (;;)
     {
-        (void)snprintf(right_name, sizeof(right_name), "Person %u", right_person->id);
+        size_t largest = position;
+        size_t left = position * 2U + 1U;
+        size_t right = left + 1U;
+        if (left < count && search_compare_candidates(&heap[left], &heap[largest]) > 0)
+        {
+            largest = left;
+        }
+        if (right < count && search_compare_candidates(&heap[right], &heap[largest]) > 0)
+        {
+            largest = right;
+        }
+        if (largest == position)
+        {
+            return;
+        }
+        SearchCandidate swap = heap[position];
+        heap[position] = heap[largest];
+        heap[largest] = swap;
+        position = largest;
     }
-    int diff = string_casefold_compare(left_name, right_name);
-    if (diff != 0)
+}
+
+static bool search_collect_visit(const Person *person, const char *folded_name, void *user_data)
+{
+    SearchCollect *collect = (SearchCollect *)user_data;
+    if (!search_matches_person(person, collect->filter, collect->min_year, collect->max_year))
     {
-        return diff;
+        return true;
     }
-    if (left_person->id < right_person->id)
+    SearchCandidate candidate = {person, folded_name};
+    if (collect->count < collect->capacity)
     {
-        return -1;
+        size_t position = collect->count++;
+        while (position > 0U)
+        {
+            size_t parent = (position - 1U) / 2U;
+            if (search_compare_candidates(&collect->heap[parent], &candidate) >= 0)
+            {
+                break;
+            }
+            collect->heap[position] = collect->heap[parent];
+            position = parent;
+        }
+        collect->heap[position] = candidate;
     }
-    if (left_person->id > right_person->id)
+    else if (search_compare_candidates(&candidate, &collect->heap[0]) < 0)
     {
-        return 1;
+        collect->heap[0] = candidate;
+        search_heap_sift_down(collect->heap, collect->count, 0U);
     }
-    return 0;
+    return true;
 }
 
 size_t search_execute(const FamilyTree *tree, const SearchFilter *filter, const Person **out_results,
@@ -215,29 +184,45 @@ size_t search_execute(const FamilyTree *tree, const SearchFilter *filter, const
         filter = &resolved_filter;
     }
 
-    size_t stored = 0U;
-    for (size_t index = 0U; index < tree->person_count; ++index)
+    int min_year = filter->birth_year_min;
+    int max_year = filter->birth_year_max;
+    if (min_year > max_year)
     {
-        const Person *person = tree->persons[index];
-        if (!search_matches_person(person, filter))
-        {
-            continue;
-        }
-        if (stored < capacity)
-        {
-            out_results[stored] = person;
-        }
-        stored++;
-        if (stored == capacity)
-        {
-            /* Continue iterating to honour sort stability even when capacity reached. */
-        }
+        int swap = min_year;
+        min_year = max_year;
+        max_year = swap;
     }
+    bool match_name = filter->name_substring && filter->name_substring[0] != '\0';
+    char needle[96];
+    lowercase_copy(needle, sizeof(needle), match_name ? filter->name_substring : NULL);
 
-    size_t count_to_sort = (stored < capacity) ? stored : capacity;
-    if (count_to_sort > 1U)
+    /* Every match is considered, but only the first capacity by name are kept and sorted. Sort keys are the
+     * index's folded names, so no name is formatted during the search. */
+    FamilyTree *mutable_tree = (FamilyTree *)tree;
+    if (!search_index_ensure(mutable_tree->search, mutable_tree->persons, mutable_tree->person_count))
+    {
+        return 0U;
+    }
+    size_t heap_capacity = capacity < tree->person_count ? capacity : tree->person_count;
+    if (heap_capacity == 0U)
+    {
+        return 0U;
+    }
+    SearchCollect collect = {filter, min_year, max_year, NULL, 0U, heap_capacity};
+    collect.heap = AT_MALLOC(heap_capacity * sizeof(SearchCandidate));
+    if (!collect.heap)
+    {
+        return 0U;
+    }
+    (void)search_index_query(tree->search, needle, search_collect_visit, &collect);
+    if (collect.count > 1U)
+    {
+        qsort(collect.heap, collect.count, sizeof(SearchCandidate), search_compare_candidates);
+    }
+    for (size_t index = 0U; index < collect.count; ++index)
     {
-        qsort(out_results, count_to_sort, sizeof(out_results[0]), search_compare_persons);
+        out_results[index] = collect.heap[index].person;
     }
-    return count_to_sort;
+    AT_FREE(collect.heap);
+    return collect.count;
 }
@@ -0,0 +1,527 @@
+#include "search_index.h"
+
+#include "at_memory.h"
+#include "at_string.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SEARCH_INDEX_NAME_CAPACITY 160U
+#define SEARCH_INDEX_REBUILD_MIN 1024U
+
+typedef struct SearchIndexEntry
+{
+    const Person *person; /* NULL once removed; the slot is not reused so entry order stays tree order. */
+    char *folded;
+} SearchIndexEntry;
+
+typedef struct SearchIndexPosting
+{
+    uint32_t key; /* Three name bytes packed big-endian, plus one so zero marks an empty slot. */
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t *slots;
+} SearchIndexPosting;
+
+struct SearchIndex
+{
+    bool built;
+    SearchIndexEntry *entries;
+    size_t entry_count;
+    size_t entry_capacity;
+    size_t live_count;
+    const Person **person_keys;
+    uint32_t *person_slots;
+    size_t person_capacity;
+    size_t person_used;
+    SearchIndexPosting *postings;
+    size_t posting_capacity;
+    size_t posting_used;
+    size_t posting_total; /* Slot ids across all posting lists. */
+    size_t posting_stale; /* Ids left behind by removals and renames; queries re-check and skip them. */
+};
+
+static size_t search_index_pointer_hash(const Person *person, size_t capacity)
+{
+    uintptr_t value = (uintptr_t)person;
+    value ^= value >> 17U;
+    value *= (uintptr_t)0x9E3779B97F4A7C15ULL;
+    value ^= value >> 29U;
+    return (size_t)value & (capacity - 1U);
+}
+
+static size_t search_index_key_hash(uint32_t key, size_t capacity)
+{
+    uint32_t value = key * 0x9E3779B1U;
+    value ^= value >> 16U;
+    return (size_t)value & (capacity - 1U);
+}
+
+static uint32_t search_index_trigram(const char *text)
+{
+    return (((uint32_t)(unsigned char)text[0] << 16U) | ((uint32_t)(unsigned char)text[1] << 8U) |
+            (uint32_t)(unsigned char)text[2]) +
+           1U;
+}
+
+void search_index_fold_name(const Person *person, char *buffer, size_t capacity)
+{
+    if (!buffer || capacity == 0U)
+    {
+        return;
+    }
+    buffer[0] = '\0';
+    if (!person)
+    {
+        return;
+    }
+    if (!person_format_display_name(person, buffer, capacity))
+    {
+        (void)snprintf(buffer, capacity, "Person %u", person->id);
+    }
+    for (size_t index = 0U; buffer[index] != '\0'; ++index)
+    {
+        buffer[index] = (char)tolower((unsigned char)buffer[index]);
+    }
+}
+
+static void search_index_clear(SearchIndex *index)
+{
+    for (size_t slot = 0U; slot < index->entry_count; ++slot)
+    {
+        AT_FREE(index->entries[slot].folded);
+    }
+    for (size_t slot = 0U; slot < index->posting_capacity; ++slot)
+    {
+        AT_FREE(index->postings[slot].slots);
+    }
+    AT_FREE(index->entries);
+    AT_FREE(index->person_keys);
+    AT_FREE(index->person_slots);
+    AT_FREE(index->postings);
+    memset(index, 0, sizeof(*index));
+}
+
+SearchIndex *search_index_create(void)
+{
+    return AT_CALLOC(1U, sizeof(SearchIndex));
+}
+
+void search_index_destroy(SearchIndex *index)
+{
+    if (!index)
+    {
+        return;
+    }
+    search_index_clear(index);
+    AT_FREE(index);
+}
+
+bool search_index_is_built(const SearchIndex *index)
+{
+    return index && index->built;
+}
+
+static uint32_t search_index_find_slot(const SearchIndex *index, const Person *person)
+{
+    if (!person || index->person_capacity == 0U)
+    {
+        return UINT32_MAX;
+    }
+    size_t probe = search_index_pointer_hash(person, index->person_capacity);
+    while (index->person_keys[probe])
+    {
+        if (index->person_keys[probe] == person)
+        {
+            uint32_t slot = index->person_slots[probe];
+            return index->entries[slot].person == person ? slot : UINT32_MAX;
+        }
+        probe = (probe + 1U) & (index->person_capacity - 1U);
+    }
+    return UINT32_MAX;
+}
+
+static void search_index_person_put(SearchIndex *index, const Person *person, uint32_t slot)
+{
+    size_t probe = search_index_pointer_hash(person, index->person_capacity);
+    while (index->person_keys[probe] && index->person_keys[probe] != person)
+    {
+        probe = (probe + 1U) & (index->person_capacity - 1U);
+    }
+    if (!index->person_keys[probe])
+    {
+        index->person_keys[probe] = person;
+        index->person_used++;
+    }
+    index->person_slots[probe] = slot;
+}
+
+/* Keeps the person map at most half full; rehashing drops keys of removed entries. */
+static bool search_index_person_reserve(SearchIndex *index, size_t additional)
+{
+    if ((index->person_used + additional) * 2U <= index->person_capacity)
+    {
+        return true;
+    }
+    size_t capacity = 64U;
+    while (capacity < (index->live_count + additional) * 4U)
+    {
+        capacity *= 2U;
+    }
+    const Person **keys = AT_CALLOC(capacity, sizeof(const Person *));
+    uint32_t *slots = AT_CALLOC(capacity, sizeof(uint32_t));
+    if (!keys || !slots)
+    {
+        AT_FREE(keys);
+        AT_FREE(slots);
+        return false;
+    }
+    AT_FREE(index->person_keys);
+    AT_FREE(index->person_slots);
+    index->person_keys = keys;
+    index->person_slots = slots;
+    index->person_capacity = capacity;
+    index->person_used = 0U;
+    for (size_t slot = 0U; slot < index->entry_count; ++slot)
+    {
+        if (index->entries[slot].person)
+        {
+            search_index_person_put(index, index->entries[slot].person, (uint32_t)slot);
+        }
+    }
+    return true;
+}
+
+static SearchIndexPosting *search_index_posting_find(const SearchIndex *index, uint32_t key)
+{
+    if (index->posting_capacity == 0U)
+    {
+        return NULL;
+    }
+    size_t probe = search_index_key_hash(key, index->posting_capacity);
+    while (index->postings[probe].key != 0U)
+    {
+        if (index->postings[probe].key == key)
+        {
+            return &index->postings[probe];
+        }
+        probe = (probe + 1U) & (index->posting_capacity - 1U);
+    }
+    return NULL;
+}
+
+static SearchIndexPosting *search_index_posting_insert(SearchIndex *index, uint32_t key)
+{
+    SearchIndexPosting *existing = search_index_posting_find(index, key);
+    if (existing)
+    {
+        return existing;
+    }
+    if ((index->posting_used + 1U) * 2U > index->posting_capacity)
+    {
+        size_t capacity = index->posting_capacity > 0U ? index->posting_capacity * 2U : 1024U;
+        SearchIndexPosting *postings = AT_CALLOC(capacity, sizeof(SearchIndexPosting));
+        if (!postings)
+        {
+            return NULL;
+        }
+        for (size_t slot = 0U; slot < index->posting_capacity; ++slot)
+        {
+            if (index->postings[slot].key != 0U)
+            {
+                size_t probe = search_index_key_hash(index->postings[slot].key, capacity);
+                while (postings[probe].key != 0U)
+                {
+                    probe = (probe + 1U) & (capacity - 1U);
+                }
+                postings[probe] = index->postings[slot];
+            }
+        }
+        AT_FREE(index->postings);
+        index->postings = postings;
+        index->posting_capacity = capacity;
+    }
+    size_t probe = search_index_key_hash(key, index->posting_capacity);
+    while (index->postings[probe].key != 0U)
+    {
+        probe = (probe + 1U) & (index->posting_capacity - 1U);
+    }
+    index->postings[probe].key = key;
+    index->posting_used++;
+    return &index->postings[probe];
+}
+
+static bool search_index_add_trigrams(SearchIndex *index, uint32_t slot, const char *folded)
+{
+    size_t length = strlen(folded);
+    for (size_t offset = 0U; offset + 3U <= length; ++offset)
+    {
+        SearchIndexPosting *posting = search_index_posting_insert(index, search_index_trigram(folded + offset));
+        if (!posting)
+        {
+            return false;
+        }
+        /* A trigram repeated within one name would otherwise list the slot twice in a row. */
+        if (posting->count > 0U && posting->slots[posting->count - 1U] == slot)
+        {
+            continue;
+        }
+        if (posting->count == posting->capacity)
+        {
+            uint32_t capacity = posting->capacity > 0U ? posting->capacity * 2U : 4U;
+            uint32_t *slots = at_secure_realloc(posting->slots, capacity, sizeof(uint32_t));
+            if (!slots)
+            {
+                return false;
+            }
+            posting->slots = slots;
+            posting->capacity = capacity;
+        }
+        posting->slots[posting->count++] = slot;
+        index->posting_total++;
+    }
+    return true;
+}
+
+static size_t search_index_trigram_count(const char *folded)
+{
+    size_t length = folded ? strlen(folded) : 0U;
+    return length >= 3U ? length - 2U : 0U;
+}
+
+static bool search_index_append(SearchIndex *index, const Person *person)
+{
+    if (index->entry_count == index->entry_capacity)
+    {
+        size_t capacity = index->entry_capacity > 0U ? index->entry_capacity * 2U : 64U;
+        SearchIndexEntry *entries = at_secure_realloc(index->entries, capacity, sizeof(SearchIndexEntry));
+        if (!entries)
+        {
+            return false;
+        }
+        index->entries = entries;
+        index->entry_capacity = capacity;
+    }
+    if (index->entry_count >= UINT32_MAX || !search_index_person_reserve(index, 1U))
+    {
+        return false;
+    }
+    char folded[SEARCH_INDEX_NAME_CAPACITY];
+    search_index_fold_name(person, folded, sizeof(folded));
+    char *copy = at_string_dup(folded);
+    if (!copy)
+    {
+        return false;
+    }
+    uint32_t slot = (uint32_t)index->entry_count++;
+    index->entries[slot].person = person;
+    index->entries[slot].folded = copy;
+    index->live_count++;
+    search_index_person_put(index, person, slot);
+    return search_index_add_trigrams(index, slot, copy);
+}
+
+/* Leftovers from edits only cost query time, so they are swept by a full rebuild once they dominate. */
+static void search_index_check_waste(SearchIndex *index)
+{
+    size_t dead = index->entry_count - index->live_count;
+    if ((index->posting_stale > SEARCH_INDEX_REBUILD_MIN && index->posting_stale * 2U > index->posting_total) ||
+        (dead > SEARCH_INDEX_REBUILD_MIN && dead > index->live_count))
+    {
+        index->built = false;
+    }
+}
+
+bool search_index_ensure(SearchIndex *index, Person *const *persons, size_t count)
+{
+    if (!index)
+    {
+        return false;
+    }
+    if (index->built)
+    {
+        return true;
+    }
+    search_index_clear(index);
+    for (size_t position = 0U; position < count; ++position)
+    {
+        if (persons[position] && !search_index_append(index, persons[position]))
+        {
+            search_index_clear(index);
+            return false;
+        }
+    }
+    index->built = true;
+    return true;
+}
+
+void search_index_add_person(SearchIndex *index, const Person *person)
+{
+    if (!index || !index->built || !person)
+    {
+        return;
+    }
+    if (search_index_find_slot(index, person) != UINT32_MAX)
+    {
+        search_index_update_person(index, person);
+        return;
+    }
+    if (!search_index_append(index, person))
+    {
+        index->built = false;
+    }
+}
+
+void search_index_update_person(SearchIndex *index, const Person *person)
+{
+    if (!index || !index->built)
+    {
+        return;
+    }
+    uint32_t slot = search_index_find_slot(index, person);
+    if (slot == UINT32_MAX)
+    {
+        return;
+    }
+    char folded[SEARCH_INDEX_NAME_CAPACITY];
+    search_index_fold_name(person, folded, sizeof(folded));
+    SearchIndexEntry *entry = &index->entries[slot];
+    if (strcmp(entry->folded, folded) == 0)
+    {
+        return;
+    }
+    char *copy = at_string_dup(folded);
+    if (!copy)
+    {
+        index->built = false;
+        return;
+    }
+    index->posting_stale += search_index_trigram_count(entry->folded);
+    AT_FREE(entry->folded);
+    entry->folded = copy;
+    if (!search_index_add_trigrams(index, slot, copy))
+    {
+        index->built = false;
+        return;
+    }
+    search_index_check_waste(index);
+}
+
+void search_index_remove_person(SearchIndex *index, const Person *person)
+{
+    if (!index || !index->built)
+    {
+        return;
+    }
+    uint32_t slot = search_index_find_slot(index, person);
+    if (slot == UINT32_MAX)
+    {
+        return;
+    }
+    SearchIndexEntry *entry = &index->entries[slot];
+    index->posting_stale += search_index_trigram_count(entry->folded);
+    AT_FREE(entry->folded);
+    entry->folded = NULL;
+    entry->person = NULL;
+    index->live_count--;
+    search_index_check_waste(index);
+}
+
+const char *search_index_folded_name(const SearchIndex *index, const Person *person)
+{
+    if (!index || !index->built)
+    {
+        return NULL;
+    }
+    uint32_t slot = search_index_find_slot(index, person);
+    return slot != UINT32_MAX ? index->entries[slot].folded : NULL;
+}
+
+static int search_index_compare_slots(const void *lhs, const void *rhs)
+{
+    uint32_t left = *(const uint32_t *)lhs;
+    uint32_t right = *(const uint32_t *)rhs;
+    return (left > right) - (left < right);
+}
+
+static bool search_index_visit_slot(const SearchIndex *index, uint32_t slot, const char *needle,
+                                    SearchIndexVisitor visit, void *user_data, size_t *visited)
+{
+    const SearchIndexEntry *entry = &index->entries[slot];
+    if (!entry->person || !strstr(entry->folded, needle))
+    {
+        return true;
+    }
+    (*visited)++;
+    return visit(entry->person, entry->folded, user_data);
+}
+
+size_t search_index_query(const SearchIndex *index, const char *needle, SearchIndexVisitor visit, void *user_data)
+{
+    if (!index || !index->built || !needle || !visit)
+    {
+        return 0U;
+    }
+    size_t visited = 0U;
+    size_t length = strlen(needle);
+    if (length < 3U)
+    {
+        /* Too short for a trigram; scanning the folded names still skips all name formatting. */
+        for (uint32_t slot = 0U; slot < (uint32_t)index->entry_count; ++slot)
+        {
+            if (!search_index_visit_slot(index, slot, needle, visit, user_data, &visited))
+            {
+                break;
+            }
+        }
+        return visited;
+    }
+
+    /* Every match contains all of the needle's trigrams, so the shortest posting list bounds the candidates. */
+    const SearchIndexPosting *best = NULL;
+    for (size_t offset = 0U; offset + 3U <= length; ++offset)
+    {
+        const SearchIndexPosting *posting = search_index_posting_find(index, search_index_trigram(needle + offset));
+        if (!posting || posting->count == 0U)
+        {
+            return 0U;
+        }
+        if (!best || posting->count < best->count)
+        {
+            best = posting;
+        }
+    }
+    const uint32_t *candidates = best->slots;
+    uint32_t *sorted = NULL;
+    for (uint32_t position = 1U; position < best->count; ++position)
+    {
+        if (best->slots[position] < best->slots[position - 1U])
+        {
+            /* Renamed entries append their old slot out of order; restore index order for the caller. */
+            sorted = AT_MALLOC(best->count * sizeof(uint32_t));
+            if (!sorted)
+            {
+                return 0U;
+            }
+            memcpy(sorted, best->slots, best->count * sizeof(uint32_t));
+            qsort(sorted, best->count, sizeof(uint32_t), search_index_compare_slots);
+            candidates = sorted;
+            break;
+        }
+    }
+    for (uint32_t position = 0U; position < best->count; ++position)
+    {
+        if (position > 0U && candidates[position] == candidates[position - 1U])
+        {
+            continue;
+        }
+        if (!search_index_visit_slot(index, candidates[position], needle, visit, user_data, &visited))
+        {
+            break;
+        }
+    }
+    AT_FREE(sorted);
+    return visited;
+}
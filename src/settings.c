@@ -5,6 +5,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#if !defined(_MSC_VER)
+#include <strings.h>
+#endif
 
 static int settings_strcasecmp(const char *a, const char *b)
 {
@@ -31,6 +34,7 @@ static void settings_set_defaults(Settings *settings)
     settings->default_layout_algorithm = SETTINGS_LAYOUT_ALGORITHM_HIERARCHICAL;
     settings->color_scheme = SETTINGS_COLOR_SCHEME_CYAN_GRAPH;
     settings->language = SETTINGS_LANGUAGE_ENGLISH;
+    settings->texture_budget_megabytes = 256U;
 }
 
 void settings_init_defaults(Settings *settings)
@@ -238,6 +242,14 @@ bool settings_try_load(Settings *settings, const char *path, char *error_buffer,
                 settings->language = (SettingsLanguage)parsed;
             }
         }
+        else if (settings_strcasecmp(key, "texture_budget_megabytes") == 0)
+        {
+            unsigned int parsed = 0U;
+            if (settings_parse_uint(value, &parsed) && parsed >= 16U && parsed <= 8192U)
+            {
+                settings->texture_budget_megabytes = parsed;
+            }
+        }
     }
 
     fclose(stream);
@@ -287,12 +299,14 @@ bool settings_save(const Settings *settings, const char *path, char *error_buffe
                           "auto_save_interval_seconds=%u\n"
                           "default_layout_algorithm=%u\n"
                           "color_scheme=%u\n"
-                          "language=%u\n",
+                          "language=%u\n"
+                          "texture_budget_megabytes=%u\n",
                           (unsigned int)settings->graphics_quality, settings->camera_rotation_sensitivity,
                           settings->camera_pan_sensitivity, settings->camera_keyboard_pan_sensitivity,
                           settings->camera_zoom_sensitivity, settings->auto_save_enabled ? 1U : 0U,
                           settings->auto_save_interval_seconds, (unsigned int)settings->default_layout_algorithm,
-                          (unsigned int)settings->color_scheme, (unsigned int)settings->language);
+                          (unsigned int)settings->color_scheme, (unsigned int)settings->language,
+                          settings->texture_budget_megabytes);
 
     bool success = written >= 0;
     if (!success && error_buffer && error_buffer_size > 0U)
@@ -8,6 +8,10 @@
 #define DEFAULT_KEYBOARD_PAN_SENSITIVITY 1.0f
 #define DEFAULT_ZOOM_SENSITIVITY 1.0f
 
+#define DEFAULT_TEXTURE_BUDGET_MEGABYTES 256U
+#define MIN_TEXTURE_BUDGET_MEGABYTES 16U
+#define MAX_TEXTURE_BUDGET_MEGABYTES 8192U
+
 #define BASE_ROTATION_SPEED 1.5f
 #define BASE_PAN_SPEED 10.0f
 #define BASE_ZOOM_SPEED 15.0f
@@ -167,3 +171,23 @@ bool settings_runtime_apply_render(const Settings *settings, RenderConfig *confi
     apply_color_scheme(config, settings->color_scheme);
     return true;
 }
+
+bool settings_runtime_apply_texture_budget(const Settings *settings, TextureResidency *residency)
+{
+    if (!residency)
+    {
+        return false;
+    }
+
+    unsigned int megabytes = settings ? settings->texture_budget_megabytes : DEFAULT_TEXTURE_BUDGET_MEGABYTES;
+    if (megabytes < MIN_TEXTURE_BUDGET_MEGABYTES)
+    {
+        megabytes = MIN_TEXTURE_BUDGET_MEGABYTES;
+    }
+    if (megabytes > MAX_TEXTURE_BUDGET_MEGABYTES)
+    {
+        megabytes = MAX_TEXTURE_BUDGET_MEGABYTES;
+    }
+    texture_residency_set_budget(residency, (size_t)megabytes * 1024U * 1024U);
+    return true;
+}
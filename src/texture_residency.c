@@ -0,0 +1,258 @@
+#include "texture_residency.h"
+
+#include "at_memory.h"
+
+#include <string.h>
+
+static TextureResidencyEntry *texture_residency_entry(TextureResidency *residency, TextureResidencyHandle handle)
+{
+    if (!residency || handle == 0U || (size_t)handle > residency->capacity)
+    {
+        return NULL;
+    }
+    TextureResidencyEntry *entry = &residency->entries[handle - 1U];
+    return entry->in_use ? entry : NULL;
+}
+
+static void texture_residency_unlink(TextureResidency *residency, TextureResidencyHandle handle)
+{
+    TextureResidencyEntry *entry = &residency->entries[handle - 1U];
+    if (entry->previous != 0U)
+    {
+        residency->entries[entry->previous - 1U].next = entry->next;
+    }
+    else
+    {
+        residency->lru_head = entry->next;
+    }
+    if (entry->next != 0U)
+    {
+        residency->entries[entry->next - 1U].previous = entry->previous;
+    }
+    else
+    {
+        residency->lru_tail = entry->previous;
+    }
+    entry->previous = 0U;
+    entry->next = 0U;
+}
+
+static void texture_residency_append(TextureResidency *residency, TextureResidencyHandle handle)
+{
+    TextureResidencyEntry *entry = &residency->entries[handle - 1U];
+    entry->previous = residency->lru_tail;
+    entry->next = 0U;
+    if (residency->lru_tail != 0U)
+    {
+        residency->entries[residency->lru_tail - 1U].next = handle;
+    }
+    else
+    {
+        residency->lru_head = handle;
+    }
+    residency->lru_tail = handle;
+}
+
+/* Unlinks the entry, drops its bytes and puts it on the free list. */
+static void texture_residency_forget(TextureResidency *residency, TextureResidencyHandle handle)
+{
+    TextureResidencyEntry *entry = &residency->entries[handle - 1U];
+    texture_residency_unlink(residency, handle);
+    TextureResidencyCounters *counters = &residency->counters;
+    counters->resident_bytes -= entry->bytes;
+    counters->resident_textures -= 1U;
+    counters->bytes_by_kind[entry->kind] -= entry->bytes;
+    counters->textures_by_kind[entry->kind] -= 1U;
+    entry->in_use = false;
+    entry->evict = NULL;
+    entry->owner = NULL;
+    entry->next = residency->free_head;
+    residency->free_head = handle;
+}
+
+/* Touched entries move to the tail, so the head is the least recently used and everything from the first entry
+ * drawn this frame onwards is pinned. */
+static void texture_residency_evict_until(TextureResidency *residency, size_t limit)
+{
+    while (residency->counters.resident_bytes > limit && residency->lru_head != 0U)
+    {
+        TextureResidencyHandle handle = residency->lru_head;
+        TextureResidencyEntry *entry = &residency->entries[handle - 1U];
+        if (entry->last_frame == residency->frame)
+        {
+            break;
+        }
+        TextureResidencyEvictFunction evict = entry->evict;
+        void *owner = entry->owner;
+        size_t slot = entry->slot;
+        residency->counters.evictions += 1U;
+        residency->counters.evicted_bytes += entry->bytes;
+        texture_residency_forget(residency, handle);
+        if (evict)
+        {
+            evict(owner, slot);
+        }
+    }
+}
+
+void texture_residency_init(TextureResidency *residency, size_t budget_bytes)
+{
+    if (!residency)
+    {
+        return;
+    }
+    memset(residency, 0, sizeof(*residency));
+    residency->frame = 1U;
+    residency->counters.budget_bytes = budget_bytes;
+}
+
+void texture_residency_shutdown(TextureResidency *residency)
+{
+    if (!residency)
+    {
+        return;
+    }
+    AT_FREE(residency->entries);
+    size_t budget_bytes = residency->counters.budget_bytes;
+    texture_residency_init(residency, budget_bytes);
+}
+
+void texture_residency_set_budget(TextureResidency *residency, size_t budget_bytes)
+{
+    if (!residency)
+    {
+        return;
+    }
+    residency->counters.budget_bytes = budget_bytes;
+    texture_residency_evict_until(residency, budget_bytes);
+}
+
+void texture_residency_begin_frame(TextureResidency *residency)
+{
+    if (residency)
+    {
+        residency->frame += 1U;
+    }
+}
+
+size_t texture_residency_estimate_bytes(int width, int height, bool mipmapped)
+{
+    if (width <= 0 || height <= 0)
+    {
+        return 0U;
+    }
+    size_t bytes = (size_t)width * (size_t)height * 4U;
+    return mipmapped ? bytes + bytes / 3U : bytes;
+}
+
+bool texture_residency_reserve(TextureResidency *residency, size_t bytes)
+{
+    if (!residency)
+    {
+        return true;
+    }
+    size_t budget = residency->counters.budget_bytes;
+    if (bytes > budget)
+    {
+        residency->counters.rejected_reservations += 1U;
+        return false;
+    }
+    texture_residency_evict_until(residency, budget - bytes);
+    if (residency->counters.resident_bytes > budget - bytes)
+    {
+        residency->counters.rejected_reservations += 1U;
+        return false;
+    }
+    return true;
+}
+
+static bool texture_residency_grow(TextureResidency *residency)
+{
+    size_t capacity = residency->capacity == 0U ? 64U : residency->capacity * 2U;
+    if (capacity > (size_t)UINT32_MAX)
+    {
+        return false;
+    }
+    TextureResidencyEntry *entries =
+        (TextureResidencyEntry *)at_secure_realloc(residency->entries, capacity, sizeof(TextureResidencyEntry));
+    if (!entries)
+    {
+        return false;
+    }
+    /* Thread the new entries onto the free list in index order. */
+    for (size_t index = capacity; index > residency->capacity; --index)
+    {
+        TextureResidencyEntry *entry = &entries[index - 1U];
+        memset(entry, 0, sizeof(*entry));
+        entry->next = residency->free_head;
+        residency->free_head = (uint32_t)index;
+    }
+    residency->entries = entries;
+    residency->capacity = capacity;
+    return true;
+}
+
+TextureResidencyHandle texture_residency_track(TextureResidency *residency, TextureResidencyKind kind,
+                                               size_t bytes, TextureResidencyEvictFunction evict, void *owner,
+                                               size_t slot)
+{
+    if (!residency || kind >= TEXTURE_RESIDENCY_KIND_COUNT)
+    {
+        return 0U;
+    }
+    if (residency->free_head == 0U && !texture_residency_grow(residency))
+    {
+        return 0U;
+    }
+    TextureResidencyHandle handle = residency->free_head;
+    TextureResidencyEntry *entry = &residency->entries[handle - 1U];
+    residency->free_head = entry->next;
+    entry->kind = kind;
+    entry->bytes = bytes;
+    entry->last_frame = residency->frame;
+    entry->evict = evict;
+    entry->owner = owner;
+    entry->slot = slot;
+    entry->in_use = true;
+    texture_residency_append(residency, handle);
+
+    TextureResidencyCounters *counters = &residency->counters;
+    counters->resident_bytes += bytes;
+    counters->resident_textures += 1U;
+    counters->bytes_by_kind[kind] += bytes;
+    counters->textures_by_kind[kind] += 1U;
+    if (counters->resident_bytes > counters->peak_bytes)
+    {
+        counters->peak_bytes = counters->resident_bytes;
+    }
+    return handle;
+}
+
+void texture_residency_touch(TextureResidency *residency, TextureResidencyHandle handle)
+{
+    TextureResidencyEntry *entry = texture_residency_entry(residency, handle);
+    if (!entry || entry->last_frame == residency->frame)
+    {
+        return;
+    }
+    entry->last_frame = residency->frame;
+    texture_residency_unlink(residency, handle);
+    texture_residency_append(residency, handle);
+}
+
+void texture_residency_release(TextureResidency *residency, TextureResidencyHandle handle)
+{
+    if (texture_residency_entry(residency, handle))
+    {
+        texture_residency_forget(residency, handle);
+    }
+}
+
+void texture_residency_get_counters(const TextureResidency *residency, TextureResidencyCounters *out_counters)
+{
+    if (!residency || !out_counters)
+    {
+        return;
+    }
+    *out_counters = residency->counters;
+}
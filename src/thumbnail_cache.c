@@ -0,0 +1,879 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "thumbnail_cache.h"
+
+#include "at_memory.h"
+#include "at_string.h"
+#include "at_thread.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <direct.h>
+#endif
+
+#if defined(ANCESTRYTREE_HAVE_RAYLIB)
+#include <raylib.h>
+#endif
+
+/* Cache file: magic, u64 key, u32 width, u32 height (all little-endian), then width * height RGBA8 pixels. */
+static const unsigned char g_thumbnail_magic[8] = {'A', 'T', 'T', 'H', 'U', 'M', 'B', '1'};
+#define THUMBNAIL_HEADER_SIZE 24U
+#define THUMBNAIL_PATH_MAX 512
+#define THUMBNAIL_MAX_WORKERS 4U
+#define THUMBNAIL_DEFAULT_PREFETCH_BUDGET (32U * 1024U * 1024U)
+
+typedef enum ThumbnailJobState
+{
+    THUMBNAIL_JOB_QUEUED = 0,
+    THUMBNAIL_JOB_RUNNING,
+    THUMBNAIL_JOB_READY,
+    THUMBNAIL_JOB_FAILED
+} ThumbnailJobState;
+
+typedef struct ThumbnailJob
+{
+    char *path;
+    ThumbnailJobState state;
+    ThumbnailImage image;
+    uint64_t path_hash;
+    bool prefetch; /* Nobody has asked for it yet; its pixels count against the prefetch budget. */
+} ThumbnailJob;
+
+struct ThumbnailCache
+{
+    ThumbnailCacheConfig config;
+    char *cache_directory;
+    ThumbnailJob **jobs; /* Request order; workers take the oldest queued fetch, then the oldest prefetch. */
+    size_t job_count;
+    size_t job_capacity;
+    ThumbnailJob **slots; /* Jobs by path hash, linear probing, at most half full; NULL marks an empty slot. */
+    size_t slot_capacity;
+    size_t busy; /* Queued plus running. */
+    size_t prefetch_budget;
+    ThumbnailCacheStats stats;
+    bool stopping;
+    AtMutex mutex;
+    AtCondition work;
+    AtCondition idle;
+    AtThread *workers;
+    size_t worker_count;
+};
+
+static void thumbnail_set_error(char *error_buffer, size_t error_buffer_size, const char *message, const char *path)
+{
+    if (!error_buffer || error_buffer_size == 0U)
+    {
+        return;
+    }
+    if (path)
+    {
+        (void)snprintf(error_buffer, error_buffer_size, "%s: %s", message, path);
+    }
+    else
+    {
+        (void)snprintf(error_buffer, error_buffer_size, "%s", message);
+    }
+}
+
+static bool thumbnail_pixel_bytes(int width, int height, size_t *out_bytes)
+{
+    if (width <= 0 || height <= 0 || (size_t)width > SIZE_MAX / 4U / (size_t)height)
+    {
+        return false;
+    }
+    *out_bytes = (size_t)width * (size_t)height * 4U;
+    return true;
+}
+
+void thumbnail_image_reset(ThumbnailImage *image)
+{
+    if (!image)
+    {
+        return;
+    }
+    AT_FREE(image->pixels);
+    image->pixels = NULL;
+    image->width = 0;
+    image->height = 0;
+}
+
+bool thumbnail_downscale(const ThumbnailImage *source, int max_edge, ThumbnailImage *out_image)
+{
+    size_t source_bytes = 0U;
+    if (!source || !source->pixels || !out_image || max_edge <= 0 ||
+        !thumbnail_pixel_bytes(source->width, source->height, &source_bytes))
+    {
+        return false;
+    }
+    int width = source->width;
+    int height = source->height;
+    if (width > max_edge || height > max_edge)
+    {
+        if (width >= height)
+        {
+            height = (int)(((long long)height * max_edge + width / 2) / width);
+            width = max_edge;
+        }
+        else
+        {
+            width = (int)(((long long)width * max_edge + height / 2) / height);
+            height = max_edge;
+        }
+        width = width > 0 ? width : 1;
+        height = height > 0 ? height : 1;
+    }
+    size_t bytes = (size_t)width * (size_t)height * 4U;
+    unsigned char *pixels = (unsigned char *)AT_MALLOC(bytes);
+    if (!pixels)
+    {
+        return false;
+    }
+    if (width == source->width && height == source->height)
+    {
+        memcpy(pixels, source->pixels, source_bytes);
+    }
+    else
+    {
+        /* Each output pixel averages the block of source pixels it covers; blocks tile the source exactly. */
+        size_t source_stride = (size_t)source->width * 4U;
+        for (int y = 0; y < height; ++y)
+        {
+            size_t y0 = (size_t)y * (size_t)source->height / (size_t)height;
+            size_t y1 = ((size_t)y + 1U) * (size_t)source->height / (size_t)height;
+            y1 = y1 > y0 ? y1 : y0 + 1U;
+            for (int x = 0; x < width; ++x)
+            {
+                size_t x0 = (size_t)x * (size_t)source->width / (size_t)width;
+                size_t x1 = ((size_t)x + 1U) * (size_t)source->width / (size_t)width;
+                x1 = x1 > x0 ? x1 : x0 + 1U;
+                uint64_t sums[4] = {0U, 0U, 0U, 0U};
+                for (size_t row = y0; row < y1; ++row)
+                {
+                    const unsigned char *cursor = source->pixels + row * source_stride + x0 * 4U;
+                    for (size_t column = x0; column < x1; ++column, cursor += 4)
+                    {
+                        sums[0] += cursor[0];
+                        sums[1] += cursor[1];
+                        sums[2] += cursor[2];
+                        sums[3] += cursor[3];
+                    }
+                }
+                uint64_t area = (uint64_t)(y1 - y0) * (uint64_t)(x1 - x0);
+                unsigned char *target = pixels + ((size_t)y * (size_t)width + (size_t)x) * 4U;
+                for (int channel = 0; channel < 4; ++channel)
+                {
+                    target[channel] = (unsigned char)((sums[channel] + area / 2U) / area);
+                }
+            }
+        }
+    }
+    out_image->pixels = pixels;
+    out_image->width = width;
+    out_image->height = height;
+    return true;
+}
+
+static uint64_t thumbnail_hash_bytes(uint64_t hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = (const unsigned char *)data;
+    for (size_t index = 0U; index < size; ++index)
+    {
+        hash ^= bytes[index];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+bool thumbnail_cache_key(const char *path, int max_edge, uint64_t *out_key)
+{
+    if (!path || path[0] == '\0' || !out_key)
+    {
+        return false;
+    }
+#if defined(_WIN32)
+    struct _stat64 info;
+    if (_stat64(path, &info) != 0)
+    {
+        return false;
+    }
+#else
+    struct stat info;
+    if (stat(path, &info) != 0)
+    {
+        return false;
+    }
+#endif
+    int64_t modified = (int64_t)info.st_mtime;
+    uint64_t size = (uint64_t)info.st_size;
+    uint64_t hash = thumbnail_hash_bytes(14695981039346656037ULL, path, strlen(path));
+    hash = thumbnail_hash_bytes(hash, &modified, sizeof(modified));
+    hash = thumbnail_hash_bytes(hash, &size, sizeof(size));
+    hash = thumbnail_hash_bytes(hash, &max_edge, sizeof(max_edge));
+    *out_key = hash;
+    return true;
+}
+
+static int thumbnail_max_edge(const ThumbnailCacheConfig *config)
+{
+    return config->max_edge > 0 ? config->max_edge : THUMBNAIL_DEFAULT_MAX_EDGE;
+}
+
+static bool thumbnail_cache_file_path(const ThumbnailCacheConfig *config, uint64_t key, const char *suffix,
+                                      char *buffer, size_t capacity)
+{
+    int written = snprintf(buffer, capacity, "%s/%016llx%s", config->cache_directory, (unsigned long long)key,
+                           suffix);
+    return written > 0 && (size_t)written < capacity;
+}
+
+static void thumbnail_put_u32(unsigned char *out, uint32_t value)
+{
+    for (unsigned int index = 0U; index < 4U; ++index)
+    {
+        out[index] = (unsigned char)(value >> (8U * index));
+    }
+}
+
+static uint64_t thumbnail_get_le(const unsigned char *in, unsigned int bytes)
+{
+    uint64_t value = 0U;
+    for (unsigned int index = 0U; index < bytes; ++index)
+    {
+        value |= (uint64_t)in[index] << (8U * index);
+    }
+    return value;
+}
+
+/* A missing, truncated or mismatched file is a miss rather than an error; the caller rebuilds it. */
+static bool thumbnail_cache_read(const char *file_path, uint64_t key, int max_edge, ThumbnailImage *out_image)
+{
+    FILE *file = fopen(file_path, "rb");
+    if (!file)
+    {
+        return false;
+    }
+    unsigned char header[THUMBNAIL_HEADER_SIZE];
+    bool valid = fread(header, 1U, sizeof(header), file) == sizeof(header) &&
+                 memcmp(header, g_thumbnail_magic, sizeof(g_thumbnail_magic)) == 0 &&
+                 thumbnail_get_le(header + 8U, 8U) == key;
+    uint64_t width = valid ? thumbnail_get_le(header + 16U, 4U) : 0U;
+    uint64_t height = valid ? thumbnail_get_le(header + 20U, 4U) : 0U;
+    size_t bytes = 0U;
+    valid = valid && width <= (uint64_t)max_edge && height <= (uint64_t)max_edge &&
+            thumbnail_pixel_bytes((int)width, (int)height, &bytes);
+    unsigned char *pixels = valid ? (unsigned char *)AT_MALLOC(bytes) : NULL;
+    valid = pixels && fread(pixels, 1U, bytes, file) == bytes;
+    fclose(file);
+    if (!valid)
+    {
+        AT_FREE(pixels);
+        return false;
+    }
+    out_image->pixels = pixels;
+    out_image->width = (int)width;
+    out_image->height = (int)height;
+    return true;
+}
+
+static bool thumbnail_create_directory(const char *path)
+{
+#if defined(_WIN32)
+    int result = _mkdir(path);
+#else
+    int result = mkdir(path, 0775);
+#endif
+    return result == 0 || errno == EEXIST;
+}
+
+/* Written under a temporary name and renamed into place, so readers never see a partial thumbnail. */
+static bool thumbnail_cache_write(const ThumbnailCacheConfig *config, uint64_t key, const ThumbnailImage *image)
+{
+    char final_path[THUMBNAIL_PATH_MAX];
+    char temp_path[THUMBNAIL_PATH_MAX];
+    if (!thumbnail_cache_file_path(config, key, ".thumb", final_path, sizeof(final_path)) ||
+        !thumbnail_cache_file_path(config, key, ".tmp", temp_path, sizeof(temp_path)) ||
+        !thumbnail_create_directory(config->cache_directory))
+    {
+        return false;
+    }
+    FILE *file = fopen(temp_path, "wb");
+    if (!file)
+    {
+        return false;
+    }
+    unsigned char header[THUMBNAIL_HEADER_SIZE];
+    memcpy(header, g_thumbnail_magic, sizeof(g_thumbnail_magic));
+    thumbnail_put_u32(header + 8U, (uint32_t)key);
+    thumbnail_put_u32(header + 12U, (uint32_t)(key >> 32U));
+    thumbnail_put_u32(header + 16U, (uint32_t)image->width);
+    thumbnail_put_u32(header + 20U, (uint32_t)image->height);
+    size_t bytes = (size_t)image->width * (size_t)image->height * 4U;
+    bool written = fwrite(header, 1U, sizeof(header), file) == sizeof(header) &&
+                   fwrite(image->pixels, 1U, bytes, file) == bytes;
+    written = (fclose(file) == 0) && written;
+#if defined(_WIN32)
+    written = written && MoveFileExA(temp_path, final_path, MOVEFILE_REPLACE_EXISTING);
+#else
+    written = written && rename(temp_path, final_path) == 0;
+#endif
+    if (!written)
+    {
+        (void)remove(temp_path);
+    }
+    return written;
+}
+
+static bool thumbnail_build(const ThumbnailCacheConfig *config, const char *path, ThumbnailImage *out_image,
+                            bool *out_cache_hit, char *error_buffer, size_t error_buffer_size)
+{
+    if (out_cache_hit)
+    {
+        *out_cache_hit = false;
+    }
+    if (!config || !config->cache_directory || !config->decode || !path || !out_image)
+    {
+        thumbnail_set_error(error_buffer, error_buffer_size, "invalid thumbnail request", NULL);
+        return false;
+    }
+    int max_edge = thumbnail_max_edge(config);
+    uint64_t key = 0U;
+    if (!thumbnail_cache_key(path, max_edge, &key))
+    {
+        thumbnail_set_error(error_buffer, error_buffer_size, "image not found", path);
+        return false;
+    }
+    char cache_path[THUMBNAIL_PATH_MAX];
+    if (!thumbnail_cache_file_path(config, key, ".thumb", cache_path, sizeof(cache_path)))
+    {
+        thumbnail_set_error(error_buffer, error_buffer_size, "thumbnail cache path too long", NULL);
+        return false;
+    }
+    if (thumbnail_cache_read(cache_path, key, max_edge, out_image))
+    {
+        if (out_cache_hit)
+        {
+            *out_cache_hit = true;
+        }
+        return true;
+    }
+    ThumbnailImage decoded = {NULL, 0, 0};
+    if (!config->decode(path, &decoded, config->decode_user_data))
+    {
+        thumbnail_image_reset(&decoded);
+        thumbnail_set_error(error_buffer, error_buffer_size, "failed to decode image", path);
+        return false;
+    }
+    bool scaled = thumbnail_downscale(&decoded, max_edge, out_image);
+    thumbnail_image_reset(&decoded);
+    if (!scaled)
+    {
+        thumbnail_set_error(error_buffer, error_buffer_size, "failed to downscale image", path);
+        return false;
+    }
+    /* A failed store only costs a decode next time. */
+    (void)thumbnail_cache_write(config, key, out_image);
+    return true;
+}
+
+bool thumbnail_cache_load_or_build(const ThumbnailCacheConfig *config, const char *path,
+                                   ThumbnailImage *out_image, bool *out_cache_hit, char *error_buffer,
+                                   size_t error_buffer_size)
+{
+    return thumbnail_build(config, path, out_image, out_cache_hit, error_buffer, error_buffer_size);
+}
+
+#if defined(ANCESTRYTREE_HAVE_RAYLIB)
+static bool thumbnail_decode_raylib(const char *path, ThumbnailImage *out_image, void *user_data)
+{
+    (void)user_data;
+    Image image = LoadImage(path);
+    if (!image.data)
+    {
+        return false;
+    }
+    ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    size_t bytes = 0U;
+    bool valid = image.format == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 &&
+                 thumbnail_pixel_bytes(image.width, image.height, &bytes);
+    unsigned char *pixels = valid ? (unsigned char *)AT_MALLOC(bytes) : NULL;
+    if (pixels)
+    {
+        memcpy(pixels, image.data, bytes);
+        out_image->pixels = pixels;
+        out_image->width = image.width;
+        out_image->height = image.height;
+    }
+    UnloadImage(image);
+    return pixels != NULL;
+}
+#endif
+
+static void thumbnail_job_destroy(ThumbnailJob *job)
+{
+    if (!job)
+    {
+        return;
+    }
+    thumbnail_image_reset(&job->image);
+    AT_FREE(job->path);
+    AT_FREE(job);
+}
+
+static uint64_t thumbnail_path_hash(const char *path)
+{
+    return thumbnail_hash_bytes(14695981039346656037ULL, path, strlen(path));
+}
+
+/* Returns the slot holding path, or the empty slot where it would go. */
+static size_t thumbnail_cache_slot_locked(const ThumbnailCache *cache, const char *path, uint64_t hash)
+{
+    size_t mask = cache->slot_capacity - 1U;
+    size_t slot = (size_t)hash & mask;
+    while (cache->slots[slot] &&
+           (cache->slots[slot]->path_hash != hash || strcmp(cache->slots[slot]->path, path) != 0))
+    {
+        slot = (slot + 1U) & mask;
+    }
+    return slot;
+}
+
+static ThumbnailJob *thumbnail_cache_find_locked(ThumbnailCache *cache, const char *path)
+{
+    if (cache->slot_capacity == 0U)
+    {
+        return NULL;
+    }
+    return cache->slots[thumbnail_cache_slot_locked(cache, path, thumbnail_path_hash(path))];
+}
+
+/* Sizes the slots for required jobs and reinserts every job. */
+static bool thumbnail_cache_reindex_locked(ThumbnailCache *cache, size_t required)
+{
+    size_t slot_capacity = 32U;
+    while (slot_capacity < required * 2U)
+    {
+        slot_capacity *= 2U;
+    }
+    ThumbnailJob **slots = (ThumbnailJob **)AT_CALLOC(slot_capacity, sizeof(ThumbnailJob *));
+    if (!slots)
+    {
+        return false;
+    }
+    AT_FREE(cache->slots);
+    cache->slots = slots;
+    cache->slot_capacity = slot_capacity;
+    for (size_t index = 0U; index < cache->job_count; ++index)
+    {
+        ThumbnailJob *job = cache->jobs[index];
+        cache->slots[thumbnail_cache_slot_locked(cache, job->path, job->path_hash)] = job;
+    }
+    return true;
+}
+
+/* Backward-shift deletion, so lookups never meet tombstones. */
+static void thumbnail_cache_unindex_locked(ThumbnailCache *cache, const ThumbnailJob *job)
+{
+    size_t mask = cache->slot_capacity - 1U;
+    size_t hole = thumbnail_cache_slot_locked(cache, job->path, job->path_hash);
+    if (cache->slots[hole] != job)
+    {
+        return;
+    }
+    size_t slot = (hole + 1U) & mask;
+    while (cache->slots[slot])
+    {
+        size_t home = (size_t)cache->slots[slot]->path_hash & mask;
+        bool home_between = (hole <= slot) ? (home > hole && home <= slot) : (home > hole || home <= slot);
+        if (!home_between)
+        {
+            cache->slots[hole] = cache->slots[slot];
+            hole = slot;
+        }
+        slot = (slot + 1U) & mask;
+    }
+    cache->slots[hole] = NULL;
+}
+
+static size_t thumbnail_cache_position_locked(const ThumbnailCache *cache, const ThumbnailJob *job)
+{
+    size_t index = 0U;
+    while (index < cache->job_count && cache->jobs[index] != job)
+    {
+        ++index;
+    }
+    return index;
+}
+
+static size_t thumbnail_job_bytes(const ThumbnailJob *job)
+{
+    return job->image.pixels ? (size_t)job->image.width * (size_t)job->image.height * 4U : 0U;
+}
+
+static void thumbnail_cache_remove_locked(ThumbnailCache *cache, size_t index)
+{
+    ThumbnailJob *job = cache->jobs[index];
+    thumbnail_cache_unindex_locked(cache, job);
+    memmove(&cache->jobs[index], &cache->jobs[index + 1U], (cache->job_count - index - 1U) * sizeof(ThumbnailJob *));
+    cache->job_count -= 1U;
+    thumbnail_job_destroy(job);
+}
+
+/* Drops the oldest unclaimed prefetch results until the rest fit the budget. Their thumbnails stay on disk, so a
+ * later fetch still skips the decode. */
+static void thumbnail_cache_trim_prefetch_locked(ThumbnailCache *cache)
+{
+    size_t index = 0U;
+    while (cache->stats.prefetched_bytes > cache->prefetch_budget && index < cache->job_count)
+    {
+        ThumbnailJob *job = cache->jobs[index];
+        if (job->prefetch && job->state == THUMBNAIL_JOB_READY)
+        {
+            cache->stats.prefetched_bytes -= thumbnail_job_bytes(job);
+            cache->stats.prefetch_evictions += 1U;
+            thumbnail_cache_remove_locked(cache, index);
+            continue;
+        }
+        ++index;
+    }
+}
+
+static void thumbnail_cache_worker(void *user_data)
+{
+    ThumbnailCache *cache = (ThumbnailCache *)user_data;
+    at_mutex_lock(&cache->mutex);
+    for (;;)
+    {
+        ThumbnailJob *job = NULL;
+        for (size_t index = 0U; index < cache->job_count; ++index)
+        {
+            ThumbnailJob *candidate = cache->jobs[index];
+            if (candidate->state == THUMBNAIL_JOB_QUEUED && (!job || (job->prefetch && !candidate->prefetch)))
+            {
+                job = candidate;
+                if (!job->prefetch)
+                {
+                    break;
+                }
+            }
+        }
+        if (!job)
+        {
+            if (cache->stopping)
+            {
+                break;
+            }
+            at_condition_wait(&cache->work, &cache->mutex);
+            continue;
+        }
+        job->state = THUMBNAIL_JOB_RUNNING;
+        at_mutex_unlock(&cache->mutex);
+
+        /* The job stays in the list while running, so its path and image are only touched here. */
+        ThumbnailImage image = {NULL, 0, 0};
+        bool built = thumbnail_build(&cache->config, job->path, &image, NULL, NULL, 0U);
+
+        at_mutex_lock(&cache->mutex);
+        job->image = image;
+        job->state = built ? THUMBNAIL_JOB_READY : THUMBNAIL_JOB_FAILED;
+        if (!built && job->prefetch)
+        {
+            /* Nobody is waiting for the failure, and a later fetch should try the file afresh. */
+            thumbnail_cache_remove_locked(cache, thumbnail_cache_position_locked(cache, job));
+        }
+        else if (built && job->prefetch)
+        {
+            cache->stats.prefetched_bytes += thumbnail_job_bytes(job);
+            thumbnail_cache_trim_prefetch_locked(cache);
+        }
+        cache->busy -= 1U;
+        if (cache->busy == 0U)
+        {
+            at_condition_broadcast(&cache->idle);
+        }
+    }
+    at_mutex_unlock(&cache->mutex);
+}
+
+ThumbnailCache *thumbnail_cache_create(const ThumbnailCacheConfig *config)
+{
+    if (!config || !config->cache_directory || config->cache_directory[0] == '\0')
+    {
+        return NULL;
+    }
+    ThumbnailDecodeFunction decode = config->decode;
+#if defined(ANCESTRYTREE_HAVE_RAYLIB)
+    if (!decode)
+    {
+        decode = thumbnail_decode_raylib;
+    }
+#endif
+    if (!decode)
+    {
+        return NULL;
+    }
+    ThumbnailCache *cache = (ThumbnailCache *)AT_CALLOC(1U, sizeof(ThumbnailCache));
+    if (!cache)
+    {
+        return NULL;
+    }
+    cache->cache_directory = at_string_dup(config->cache_directory);
+    size_t worker_count = config->worker_count;
+    if (worker_count == 0U)
+    {
+        /* Decoding competes with the render thread, so leave it most of the machine. */
+        worker_count = at_thread_hardware_concurrency() / 2U;
+        worker_count = worker_count == 0U ? 1U : worker_count;
+        worker_count = worker_count > THUMBNAIL_MAX_WORKERS ? THUMBNAIL_MAX_WORKERS : worker_count;
+    }
+    cache->workers = (AtThread *)AT_CALLOC(worker_count, sizeof(AtThread));
+    if (!cache->cache_directory || !cache->workers)
+    {
+        AT_FREE(cache->workers);
+        AT_FREE(cache->cache_directory);
+        AT_FREE(cache);
+        return NULL;
+    }
+    cache->config = *config;
+    cache->config.cache_directory = cache->cache_directory;
+    cache->config.max_edge = thumbnail_max_edge(config);
+    cache->config.decode = decode;
+    cache->prefetch_budget =
+        config->prefetch_budget_bytes > 0U ? config->prefetch_budget_bytes : THUMBNAIL_DEFAULT_PREFETCH_BUDGET;
+    at_mutex_init(&cache->mutex);
+    at_condition_init(&cache->work);
+    at_condition_init(&cache->idle);
+    for (size_t index = 0U; index < worker_count; ++index)
+    {
+        if (!at_thread_start(&cache->workers[index], thumbnail_cache_worker, cache))
+        {
+            break;
+        }
+        cache->worker_count += 1U;
+    }
+    if (cache->worker_count == 0U)
+    {
+        thumbnail_cache_destroy(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+void thumbnail_cache_destroy(ThumbnailCache *cache)
+{
+    if (!cache)
+    {
+        return;
+    }
+    at_mutex_lock(&cache->mutex);
+    cache->stopping = true;
+    /* Drop queued work so shutdown waits for at most one decode per worker. */
+    size_t kept = 0U;
+    for (size_t index = 0U; index < cache->job_count; ++index)
+    {
+        ThumbnailJob *job = cache->jobs[index];
+        if (job->state == THUMBNAIL_JOB_QUEUED)
+        {
+            cache->busy -= 1U;
+            thumbnail_cache_unindex_locked(cache, job);
+            thumbnail_job_destroy(job);
+        }
+        else
+        {
+            cache->jobs[kept++] = job;
+        }
+    }
+    cache->job_count = kept;
+    at_condition_broadcast(&cache->work);
+    at_mutex_unlock(&cache->mutex);
+    for (size_t index = 0U; index < cache->worker_count; ++index)
+    {
+        (void)at_thread_join(&cache->workers[index]);
+    }
+    for (size_t index = 0U; index < cache->job_count; ++index)
+    {
+        thumbnail_job_destroy(cache->jobs[index]);
+    }
+    at_condition_destroy(&cache->idle);
+    at_condition_destroy(&cache->work);
+    at_mutex_destroy(&cache->mutex);
+    AT_FREE(cache->jobs);
+    AT_FREE(cache->slots);
+    AT_FREE(cache->workers);
+    AT_FREE(cache->cache_directory);
+    AT_FREE(cache);
+}
+
+static bool thumbnail_cache_enqueue_locked(ThumbnailCache *cache, const char *path, bool prefetch)
+{
+    if (cache->job_count == cache->job_capacity)
+    {
+        size_t capacity = cache->job_capacity == 0U ? 16U : cache->job_capacity * 2U;
+        ThumbnailJob **jobs = (ThumbnailJob **)at_secure_realloc(cache->jobs, capacity, sizeof(ThumbnailJob *));
+        if (!jobs)
+        {
+            return false;
+        }
+        cache->jobs = jobs;
+        cache->job_capacity = capacity;
+    }
+    if ((cache->job_count + 1U) * 2U > cache->slot_capacity &&
+        !thumbnail_cache_reindex_locked(cache, cache->job_count + 1U))
+    {
+        return false;
+    }
+    ThumbnailJob *job = (ThumbnailJob *)AT_CALLOC(1U, sizeof(ThumbnailJob));
+    if (!job)
+    {
+        return false;
+    }
+    job->path = at_string_dup(path);
+    if (!job->path)
+    {
+        AT_FREE(job);
+        return false;
+    }
+    job->path_hash = thumbnail_path_hash(path);
+    job->state = THUMBNAIL_JOB_QUEUED;
+    job->prefetch = prefetch;
+    cache->slots[thumbnail_cache_slot_locked(cache, job->path, job->path_hash)] = job;
+    cache->jobs[cache->job_count++] = job;
+    cache->busy += 1U;
+    at_condition_signal(&cache->work);
+    return true;
+}
+
+ThumbnailStatus thumbnail_cache_fetch(ThumbnailCache *cache, const char *path, ThumbnailImage *out_image)
+{
+    if (!cache || !path || path[0] == '\0' || !out_image)
+    {
+        return THUMBNAIL_STATUS_FAILED;
+    }
+    ThumbnailStatus status = THUMBNAIL_STATUS_PENDING;
+    at_mutex_lock(&cache->mutex);
+    ThumbnailJob *job = thumbnail_cache_find_locked(cache, path);
+    if (!job)
+    {
+        if (!thumbnail_cache_enqueue_locked(cache, path, false))
+        {
+            status = THUMBNAIL_STATUS_FAILED;
+        }
+    }
+    else if (job->state == THUMBNAIL_JOB_FAILED)
+    {
+        /* Reported once; the next fetch tries again, e.g. after the file was restored. */
+        thumbnail_cache_remove_locked(cache, thumbnail_cache_position_locked(cache, job));
+        status = THUMBNAIL_STATUS_FAILED;
+    }
+    else if (job->state == THUMBNAIL_JOB_READY)
+    {
+        if (job->prefetch)
+        {
+            cache->stats.prefetched_bytes -= thumbnail_job_bytes(job);
+            cache->stats.prefetch_hits += 1U;
+        }
+        *out_image = job->image;
+        job->image.pixels = NULL;
+        thumbnail_cache_remove_locked(cache, thumbnail_cache_position_locked(cache, job));
+        status = THUMBNAIL_STATUS_READY;
+    }
+    else if (job->prefetch)
+    {
+        /* Someone is waiting on it now, so it jumps the prefetch queue. */
+        job->prefetch = false;
+    }
+    at_mutex_unlock(&cache->mutex);
+    return status;
+}
+
+void thumbnail_cache_wait_idle(ThumbnailCache *cache)
+{
+    if (!cache)
+    {
+        return;
+    }
+    at_mutex_lock(&cache->mutex);
+    while (cache->busy > 0U)
+    {
+        at_condition_wait(&cache->idle, &cache->mutex);
+    }
+    at_mutex_unlock(&cache->mutex);
+}
+
+bool thumbnail_cache_prefetch(ThumbnailCache *cache, const char *path)
+{
+    if (!cache || !path || path[0] == '\0')
+    {
+        return false;
+    }
+    at_mutex_lock(&cache->mutex);
+    bool queued = false;
+    if (!thumbnail_cache_find_locked(cache, path))
+    {
+        queued = thumbnail_cache_enqueue_locked(cache, path, true);
+    }
+    at_mutex_unlock(&cache->mutex);
+    return queued;
+}
+
+void thumbnail_cache_cancel_prefetch(ThumbnailCache *cache)
+{
+    if (!cache)
+    {
+        return;
+    }
+    at_mutex_lock(&cache->mutex);
+    size_t index = 0U;
+    while (index < cache->job_count)
+    {
+        ThumbnailJob *job = cache->jobs[index];
+        if (job->prefetch && job->state == THUMBNAIL_JOB_QUEUED)
+        {
+            cache->busy -= 1U;
+            thumbnail_cache_remove_locked(cache, index);
+            continue;
+        }
+        ++index;
+    }
+    if (cache->busy == 0U)
+    {
+        at_condition_broadcast(&cache->idle);
+    }
+    at_mutex_unlock(&cache->mutex);
+}
+
+bool thumbnail_cache_lookup_exists(ThumbnailCache *cache, const char *path, bool *out_exists)
+{
+    if (!cache || !path || !out_exists)
+    {
+        return false;
+    }
+    at_mutex_lock(&cache->mutex);
+    /* Only a decoded result proves the file is there; a failure may be stale, so it stays unknown. */
+    ThumbnailJob *job = thumbnail_cache_find_locked(cache, path);
+    bool known = job && job->state == THUMBNAIL_JOB_READY;
+    if (known)
+    {
+        *out_exists = true;
+    }
+    at_mutex_unlock(&cache->mutex);
+    return known;
+}
+
+void thumbnail_cache_get_stats(ThumbnailCache *cache, ThumbnailCacheStats *out_stats)
+{
+    if (!cache || !out_stats)
+    {
+        return;
+    }
+    at_mutex_lock(&cache->mutex);
+    *out_stats = cache->stats;
+    at_mutex_unlock(&cache->mutex);
+}
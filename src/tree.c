@@ -2,7 +2,12 @@
 
 #include "at_memory.h"
 #include "at_string.h"
+#include "at_string_pool.h"
+#include "person_slab.h"
+#include "search_index.h"
+#include "tree_graph.h"
 
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -28,6 +33,26 @@ static bool ensure_person_capacity(FamilyTree *tree)
     return true;
 }
 
+bool family_tree_reserve(FamilyTree *tree, size_t capacity)
+{
+    if (!tree)
+    {
+        return false;
+    }
+    if (capacity <= tree->person_capacity)
+    {
+        return true;
+    }
+    Person **persons = at_secure_realloc(tree->persons, capacity, sizeof(Person *));
+    if (!persons)
+    {
+        return false;
+    }
+    tree->persons = persons;
+    tree->person_capacity = capacity;
+    return true;
+}
+
 FamilyTree *family_tree_create(const char *name)
 {
     FamilyTree *tree = AT_CALLOC(1U, sizeof(FamilyTree));
@@ -35,6 +60,14 @@ FamilyTree *family_tree_create(const char *name)
     {
         return NULL;
     }
+    tree->strings = at_string_pool_create();
+    tree->slab = person_slab_create();
+    tree->search = search_index_create();
+    if (!tree->strings || !tree->slab || !tree->search)
+    {
+        family_tree_destroy(tree);
+        return NULL;
+    }
     if (name)
     {
         tree->name = at_string_dup(name);
@@ -53,16 +86,193 @@ void family_tree_destroy(FamilyTree *tree)
     {
         return;
     }
+    /* Members' pooled strings die with the pool and their records with the slab blocks, so only the arrays each
+     * member owns on the heap are freed one by one. */
+    at_string_pool_discard(tree->strings);
+    size_t abandoned = 0U;
     for (size_t index = 0; index < tree->person_count; ++index)
     {
-        person_destroy(tree->persons[index]);
+        Person *person = tree->persons[index];
+        if (person && person->slab == tree->slab && person->string_pool == tree->strings)
+        {
+            person_release_arrays(person);
+            abandoned++;
+        }
+        else
+        {
+            person_destroy(person);
+        }
     }
+    /* Records already extracted keep the blocks alive until they are destroyed. */
+    person_slab_abandon(tree->slab, abandoned);
+    at_string_pool_destroy(tree->strings);
+    search_index_destroy(tree->search);
     AT_FREE(tree->persons);
     AT_FREE(tree->name);
     AT_FREE(tree->creation_date);
     AT_FREE(tree);
 }
 
+typedef struct FamilyTreePointerMap
+{
+    const Person **keys;
+    Person **values;
+    size_t capacity;
+} FamilyTreePointerMap;
+
+static size_t family_tree_pointer_hash(const Person *person, size_t capacity)
+{
+    uintptr_t value = (uintptr_t)person;
+    value ^= value >> 17U;
+    value *= (uintptr_t)0x9E3779B97F4A7C15ULL;
+    value ^= value >> 29U;
+    return (size_t)value & (capacity - 1U);
+}
+
+static bool family_tree_pointer_map_init(FamilyTreePointerMap *map, size_t count)
+{
+    size_t capacity = 16U;
+    while (capacity < count * 2U)
+    {
+        capacity *= 2U;
+    }
+    map->keys = calloc(capacity, sizeof(const Person *));
+    map->values = calloc(capacity, sizeof(Person *));
+    map->capacity = capacity;
+    if (!map->keys || !map->values)
+    {
+        free(map->keys);
+        free(map->values);
+        map->keys = NULL;
+        map->values = NULL;
+        return false;
+    }
+    return true;
+}
+
+static void family_tree_pointer_map_dispose(FamilyTreePointerMap *map)
+{
+    free(map->keys);
+    free(map->values);
+    map->keys = NULL;
+    map->values = NULL;
+    map->capacity = 0U;
+}
+
+static void family_tree_pointer_map_put(FamilyTreePointerMap *map, const Person *key, Person *value)
+{
+    size_t slot = family_tree_pointer_hash(key, map->capacity);
+    while (map->keys[slot] && map->keys[slot] != key)
+    {
+        slot = (slot + 1U) & (map->capacity - 1U);
+    }
+    map->keys[slot] = key;
+    map->values[slot] = value;
+}
+
+static Person *family_tree_pointer_map_get(const FamilyTreePointerMap *map, const Person *key)
+{
+    if (!key)
+    {
+        return NULL;
+    }
+    size_t slot = family_tree_pointer_hash(key, map->capacity);
+    while (map->keys[slot])
+    {
+        if (map->keys[slot] == key)
+        {
+            return map->values[slot];
+        }
+        slot = (slot + 1U) & (map->capacity - 1U);
+    }
+    return NULL;
+}
+
+static bool family_tree_remap_clone(Person *clone, const FamilyTreePointerMap *map)
+{
+    for (size_t slot = 0U; slot < 2U; ++slot)
+    {
+        if (clone->parents[slot])
+        {
+            clone->parents[slot] = family_tree_pointer_map_get(map, clone->parents[slot]);
+            if (!clone->parents[slot])
+            {
+                return false;
+            }
+        }
+    }
+    for (size_t index = 0U; index < clone->children_count; ++index)
+    {
+        clone->children[index] = family_tree_pointer_map_get(map, clone->children[index]);
+        if (!clone->children[index])
+        {
+            return false;
+        }
+    }
+    for (size_t index = 0U; index < clone->spouses_count; ++index)
+    {
+        clone->spouses[index].partner = family_tree_pointer_map_get(map, clone->spouses[index].partner);
+        if (!clone->spouses[index].partner)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+FamilyTree *family_tree_clone(const FamilyTree *source)
+{
+    if (!source)
+    {
+        return NULL;
+    }
+    FamilyTree *clone = family_tree_create(source->name);
+    if (!clone)
+    {
+        return NULL;
+    }
+    if (!family_tree_set_creation_date(clone, source->creation_date))
+    {
+        family_tree_destroy(clone);
+        return NULL;
+    }
+    if (source->person_count == 0U)
+    {
+        return clone;
+    }
+    clone->persons = at_secure_realloc(NULL, source->person_count, sizeof(Person *));
+    FamilyTreePointerMap map;
+    if (!clone->persons || !family_tree_pointer_map_init(&map, source->person_count))
+    {
+        family_tree_destroy(clone);
+        return NULL;
+    }
+    clone->person_capacity = source->person_count;
+    bool ok = true;
+    for (size_t index = 0U; index < source->person_count && ok; ++index)
+    {
+        Person *copy = person_clone_into(source->persons[index], clone->slab, clone->strings);
+        if (!copy)
+        {
+            ok = false;
+            break;
+        }
+        clone->persons[clone->person_count++] = copy;
+        family_tree_pointer_map_put(&map, source->persons[index], copy);
+    }
+    for (size_t index = 0U; index < clone->person_count && ok; ++index)
+    {
+        ok = family_tree_remap_clone(clone->persons[index], &map);
+    }
+    family_tree_pointer_map_dispose(&map);
+    if (!ok)
+    {
+        family_tree_destroy(clone);
+        return NULL;
+    }
+    return clone;
+}
+
 bool family_tree_set_creation_date(FamilyTree *tree, const char *creation_date_iso8601)
 {
     if (!tree)
@@ -97,18 +307,6 @@ static bool family_tree_contains_person(const FamilyTree *tree, const Person *pe
     return false;
 }
 
-static int family_tree_index_of(const FamilyTree *tree, const Person *person)
-{
-    for (size_t index = 0; index < tree->person_count; ++index)
-    {
-        if (tree->persons[index] == person)
-        {
-            return (int)index;
-        }
-    }
-    return -1;
-}
-
 static int family_tree_index_of_id(const FamilyTree *tree, uint32_t id)
 {
     if (!tree || id == 0U)
@@ -125,42 +323,48 @@ static int family_tree_index_of_id(const FamilyTree *tree, uint32_t id)
     return -1;
 }
 
-static bool family_tree_detect_cycle_from(const FamilyTree *tree, size_t index, unsigned char *states,
-                                          size_t *cycle_index)
+/* Writes "Cycle detected involving person A: A -> B -> A" when graph has a cycle. */
+static bool family_tree_report_cycles(const TreeGraph *graph, char *error_buffer, size_t error_buffer_size)
 {
-    if (states[index] == 1U)
+    uint32_t *path = NULL;
+    size_t length = 0U;
+    if (!tree_graph_find_cycle(graph, &path, &length))
     {
-        if (cycle_index)
+        if (error_buffer && error_buffer_size > 0U)
         {
-            *cycle_index = index;
+            (void)snprintf(error_buffer, error_buffer_size, "Insufficient memory for tree validation");
         }
-        return true;
+        return false;
     }
-    if (states[index] == 2U)
+    if (length == 0U)
     {
-        return false;
+        return true;
     }
-
-    states[index] = 1U;
-    const Person *person = tree->persons[index];
-    for (size_t child_idx = 0; child_idx < person->children_count; ++child_idx)
+    if (error_buffer && error_buffer_size > 0U)
     {
-        const Person *child = person->children[child_idx];
-        int child_index = family_tree_index_of(tree, child);
-        if (child_index < 0)
+        int written = snprintf(error_buffer, error_buffer_size, "Cycle detected involving person %u:",
+                               graph->persons[path[0]]->id);
+        size_t used = written > 0 ? (size_t)written : 0U;
+        for (size_t index = 0U; index <= length && used < error_buffer_size; ++index)
         {
-            continue;
-        }
-        if (family_tree_detect_cycle_from(tree, (size_t)child_index, states, cycle_index))
-        {
-            return true;
+            written = snprintf(error_buffer + used, error_buffer_size - used, index == 0U ? " %u" : " -> %u",
+                               graph->persons[path[index % length]]->id);
+            used += written > 0 ? (size_t)written : 0U;
         }
     }
-
-    states[index] = 2U;
+    AT_FREE(path);
     return false;
 }
 
+Person *family_tree_create_person(FamilyTree *tree, uint32_t id)
+{
+    if (!tree)
+    {
+        return NULL;
+    }
+    return person_create_in(id, tree->slab, tree->strings);
+}
+
 bool family_tree_add_person(FamilyTree *tree, Person *person)
 {
     if (!tree || !person)
@@ -178,11 +382,12 @@ bool family_tree_add_person(FamilyTree *tree, Person *person)
             return false;
         }
     }
-    if (!ensure_person_capacity(tree))
+    if (!ensure_person_capacity(tree) || !person_bind_string_pool(person, tree->strings))
     {
         return false;
     }
     tree->persons[tree->person_count++] = person;
+    search_index_add_person(tree->search, person);
     return true;
 }
 
@@ -225,6 +430,11 @@ Person *family_tree_extract_person(FamilyTree *tree, uint32_t id)
         return NULL;
     }
     Person *person = tree->persons[index];
+    /* The caller may keep the person after the tree is gone, so hand it private strings. */
+    if (!person_bind_string_pool(person, NULL))
+    {
+        return NULL;
+    }
     for (size_t shift = (size_t)index + 1U; shift < tree->person_count; ++shift)
     {
         tree->persons[shift - 1U] = tree->persons[shift];
@@ -234,9 +444,188 @@ Person *family_tree_extract_person(FamilyTree *tree, uint32_t id)
     {
         tree->persons[tree->person_count] = NULL;
     }
+    search_index_remove_person(tree->search, person);
     return person;
 }
 
+void family_tree_note_person_edited(FamilyTree *tree, const Person *person)
+{
+    if (tree)
+    {
+        search_index_update_person(tree->search, person);
+    }
+}
+
+void family_tree_unlink_person(FamilyTree *tree, Person *person)
+{
+    if (!tree || !person)
+    {
+        return;
+    }
+    for (size_t index = 0; index < person->children_count; ++index)
+    {
+        Person *child = person->children[index];
+        if (!child)
+        {
+            continue;
+        }
+        for (size_t slot = 0; slot < 2U; ++slot)
+        {
+            if (child->parents[slot] == person)
+            {
+                child->parents[slot] = NULL;
+            }
+        }
+    }
+    for (size_t slot = 0; slot < 2U; ++slot)
+    {
+        Person *parent = person->parents[slot];
+        if (!parent)
+        {
+            continue;
+        }
+        for (size_t child_index = 0; child_index < parent->children_count; ++child_index)
+        {
+            if (parent->children[child_index] == person)
+            {
+                for (size_t shift = child_index + 1U; shift < parent->children_count; ++shift)
+                {
+                    parent->children[shift - 1U] = parent->children[shift];
+                }
+                parent->children_count -= 1U;
+                break;
+            }
+        }
+    }
+    for (size_t index = 0; index < person->spouses_count; ++index)
+    {
+        Person *spouse = person->spouses[index].partner;
+        if (!spouse)
+        {
+            continue;
+        }
+        for (size_t spouse_index = 0; spouse_index < spouse->spouses_count; ++spouse_index)
+        {
+            if (spouse->spouses[spouse_index].partner == person)
+            {
+                for (size_t shift = spouse_index + 1U; shift < spouse->spouses_count; ++shift)
+                {
+                    spouse->spouses[shift - 1U] = spouse->spouses[shift];
+                }
+                spouse->spouses_count -= 1U;
+                break;
+            }
+        }
+    }
+}
+
+static bool family_tree_in_removal_set(const Person *other, void *context)
+{
+    return tree_graph_find((const TreeGraph *)context, other) != TREE_GRAPH_NONE;
+}
+
+size_t family_tree_remove_persons(FamilyTree *tree, Person *const *persons, size_t count)
+{
+    if (!tree || !persons || count == 0U)
+    {
+        return 0U;
+    }
+    TreeGraph removal;
+    tree_graph_init(&removal);
+    if (!tree_graph_build(&removal, persons, count))
+    {
+        return 0U;
+    }
+    /* One stable compaction of tree->persons; survivors lose their links to the set as they are kept. */
+    size_t kept = 0U;
+    size_t removed = 0U;
+    for (size_t index = 0U; index < tree->person_count; ++index)
+    {
+        Person *person = tree->persons[index];
+        if (tree_graph_find(&removal, person) != TREE_GRAPH_NONE)
+        {
+            search_index_remove_person(tree->search, person);
+            person_destroy(person);
+            ++removed;
+            continue;
+        }
+        person_remove_links(person, family_tree_in_removal_set, &removal);
+        tree->persons[kept++] = person;
+    }
+    for (size_t index = kept; index < tree->person_count; ++index)
+    {
+        tree->persons[index] = NULL;
+    }
+    tree->person_count = kept;
+    tree_graph_reset(&removal);
+    return removed;
+}
+
+bool family_tree_relink_person(FamilyTree *tree, Person *person)
+{
+    if (!tree || !person)
+    {
+        return false;
+    }
+    for (size_t index = 0U; index < 2U; ++index)
+    {
+        Person *parent = person->parents[index];
+        if (!parent || !family_tree_contains_person(tree, parent))
+        {
+            continue;
+        }
+        if (!person_add_child(parent, person))
+        {
+            return false;
+        }
+    }
+    for (size_t index = 0U; index < person->children_count; ++index)
+    {
+        Person *child = person->children[index];
+        if (!child || !family_tree_contains_person(tree, child))
+        {
+            continue;
+        }
+        bool slot_found = false;
+        for (size_t slot = 0U; slot < 2U; ++slot)
+        {
+            if (child->parents[slot] == person)
+            {
+                slot_found = true;
+                break;
+            }
+            if (!child->parents[slot])
+            {
+                child->parents[slot] = person;
+                slot_found = true;
+                break;
+            }
+        }
+        if (!slot_found)
+        {
+            return false;
+        }
+    }
+    for (size_t index = 0U; index < person->spouses_count; ++index)
+    {
+        PersonSpouseRecord *record = &person->spouses[index];
+        Person *partner = record->partner;
+        if (!partner || !family_tree_contains_person(tree, partner))
+        {
+            continue;
+        }
+        if (!person_add_spouse(partner, person))
+        {
+            return false;
+        }
+        if (!person_set_marriage(partner, person, record->marriage_date, record->marriage_location))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
 size_t family_tree_get_roots(const FamilyTree *tree, Person **out_roots, size_t capacity)
 {
     if (!tree)
@@ -269,13 +658,13 @@ size_t family_tree_get_roots(const FamilyTree *tree, Person **out_roots, size_t
     return count;
 }
 
-static bool family_tree_validate_relationships(const FamilyTree *tree, const Person *person,
+static bool family_tree_validate_relationships(const TreeGraph *graph, const Person *person,
                                                char *error_buffer, size_t error_buffer_size)
 {
     for (size_t index = 0; index < person->children_count; ++index)
     {
         const Person *child = person->children[index];
-        if (!family_tree_contains_person(tree, child))
+        if (tree_graph_find(graph, child) == TREE_GRAPH_NONE)
         {
             if (error_buffer && error_buffer_size > 0U)
             {
@@ -315,7 +704,7 @@ static bool family_tree_validate_relationships(const FamilyTree *tree, const Per
             }
             return false;
         }
-        if (!family_tree_contains_person(tree, spouse))
+        if (tree_graph_find(graph, spouse) == TREE_GRAPH_NONE)
         {
             if (error_buffer && error_buffer_size > 0U)
             {
@@ -346,7 +735,7 @@ static bool family_tree_validate_relationships(const FamilyTree *tree, const Per
     for (size_t index = 0; index < 2U; ++index)
     {
         const Person *parent = person->parents[index];
-        if (parent && !family_tree_contains_person(tree, parent))
+        if (parent && tree_graph_find(graph, parent) == TREE_GRAPH_NONE)
         {
             if (error_buffer && error_buffer_size > 0U)
             {
@@ -368,44 +757,55 @@ bool family_tree_validate(const FamilyTree *tree, char *error_buffer, size_t err
         }
         return false;
     }
-    for (size_t index = 0; index < tree->person_count; ++index)
+    /* Membership checks and the cycle walk both run over the dense graph instead of scanning persons. */
+    TreeGraph graph;
+    tree_graph_init(&graph);
+    if (!tree_graph_build_from_tree(&graph, tree))
     {
-        Person *person = tree->persons[index];
-        if (!person_validate(person, error_buffer, error_buffer_size))
+        if (error_buffer && error_buffer_size > 0U)
         {
-            return false;
-        }
-        if (!family_tree_validate_relationships(tree, person, error_buffer, error_buffer_size))
-        {
-            return false;
+            (void)snprintf(error_buffer, error_buffer_size, "Insufficient memory for tree validation");
         }
+        return false;
     }
-    if (tree->person_count > 0U)
+    bool valid = true;
+    for (size_t index = 0; valid && index < tree->person_count; ++index)
+    {
+        Person *person = tree->persons[index];
+        valid = person_validate_record(person, error_buffer, error_buffer_size) &&
+                family_tree_validate_relationships(&graph, person, error_buffer, error_buffer_size);
+    }
+    valid = valid && family_tree_report_cycles(&graph, error_buffer, error_buffer_size);
+    tree_graph_reset(&graph);
+    return valid;
+}
+
+bool family_tree_check_cycles(const FamilyTree *tree, char *error_buffer, size_t error_buffer_size)
+{
+    if (!tree)
     {
-        unsigned char *states = calloc(tree->person_count, sizeof(unsigned char));
-        if (!states)
+        if (error_buffer && error_buffer_size > 0U)
         {
-            if (error_buffer && error_buffer_size > 0U)
-            {
-                (void)snprintf(error_buffer, error_buffer_size, "Insufficient memory for tree validation");
-            }
-            return false;
+            (void)snprintf(error_buffer, error_buffer_size, "Family tree pointer is NULL");
         }
-        size_t cycle_index = 0U;
-        for (size_t index = 0; index < tree->person_count; ++index)
+        return false;
+    }
+    TreeGraph graph;
+    tree_graph_init(&graph);
+    if (!tree_graph_build_from_tree(&graph, tree))
+    {
+        if (error_buffer && error_buffer_size > 0U)
         {
-            if (family_tree_detect_cycle_from(tree, index, states, &cycle_index))
-            {
-                if (error_buffer && error_buffer_size > 0U)
-                {
-                    (void)snprintf(error_buffer, error_buffer_size, "Cycle detected involving person %u",
-                                   tree->persons[cycle_index]->id);
-                }
-                free(states);
-                return false;
-            }
+            (void)snprintf(error_buffer, error_buffer_size, "Insufficient memory for tree validation");
         }
-        free(states);
+        return false;
     }
-    return true;
+    bool acyclic = family_tree_report_cycles(&graph, error_buffer, error_buffer_size);
+    tree_graph_reset(&graph);
+    return acyclic;
+}
+
+void family_tree_get_string_stats(const FamilyTree *tree, AtStringPoolStats *out_stats)
+{
+    at_string_pool_get_stats(tree ? tree->strings : NULL, out_stats);
 }
@@ -0,0 +1,335 @@
+#include "tree_builder.h"
+
+#include "at_memory.h"
+#include "at_string.h"
+#include "at_time.h"
+#include "search_index.h"
+
+#include <stdio.h>
+#include <string.h>
+
+typedef enum FamilyTreeBuilderLinkKind
+{
+    FAMILY_TREE_BUILDER_CHILD = 0,
+    FAMILY_TREE_BUILDER_PARENT,
+    FAMILY_TREE_BUILDER_SPOUSE
+} FamilyTreeBuilderLinkKind;
+
+typedef struct FamilyTreeBuilderLink
+{
+    uint32_t kind;
+    uint32_t slot;
+    uint32_t from;
+    uint32_t to;
+    char *marriage_date;
+    char *marriage_location;
+} FamilyTreeBuilderLink;
+
+struct FamilyTreeBuilder
+{
+    FamilyTree *tree;
+    uint32_t *id_keys; /* Open-addressed id -> member map; id 0 is never valid, so it marks empty slots. */
+    Person **id_values;
+    size_t id_capacity;
+    FamilyTreeBuilderLink *links;
+    size_t link_count;
+    size_t link_capacity;
+    double created_at;
+};
+
+static size_t family_tree_builder_hash(uint32_t id, size_t capacity)
+{
+    uint32_t value = id * 0x9E3779B1U;
+    value ^= value >> 15U;
+    return (size_t)value & (capacity - 1U);
+}
+
+static bool family_tree_builder_set_error(char *buffer, size_t buffer_size, const char *format, uint32_t first,
+                                          uint32_t second)
+{
+    if (buffer && buffer_size > 0U)
+    {
+        (void)snprintf(buffer, buffer_size, format, first, second);
+    }
+    return false;
+}
+
+static void family_tree_builder_map_put(uint32_t *keys, Person **values, size_t capacity, Person *person)
+{
+    size_t slot = family_tree_builder_hash(person->id, capacity);
+    while (keys[slot] != 0U)
+    {
+        slot = (slot + 1U) & (capacity - 1U);
+    }
+    keys[slot] = person->id;
+    values[slot] = person;
+}
+
+/* Keeps the id map at most half full for the given member count. */
+static bool family_tree_builder_map_reserve(FamilyTreeBuilder *builder, size_t member_count)
+{
+    if (builder->id_capacity >= member_count * 2U && builder->id_capacity > 0U)
+    {
+        return true;
+    }
+    size_t capacity = 16U;
+    while (capacity < member_count * 2U)
+    {
+        capacity *= 2U;
+    }
+    uint32_t *keys = AT_CALLOC(capacity, sizeof(uint32_t));
+    Person **values = AT_CALLOC(capacity, sizeof(Person *));
+    if (!keys || !values)
+    {
+        AT_FREE(keys);
+        AT_FREE(values);
+        return false;
+    }
+    for (size_t slot = 0U; slot < builder->id_capacity; ++slot)
+    {
+        if (builder->id_keys[slot] != 0U)
+        {
+            family_tree_builder_map_put(keys, values, capacity, builder->id_values[slot]);
+        }
+    }
+    AT_FREE(builder->id_keys);
+    AT_FREE(builder->id_values);
+    builder->id_keys = keys;
+    builder->id_values = values;
+    builder->id_capacity = capacity;
+    return true;
+}
+
+static bool family_tree_builder_links_reserve(FamilyTreeBuilder *builder, size_t required)
+{
+    if (required <= builder->link_capacity)
+    {
+        return true;
+    }
+    size_t capacity = builder->link_capacity > 0U ? builder->link_capacity : 16U;
+    while (capacity < required)
+    {
+        capacity *= 2U;
+    }
+    FamilyTreeBuilderLink *links = at_secure_realloc(builder->links, capacity, sizeof(FamilyTreeBuilderLink));
+    if (!links)
+    {
+        return false;
+    }
+    builder->links = links;
+    builder->link_capacity = capacity;
+    return true;
+}
+
+static void family_tree_builder_release(FamilyTreeBuilder *builder)
+{
+    for (size_t index = 0U; index < builder->link_count; ++index)
+    {
+        AT_FREE(builder->links[index].marriage_date);
+        AT_FREE(builder->links[index].marriage_location);
+    }
+    AT_FREE(builder->links);
+    AT_FREE(builder->id_keys);
+    AT_FREE(builder->id_values);
+    AT_FREE(builder);
+}
+
+FamilyTreeBuilder *family_tree_builder_create(const char *name, size_t expected_persons,
+                                              size_t expected_relationships)
+{
+    FamilyTreeBuilder *builder = AT_CALLOC(1U, sizeof(FamilyTreeBuilder));
+    if (!builder)
+    {
+        return NULL;
+    }
+    builder->created_at = at_time_now_seconds();
+    builder->tree = family_tree_create(name);
+    if (!builder->tree || !family_tree_reserve(builder->tree, expected_persons) ||
+        !family_tree_builder_map_reserve(builder, expected_persons) ||
+        !family_tree_builder_links_reserve(builder, expected_relationships))
+    {
+        family_tree_builder_destroy(builder);
+        return NULL;
+    }
+    return builder;
+}
+
+FamilyTree *family_tree_builder_tree(FamilyTreeBuilder *builder)
+{
+    return builder ? builder->tree : NULL;
+}
+
+Person *family_tree_builder_find_person(const FamilyTreeBuilder *builder, uint32_t id)
+{
+    if (!builder || id == 0U || builder->id_capacity == 0U)
+    {
+        return NULL;
+    }
+    size_t slot = family_tree_builder_hash(id, builder->id_capacity);
+    while (builder->id_keys[slot] != 0U)
+    {
+        if (builder->id_keys[slot] == id)
+        {
+            return builder->id_values[slot];
+        }
+        slot = (slot + 1U) & (builder->id_capacity - 1U);
+    }
+    return NULL;
+}
+
+bool family_tree_builder_add_person(FamilyTreeBuilder *builder, Person *person)
+{
+    if (!builder || !person || person->id == 0U || family_tree_builder_find_person(builder, person->id))
+    {
+        return false;
+    }
+    FamilyTree *tree = builder->tree;
+    if (tree->person_count == tree->person_capacity &&
+        !family_tree_reserve(tree, tree->person_capacity > 0U ? tree->person_capacity * 2U : 8U))
+    {
+        return false;
+    }
+    if (!family_tree_builder_map_reserve(builder, tree->person_count + 1U) ||
+        !person_bind_string_pool(person, tree->strings))
+    {
+        return false;
+    }
+    family_tree_builder_map_put(builder->id_keys, builder->id_values, builder->id_capacity, person);
+    tree->persons[tree->person_count++] = person;
+    search_index_add_person(tree->search, person);
+    return true;
+}
+
+static bool family_tree_builder_queue(FamilyTreeBuilder *builder, FamilyTreeBuilderLinkKind kind, uint32_t from,
+                                      uint32_t to, uint32_t slot, const char *marriage_date,
+                                      const char *marriage_location)
+{
+    if (!builder || from == 0U || to == 0U || !family_tree_builder_links_reserve(builder, builder->link_count + 1U))
+    {
+        return false;
+    }
+    FamilyTreeBuilderLink link = {(uint32_t)kind, slot, from, to, NULL, NULL};
+    if ((marriage_date && !(link.marriage_date = at_string_dup(marriage_date))) ||
+        (marriage_location && !(link.marriage_location = at_string_dup(marriage_location))))
+    {
+        AT_FREE(link.marriage_date);
+        return false;
+    }
+    builder->links[builder->link_count++] = link;
+    return true;
+}
+
+bool family_tree_builder_add_child(FamilyTreeBuilder *builder, uint32_t parent_id, uint32_t child_id)
+{
+    return family_tree_builder_queue(builder, FAMILY_TREE_BUILDER_CHILD, parent_id, child_id, 0U, NULL, NULL);
+}
+
+bool family_tree_builder_set_parent(FamilyTreeBuilder *builder, uint32_t child_id, uint32_t parent_id,
+                                    PersonParentSlot slot)
+{
+    if (slot > PERSON_PARENT_MOTHER)
+    {
+        return false;
+    }
+    return family_tree_builder_queue(builder, FAMILY_TREE_BUILDER_PARENT, child_id, parent_id, (uint32_t)slot, NULL,
+                                     NULL);
+}
+
+bool family_tree_builder_add_spouse(FamilyTreeBuilder *builder, uint32_t person_id, uint32_t spouse_id,
+                                    const char *marriage_date, const char *marriage_location)
+{
+    return family_tree_builder_queue(builder, FAMILY_TREE_BUILDER_SPOUSE, person_id, spouse_id, 0U, marriage_date,
+                                     marriage_location);
+}
+
+static bool family_tree_builder_apply(FamilyTreeBuilder *builder, const FamilyTreeBuilderLink *link,
+                                      char *error_buffer, size_t error_buffer_size)
+{
+    Person *from = family_tree_builder_find_person(builder, link->from);
+    Person *to = family_tree_builder_find_person(builder, link->to);
+    if (!from || !to)
+    {
+        return family_tree_builder_set_error(error_buffer, error_buffer_size,
+                                             "Relationship %u -> %u references an unknown person", link->from,
+                                             link->to);
+    }
+    switch ((FamilyTreeBuilderLinkKind)link->kind)
+    {
+    case FAMILY_TREE_BUILDER_CHILD:
+        if (!person_add_child(from, to))
+        {
+            return family_tree_builder_set_error(error_buffer, error_buffer_size, "Invalid child link %u -> %u",
+                                                 link->from, link->to);
+        }
+        return true;
+    case FAMILY_TREE_BUILDER_PARENT:
+        if (!person_set_parent(from, to, (PersonParentSlot)link->slot))
+        {
+            return family_tree_builder_set_error(error_buffer, error_buffer_size, "Invalid parent link %u -> %u",
+                                                 link->from, link->to);
+        }
+        return true;
+    default:
+        if (!person_add_spouse(from, to) ||
+            !person_set_marriage(from, to, link->marriage_date, link->marriage_location))
+        {
+            return family_tree_builder_set_error(error_buffer, error_buffer_size, "Invalid spouse link %u -> %u",
+                                                 link->from, link->to);
+        }
+        return true;
+    }
+}
+
+FamilyTree *family_tree_builder_finish(FamilyTreeBuilder *builder, FamilyTreeBuilderStats *out_stats,
+                                       char *error_buffer, size_t error_buffer_size)
+{
+    if (out_stats)
+    {
+        memset(out_stats, 0, sizeof(*out_stats));
+    }
+    if (!builder)
+    {
+        (void)family_tree_builder_set_error(error_buffer, error_buffer_size, "Tree builder is NULL", 0U, 0U);
+        return NULL;
+    }
+    FamilyTree *tree = builder->tree;
+    FamilyTreeBuilderStats stats;
+    memset(&stats, 0, sizeof(stats));
+    stats.persons = tree->person_count;
+    stats.relationships = builder->link_count;
+    double resolve_start = at_time_now_seconds();
+    stats.ingest_seconds = resolve_start - builder->created_at;
+
+    bool ok = true;
+    for (size_t index = 0U; ok && index < builder->link_count; ++index)
+    {
+        ok = family_tree_builder_apply(builder, &builder->links[index], error_buffer, error_buffer_size);
+    }
+    double validate_start = at_time_now_seconds();
+    stats.resolve_seconds = validate_start - resolve_start;
+    ok = ok && family_tree_validate(tree, error_buffer, error_buffer_size);
+    stats.validate_seconds = at_time_now_seconds() - validate_start;
+
+    builder->tree = NULL;
+    family_tree_builder_release(builder);
+    if (out_stats)
+    {
+        *out_stats = stats;
+    }
+    if (!ok)
+    {
+        family_tree_destroy(tree);
+        return NULL;
+    }
+    return tree;
+}
+
+void family_tree_builder_destroy(FamilyTreeBuilder *builder)
+{
+    if (!builder)
+    {
+        return;
+    }
+    family_tree_destroy(builder->tree);
+    family_tree_builder_release(builder);
+}
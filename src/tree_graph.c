@@ -0,0 +1,678 @@
+#include "tree_graph.h"
+
+#include "at_memory.h"
+
+#include <string.h>
+
+#define TREE_GRAPH_INLINE_ROW 16U
+#define TREE_GRAPH_COMPACT_MIN 64U
+
+typedef enum TreeGraphKind
+{
+    TREE_GRAPH_CHILDREN = 0,
+    TREE_GRAPH_PARENTS,
+    TREE_GRAPH_SPOUSES
+} TreeGraphKind;
+
+static size_t tree_graph_hash(const Person *person, size_t capacity)
+{
+    uintptr_t value = (uintptr_t)person;
+    value ^= value >> 17U;
+    value *= (uintptr_t)0x9E3779B97F4A7C15ULL;
+    value ^= value >> 29U;
+    return (size_t)value & (capacity - 1U);
+}
+
+static void tree_graph_lookup_put(TreeGraph *graph, const Person *person, uint32_t node)
+{
+    size_t slot = tree_graph_hash(person, graph->lookup_capacity);
+    while (graph->lookup_keys[slot] && graph->lookup_keys[slot] != person)
+    {
+        slot = (slot + 1U) & (graph->lookup_capacity - 1U);
+    }
+    if (!graph->lookup_keys[slot])
+    {
+        graph->lookup_keys[slot] = person;
+        graph->lookup_values[slot] = node;
+    }
+}
+
+/* Sized for at least twice the node count so probes stay short. */
+static bool tree_graph_lookup_reserve(TreeGraph *graph, size_t node_count)
+{
+    if (graph->lookup_capacity >= node_count * 2U && graph->lookup_capacity > 0U)
+    {
+        return true;
+    }
+    size_t capacity = 16U;
+    while (capacity < node_count * 2U)
+    {
+        capacity *= 2U;
+    }
+    const Person **keys = AT_CALLOC(capacity, sizeof(const Person *));
+    uint32_t *values = AT_CALLOC(capacity, sizeof(uint32_t));
+    if (!keys || !values)
+    {
+        AT_FREE(keys);
+        AT_FREE(values);
+        return false;
+    }
+    AT_FREE(graph->lookup_keys);
+    AT_FREE(graph->lookup_values);
+    graph->lookup_keys = keys;
+    graph->lookup_values = values;
+    graph->lookup_capacity = capacity;
+    for (size_t node = 0U; node < graph->count; ++node)
+    {
+        if (graph->persons[node])
+        {
+            tree_graph_lookup_put(graph, graph->persons[node], (uint32_t)node);
+        }
+    }
+    return true;
+}
+
+uint32_t tree_graph_find(const TreeGraph *graph, const Person *person)
+{
+    if (!graph || !person || graph->lookup_capacity == 0U)
+    {
+        return TREE_GRAPH_NONE;
+    }
+    size_t slot = tree_graph_hash(person, graph->lookup_capacity);
+    while (graph->lookup_keys[slot])
+    {
+        if (graph->lookup_keys[slot] == person)
+        {
+            uint32_t node = graph->lookup_values[slot];
+            /* Removed nodes keep their key; the cleared person slot marks them dead. */
+            return graph->persons[node] == person ? node : TREE_GRAPH_NONE;
+        }
+        slot = (slot + 1U) & (graph->lookup_capacity - 1U);
+    }
+    return TREE_GRAPH_NONE;
+}
+
+static void tree_graph_rows_dispose(TreeGraphRows *rows)
+{
+    AT_FREE(rows->start);
+    AT_FREE(rows->count);
+    AT_FREE(rows->slot);
+    AT_FREE(rows->indices);
+    memset(rows, 0, sizeof(*rows));
+}
+
+static bool tree_graph_rows_reserve_nodes(TreeGraphRows *rows, size_t node_capacity)
+{
+    uint32_t *start = at_secure_realloc(rows->start, node_capacity, sizeof(uint32_t));
+    if (!start)
+    {
+        return false;
+    }
+    rows->start = start;
+    uint32_t *count = at_secure_realloc(rows->count, node_capacity, sizeof(uint32_t));
+    if (!count)
+    {
+        return false;
+    }
+    rows->count = count;
+    uint32_t *slot = at_secure_realloc(rows->slot, node_capacity, sizeof(uint32_t));
+    if (!slot)
+    {
+        return false;
+    }
+    rows->slot = slot;
+    return true;
+}
+
+static bool tree_graph_rows_reserve_indices(TreeGraphRows *rows, size_t required)
+{
+    if (required <= rows->capacity)
+    {
+        return true;
+    }
+    size_t capacity = rows->capacity > 0U ? rows->capacity : 16U;
+    while (capacity < required)
+    {
+        capacity *= 2U;
+    }
+    uint32_t *indices = at_secure_realloc(rows->indices, capacity, sizeof(uint32_t));
+    if (!indices)
+    {
+        return false;
+    }
+    rows->indices = indices;
+    rows->capacity = capacity;
+    return true;
+}
+
+static bool tree_graph_rows_compact(TreeGraphRows *rows, size_t node_count)
+{
+    size_t live = rows->used - rows->wasted;
+    uint32_t *indices = AT_MALLOC((live > 0U ? live : 1U) * sizeof(uint32_t));
+    if (!indices)
+    {
+        return false;
+    }
+    size_t cursor = 0U;
+    for (size_t node = 0U; node < node_count; ++node)
+    {
+        memcpy(indices + cursor, rows->indices + rows->start[node], rows->count[node] * sizeof(uint32_t));
+        rows->start[node] = (uint32_t)cursor;
+        rows->slot[node] = rows->count[node];
+        cursor += rows->count[node];
+    }
+    AT_FREE(rows->indices);
+    rows->indices = indices;
+    rows->capacity = live > 0U ? live : 1U;
+    rows->used = cursor;
+    rows->wasted = 0U;
+    return true;
+}
+
+static bool tree_graph_rows_write(TreeGraphRows *rows, size_t node_count, uint32_t node, const uint32_t *values,
+                                  uint32_t value_count)
+{
+    if (value_count > rows->slot[node])
+    {
+        if (!tree_graph_rows_reserve_indices(rows, rows->used + value_count))
+        {
+            return false;
+        }
+        rows->wasted += rows->slot[node];
+        rows->start[node] = (uint32_t)rows->used;
+        rows->slot[node] = value_count;
+        rows->used += value_count;
+    }
+    if (value_count > 0U)
+    {
+        memcpy(rows->indices + rows->start[node], values, value_count * sizeof(uint32_t));
+    }
+    rows->count[node] = value_count;
+    if (rows->wasted > TREE_GRAPH_COMPACT_MIN && rows->wasted * 2U > rows->used)
+    {
+        return tree_graph_rows_compact(rows, node_count);
+    }
+    return true;
+}
+
+static TreeGraphRows *tree_graph_rows_of(TreeGraph *graph, TreeGraphKind kind)
+{
+    switch (kind)
+    {
+    case TREE_GRAPH_CHILDREN:
+        return &graph->children;
+    case TREE_GRAPH_PARENTS:
+        return &graph->parents;
+    default:
+        return &graph->spouses;
+    }
+}
+
+static size_t tree_graph_link_count(const Person *person, TreeGraphKind kind)
+{
+    switch (kind)
+    {
+    case TREE_GRAPH_CHILDREN:
+        return person->children_count;
+    case TREE_GRAPH_PARENTS:
+        return 2U;
+    default:
+        return person->spouses_count;
+    }
+}
+
+static const Person *tree_graph_link(const Person *person, TreeGraphKind kind, size_t index)
+{
+    switch (kind)
+    {
+    case TREE_GRAPH_CHILDREN:
+        return person->children[index];
+    case TREE_GRAPH_PARENTS:
+        return person->parents[index];
+    default:
+        return person->spouses[index].partner;
+    }
+}
+
+/* Resolves person's links of one kind to node indices, dropping those outside the graph. */
+static uint32_t tree_graph_resolve(const TreeGraph *graph, const Person *person, TreeGraphKind kind,
+                                   uint32_t *out_nodes)
+{
+    uint32_t resolved = 0U;
+    size_t link_count = person ? tree_graph_link_count(person, kind) : 0U;
+    for (size_t index = 0U; index < link_count; ++index)
+    {
+        uint32_t node = tree_graph_find(graph, tree_graph_link(person, kind, index));
+        if (node != TREE_GRAPH_NONE)
+        {
+            out_nodes[resolved++] = node;
+        }
+    }
+    return resolved;
+}
+
+static bool tree_graph_refresh_node(TreeGraph *graph, uint32_t node)
+{
+    const Person *person = graph->persons[node];
+    for (int kind = TREE_GRAPH_CHILDREN; kind <= TREE_GRAPH_SPOUSES; ++kind)
+    {
+        size_t link_count = person ? tree_graph_link_count(person, (TreeGraphKind)kind) : 0U;
+        uint32_t inline_nodes[TREE_GRAPH_INLINE_ROW];
+        uint32_t *nodes = inline_nodes;
+        if (link_count > TREE_GRAPH_INLINE_ROW)
+        {
+            nodes = AT_MALLOC(link_count * sizeof(uint32_t));
+            if (!nodes)
+            {
+                return false;
+            }
+        }
+        uint32_t resolved = tree_graph_resolve(graph, person, (TreeGraphKind)kind, nodes);
+        bool ok = tree_graph_rows_write(tree_graph_rows_of(graph, (TreeGraphKind)kind), graph->count, node, nodes,
+                                        resolved);
+        if (nodes != inline_nodes)
+        {
+            AT_FREE(nodes);
+        }
+        if (!ok)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Appends node's current neighbours of every kind to list, growing it as needed. */
+static bool tree_graph_collect_neighbours(const TreeGraph *graph, uint32_t node, uint32_t **list, size_t *count,
+                                          size_t *capacity)
+{
+    const TreeGraphRows *kinds[3] = {&graph->children, &graph->parents, &graph->spouses};
+    for (size_t kind = 0U; kind < 3U; ++kind)
+    {
+        const TreeGraphRows *rows = kinds[kind];
+        for (uint32_t edge = 0U; edge < rows->count[node]; ++edge)
+        {
+            if (*count == *capacity)
+            {
+                size_t grown = *capacity > 0U ? *capacity * 2U : 16U;
+                uint32_t *resized = at_secure_realloc(*list, grown, sizeof(uint32_t));
+                if (!resized)
+                {
+                    return false;
+                }
+                *list = resized;
+                *capacity = grown;
+            }
+            (*list)[(*count)++] = rows->indices[rows->start[node] + edge];
+        }
+    }
+    return true;
+}
+
+/* Refreshes node, then everyone it was linked to before and after the edit. */
+static bool tree_graph_refresh_around(TreeGraph *graph, uint32_t node)
+{
+    uint32_t *affected = NULL;
+    size_t affected_count = 0U;
+    size_t affected_capacity = 0U;
+    bool ok = tree_graph_collect_neighbours(graph, node, &affected, &affected_count, &affected_capacity) &&
+              tree_graph_refresh_node(graph, node) &&
+              tree_graph_collect_neighbours(graph, node, &affected, &affected_count, &affected_capacity);
+    for (size_t index = 0U; ok && index < affected_count; ++index)
+    {
+        ok = tree_graph_refresh_node(graph, affected[index]);
+    }
+    AT_FREE(affected);
+    return ok;
+}
+
+void tree_graph_init(TreeGraph *graph)
+{
+    if (graph)
+    {
+        memset(graph, 0, sizeof(*graph));
+    }
+}
+
+void tree_graph_reset(TreeGraph *graph)
+{
+    if (!graph)
+    {
+        return;
+    }
+    AT_FREE(graph->persons);
+    tree_graph_rows_dispose(&graph->children);
+    tree_graph_rows_dispose(&graph->parents);
+    tree_graph_rows_dispose(&graph->spouses);
+    AT_FREE(graph->lookup_keys);
+    AT_FREE(graph->lookup_values);
+    tree_graph_init(graph);
+}
+
+static bool tree_graph_reserve_nodes(TreeGraph *graph, size_t node_capacity)
+{
+    if (node_capacity <= graph->node_capacity)
+    {
+        return true;
+    }
+    Person **persons = at_secure_realloc(graph->persons, node_capacity, sizeof(Person *));
+    if (!persons)
+    {
+        return false;
+    }
+    graph->persons = persons;
+    if (!tree_graph_rows_reserve_nodes(&graph->children, node_capacity) ||
+        !tree_graph_rows_reserve_nodes(&graph->parents, node_capacity) ||
+        !tree_graph_rows_reserve_nodes(&graph->spouses, node_capacity))
+    {
+        return false;
+    }
+    graph->node_capacity = node_capacity;
+    return true;
+}
+
+/* Lays rows out back to back in node order, exactly sized, once persons and the lookup are in place. */
+static bool tree_graph_fill_rows(TreeGraph *graph)
+{
+    size_t totals[3] = {0U, 0U, 0U};
+    for (size_t node = 0U; node < graph->count; ++node)
+    {
+        const Person *person = graph->persons[node];
+        if (person)
+        {
+            totals[TREE_GRAPH_CHILDREN] += person->children_count;
+            totals[TREE_GRAPH_PARENTS] += 2U;
+            totals[TREE_GRAPH_SPOUSES] += person->spouses_count;
+        }
+    }
+    for (int kind = TREE_GRAPH_CHILDREN; kind <= TREE_GRAPH_SPOUSES; ++kind)
+    {
+        TreeGraphRows *rows = tree_graph_rows_of(graph, (TreeGraphKind)kind);
+        if (!tree_graph_rows_reserve_indices(rows, totals[kind] > 0U ? totals[kind] : 1U))
+        {
+            return false;
+        }
+        for (size_t node = 0U; node < graph->count; ++node)
+        {
+            /* A repeated person keeps empty rows; only its first node is reachable through find. */
+            const Person *person = graph->persons[node];
+            uint32_t resolved = tree_graph_find(graph, person) == node
+                                    ? tree_graph_resolve(graph, person, (TreeGraphKind)kind,
+                                                         rows->indices + rows->used)
+                                    : 0U;
+            rows->start[node] = (uint32_t)rows->used;
+            rows->count[node] = resolved;
+            rows->slot[node] = resolved;
+            rows->used += resolved;
+        }
+    }
+    return true;
+}
+
+bool tree_graph_build(TreeGraph *graph, Person *const *persons, size_t count)
+{
+    if (!graph)
+    {
+        return false;
+    }
+    tree_graph_reset(graph);
+    if (count == 0U)
+    {
+        return true;
+    }
+    if (!persons || count >= TREE_GRAPH_NONE || !tree_graph_reserve_nodes(graph, count))
+    {
+        tree_graph_reset(graph);
+        return false;
+    }
+    memcpy(graph->persons, persons, count * sizeof(Person *));
+    graph->count = count;
+    if (!tree_graph_lookup_reserve(graph, count) || !tree_graph_fill_rows(graph))
+    {
+        tree_graph_reset(graph);
+        return false;
+    }
+    return true;
+}
+
+bool tree_graph_build_descendants(TreeGraph *graph, const Person *root)
+{
+    if (!graph)
+    {
+        return false;
+    }
+    tree_graph_reset(graph);
+    if (!root)
+    {
+        return true;
+    }
+    if (!tree_graph_reserve_nodes(graph, 16U) || !tree_graph_lookup_reserve(graph, 16U))
+    {
+        tree_graph_reset(graph);
+        return false;
+    }
+    /* The graph only reads through these pointers. */
+    graph->persons[0] = (Person *)root;
+    graph->count = 1U;
+    tree_graph_lookup_put(graph, root, 0U);
+    /* Breadth-first over child links; the persons array doubles as the queue. */
+    for (size_t head = 0U; head < graph->count; ++head)
+    {
+        const Person *person = graph->persons[head];
+        for (size_t index = 0U; index < person->children_count; ++index)
+        {
+            Person *child = person->children[index];
+            if (!child || tree_graph_find(graph, child) != TREE_GRAPH_NONE)
+            {
+                continue;
+            }
+            if (graph->count + 1U >= TREE_GRAPH_NONE ||
+                (graph->count == graph->node_capacity &&
+                 !tree_graph_reserve_nodes(graph, graph->node_capacity * 2U)) ||
+                !tree_graph_lookup_reserve(graph, graph->count + 1U))
+            {
+                tree_graph_reset(graph);
+                return false;
+            }
+            graph->persons[graph->count] = child;
+            tree_graph_lookup_put(graph, child, (uint32_t)graph->count);
+            graph->count++;
+        }
+    }
+    if (!tree_graph_fill_rows(graph))
+    {
+        tree_graph_reset(graph);
+        return false;
+    }
+    return true;
+}
+
+bool tree_graph_build_from_tree(TreeGraph *graph, const FamilyTree *tree)
+{
+    if (!tree)
+    {
+        return false;
+    }
+    return tree_graph_build(graph, tree->persons, tree->person_count);
+}
+
+static const uint32_t *tree_graph_row(const TreeGraph *graph, const TreeGraphRows *rows, uint32_t node,
+                                      uint32_t *out_count)
+{
+    if (!graph || node >= graph->count)
+    {
+        if (out_count)
+        {
+            *out_count = 0U;
+        }
+        return NULL;
+    }
+    if (out_count)
+    {
+        *out_count = rows->count[node];
+    }
+    return rows->indices + rows->start[node];
+}
+
+const uint32_t *tree_graph_children(const TreeGraph *graph, uint32_t node, uint32_t *out_count)
+{
+    return tree_graph_row(graph, graph ? &graph->children : NULL, node, out_count);
+}
+
+const uint32_t *tree_graph_parents(const TreeGraph *graph, uint32_t node, uint32_t *out_count)
+{
+    return tree_graph_row(graph, graph ? &graph->parents : NULL, node, out_count);
+}
+
+const uint32_t *tree_graph_spouses(const TreeGraph *graph, uint32_t node, uint32_t *out_count)
+{
+    return tree_graph_row(graph, graph ? &graph->spouses : NULL, node, out_count);
+}
+
+bool tree_graph_add_person(TreeGraph *graph, Person *person)
+{
+    if (!graph || !person)
+    {
+        return false;
+    }
+    if (tree_graph_find(graph, person) != TREE_GRAPH_NONE)
+    {
+        return tree_graph_update_person(graph, person);
+    }
+    if (graph->count + 1U >= TREE_GRAPH_NONE)
+    {
+        return false;
+    }
+    if (graph->count == graph->node_capacity &&
+        !tree_graph_reserve_nodes(graph, graph->node_capacity > 0U ? graph->node_capacity * 2U : 16U))
+    {
+        return false;
+    }
+    if (!tree_graph_lookup_reserve(graph, graph->count + 1U))
+    {
+        return false;
+    }
+    uint32_t node = (uint32_t)graph->count++;
+    graph->persons[node] = person;
+    TreeGraphRows *kinds[3] = {&graph->children, &graph->parents, &graph->spouses};
+    for (size_t kind = 0U; kind < 3U; ++kind)
+    {
+        kinds[kind]->start[node] = (uint32_t)kinds[kind]->used;
+        kinds[kind]->count[node] = 0U;
+        kinds[kind]->slot[node] = 0U;
+    }
+    /* A removed node may still own this key; point it at the new slot. */
+    size_t slot = tree_graph_hash(person, graph->lookup_capacity);
+    while (graph->lookup_keys[slot] && graph->lookup_keys[slot] != person)
+    {
+        slot = (slot + 1U) & (graph->lookup_capacity - 1U);
+    }
+    graph->lookup_keys[slot] = person;
+    graph->lookup_values[slot] = node;
+    return tree_graph_refresh_around(graph, node);
+}
+
+bool tree_graph_update_person(TreeGraph *graph, const Person *person)
+{
+    uint32_t node = tree_graph_find(graph, person);
+    if (node == TREE_GRAPH_NONE)
+    {
+        return false;
+    }
+    return tree_graph_refresh_around(graph, node);
+}
+
+bool tree_graph_remove_person(TreeGraph *graph, const Person *person)
+{
+    uint32_t node = tree_graph_find(graph, person);
+    if (node == TREE_GRAPH_NONE)
+    {
+        return false;
+    }
+    uint32_t *affected = NULL;
+    size_t affected_count = 0U;
+    size_t affected_capacity = 0U;
+    bool ok = tree_graph_collect_neighbours(graph, node, &affected, &affected_count, &affected_capacity);
+    graph->persons[node] = NULL;
+    ok = ok && tree_graph_refresh_node(graph, node);
+    for (size_t index = 0U; ok && index < affected_count; ++index)
+    {
+        ok = tree_graph_refresh_node(graph, affected[index]);
+    }
+    AT_FREE(affected);
+    return ok;
+}
+
+bool tree_graph_find_cycle(const TreeGraph *graph, uint32_t **out_path, size_t *out_length)
+{
+    if (!graph || !out_path || !out_length)
+    {
+        return false;
+    }
+    *out_path = NULL;
+    *out_length = 0U;
+    if (graph->count == 0U)
+    {
+        return true;
+    }
+    /* depth[v] is 0 while unvisited, 1 + stack position while on the stack, UINT32_MAX once finished. */
+    uint32_t *depth = AT_CALLOC(graph->count, sizeof(uint32_t));
+    uint32_t *cursor = AT_CALLOC(graph->count, sizeof(uint32_t));
+    uint32_t *stack = AT_MALLOC(graph->count * sizeof(uint32_t));
+    if (!depth || !cursor || !stack)
+    {
+        AT_FREE(depth);
+        AT_FREE(cursor);
+        AT_FREE(stack);
+        return false;
+    }
+    bool ok = true;
+    for (uint32_t root = 0U; root < (uint32_t)graph->count && *out_length == 0U; ++root)
+    {
+        if (depth[root] != 0U)
+        {
+            continue;
+        }
+        size_t top = 0U;
+        stack[top++] = root;
+        depth[root] = 1U;
+        while (top > 0U)
+        {
+            uint32_t node = stack[top - 1U];
+            const TreeGraphRows *rows = &graph->children;
+            if (cursor[node] == rows->count[node])
+            {
+                depth[node] = UINT32_MAX;
+                --top;
+                continue;
+            }
+            uint32_t child = rows->indices[rows->start[node] + cursor[node]++];
+            if (depth[child] == 0U)
+            {
+                stack[top++] = child;
+                depth[child] = (uint32_t)top;
+            }
+            else if (depth[child] != UINT32_MAX)
+            {
+                /* Back edge: the cycle is the stack from child up to node. */
+                size_t first = depth[child] - 1U;
+                *out_length = top - first;
+                *out_path = AT_MALLOC(*out_length * sizeof(uint32_t));
+                if (!*out_path)
+                {
+                    *out_length = 0U;
+                    ok = false;
+                }
+                else
+                {
+                    memcpy(*out_path, stack + first, *out_length * sizeof(uint32_t));
+                }
+                break;
+            }
+        }
+    }
+    AT_FREE(depth);
+    AT_FREE(cursor);
+    AT_FREE(stack);
+    return ok;
+}
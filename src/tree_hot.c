@@ -0,0 +1,134 @@
+#include "tree_hot.h"
+
+#include "at_memory.h"
+
+#include <ctype.h>
+#include <string.h>
+
+void tree_hot_index_init(TreeHotIndex *index)
+{
+    if (index)
+    {
+        memset(index, 0, sizeof(*index));
+    }
+}
+
+void tree_hot_index_reset(TreeHotIndex *index)
+{
+    if (!index)
+    {
+        return;
+    }
+    AT_FREE(index->records);
+    AT_FREE(index->cold);
+    AT_FREE(index->edges);
+    tree_graph_reset(&index->graph);
+    tree_hot_index_init(index);
+}
+
+uint32_t tree_hot_index_find(const TreeHotIndex *index, const Person *person)
+{
+    return index ? tree_graph_find(&index->graph, person) : TREE_HOT_NONE;
+}
+
+bool tree_hot_parse_year(const char *value, int *out_year)
+{
+    if (!value)
+    {
+        return false;
+    }
+    int digits = 0;
+    int year = 0;
+    for (size_t index = 0U; value[index] != '\0'; ++index)
+    {
+        unsigned char ch = (unsigned char)value[index];
+        if (isdigit(ch))
+        {
+            year = year * 10 + (ch - '0');
+            digits++;
+            if (digits == 4)
+            {
+                if (out_year)
+                {
+                    *out_year = year;
+                }
+                return true;
+            }
+        }
+        else if (digits > 0)
+        {
+            break;
+        }
+    }
+    return false;
+}
+
+bool tree_hot_index_build(TreeHotIndex *index, const FamilyTree *tree)
+{
+    if (!index)
+    {
+        return false;
+    }
+    tree_hot_index_reset(index);
+    if (!tree || tree->person_count == 0U)
+    {
+        return tree != NULL;
+    }
+    if (!tree_graph_build_from_tree(&index->graph, tree))
+    {
+        tree_hot_index_reset(index);
+        return false;
+    }
+    const TreeGraph *graph = &index->graph;
+    size_t edge_capacity = graph->children.used + graph->spouses.used;
+    if (edge_capacity >= TREE_HOT_NONE)
+    {
+        tree_hot_index_reset(index);
+        return false;
+    }
+    index->records = AT_CALLOC(graph->count, sizeof(TreeHotRecord));
+    index->cold = AT_CALLOC(graph->count, sizeof(Person *));
+    index->edges = edge_capacity > 0U ? AT_CALLOC(edge_capacity, sizeof(uint32_t)) : NULL;
+    if (!index->records || !index->cold || (edge_capacity > 0U && !index->edges))
+    {
+        tree_hot_index_reset(index);
+        return false;
+    }
+    index->count = graph->count;
+
+    /* Spans copy the graph rows so a record's children and spouses sit next to each other in edges. */
+    for (uint32_t node = 0U; node < (uint32_t)index->count; ++node)
+    {
+        const Person *person = graph->persons[node];
+        TreeHotRecord *record = &index->records[node];
+        index->cold[node] = graph->persons[node];
+        record->id = person->id;
+        record->parents[0] = tree_graph_find(graph, person->parents[0]);
+        record->parents[1] = tree_graph_find(graph, person->parents[1]);
+        uint32_t row_count = 0U;
+        const uint32_t *row = tree_graph_children(graph, node, &row_count);
+        record->child_offset = (uint32_t)index->edge_count;
+        record->child_count = row_count;
+        if (row_count > 0U)
+        {
+            memcpy(index->edges + index->edge_count, row, row_count * sizeof(uint32_t));
+            index->edge_count += row_count;
+        }
+        row = tree_graph_spouses(graph, node, &row_count);
+        record->spouse_offset = (uint32_t)index->edge_count;
+        record->spouse_count = row_count;
+        if (row_count > 0U)
+        {
+            memcpy(index->edges + index->edge_count, row, row_count * sizeof(uint32_t));
+            index->edge_count += row_count;
+        }
+        record->flags = person->is_alive ? TREE_HOT_ALIVE : 0U;
+        int birth_year = 0;
+        if (tree_hot_parse_year(person->dates.birth_date, &birth_year))
+        {
+            record->birth_year = (int16_t)birth_year;
+            record->flags |= TREE_HOT_HAS_BIRTH_YEAR;
+        }
+    }
+    return true;
+}
@@ -1078,6 +1078,19 @@ static void ui_draw_settings_window(UIInternal *internal, UIContext *ui, Setting
             nk_combo_end(ctx);
         }
 
+        nk_layout_row_dynamic(ctx, 24.0f, 1);
+        int texture_budget = (int)settings->texture_budget_megabytes;
+        nk_property_int(ctx, "Texture budget (MiB)", 16, &texture_budget, 8192, 16, 16);
+        if (texture_budget < 16)
+        {
+            texture_budget = 16;
+        }
+        if ((unsigned int)texture_budget != settings->texture_budget_megabytes)
+        {
+            settings->texture_budget_megabytes = (unsigned int)texture_budget;
+            settings_mark_dirty(settings);
+        }
+
         nk_layout_row_dynamic(ctx, 6.0f, 1);
         nk_spacer(ctx);
 
@@ -1958,6 +1971,8 @@ void ui_draw_overlay(UIContext *ui, const FamilyTree *tree, const LayoutResult *
     {
         ui_internal_add_pointer_region(internal, 0.0f, 0.0f, (float)ui->width, (float)ui->height);
     }
+    detail_view_prefetch(&internal->detail_view,
+                         detail_person ? detail_person : (hovered_person ? hovered_person : selected_person));
 
     ui_draw_menu_bar(internal, ui, tree, layout, camera, render_config, settings_dirty, selected_person,
                      detail_requested);
@@ -2149,6 +2164,25 @@ bool ui_notify_status(UIContext *ui, const char *message)
     return false;
 }
 
+bool ui_set_texture_residency(UIContext *ui, struct TextureResidency *residency)
+{
+    if (!ui)
+    {
+        return false;
+    }
+#if defined(ANCESTRYTREE_HAVE_RAYLIB) && defined(ANCESTRYTREE_HAVE_NUKLEAR)
+    UIInternal *internal = ui_internal_cast(ui);
+    if (internal)
+    {
+        detail_view_set_texture_residency(&internal->detail_view, residency);
+        return true;
+    }
+#else
+    (void)residency;
+#endif
+    return false;
+}
+
 bool ui_show_error_dialog(UIContext *ui, const char *title, const char *message)
 {
     if (!ui || !ui->available)
@@ -319,6 +319,60 @@ DECLARE_TEST(test_app_command_delete_person_roundtrip)
     app_state_test_context_shutdown(&state, &layout, tree);
 }
 
+DECLARE_TEST(test_app_state_delete_branch_removes_descendants)
+{
+    AppState state;
+    FamilyTree *tree = NULL;
+    LayoutResult layout;
+    InteractionState interaction;
+    CameraController camera;
+    Settings settings;
+    Settings persisted_settings;
+
+    app_state_test_context_init(&state, &tree, &layout, &interaction, &camera, &settings, &persisted_settings);
+
+    char error_buffer[128];
+    Person *elder = app_state_test_create_person(5001U, "Ada", "Elder", "1900-01-01", NULL);
+    Person *branch = app_state_test_create_person(5002U, "Bram", "Elder", "1925-01-01", NULL);
+    Person *sibling = app_state_test_create_person(5003U, "Dora", "Elder", "1927-01-01", NULL);
+    Person *partner = app_state_test_create_person(5004U, "Sina", "Vale", "1926-01-01", NULL);
+    Person *first_child = app_state_test_create_person(5005U, "Cato", "Elder", "1950-01-01", NULL);
+    Person *second_child = app_state_test_create_person(5006U, "Cleo", "Elder", "1952-01-01", NULL);
+    Person *grandchild = app_state_test_create_person(5007U, "Gus", "Elder", "1975-01-01", NULL);
+    Person *members[] = {elder, branch, sibling, partner, first_child, second_child, grandchild};
+    for (size_t index = 0U; index < sizeof(members) / sizeof(members[0]); ++index)
+    {
+        ASSERT_NOT_NULL(members[index]);
+        ASSERT_TRUE(app_state_add_person(&state, members[index], error_buffer, sizeof(error_buffer)));
+    }
+    ASSERT_TRUE(person_add_child(elder, branch));
+    ASSERT_TRUE(person_add_child(elder, sibling));
+    ASSERT_TRUE(person_add_spouse(branch, partner));
+    ASSERT_TRUE(person_add_child(branch, first_child));
+    ASSERT_TRUE(person_add_child(branch, second_child));
+    ASSERT_TRUE(person_add_child(first_child, grandchild));
+    state.selected_person = grandchild;
+
+    size_t removed = 0U;
+    ASSERT_TRUE(app_state_delete_branch(&state, 5002U, &removed, error_buffer, sizeof(error_buffer)));
+    ASSERT_EQ(removed, 4U);
+    ASSERT_EQ(tree->person_count, 3U);
+    ASSERT_EQ(tree->persons[0], elder);
+    ASSERT_EQ(tree->persons[1], sibling);
+    ASSERT_EQ(tree->persons[2], partner);
+    ASSERT_EQ(elder->children_count, 1U);
+    ASSERT_EQ(elder->children[0], sibling);
+    ASSERT_EQ(partner->spouses_count, 0U);
+    ASSERT_NULL(state.selected_person);
+    ASSERT_TRUE(state.tree_dirty);
+    ASSERT_TRUE(family_tree_validate(tree, error_buffer, sizeof(error_buffer)));
+
+    ASSERT_FALSE(app_state_delete_branch(&state, 5002U, &removed, error_buffer, sizeof(error_buffer)));
+    ASSERT_EQ(removed, 0U);
+
+    app_state_test_context_shutdown(&state, &layout, tree);
+}
+
 DECLARE_TEST(test_app_command_edit_person_roundtrip)
 {
     AppState state;
@@ -374,6 +428,63 @@ DECLARE_TEST(test_app_command_edit_person_roundtrip)
     app_state_test_context_shutdown(&state, &layout, tree);
 }
 
+typedef struct PersonChangeLog
+{
+    AppPersonChange changes[8];
+    uint32_t ids[8];
+    size_t count;
+} PersonChangeLog;
+
+static void person_change_log_listener(AppPersonChange change, const Person *person, void *user_data)
+{
+    PersonChangeLog *log = (PersonChangeLog *)user_data;
+    if (log->count < 8U)
+    {
+        log->changes[log->count] = change;
+        log->ids[log->count] = person->id;
+        log->count++;
+    }
+}
+
+DECLARE_TEST(test_app_state_person_change_listener_tracks_commands)
+{
+    AppState state;
+    FamilyTree *tree = NULL;
+    LayoutResult layout;
+    InteractionState interaction;
+    CameraController camera;
+    Settings settings;
+    Settings persisted_settings;
+
+    app_state_test_context_init(&state, &tree, &layout, &interaction, &camera, &settings, &persisted_settings);
+
+    PersonChangeLog log;
+    memset(&log, 0, sizeof(log));
+    app_state_set_person_change_listener(&state, person_change_log_listener, &log);
+
+    char error_buffer[128];
+    Person *person = app_state_test_create_person(4001U, "Lumen", "Trace", "1990-02-02", NULL);
+    ASSERT_NOT_NULL(person);
+    ASSERT_TRUE(app_state_push_command(&state, app_command_create_add_person(person), error_buffer,
+                                       sizeof(error_buffer)));
+
+    AppPersonEditData edit_data = {"Lumen", NULL, "Traced", "1990-02-02", NULL, NULL, NULL, true};
+    ASSERT_TRUE(app_state_push_command(&state, app_command_create_edit_person(4001U, &edit_data), error_buffer,
+                                       sizeof(error_buffer)));
+    ASSERT_TRUE(app_state_push_command(&state, app_command_create_delete_person(4001U), error_buffer,
+                                       sizeof(error_buffer)));
+    ASSERT_TRUE(app_state_undo(&state, error_buffer, sizeof(error_buffer)));
+
+    ASSERT_EQ(log.count, 4U);
+    ASSERT_EQ(log.changes[0], APP_PERSON_CHANGE_ADDED);
+    ASSERT_EQ(log.changes[1], APP_PERSON_CHANGE_EDITED);
+    ASSERT_EQ(log.changes[2], APP_PERSON_CHANGE_REMOVED);
+    ASSERT_EQ(log.changes[3], APP_PERSON_CHANGE_ADDED);
+    ASSERT_EQ(log.ids[3], 4001U);
+
+    app_state_test_context_shutdown(&state, &layout, tree);
+}
+
 void register_app_state_tests(TestRegistry *registry)
 {
     REGISTER_TEST(registry, test_app_state_push_undo_redo);
@@ -381,5 +492,7 @@ void register_app_state_tests(TestRegistry *registry)
     REGISTER_TEST(registry, test_app_state_reset_history_clears_dirty_flag);
     REGISTER_TEST(registry, test_app_command_add_person_roundtrip);
     REGISTER_TEST(registry, test_app_command_delete_person_roundtrip);
+    REGISTER_TEST(registry, test_app_state_delete_branch_removes_descendants);
     REGISTER_TEST(registry, test_app_command_edit_person_roundtrip);
+    REGISTER_TEST(registry, test_app_state_person_change_listener_tracks_commands);
 }
@@ -158,6 +158,18 @@ static bool testpkg_read_u64(FILE *file, uint64_t *out_value)
     return true;
 }
 
+/* Reads an entry's codec, raw size and stored size; only uncompressed entries are expected here. */
+static bool testpkg_read_entry_sizes(FILE *file, uint64_t *out_size)
+{
+    unsigned char codec = 0xFFU;
+    uint64_t raw_size = 0U;
+    if (fread(&codec, 1U, 1U, file) != 1U || !testpkg_read_u64(file, &raw_size) || !testpkg_read_u64(file, out_size))
+    {
+        return false;
+    }
+    return codec == 0U && raw_size == *out_size;
+}
+
 static FamilyTree *test_create_tree_with_person(uint32_t id)
 {
     FamilyTree *tree = family_tree_create("AssetCleanupTest");
@@ -187,13 +199,7 @@ static bool test_assign_profile(Person *person, const char *relative_path)
     {
         return false;
     }
-    char *copy = at_string_dup(relative_path);
-    if (!copy)
-    {
-        return false;
-    }
-    person->profile_image_path = copy;
-    return true;
+    return person_set_profile_image(person, relative_path);
 }
 
 static void test_asset_copy_creates_destination(void)
@@ -245,6 +251,58 @@ static void test_asset_copy_creates_destination(void)
     ASSERT_TRUE(memcmp(buffer, payload, sizeof(payload)) == 0);
 }
 
+static void test_asset_copy_preserves_large_files(void)
+{
+    const char *root_dir = "Testing/Temporary/asset_copy_large";
+    const char *source_path = "Testing/Temporary/asset_copy_large.bin";
+    /* Larger than the buffered fallback's chunk and not a multiple of it. */
+    const size_t size = 3U * 1024U * 1024U + 7U;
+    unsigned char *payload = (unsigned char *)malloc(size);
+    ASSERT_NOT_NULL(payload);
+    for (size_t index = 0U; index < size; ++index)
+    {
+        payload[index] = (unsigned char)((index * 131U) >> 3U);
+    }
+    ASSERT_TRUE(testfs_create_directory("Testing"));
+    ASSERT_TRUE(testfs_create_directory("Testing/Temporary"));
+    ASSERT_TRUE(testfs_create_directory(root_dir));
+    ASSERT_TRUE(testfs_write_sample(source_path, payload, size));
+
+    AssetCopyRequest request;
+    request.source_path = source_path;
+    request.asset_root = root_dir;
+    request.subdirectory = "imports";
+    request.name_prefix = "scan";
+    char relative[256];
+    char error[128];
+    ASSERT_TRUE(asset_copy(&request, relative, sizeof(relative), error, sizeof(error)));
+
+    char destination[512];
+    int written = snprintf(destination, sizeof(destination), "%s/%s", root_dir, relative);
+    ASSERT_TRUE(written > 0 && (size_t)written < sizeof(destination));
+    FILE *copied = NULL;
+#if defined(_WIN32)
+    if (fopen_s(&copied, destination, "rb") != 0)
+    {
+        copied = NULL;
+    }
+#else
+    copied = fopen(destination, "rb");
+#endif
+    ASSERT_NOT_NULL(copied);
+    unsigned char *buffer = (unsigned char *)malloc(size + 1U);
+    ASSERT_NOT_NULL(buffer);
+    size_t total = fread(buffer, 1U, size + 1U, copied);
+    fclose(copied);
+    ASSERT_EQ(total, size);
+    ASSERT_TRUE(memcmp(buffer, payload, size) == 0);
+
+    free(buffer);
+    free(payload);
+    (void)testfs_remove_file(destination);
+    (void)testfs_remove_file(source_path);
+}
+
 static void test_asset_copy_generates_unique_names(void)
 {
     const char *root_dir = "Testing/Temporary/asset_copy_unique";
@@ -268,10 +326,203 @@ static void test_asset_copy_generates_unique_names(void)
     char error[64];
 
     ASSERT_TRUE(asset_copy(&request, relative_a, sizeof(relative_a), error, sizeof(error)));
+    payload[0] ^= 0xFFU;
+    ASSERT_TRUE(testfs_write_sample(source_path, payload, sizeof(payload)));
     ASSERT_TRUE(asset_copy(&request, relative_b, sizeof(relative_b), error, sizeof(error)));
     ASSERT_TRUE(strcmp(relative_a, relative_b) != 0);
 }
 
+static void test_asset_copy_reuses_identical_content(void)
+{
+    const char *root_dir = "Testing/Temporary/asset_copy_dedup";
+    const char *source_a = "Testing/Temporary/asset_copy_dedup_a.bin";
+    const char *source_b = "Testing/Temporary/asset_copy_dedup_b.bin";
+    const char *index_path = "Testing/Temporary/asset_copy_dedup/.content_index";
+    unsigned char payload[] = {0x5A, 0x00, 0x13, 0x37, 0xC0, 0xDE, 0x01, 0x02, 0x03};
+
+    ASSERT_TRUE(testfs_create_directory("Testing"));
+    ASSERT_TRUE(testfs_create_directory("Testing/Temporary"));
+    ASSERT_TRUE(testfs_create_directory(root_dir));
+    (void)testfs_remove_file(index_path);
+    ASSERT_TRUE(testfs_write_sample(source_a, payload, sizeof(payload)));
+    ASSERT_TRUE(testfs_write_sample(source_b, payload, sizeof(payload)));
+
+    AssetCopyRequest request;
+    request.source_path = source_a;
+    request.asset_root = root_dir;
+    request.subdirectory = "imports";
+    request.name_prefix = "certificate";
+
+    char first[128];
+    char second[128];
+    char third[128];
+    char error[64];
+    ASSERT_TRUE(asset_copy(&request, first, sizeof(first), error, sizeof(error)));
+    request.source_path = source_b;
+    request.subdirectory = "scans";
+    ASSERT_TRUE(asset_copy(&request, second, sizeof(second), error, sizeof(error)));
+    ASSERT_STREQ(second, first);
+
+    payload[sizeof(payload) - 1U] = 0x04;
+    ASSERT_TRUE(testfs_write_sample(source_b, payload, sizeof(payload)));
+    ASSERT_TRUE(asset_copy(&request, third, sizeof(third), error, sizeof(error)));
+    ASSERT_TRUE(strcmp(third, first) != 0);
+    ASSERT_TRUE(strncmp(third, "scans/", 6U) == 0);
+
+    char absolute[256];
+    ASSERT_TRUE(snprintf(absolute, sizeof(absolute), "%s/%s", root_dir, first) < (int)sizeof(absolute));
+    (void)testfs_remove_file(absolute);
+    request.source_path = source_a;
+    ASSERT_TRUE(asset_copy(&request, second, sizeof(second), error, sizeof(error)));
+    ASSERT_TRUE(strcmp(second, first) != 0);
+
+    ASSERT_TRUE(snprintf(absolute, sizeof(absolute), "%s/%s", root_dir, second) < (int)sizeof(absolute));
+    (void)testfs_remove_file(absolute);
+    ASSERT_TRUE(snprintf(absolute, sizeof(absolute), "%s/%s", root_dir, third) < (int)sizeof(absolute));
+    (void)testfs_remove_file(absolute);
+    (void)testfs_remove_file(index_path);
+    (void)testfs_remove_file(source_a);
+    (void)testfs_remove_file(source_b);
+}
+
+static size_t testfs_count_lines(const char *path, const char *needle, size_t *out_matching)
+{
+    size_t lines = 0U;
+    size_t matching = 0U;
+    FILE *file = fopen(path, "rb");
+    if (file)
+    {
+        char line[512];
+        while (fgets(line, (int)sizeof(line), file))
+        {
+            lines++;
+            if (needle && strstr(line, needle))
+            {
+                matching++;
+            }
+        }
+        fclose(file);
+    }
+    if (out_matching)
+    {
+        *out_matching = matching;
+    }
+    return lines;
+}
+
+static void test_asset_copy_prunes_stale_content_index_entries(void)
+{
+    const char *root_dir = "Testing/Temporary/asset_copy_prune";
+    const char *source_path = "Testing/Temporary/asset_copy_prune.bin";
+    const char *index_path = "Testing/Temporary/asset_copy_prune/.content_index";
+    unsigned char payload[] = {0x11, 0x22, 0x33, 0x44, 0x55};
+
+    ASSERT_TRUE(testfs_create_directory("Testing"));
+    ASSERT_TRUE(testfs_create_directory("Testing/Temporary"));
+    ASSERT_TRUE(testfs_create_directory(root_dir));
+    (void)testfs_remove_file(index_path);
+    asset_content_index_release();
+
+    AssetCopyRequest request;
+    request.source_path = source_path;
+    request.asset_root = root_dir;
+    request.subdirectory = "imports";
+    request.name_prefix = "scan";
+
+    char copies[4][128];
+    char error[64];
+    char absolute[256];
+    for (size_t index = 0U; index < 4U; ++index)
+    {
+        payload[0] = (unsigned char)index;
+        ASSERT_TRUE(testfs_write_sample(source_path, payload, sizeof(payload)));
+        ASSERT_TRUE(asset_copy(&request, copies[index], sizeof(copies[index]), error, sizeof(error)));
+    }
+    ASSERT_EQ(testfs_count_lines(index_path, NULL, NULL), 4U);
+
+    /* Repeats are answered from memory and add nothing to the file. */
+    char again[128];
+    ASSERT_TRUE(asset_copy(&request, again, sizeof(again), error, sizeof(error)));
+    ASSERT_STREQ(again, copies[3]);
+    ASSERT_EQ(testfs_count_lines(index_path, NULL, NULL), 4U);
+
+    /* The removed file's entry is dropped once found and the file is rewritten without it. */
+    ASSERT_TRUE(snprintf(absolute, sizeof(absolute), "%s/%s", root_dir, copies[3]) < (int)sizeof(absolute));
+    ASSERT_TRUE(testfs_remove_file(absolute));
+    ASSERT_TRUE(asset_copy(&request, again, sizeof(again), error, sizeof(error)));
+    ASSERT_TRUE(snprintf(absolute, sizeof(absolute), "%s/%s", root_dir, again) < (int)sizeof(absolute));
+    FILE *restored = fopen(absolute, "rb");
+    ASSERT_NOT_NULL(restored);
+    fclose(restored);
+    size_t matching = 0U;
+    ASSERT_EQ(testfs_count_lines(index_path, again, &matching), 4U);
+    ASSERT_EQ(matching, 1U);
+    (void)snprintf(copies[3], sizeof(copies[3]), "%s", again);
+
+    /* Replacing the index file on disk is noticed: a fresh file means nothing is known yet. */
+    ASSERT_TRUE(testfs_remove_file(index_path));
+    payload[0] = 0U;
+    ASSERT_TRUE(testfs_write_sample(source_path, payload, sizeof(payload)));
+    ASSERT_TRUE(asset_copy(&request, again, sizeof(again), error, sizeof(error)));
+    ASSERT_TRUE(strcmp(again, copies[0]) != 0);
+    ASSERT_EQ(testfs_count_lines(index_path, NULL, NULL), 1U);
+
+    ASSERT_TRUE(snprintf(absolute, sizeof(absolute), "%s/%s", root_dir, again) < (int)sizeof(absolute));
+    (void)testfs_remove_file(absolute);
+    for (size_t index = 0U; index < 4U; ++index)
+    {
+        ASSERT_TRUE(snprintf(absolute, sizeof(absolute), "%s/%s", root_dir, copies[index]) < (int)sizeof(absolute));
+        (void)testfs_remove_file(absolute);
+    }
+    (void)testfs_remove_file(index_path);
+    (void)testfs_remove_file(source_path);
+    asset_content_index_release();
+}
+
+static void test_asset_copy_keeps_index_entry_on_content_mismatch(void)
+{
+    const char *root_dir = "Testing/Temporary/asset_copy_collide";
+    const char *source_path = "Testing/Temporary/asset_copy_collide.bin";
+    const char *index_path = "Testing/Temporary/asset_copy_collide/.content_index";
+    const unsigned char payload[] = {0x61, 0x62, 0x63, 0x64};
+    const unsigned char rewritten[] = {0x71, 0x72, 0x73, 0x74};
+
+    ASSERT_TRUE(testfs_create_directory("Testing"));
+    ASSERT_TRUE(testfs_create_directory("Testing/Temporary"));
+    ASSERT_TRUE(testfs_create_directory(root_dir));
+    (void)testfs_remove_file(index_path);
+    asset_content_index_release();
+
+    AssetCopyRequest request;
+    request.source_path = source_path;
+    request.asset_root = root_dir;
+    request.subdirectory = "imports";
+    request.name_prefix = "scan";
+
+    char first[128];
+    char second[128];
+    char error[64];
+    char absolute[256];
+    ASSERT_TRUE(testfs_write_sample(source_path, payload, sizeof(payload)));
+    ASSERT_TRUE(asset_copy(&request, first, sizeof(first), error, sizeof(error)));
+
+    /* Same size, other bytes: what a hash collision looks like. The file is still there, so its entry stays. */
+    ASSERT_TRUE(snprintf(absolute, sizeof(absolute), "%s/%s", root_dir, first) < (int)sizeof(absolute));
+    ASSERT_TRUE(testfs_write_sample(absolute, rewritten, sizeof(rewritten)));
+    ASSERT_TRUE(asset_copy(&request, second, sizeof(second), error, sizeof(error)));
+    ASSERT_TRUE(strcmp(first, second) != 0);
+    size_t matching = 0U;
+    ASSERT_EQ(testfs_count_lines(index_path, first, &matching), 2U);
+    ASSERT_EQ(matching, 1U);
+
+    (void)testfs_remove_file(absolute);
+    ASSERT_TRUE(snprintf(absolute, sizeof(absolute), "%s/%s", root_dir, second) < (int)sizeof(absolute));
+    (void)testfs_remove_file(absolute);
+    (void)testfs_remove_file(index_path);
+    (void)testfs_remove_file(source_path);
+    asset_content_index_release();
+}
+
 static void test_asset_copy_missing_source_reports_error(void)
 {
     AssetCopyRequest request;
@@ -399,6 +650,53 @@ static void test_asset_cleanup_detects_missing_files(void)
     (void)testfs_remove_file(orphan_abs);
 }
 
+static void test_asset_cleanup_parallel_walks_nested_directories(void)
+{
+    const char *root_dir = "Testing/Temporary/asset_cleanup_case3";
+    const char *keep_rel = "imports/a/keep.bin";
+    const char *orphan_rels[] = {"imports/a/b/drop.bin", "imports/c/drop.bin", "imports/drop.bin"};
+
+    ASSERT_TRUE(testfs_create_directory("Testing"));
+    ASSERT_TRUE(testfs_create_directory("Testing/Temporary"));
+    ASSERT_TRUE(testfs_create_directory(root_dir));
+    ASSERT_TRUE(testfs_create_directory("Testing/Temporary/asset_cleanup_case3/imports"));
+    ASSERT_TRUE(testfs_create_directory("Testing/Temporary/asset_cleanup_case3/imports/a"));
+    ASSERT_TRUE(testfs_create_directory("Testing/Temporary/asset_cleanup_case3/imports/a/b"));
+    ASSERT_TRUE(testfs_create_directory("Testing/Temporary/asset_cleanup_case3/imports/c"));
+
+    unsigned char payload[] = {0x10, 0x20};
+    char keep_abs[256];
+    int written = snprintf(keep_abs, sizeof(keep_abs), "%s/%s", root_dir, keep_rel);
+    ASSERT_TRUE(written > 0 && (size_t)written < sizeof(keep_abs));
+    ASSERT_TRUE(testfs_write_sample(keep_abs, payload, sizeof(payload)));
+    char orphan_abs[3][256];
+    for (size_t index = 0U; index < 3U; ++index)
+    {
+        written = snprintf(orphan_abs[index], sizeof(orphan_abs[index]), "%s/%s", root_dir, orphan_rels[index]);
+        ASSERT_TRUE(written > 0 && (size_t)written < sizeof(orphan_abs[index]));
+        ASSERT_TRUE(testfs_write_sample(orphan_abs[index], payload, sizeof(payload)));
+    }
+
+    FamilyTree *tree = test_create_tree_with_person(303U);
+    ASSERT_NOT_NULL(tree);
+    ASSERT_TRUE(person_add_certificate(tree->persons[0], keep_rel));
+
+    AssetCleanupStats stats;
+    char error[128];
+    ASSERT_TRUE(asset_cleanup_parallel(tree, root_dir, "imports", 4U, &stats, error, sizeof(error)));
+    ASSERT_STREQ(error, "");
+    ASSERT_EQ(stats.referenced_files, 1U);
+    ASSERT_EQ(stats.removed_files, 3U);
+    ASSERT_TRUE(testfs_file_exists(keep_abs));
+    for (size_t index = 0U; index < 3U; ++index)
+    {
+        ASSERT_FALSE(testfs_file_exists(orphan_abs[index]));
+    }
+
+    family_tree_destroy(tree);
+    (void)testfs_remove_file(keep_abs);
+}
+
 static void test_asset_export_builds_package(void)
 {
     const char *base_dir = "Testing/Temporary/asset_export_case1";
@@ -482,7 +780,7 @@ static void test_asset_export_builds_package(void)
     uint32_t file_total = 0U;
     ASSERT_TRUE(testpkg_read_u32(package, &version));
     ASSERT_TRUE(testpkg_read_u32(package, &file_total));
-    ASSERT_EQ(version, 1U);
+    ASSERT_EQ(version, 4U);
     ASSERT_EQ(file_total, 4U);
 
     uint16_t path_length = 0U;
@@ -495,7 +793,7 @@ static void test_asset_export_builds_package(void)
     ASSERT_EQ(path_read, (size_t)path_length);
     path_buffer[path_length] = '\0';
     ASSERT_STREQ(path_buffer, "tree.json");
-    ASSERT_TRUE(testpkg_read_u64(package, &entry_size));
+    ASSERT_TRUE(testpkg_read_entry_sizes(package, &entry_size));
     ASSERT_TRUE(entry_size == strlen(tree_json));
     unsigned char *file_data = (unsigned char *)malloc((size_t)entry_size);
     ASSERT_NOT_NULL(file_data);
@@ -511,7 +809,7 @@ static void test_asset_export_builds_package(void)
         path_read = fread(path_buffer, 1U, path_length, package);
         ASSERT_EQ(path_read, (size_t)path_length);
         path_buffer[path_length] = '\0';
-        ASSERT_TRUE(testpkg_read_u64(package, &entry_size));
+        ASSERT_TRUE(testpkg_read_entry_sizes(package, &entry_size));
         unsigned char *payload_buffer = (unsigned char *)malloc((size_t)entry_size);
         ASSERT_NOT_NULL(payload_buffer);
         data_read = fread(payload_buffer, 1U, (size_t)entry_size, package);
@@ -540,6 +838,24 @@ static void test_asset_export_builds_package(void)
     }
 
     fclose(package);
+
+    AssetPackage *opened = asset_package_open(package_path, error, sizeof(error));
+    ASSERT_NOT_NULL(opened);
+    ASSERT_EQ(asset_package_entry_count(opened), 4U);
+    AssetPackageEntry view;
+    ASSERT_TRUE(asset_package_read_entry(opened, "assets/imports/certificate.pdf", &view));
+    ASSERT_EQ(view.size, sizeof(certificate_payload));
+    ASSERT_TRUE(memcmp(view.data, certificate_payload, sizeof(certificate_payload)) == 0);
+    ASSERT_TRUE(view.has_checksum);
+    ASSERT_TRUE(asset_package_entry_is_intact(&view));
+    ASSERT_TRUE(asset_package_read_entry(opened, "tree.json", &view));
+    ASSERT_EQ(view.size, strlen(tree_json));
+    ASSERT_FALSE(asset_package_read_entry(opened, "assets/imports/missing.png", &view));
+    ASSERT_TRUE(asset_package_entry_at(opened, 0U, &view));
+    ASSERT_TRUE(view.path_length == strlen("assets/imports/certificate.pdf") &&
+                memcmp(view.path, "assets/imports/certificate.pdf", view.path_length) == 0);
+    asset_package_close(opened);
+
     family_tree_destroy(tree);
     (void)testfs_remove_file(package_path);
     (void)testfs_remove_file(tree_json_path);
@@ -586,13 +902,272 @@ static void test_asset_export_fails_when_asset_missing(void)
     (void)testfs_remove_file(tree_json_path);
 }
 
+static void test_asset_export_stores_duplicate_payloads_once(void)
+{
+    const char *root_dir = "Testing/Temporary/asset_export_dedup/assets";
+    const char *tree_json_path = "Testing/Temporary/asset_export_dedup/tree.json";
+    const char *package_path = "Testing/Temporary/asset_export_dedup/export.atpkg";
+    const char *files[3] = {"Testing/Temporary/asset_export_dedup/assets/imports/a.pdf",
+                            "Testing/Temporary/asset_export_dedup/assets/imports/b.pdf",
+                            "Testing/Temporary/asset_export_dedup/assets/imports/c.pdf"};
+
+    ASSERT_TRUE(testfs_create_directory("Testing"));
+    ASSERT_TRUE(testfs_create_directory("Testing/Temporary"));
+    ASSERT_TRUE(testfs_create_directory("Testing/Temporary/asset_export_dedup"));
+    ASSERT_TRUE(testfs_create_directory(root_dir));
+    ASSERT_TRUE(testfs_create_directory("Testing/Temporary/asset_export_dedup/assets/imports"));
+
+    const unsigned char shared_payload[] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF, 0x10};
+    const unsigned char other_payload[] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF, 0x11};
+    ASSERT_TRUE(testfs_write_sample(files[0], shared_payload, sizeof(shared_payload)));
+    ASSERT_TRUE(testfs_write_sample(files[1], shared_payload, sizeof(shared_payload)));
+    ASSERT_TRUE(testfs_write_sample(files[2], other_payload, sizeof(other_payload)));
+    const char tree_json[] = "{}";
+    ASSERT_TRUE(testfs_write_sample(tree_json_path, (const unsigned char *)tree_json, strlen(tree_json)));
+
+    FamilyTree *tree = test_create_tree_with_person(505U);
+    ASSERT_NOT_NULL(tree);
+    ASSERT_TRUE(person_add_certificate(tree->persons[0], "imports/a.pdf"));
+    ASSERT_TRUE(person_add_certificate(tree->persons[0], "imports/b.pdf"));
+    ASSERT_TRUE(person_add_certificate(tree->persons[0], "imports/c.pdf"));
+
+    AssetExportStats stats;
+    char error[128];
+    ASSERT_TRUE(asset_export(tree, root_dir, tree_json_path, package_path, &stats, error, sizeof(error)));
+    ASSERT_EQ(stats.exported_files, 3U);
+    ASSERT_EQ(stats.deduplicated_files, 1U);
+
+    AssetPackage *package = asset_package_open(package_path, error, sizeof(error));
+    ASSERT_NOT_NULL(package);
+    ASSERT_EQ(asset_package_entry_count(package), 4U);
+    AssetPackageEntry first;
+    AssetPackageEntry second;
+    AssetPackageEntry third;
+    ASSERT_TRUE(asset_package_read_entry(package, "assets/imports/a.pdf", &first));
+    ASSERT_TRUE(asset_package_read_entry(package, "assets/imports/b.pdf", &second));
+    ASSERT_TRUE(asset_package_read_entry(package, "assets/imports/c.pdf", &third));
+    ASSERT_TRUE(first.data == second.data);
+    ASSERT_TRUE(third.data != first.data);
+    ASSERT_TRUE(memcmp(second.data, shared_payload, sizeof(shared_payload)) == 0);
+    ASSERT_TRUE(memcmp(third.data, other_payload, sizeof(other_payload)) == 0);
+    ASSERT_TRUE(asset_package_entry_is_intact(&second));
+    asset_package_close(package);
+
+    family_tree_destroy(tree);
+    (void)testfs_remove_file(package_path);
+    (void)testfs_remove_file(tree_json_path);
+    for (size_t index = 0U; index < 3U; ++index)
+    {
+        (void)testfs_remove_file(files[index]);
+    }
+}
+
+static void test_asset_export_compresses_entries_in_order(void)
+{
+    const char *root_dir = "Testing/Temporary/asset_export_lz/assets";
+    const char *tree_json_path = "Testing/Temporary/asset_export_lz/tree.json";
+    const char *package_path = "Testing/Temporary/asset_export_lz/export.atpkg";
+    const char *files[4] = {"Testing/Temporary/asset_export_lz/assets/imports/a.txt",
+                            "Testing/Temporary/asset_export_lz/assets/imports/b.bin",
+                            "Testing/Temporary/asset_export_lz/assets/imports/c.txt",
+                            "Testing/Temporary/asset_export_lz/assets/imports/d.txt"};
+
+    ASSERT_TRUE(testfs_create_directory("Testing"));
+    ASSERT_TRUE(testfs_create_directory("Testing/Temporary"));
+    ASSERT_TRUE(testfs_create_directory("Testing/Temporary/asset_export_lz"));
+    ASSERT_TRUE(testfs_create_directory(root_dir));
+    ASSERT_TRUE(testfs_create_directory("Testing/Temporary/asset_export_lz/assets/imports"));
+
+    size_t json_capacity = 64U * 1024U;
+    char *json = (char *)malloc(json_capacity);
+    ASSERT_NOT_NULL(json);
+    size_t json_length = 0U;
+    for (unsigned int index = 0U; json_length + 96U < json_capacity; ++index)
+    {
+        json_length += (size_t)snprintf(json + json_length, json_capacity - json_length,
+                                        "{\"id\":%u,\"name\":\"Ada Lovelace\",\"place\":\"London\"},\n", index);
+    }
+    ASSERT_TRUE(testfs_write_sample(tree_json_path, (const unsigned char *)json, json_length));
+    unsigned char noise[512];
+    uint32_t state = 0x9E3779B9U;
+    for (size_t index = 0U; index < sizeof(noise); ++index)
+    {
+        state = state * 1664525U + 1013904223U;
+        noise[index] = (unsigned char)(state >> 24U);
+    }
+    ASSERT_TRUE(testfs_write_sample(files[0], (const unsigned char *)json, json_length / 2U));
+    ASSERT_TRUE(testfs_write_sample(files[1], noise, sizeof(noise)));
+    ASSERT_TRUE(testfs_write_sample(files[2], (const unsigned char *)json + 7U, json_length / 3U));
+    ASSERT_TRUE(testfs_write_sample(files[3], (const unsigned char *)json, json_length / 2U));
+
+    FamilyTree *tree = test_create_tree_with_person(606U);
+    ASSERT_NOT_NULL(tree);
+    ASSERT_TRUE(person_add_certificate(tree->persons[0], "imports/a.txt"));
+    ASSERT_TRUE(person_add_certificate(tree->persons[0], "imports/b.bin"));
+    ASSERT_TRUE(person_add_certificate(tree->persons[0], "imports/c.txt"));
+    ASSERT_TRUE(person_add_certificate(tree->persons[0], "imports/d.txt"));
+
+    AssetExportOptions options;
+    options.codec = ASSET_PACKAGE_CODEC_LZ;
+    options.worker_count = 3U;
+    AssetExportStats stats;
+    char error[128];
+    ASSERT_TRUE(asset_export_with_options(tree, root_dir, tree_json_path, package_path, &options, &stats, error,
+                                          sizeof(error)));
+    ASSERT_EQ(stats.exported_files, 4U);
+    ASSERT_EQ(stats.deduplicated_files, 1U);
+    ASSERT_EQ(stats.compressed_files, 3U);
+    ASSERT_TRUE(stats.package_bytes * 4U < stats.exported_bytes);
+
+    AssetPackage *package = asset_package_open(package_path, error, sizeof(error));
+    ASSERT_NOT_NULL(package);
+    ASSERT_EQ(asset_package_entry_count(package), 5U);
+    unsigned char *decoded = (unsigned char *)malloc(json_length);
+    ASSERT_NOT_NULL(decoded);
+    AssetPackageEntry entry;
+    ASSERT_TRUE(asset_package_read_entry(package, "tree.json", &entry));
+    ASSERT_EQ(entry.codec, ASSET_PACKAGE_CODEC_LZ);
+    ASSERT_EQ(entry.raw_size, json_length);
+    ASSERT_TRUE(entry.size < entry.raw_size);
+    ASSERT_TRUE(asset_package_entry_is_intact(&entry));
+    ASSERT_FALSE(asset_package_entry_decode(&entry, decoded, json_length - 1U));
+    ASSERT_TRUE(asset_package_entry_decode(&entry, decoded, json_length));
+    ASSERT_TRUE(memcmp(decoded, json, json_length) == 0);
+    ASSERT_TRUE(asset_package_read_entry(package, "assets/imports/b.bin", &entry));
+    ASSERT_EQ(entry.codec, ASSET_PACKAGE_CODEC_NONE);
+    ASSERT_TRUE(memcmp(entry.data, noise, sizeof(noise)) == 0);
+    ASSERT_TRUE(asset_package_read_entry(package, "assets/imports/c.txt", &entry));
+    ASSERT_TRUE(asset_package_entry_decode(&entry, decoded, json_length));
+    ASSERT_TRUE(memcmp(decoded, json + 7U, json_length / 3U) == 0);
+    AssetPackageEntry alias;
+    ASSERT_TRUE(asset_package_read_entry(package, "assets/imports/a.txt", &entry));
+    ASSERT_TRUE(asset_package_read_entry(package, "assets/imports/d.txt", &alias));
+    ASSERT_TRUE(entry.data == alias.data);
+    asset_package_close(package);
+
+    free(decoded);
+    free(json);
+    family_tree_destroy(tree);
+    (void)testfs_remove_file(package_path);
+    (void)testfs_remove_file(tree_json_path);
+    for (size_t index = 0U; index < 4U; ++index)
+    {
+        (void)testfs_remove_file(files[index]);
+    }
+}
+
+static void test_asset_package_rejects_forged_directory_count(void)
+{
+    const char *root_dir = "Testing/Temporary/asset_package_forged/assets";
+    const char *tree_json_path = "Testing/Temporary/asset_package_forged/tree.json";
+    const char *package_path = "Testing/Temporary/asset_package_forged/export.atpkg";
+    const char *file_path = "Testing/Temporary/asset_package_forged/assets/imports/a.pdf";
+
+    ASSERT_TRUE(testfs_create_directory("Testing"));
+    ASSERT_TRUE(testfs_create_directory("Testing/Temporary"));
+    ASSERT_TRUE(testfs_create_directory("Testing/Temporary/asset_package_forged"));
+    ASSERT_TRUE(testfs_create_directory(root_dir));
+    ASSERT_TRUE(testfs_create_directory("Testing/Temporary/asset_package_forged/assets/imports"));
+    const unsigned char payload[] = {0x25, 0x50, 0x44, 0x46};
+    ASSERT_TRUE(testfs_write_sample(file_path, payload, sizeof(payload)));
+    const char tree_json[] = "{}";
+    ASSERT_TRUE(testfs_write_sample(tree_json_path, (const unsigned char *)tree_json, strlen(tree_json)));
+
+    FamilyTree *tree = test_create_tree_with_person(707U);
+    ASSERT_NOT_NULL(tree);
+    ASSERT_TRUE(person_add_certificate(tree->persons[0], "imports/a.pdf"));
+    char error[128];
+    ASSERT_TRUE(asset_export(tree, root_dir, tree_json_path, package_path, NULL, error, sizeof(error)));
+
+    unsigned char bytes[1024];
+    FILE *file = fopen(package_path, "rb");
+    ASSERT_NOT_NULL(file);
+    size_t length = fread(bytes, 1U, sizeof(bytes), file);
+    fclose(file);
+    ASSERT_TRUE(length > 24U && length < sizeof(bytes));
+
+    /* The footer's entry count lies outside the directory checksum; a forged one must not size the record table. */
+    memset(bytes + length - 24U + 8U, 0xFF, 4U);
+    ASSERT_TRUE(testfs_write_sample(package_path, bytes, length));
+    ASSERT_NULL(asset_package_open(package_path, error, sizeof(error)));
+    ASSERT_TRUE(strlen(error) > 0U);
+
+    family_tree_destroy(tree);
+    (void)testfs_remove_file(package_path);
+    (void)testfs_remove_file(tree_json_path);
+    (void)testfs_remove_file(file_path);
+}
+
+static size_t testpkg_put_entry(unsigned char *cursor, const char *path, const char *payload)
+{
+    size_t path_length = strlen(path);
+    size_t payload_length = strlen(payload);
+    cursor[0] = (unsigned char)(path_length & 0xFFU);
+    cursor[1] = (unsigned char)(path_length >> 8U);
+    memcpy(cursor + 2U, path, path_length);
+    for (size_t index = 0U; index < 8U; ++index)
+    {
+        cursor[2U + path_length + index] = (unsigned char)(((uint64_t)payload_length >> (index * 8U)) & 0xFFU);
+    }
+    memcpy(cursor + 10U + path_length, payload, payload_length);
+    return 10U + path_length + payload_length;
+}
+
+static void test_asset_package_opens_version_one(void)
+{
+    const char *base_dir = "Testing/Temporary/asset_package_v1";
+    const char *package_path = "Testing/Temporary/asset_package_v1/legacy.atpkg";
+    ASSERT_TRUE(testfs_create_directory("Testing"));
+    ASSERT_TRUE(testfs_create_directory("Testing/Temporary"));
+    ASSERT_TRUE(testfs_create_directory(base_dir));
+
+    unsigned char bytes[256];
+    memcpy(bytes, "ATPKG", 5U);
+    const unsigned char header[8] = {1U, 0U, 0U, 0U, 3U, 0U, 0U, 0U};
+    memcpy(bytes + 5U, header, sizeof(header));
+    size_t length = 13U;
+    length += testpkg_put_entry(bytes + length, "tree.json", "{}");
+    length += testpkg_put_entry(bytes + length, "assets/imports/b.png", "bravo");
+    length += testpkg_put_entry(bytes + length, "assets/imports/a.png", "alpha!");
+    ASSERT_TRUE(testfs_write_sample(package_path, bytes, length));
+
+    char error[128];
+    AssetPackage *package = asset_package_open(package_path, error, sizeof(error));
+    ASSERT_NOT_NULL(package);
+    ASSERT_EQ(asset_package_entry_count(package), 3U);
+    AssetPackageEntry view;
+    ASSERT_TRUE(asset_package_read_entry(package, "assets/imports/a.png", &view));
+    ASSERT_EQ(view.size, 6U);
+    ASSERT_TRUE(memcmp(view.data, "alpha!", 6U) == 0);
+    ASSERT_FALSE(view.has_checksum);
+    ASSERT_TRUE(asset_package_entry_is_intact(&view));
+    ASSERT_TRUE(asset_package_read_entry(package, "tree.json", &view));
+    ASSERT_EQ(view.size, 2U);
+    asset_package_close(package);
+
+    bytes[9] = 4U;
+    ASSERT_TRUE(testfs_write_sample(package_path, bytes, length));
+    ASSERT_NULL(asset_package_open(package_path, error, sizeof(error)));
+    ASSERT_TRUE(strlen(error) > 0U);
+    (void)testfs_remove_file(package_path);
+}
+
 void register_assets_tests(TestRegistry *registry)
 {
     REGISTER_TEST(registry, test_asset_copy_creates_destination);
+    REGISTER_TEST(registry, test_asset_copy_preserves_large_files);
     REGISTER_TEST(registry, test_asset_copy_generates_unique_names);
+    REGISTER_TEST(registry, test_asset_copy_reuses_identical_content);
+    REGISTER_TEST(registry, test_asset_copy_prunes_stale_content_index_entries);
+    REGISTER_TEST(registry, test_asset_copy_keeps_index_entry_on_content_mismatch);
     REGISTER_TEST(registry, test_asset_copy_missing_source_reports_error);
     REGISTER_TEST(registry, test_asset_cleanup_removes_unreferenced_files);
     REGISTER_TEST(registry, test_asset_cleanup_detects_missing_files);
+    REGISTER_TEST(registry, test_asset_cleanup_parallel_walks_nested_directories);
     REGISTER_TEST(registry, test_asset_export_builds_package);
     REGISTER_TEST(registry, test_asset_export_fails_when_asset_missing);
+    REGISTER_TEST(registry, test_asset_export_stores_duplicate_payloads_once);
+    REGISTER_TEST(registry, test_asset_export_compresses_entries_in_order);
+    REGISTER_TEST(registry, test_asset_package_opens_version_one);
+    REGISTER_TEST(registry, test_asset_package_rejects_forged_directory_count);
 }
@@ -0,0 +1,98 @@
+#include "at_compress.h"
+#include "test_framework.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static bool test_compress_round_trip(const unsigned char *data, size_t size, size_t *out_compressed)
+{
+    size_t bound = at_compress_bound(size);
+    unsigned char *packed = (unsigned char *)malloc(bound);
+    unsigned char *restored = (unsigned char *)malloc(size > 0U ? size : 1U);
+    bool ok = packed && restored;
+    size_t packed_size = ok ? at_compress(data, size, packed, bound) : 0U;
+    ok = ok && packed_size > 0U && packed_size <= bound && at_decompress(packed, packed_size, restored, size) &&
+         (size == 0U || memcmp(restored, data, size) == 0);
+    if (out_compressed)
+    {
+        *out_compressed = packed_size;
+    }
+    free(packed);
+    free(restored);
+    return ok;
+}
+
+TEST(test_compress_shrinks_repetitive_json)
+{
+    size_t capacity = 256U * 1024U;
+    char *json = (char *)malloc(capacity);
+    ASSERT_NOT_NULL(json);
+    size_t length = 0U;
+    for (unsigned int index = 0U; length + 200U < capacity; ++index)
+    {
+        length += (size_t)snprintf(json + length, capacity - length,
+                                   "{\"id\":%u,\"name\":{\"first\":\"Ada\",\"last\":\"Lovelace\"},"
+                                   "\"birth\":{\"date\":\"18%02u-12-10\",\"place\":\"London\"}},\n",
+                                   index, index % 100U);
+    }
+    size_t compressed = 0U;
+    ASSERT_TRUE(test_compress_round_trip((const unsigned char *)json, length, &compressed));
+    ASSERT_TRUE(compressed * 5U < length);
+    free(json);
+
+    const unsigned char run[64] = {0};
+    ASSERT_TRUE(test_compress_round_trip(run, sizeof(run), &compressed));
+    ASSERT_TRUE(compressed < sizeof(run) / 2U);
+}
+
+TEST(test_compress_round_trips_incompressible_and_tiny_inputs)
+{
+    size_t size = 100000U;
+    unsigned char *noise = (unsigned char *)malloc(size);
+    ASSERT_NOT_NULL(noise);
+    uint32_t state = 0x2545F491U;
+    for (size_t index = 0U; index < size; ++index)
+    {
+        state ^= state << 13U;
+        state ^= state >> 17U;
+        state ^= state << 5U;
+        noise[index] = (unsigned char)state;
+    }
+    size_t compressed = 0U;
+    ASSERT_TRUE(test_compress_round_trip(noise, size, &compressed));
+    ASSERT_TRUE(compressed <= at_compress_bound(size));
+    for (size_t tiny = 0U; tiny < 16U; ++tiny)
+    {
+        ASSERT_TRUE(test_compress_round_trip(noise, tiny, NULL));
+    }
+
+    unsigned char small[8];
+    ASSERT_EQ(at_compress(noise, size, small, sizeof(small)), 0U);
+    free(noise);
+}
+
+TEST(test_compress_rejects_damaged_blocks)
+{
+    const char text[] = "abcabcabcabcabcabcabcabcabcabcabcabc tail";
+    unsigned char packed[128];
+    size_t packed_size = at_compress((const unsigned char *)text, sizeof(text), packed, sizeof(packed));
+    ASSERT_TRUE(packed_size > 0U);
+    unsigned char restored[sizeof(text)];
+    ASSERT_TRUE(at_decompress(packed, packed_size, restored, sizeof(text)));
+    ASSERT_FALSE(at_decompress(packed, packed_size, restored, sizeof(text) - 1U));
+    ASSERT_FALSE(at_decompress(packed, packed_size - 1U, restored, sizeof(text)));
+
+    /* A back reference reaching before the start of the output. */
+    const unsigned char bad_offset[] = {0x10U, 'a', 0x09U, 0x00U, 0x10U, 'b'};
+    unsigned char output[16];
+    ASSERT_FALSE(at_decompress(bad_offset, sizeof(bad_offset), output, 7U));
+}
+
+void register_compress_tests(TestRegistry *registry)
+{
+    REGISTER_TEST(registry, test_compress_shrinks_repetitive_json);
+    REGISTER_TEST(registry, test_compress_round_trips_incompressible_and_tiny_inputs);
+    REGISTER_TEST(registry, test_compress_rejects_damaged_blocks);
+}
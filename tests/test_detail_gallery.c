@@ -1,6 +1,7 @@
 #include "detail_gallery.h"
 #include "person.h"
 #include "test_framework.h"
+#include "thumbnail_cache.h"
 #include "timeline.h"
 
 #include "at_string.h"
@@ -14,7 +15,7 @@ static Person *make_person_with_media(void)
     {
         return NULL;
     }
-    person->profile_image_path = at_string_dup("assets/profile.png");
+    (void)person_set_profile_image(person, "assets/profile.png");
     (void)person_add_certificate(person, "assets/certificate.png");
 
     TimelineEntry entry;
@@ -82,9 +83,43 @@ TEST(test_detail_gallery_zoom_clamps)
     detail_gallery_shutdown(&gallery);
 }
 
+static bool test_gallery_decode_nothing(const char *path, ThumbnailImage *out_image, void *user_data)
+{
+    (void)path;
+    (void)out_image;
+    (void)user_data;
+    return false;
+}
+
+TEST(test_detail_gallery_full_resolution_follows_zoom)
+{
+    DetailGallery gallery;
+    ASSERT_TRUE(detail_gallery_init(&gallery));
+    /* Without a thumbnail cache every texture is loaded at full resolution. */
+    ASSERT_TRUE(detail_gallery_uses_full_resolution(&gallery));
+
+    ThumbnailCacheConfig config = {"Testing/Temporary/gallery_thumbnails", 0, 1U, test_gallery_decode_nothing, NULL,
+                                   0U};
+    ThumbnailCache *cache = thumbnail_cache_create(&config);
+    ASSERT_NOT_NULL(cache);
+    detail_gallery_set_thumbnail_cache(&gallery, cache);
+    ASSERT_FALSE(detail_gallery_uses_full_resolution(&gallery));
+    detail_gallery_set_zoom(&gallery, detail_gallery_full_resolution_zoom());
+    ASSERT_TRUE(detail_gallery_uses_full_resolution(&gallery));
+    detail_gallery_set_zoom(&gallery, detail_gallery_full_resolution_zoom() - 0.1f);
+    ASSERT_FALSE(detail_gallery_uses_full_resolution(&gallery));
+    detail_gallery_set_zoom(&gallery, detail_gallery_max_zoom());
+    detail_gallery_reset(&gallery);
+    ASSERT_FALSE(detail_gallery_uses_full_resolution(&gallery));
+
+    detail_gallery_shutdown(&gallery);
+    thumbnail_cache_destroy(cache);
+}
+
 void register_detail_gallery_tests(TestRegistry *registry)
 {
     REGISTER_TEST(registry, test_detail_gallery_collects_unique_media);
     REGISTER_TEST(registry, test_detail_gallery_selection_wraps);
     REGISTER_TEST(registry, test_detail_gallery_zoom_clamps);
+    REGISTER_TEST(registry, test_detail_gallery_full_resolution_follows_zoom);
 }
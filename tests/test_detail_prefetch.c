@@ -0,0 +1,111 @@
+#include "detail_prefetch.h"
+#include "person.h"
+#include "test_framework.h"
+#include "thumbnail_cache.h"
+
+#include "at_memory.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+static void testprefetch_touch(const char *path)
+{
+    FILE *file = fopen(path, "wb");
+    if (file)
+    {
+        (void)fputs(path, file);
+        fclose(file);
+    }
+}
+
+static bool testprefetch_decode(const char *path, ThumbnailImage *out_image, void *user_data)
+{
+    (void)user_data;
+    FILE *file = fopen(path, "rb");
+    if (!file)
+    {
+        return false;
+    }
+    fclose(file);
+    out_image->pixels = (unsigned char *)AT_CALLOC(4U * 4U * 4U, 1U);
+    out_image->width = 4;
+    out_image->height = 4;
+    return out_image->pixels != NULL;
+}
+
+TEST(test_detail_prefetch_queues_relatives_once_per_focus)
+{
+#if defined(_WIN32)
+    (void)_mkdir("Testing");
+    (void)_mkdir("Testing/Temporary");
+#else
+    (void)mkdir("Testing", 0775);
+    (void)mkdir("Testing/Temporary", 0775);
+#endif
+    testprefetch_touch("Testing/Temporary/prefetch_self.png");
+    testprefetch_touch("Testing/Temporary/prefetch_father.png");
+    testprefetch_touch("Testing/Temporary/prefetch_child.png");
+
+    Person *self = person_create(1U);
+    Person *father = person_create(2U);
+    Person *child = person_create(3U);
+    Person *spouse = person_create(4U);
+    Person *stranger = person_create(5U);
+    ASSERT_NOT_NULL(self);
+    ASSERT_NOT_NULL(father);
+    ASSERT_NOT_NULL(child);
+    ASSERT_NOT_NULL(spouse);
+    ASSERT_NOT_NULL(stranger);
+    ASSERT_TRUE(person_set_profile_image(self, "Testing/Temporary/prefetch_self.png"));
+    ASSERT_TRUE(person_set_profile_image(father, "Testing/Temporary/prefetch_father.png"));
+    ASSERT_TRUE(person_add_certificate(child, "Testing/Temporary/prefetch_child.png"));
+    ASSERT_TRUE(person_set_profile_image(spouse, "Testing/Temporary/prefetch_spouse_missing.png"));
+    ASSERT_TRUE(person_set_profile_image(stranger, "Testing/Temporary/prefetch_self.png"));
+    ASSERT_TRUE(person_set_parent(self, father, PERSON_PARENT_FATHER));
+    ASSERT_TRUE(person_add_child(self, child));
+    ASSERT_TRUE(person_add_spouse(self, spouse));
+
+    ThumbnailCacheConfig config = {"Testing/Temporary/prefetch_thumbnails", 0, 1U, testprefetch_decode, NULL, 0U};
+    ThumbnailCache *cache = thumbnail_cache_create(&config);
+    ASSERT_NOT_NULL(cache);
+    DetailPrefetch prefetch;
+    detail_prefetch_init(&prefetch, cache);
+
+    ASSERT_EQ(detail_prefetch_focus(&prefetch, self), 4U);
+    ASSERT_EQ(detail_prefetch_focus(&prefetch, self), 0U);
+    ASSERT_EQ(detail_prefetch_focus(&prefetch, NULL), 0U);
+    thumbnail_cache_wait_idle(cache);
+
+    bool exists = false;
+    ASSERT_TRUE(thumbnail_cache_lookup_exists(cache, "Testing/Temporary/prefetch_child.png", &exists));
+    ASSERT_TRUE(exists);
+    ASSERT_FALSE(thumbnail_cache_lookup_exists(cache, "Testing/Temporary/prefetch_spouse_missing.png", &exists));
+    ThumbnailCacheStats stats;
+    thumbnail_cache_get_stats(cache, &stats);
+    ASSERT_EQ(stats.prefetched_bytes, 3U * 4U * 4U * 4U);
+
+    /* A new focus whose media is already decoded queues nothing new. */
+    ASSERT_EQ(detail_prefetch_focus(&prefetch, stranger), 0U);
+
+    thumbnail_cache_destroy(cache);
+    person_destroy(stranger);
+    person_destroy(spouse);
+    person_destroy(child);
+    person_destroy(father);
+    person_destroy(self);
+    (void)remove("Testing/Temporary/prefetch_self.png");
+    (void)remove("Testing/Temporary/prefetch_father.png");
+    (void)remove("Testing/Temporary/prefetch_child.png");
+}
+
+void register_detail_prefetch_tests(TestRegistry *registry)
+{
+    REGISTER_TEST(registry, test_detail_prefetch_queues_relatives_once_per_focus);
+}
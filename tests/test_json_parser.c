@@ -1,7 +1,10 @@
 #include "json_parser.h"
 #include "test_framework.h"
 
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 TEST(test_json_parser_simple_object)
 {
@@ -40,9 +43,179 @@ TEST(test_json_parser_invalid_unicode_reports_error)
     ASSERT_TRUE(line > 0);
 }
 
+TEST(test_json_parser_plain_prefix_stops_at_special_bytes)
+{
+    static const char specials[] = {'"', '\\', '\n', '\x01', '\x1f', '\0'};
+    char buffer[48];
+    for (size_t special = 0U; special < sizeof(specials); ++special)
+    {
+        for (size_t position = 0U; position < sizeof(buffer); ++position)
+        {
+            /* Clean filler mixes ASCII with the lead/continuation bytes of U+00E9 and DEL. */
+            for (size_t index = 0U; index < sizeof(buffer); ++index)
+            {
+                static const char filler[] = {'a', ' ', '\xC3', '\xA9', '\x7F', '~'};
+                buffer[index] = filler[index % sizeof(filler)];
+            }
+            buffer[position] = specials[special];
+            ASSERT_EQ(json_string_plain_prefix(buffer, sizeof(buffer)), position);
+            ASSERT_EQ(json_string_plain_prefix(buffer, position), position);
+        }
+    }
+    ASSERT_EQ(json_string_plain_prefix(NULL, 4U), 0U);
+}
+
+TEST(test_json_parser_long_strings_keep_escapes_and_columns)
+{
+    char text[160];
+    char expected[160];
+    static const char xs[] = "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx";
+    static const char ys[] = "yyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyy";
+    (void)snprintf(text, sizeof(text), "\"%s\\n%s\\u00e9\\\"\"", xs, ys);
+    (void)snprintf(expected, sizeof(expected), "%s\n%s\xC3\xA9\"", xs, ys);
+    char error[128];
+    JsonValue *root = json_parse(text, error, sizeof(error), NULL, NULL);
+    ASSERT_NOT_NULL(root);
+    ASSERT_STREQ(json_value_get_string(root), expected);
+    json_value_destroy(root);
+
+    /* The column reported for a bad byte must account for the clean run skipped before it. */
+    char broken[64];
+    memset(broken, 'a', sizeof(broken));
+    broken[0] = '"';
+    broken[38] = '\x01';
+    broken[39] = '"';
+    broken[40] = '\0';
+    int line = 0;
+    int column = 0;
+    root = json_parse(broken, error, sizeof(error), &line, &column);
+    ASSERT_NULL(root);
+    ASSERT_EQ(line, 1);
+    ASSERT_EQ(column, 40);
+}
+
+TEST(test_json_parser_integer_ids_are_exact)
+{
+    char error[128];
+    JsonValue *root = json_parse("[0, 42, 4294967295, 4294967296, -1, 12.0, 1e3, 1.5, 9007199254740993]", error,
+                                 sizeof(error), NULL, NULL);
+    ASSERT_NOT_NULL(root);
+    uint32_t id = 7U;
+    ASSERT_TRUE(json_value_get_uint32(json_value_array_get(root, 0U), &id));
+    ASSERT_EQ(id, 0U);
+    ASSERT_TRUE(json_value_get_uint32(json_value_array_get(root, 1U), &id));
+    ASSERT_EQ(id, 42U);
+    ASSERT_TRUE(json_value_get_uint32(json_value_array_get(root, 2U), &id));
+    ASSERT_EQ(id, 4294967295U);
+    ASSERT_FALSE(json_value_get_uint32(json_value_array_get(root, 3U), &id));
+    ASSERT_FALSE(json_value_get_uint32(json_value_array_get(root, 4U), &id));
+    ASSERT_TRUE(json_value_get_uint32(json_value_array_get(root, 5U), &id));
+    ASSERT_EQ(id, 12U);
+    ASSERT_TRUE(json_value_get_uint32(json_value_array_get(root, 6U), &id));
+    ASSERT_EQ(id, 1000U);
+    ASSERT_FALSE(json_value_get_uint32(json_value_array_get(root, 7U), &id));
+    double number = 0.0;
+    ASSERT_TRUE(json_value_get_number(json_value_array_get(root, 3U), &number));
+    ASSERT_TRUE(number == 4294967296.0);
+    ASSERT_TRUE(json_value_get_number(json_value_array_get(root, 8U), &number));
+    ASSERT_TRUE(number == 9007199254740992.0);
+    ASSERT_TRUE(json_value_get_uint32(json_value_array_get(root, 0U), NULL));
+    json_value_destroy(root);
+}
+
+TEST(test_json_parser_numbers_match_strtod)
+{
+    static const char *const tokens[] = {"0.1",
+                                         "-0.0",
+                                         "3.14159",
+                                         "2.5e-3",
+                                         "1e22",
+                                         "1e23",
+                                         "123456789012345678901234567890",
+                                         "2.2250738585072014e-308",
+                                         "1.7976931348623157e308",
+                                         "4.9e-324",
+                                         "0.000001234",
+                                         "-9223372036854775808",
+                                         "9223372036854775808",
+                                         "1E+2",
+                                         "7e-22"};
+    char text[128];
+    char error[128];
+    for (size_t index = 0U; index < sizeof(tokens) / sizeof(tokens[0]); ++index)
+    {
+        JsonValue *root = json_parse(tokens[index], error, sizeof(error), NULL, NULL);
+        ASSERT_NOT_NULL(root);
+        double parsed = 0.0;
+        ASSERT_TRUE(json_value_get_number(root, &parsed));
+        double expected = strtod(tokens[index], NULL);
+        ASSERT_TRUE(memcmp(&parsed, &expected, sizeof(double)) == 0);
+        json_value_destroy(root);
+    }
+    /* Random decimals inside and just outside the fast-path window. */
+    uint32_t state = 0x2545F491U;
+    for (unsigned int iteration = 0U; iteration < 5000U; ++iteration)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        unsigned long long mantissa = ((unsigned long long)state << 21) ^ (state >> 3);
+        int digits_after_point = (int)(state % 18U);
+        int exponent = (int)(state % 61U) - 30;
+        (void)snprintf(text, sizeof(text), "%llu", mantissa % 100000000000000000ULL);
+        size_t length = strlen(text);
+        if ((size_t)digits_after_point < length)
+        {
+            memmove(text + length - (size_t)digits_after_point + 1U, text + length - (size_t)digits_after_point,
+                    (size_t)digits_after_point + 1U);
+            text[length - (size_t)digits_after_point] = '.';
+        }
+        length = strlen(text);
+        (void)snprintf(text + length, sizeof(text) - length, "e%d", exponent);
+        JsonValue *root = json_parse(text, error, sizeof(error), NULL, NULL);
+        ASSERT_NOT_NULL(root);
+        double parsed = 0.0;
+        ASSERT_TRUE(json_value_get_number(root, &parsed));
+        double expected = strtod(text, NULL);
+        if (memcmp(&parsed, &expected, sizeof(double)) != 0)
+        {
+            fprintf(stderr, "number mismatch for %s\n", text);
+        }
+        ASSERT_TRUE(memcmp(&parsed, &expected, sizeof(double)) == 0);
+        json_value_destroy(root);
+    }
+}
+
+/* Raw bytes below 0x20 were rejected before block scanning existed; every path must keep rejecting them. */
+TEST(test_json_parser_rejects_raw_control_characters)
+{
+    const char *documents[] = {
+        "{\"key\": \"a\tb\"}",                                    /* Short string, scalar scan. */
+        "{\"key\": \"plain text that spans several words\x01\"}", /* Found inside a scanned block. */
+        "{\"key\": \"escaped \\\" then\nraw newline\"}",        /* After an escape sequence. */
+    };
+    char error[128];
+    for (size_t index = 0U; index < sizeof(documents) / sizeof(documents[0]); ++index)
+    {
+        JsonValue *root = json_parse(documents[index], error, sizeof(error), NULL, NULL);
+        ASSERT_NULL(root);
+        ASSERT_NOT_NULL(strstr(error, "control character in string"));
+    }
+
+    JsonValue *root = json_parse("{\"key\": \"a\\tb\\n\"}", error, sizeof(error), NULL, NULL);
+    ASSERT_NOT_NULL(root);
+    ASSERT_STREQ(json_value_get_string(json_value_object_get(root, "key")), "a\tb\n");
+    json_value_destroy(root);
+}
+
 void register_json_parser_tests(TestRegistry *registry)
 {
     REGISTER_TEST(registry, test_json_parser_simple_object);
     REGISTER_TEST(registry, test_json_parser_handles_unicode);
     REGISTER_TEST(registry, test_json_parser_invalid_unicode_reports_error);
+    REGISTER_TEST(registry, test_json_parser_plain_prefix_stops_at_special_bytes);
+    REGISTER_TEST(registry, test_json_parser_long_strings_keep_escapes_and_columns);
+    REGISTER_TEST(registry, test_json_parser_integer_ids_are_exact);
+    REGISTER_TEST(registry, test_json_parser_numbers_match_strtod);
+    REGISTER_TEST(registry, test_json_parser_rejects_raw_control_characters);
 }
@@ -621,6 +621,37 @@ TEST(test_layout_animate_interpolates_between_layouts)
     family_tree_destroy(tree);
 }
 
+TEST(test_layout_person_reachable_at_two_depths_stays_in_bounds)
+{
+    FamilyTree *tree = family_tree_create("Uneven");
+    ASSERT_NOT_NULL(tree);
+    Person *grandparent = person_create(1U);
+    Person *parent = person_create(2U);
+    Person *child = person_create(3U);
+    ASSERT_TRUE(person_set_name(grandparent, "Elder", NULL, "Line"));
+    ASSERT_TRUE(person_set_name(parent, "Middle", NULL, "Line"));
+    ASSERT_TRUE(person_set_name(child, "Young", NULL, "Line"));
+    ASSERT_TRUE(family_tree_add_person(tree, grandparent));
+    ASSERT_TRUE(family_tree_add_person(tree, parent));
+    ASSERT_TRUE(family_tree_add_person(tree, child));
+    ASSERT_TRUE(person_add_child(grandparent, parent));
+    ASSERT_TRUE(person_add_child(grandparent, child));
+    ASSERT_TRUE(person_add_child(parent, child));
+
+    LayoutResult result = layout_calculate(tree);
+    ASSERT_EQ(result.count, 3U);
+    const LayoutNode *child_node = find_node_by_id(&result, 3U);
+    ASSERT_NOT_NULL(child_node);
+    ASSERT_TRUE(child_node->position[1] < 0.0f);
+    for (size_t index = 0U; index < result.count; ++index)
+    {
+        ASSERT_TRUE(position_is_finite(result.nodes[index].position));
+    }
+
+    layout_result_destroy(&result);
+    family_tree_destroy(tree);
+}
+
 void register_layout_tests(TestRegistry *registry)
 {
     REGISTER_TEST(registry, test_layout_assigns_positions_for_all_persons);
@@ -632,4 +663,5 @@ void register_layout_tests(TestRegistry *registry)
     REGISTER_TEST(registry, test_layout_multiple_generations_stack_levels);
     REGISTER_TEST(registry, test_layout_large_family_has_unique_horizontal_spacing);
     REGISTER_TEST(registry, test_layout_complex_relationships_remain_finite);
+    REGISTER_TEST(registry, test_layout_person_reachable_at_two_depths_stays_in_bounds);
 }
@@ -3,14 +3,21 @@
 #include <stdio.h>
 
 void register_string_tests(TestRegistry *registry);
+void register_string_pool_tests(TestRegistry *registry);
+void register_compress_tests(TestRegistry *registry);
 void register_memory_tests(TestRegistry *registry);
 void register_log_tests(TestRegistry *registry);
 void register_person_tests(TestRegistry *registry);
+void register_person_slab_tests(TestRegistry *registry);
 void register_tree_tests(TestRegistry *registry);
+void register_tree_hot_tests(TestRegistry *registry);
+void register_tree_graph_tests(TestRegistry *registry);
+void register_tree_builder_tests(TestRegistry *registry);
 void register_timeline_tests(TestRegistry *registry);
 void register_date_tests(TestRegistry *registry);
 void register_persistence_tests(TestRegistry *registry);
 void register_persistence_auto_save_tests(TestRegistry *registry);
+void register_persistence_utf8_tests(TestRegistry *registry);
 void register_json_parser_tests(TestRegistry *registry);
 void register_layout_tests(TestRegistry *registry);
 void register_graphics_tests(TestRegistry *registry);
@@ -24,6 +31,7 @@ void register_shortcuts_tests(TestRegistry *registry);
 void register_settings_tests(TestRegistry *registry);
 void register_settings_runtime_tests(TestRegistry *registry);
 void register_search_tests(TestRegistry *registry);
+void register_search_index_tests(TestRegistry *registry);
 void register_integration_tests(TestRegistry *registry);
 void register_app_state_tests(TestRegistry *registry);
 void register_error_tests(TestRegistry *registry);
@@ -32,22 +40,32 @@ void register_cli_tests(TestRegistry *registry);
 void register_detail_gallery_tests(TestRegistry *registry);
 void register_detail_timeline_tests(TestRegistry *registry);
 void register_detail_view_tests(TestRegistry *registry);
+void register_detail_prefetch_tests(TestRegistry *registry);
+void register_thumbnail_cache_tests(TestRegistry *registry);
+void register_texture_residency_tests(TestRegistry *registry);
 
 int main(void)
 {
     TestRegistry registry;
-    TestCase cases[192];
+    TestCase cases[224];
     test_registry_init(&registry, cases, (int)(sizeof(cases) / sizeof(cases[0])));
 
     register_string_tests(&registry);
+    register_string_pool_tests(&registry);
+    register_compress_tests(&registry);
     register_memory_tests(&registry);
     register_log_tests(&registry);
     register_person_tests(&registry);
+    register_person_slab_tests(&registry);
     register_tree_tests(&registry);
+    register_tree_hot_tests(&registry);
+    register_tree_graph_tests(&registry);
+    register_tree_builder_tests(&registry);
     register_timeline_tests(&registry);
     register_date_tests(&registry);
     register_persistence_tests(&registry);
     register_persistence_auto_save_tests(&registry);
+    register_persistence_utf8_tests(&registry);
     register_json_parser_tests(&registry);
     register_layout_tests(&registry);
     register_graphics_tests(&registry);
@@ -62,6 +80,7 @@ int main(void)
     register_settings_tests(&registry);
     register_settings_runtime_tests(&registry);
     register_search_tests(&registry);
+    register_search_index_tests(&registry);
     register_integration_tests(&registry);
     register_error_tests(&registry);
     register_assets_tests(&registry);
@@ -69,6 +88,9 @@ int main(void)
     register_detail_gallery_tests(&registry);
     register_detail_timeline_tests(&registry);
     register_detail_view_tests(&registry);
+    register_detail_prefetch_tests(&registry);
+    register_thumbnail_cache_tests(&registry);
+    register_texture_residency_tests(&registry);
 
     TestResult result = test_registry_run(&registry);
     if (result.failures != 0)
@@ -12,6 +12,8 @@ DECLARE_TEST(test_tracking_reports_outstanding_allocation);
 DECLARE_TEST(test_tracking_updates_stats_on_alloc_free);
 DECLARE_TEST(test_tracking_reports_outstanding_allocation);
 DECLARE_TEST(test_tracking_updates_stats_on_alloc_free);
+DECLARE_TEST(test_tracking_survives_many_interleaved_frees);
+DECLARE_TEST(test_tracking_aggregates_by_call_site);
 
 DECLARE_TEST(test_check_mul_overflow_detects_overflow)
 {
@@ -89,6 +91,103 @@ DECLARE_TEST(test_tracking_updates_stats_on_alloc_free)
 #endif
 }
 
+DECLARE_TEST(test_tracking_survives_many_interleaved_frees)
+{
+#if AT_MEMORY_ENABLE_TRACKING
+    at_memory_reset_tracking();
+    enum
+    {
+        BLOCK_COUNT = 4096
+    };
+    void **blocks = (void **)malloc(BLOCK_COUNT * sizeof(void *));
+    ASSERT_NOT_NULL(blocks);
+    for (size_t index = 0U; index < BLOCK_COUNT; ++index)
+    {
+        blocks[index] = AT_MALLOC(8U + (index % 7U));
+        ASSERT_NOT_NULL(blocks[index]);
+    }
+    /* Free every third block, then grow the rest, so removals hit the middle of probe runs. */
+    for (size_t index = 0U; index < BLOCK_COUNT; index += 3U)
+    {
+        AT_FREE(blocks[index]);
+        blocks[index] = NULL;
+    }
+    size_t expected_bytes = 0U;
+    for (size_t index = 0U; index < BLOCK_COUNT; ++index)
+    {
+        if (blocks[index])
+        {
+            blocks[index] = AT_REALLOC(blocks[index], 64U);
+            ASSERT_NOT_NULL(blocks[index]);
+            expected_bytes += 64U;
+        }
+    }
+    ASSERT_EQ(at_memory_outstanding_allocations(), BLOCK_COUNT - (BLOCK_COUNT + 2U) / 3U);
+    ASSERT_EQ(at_memory_outstanding_bytes(), expected_bytes);
+    for (size_t index = BLOCK_COUNT; index > 0U; --index)
+    {
+        AT_FREE(blocks[index - 1U]);
+    }
+    free(blocks);
+    ASSERT_EQ(at_memory_outstanding_allocations(), 0U);
+    ASSERT_EQ(at_memory_outstanding_bytes(), 0U);
+#else
+    at_memory_reset_tracking();
+    ASSERT_EQ(at_memory_outstanding_allocations(), 0U);
+#endif
+}
+
+static void *test_memory_site_allocate(size_t size, int *out_line)
+{
+    *out_line = __LINE__ + 1;
+    return AT_MALLOC(size);
+}
+
+DECLARE_TEST(test_tracking_aggregates_by_call_site)
+{
+#if AT_MEMORY_ENABLE_TRACKING
+    at_memory_reset_tracking();
+    int line = 0;
+    void *first = test_memory_site_allocate(16U, &line);
+    void *second = test_memory_site_allocate(32U, &line);
+    AT_FREE(first);
+    void *third = test_memory_site_allocate(8U, &line);
+
+    AtMemorySiteStats site;
+    ASSERT_TRUE(at_memory_find_site_stats(__FILE__, line, &site));
+    ASSERT_EQ(site.line, line);
+    ASSERT_EQ(site.allocations, 3U);
+    ASSERT_EQ(site.total_bytes, 56U);
+    ASSERT_EQ(site.outstanding_allocations, 2U);
+    ASSERT_EQ(site.outstanding_bytes, 40U);
+    ASSERT_EQ(site.peak_bytes, 48U);
+
+    /* A reallocation moves the bytes to the site that made it. */
+    int realloc_line = __LINE__ + 1;
+    second = AT_REALLOC(second, 100U);
+    ASSERT_NOT_NULL(second);
+    ASSERT_TRUE(at_memory_find_site_stats(__FILE__, line, &site));
+    ASSERT_EQ(site.outstanding_bytes, 8U);
+    ASSERT_TRUE(at_memory_find_site_stats(__FILE__, realloc_line, &site));
+    ASSERT_EQ(site.outstanding_bytes, 100U);
+
+    AtMemorySiteStats sites[4];
+    ASSERT_EQ(at_memory_get_site_stats(sites, 4U), 2U);
+    ASSERT_EQ(sites[0].line, line);
+    ASSERT_EQ(sites[1].line, realloc_line);
+    ASSERT_FALSE(at_memory_find_site_stats(__FILE__, -1, &site));
+
+    AT_FREE(second);
+    AT_FREE(third);
+    ASSERT_TRUE(at_memory_find_site_stats(__FILE__, line, &site));
+    ASSERT_EQ(site.outstanding_allocations, 0U);
+    ASSERT_EQ(site.peak_bytes, 48U);
+#else
+    AtMemorySiteStats site;
+    ASSERT_EQ(at_memory_get_site_stats(&site, 1U), 0U);
+#endif
+}
+
 void register_memory_tests(TestRegistry *registry)
 {
     REGISTER_TEST(registry, test_check_mul_overflow_detects_overflow);
@@ -97,4 +196,6 @@ void register_memory_tests(TestRegistry *registry)
     REGISTER_TEST(registry, test_secure_realloc_handles_zero_count);
     REGISTER_TEST(registry, test_tracking_reports_outstanding_allocation);
     REGISTER_TEST(registry, test_tracking_updates_stats_on_alloc_free);
+    REGISTER_TEST(registry, test_tracking_survives_many_interleaved_frees);
+    REGISTER_TEST(registry, test_tracking_aggregates_by_call_site);
 }
@@ -30,7 +30,7 @@ TEST(test_path_join_relative_with_two_levels_up)
 #if defined(_WIN32)
     const char *base = "C:\\Projects\\AncestryTree\\build_windows\\bin\\";
 #else
-    const char *base = "/home/user/AncestryTree/build/linux/bin/";
+    const char *base = "/home/user/AncestryTree/build/bin/";
 #endif
     char buffer[256];
     ASSERT_TRUE(path_join_relative(base, 2U, "assets/example_tree.json", buffer, sizeof(buffer)));
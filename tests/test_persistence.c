@@ -214,6 +214,43 @@ TEST(test_persistence_load_parses_escaped_characters)
     test_delete_file(path);
 }
 
+TEST(test_persistence_save_replaces_atomically_and_keeps_backup)
+{
+    FamilyTree *tree = test_build_sample_tree();
+    ASSERT_NOT_NULL(tree);
+    char buffer[256];
+    char path[TEMP_PATH_BUFFER_SIZE];
+    char backup_path[TEMP_PATH_BUFFER_SIZE + 8];
+    char temp_path[TEMP_PATH_BUFFER_SIZE + 8];
+    test_temp_file_path(path, sizeof(path), "atomic.json");
+    (void)snprintf(backup_path, sizeof(backup_path), "%s.bak", path);
+    (void)snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+    test_delete_file(backup_path);
+
+    ASSERT_TRUE(persistence_tree_save(tree, path, buffer, sizeof(buffer)));
+    ASSERT_FALSE(test_file_exists(backup_path));
+    ASSERT_FALSE(test_file_exists(temp_path));
+
+    Person *root = family_tree_find_person(tree, 1U);
+    ASSERT_NOT_NULL(root);
+    ASSERT_TRUE(person_set_name(root, "Second", NULL, "Revision"));
+    ASSERT_TRUE(persistence_tree_save(tree, path, buffer, sizeof(buffer)));
+    ASSERT_FALSE(test_file_exists(temp_path));
+
+    FamilyTree *current = persistence_tree_load(path, buffer, sizeof(buffer));
+    FamilyTree *previous = persistence_tree_load(backup_path, buffer, sizeof(buffer));
+    ASSERT_NOT_NULL(current);
+    ASSERT_NOT_NULL(previous);
+    ASSERT_STREQ(family_tree_find_person(current, 1U)->name.first, "Second");
+    ASSERT_STREQ(family_tree_find_person(previous, 1U)->name.first, "Ada");
+
+    family_tree_destroy(current);
+    family_tree_destroy(previous);
+    test_delete_file(path);
+    test_delete_file(backup_path);
+    family_tree_destroy(tree);
+}
+
 void register_persistence_tests(TestRegistry *registry)
 {
     REGISTER_TEST(registry, test_persistence_writes_expected_fields);
@@ -222,4 +259,5 @@ void register_persistence_tests(TestRegistry *registry)
     REGISTER_TEST(registry, test_persistence_load_corrupted_file_reports_error);
     REGISTER_TEST(registry, test_persistence_load_handles_missing_asset_paths);
     REGISTER_TEST(registry, test_persistence_load_parses_escaped_characters);
+    REGISTER_TEST(registry, test_persistence_save_replaces_atomically_and_keeps_backup);
 }
@@ -2,8 +2,16 @@
 #include "test_framework.h"
 #include "test_persistence_helpers.h"
 
+#include <stdio.h>
 #include <string.h>
 
+#if defined(_WIN32)
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 typedef struct AutoSaveFixture
 {
     FamilyTree *tree;
@@ -59,6 +67,7 @@ TEST(test_persistence_auto_save_triggers_after_interval)
     ASSERT_FALSE(test_file_exists(auto_save_path));
 
     ASSERT_TRUE(persistence_auto_save_tick(&state, 0.6, error, sizeof(error)));
+    ASSERT_TRUE(persistence_auto_save_wait(&state, error, sizeof(error)));
     ASSERT_TRUE(test_file_exists(auto_save_path));
 
     persistence_auto_save_shutdown(&state);
@@ -158,6 +167,7 @@ TEST(test_persistence_auto_save_respects_disable)
 
     persistence_auto_save_set_enabled(&state, true);
     ASSERT_TRUE(persistence_auto_save_tick(&state, 5.0, error, sizeof(error)));
+    ASSERT_TRUE(persistence_auto_save_wait(&state, error, sizeof(error)));
     ASSERT_TRUE(test_file_exists(auto_save_path));
 
     persistence_auto_save_shutdown(&state);
@@ -195,6 +205,416 @@ TEST(test_persistence_auto_save_interval_updates_reset_timer)
     fixture_cleanup(&fixture);
 }
 
+TEST(test_persistence_auto_save_background_writes_snapshot)
+{
+    AutoSaveFixture fixture;
+    fixture_init(&fixture);
+
+    char auto_save_path[128];
+    test_temp_file_path(auto_save_path, sizeof(auto_save_path), "background.json");
+    test_delete_file(auto_save_path);
+
+    PersistenceAutoSave state;
+    memset(&state, 0, sizeof(state));
+    PersistenceAutoSaveConfig config;
+    config.tree_supplier = fixture_tree_supplier;
+    config.user_data = &fixture;
+    config.path = auto_save_path;
+    config.interval_seconds = 1U;
+
+    char error[256];
+    ASSERT_TRUE(persistence_auto_save_init(&state, &config, error, sizeof(error)));
+    ASSERT_TRUE(state.background);
+
+    persistence_auto_save_mark_dirty(&state);
+    ASSERT_TRUE(persistence_auto_save_tick(&state, 1.0, error, sizeof(error)));
+    ASSERT_EQ(state.last_event, PERSISTENCE_AUTO_SAVE_EVENT_STARTED);
+    ASSERT_TRUE(persistence_auto_save_is_busy(&state));
+    ASSERT_FALSE(state.dirty);
+
+    /* Edits made while the writer runs must not leak into the snapshot being written. */
+    Person *root = family_tree_find_person(fixture.tree, 1U);
+    ASSERT_NOT_NULL(root);
+    ASSERT_TRUE(person_set_name(root, "Edited", NULL, "Afterwards"));
+    persistence_auto_save_mark_dirty(&state);
+
+    ASSERT_TRUE(persistence_auto_save_wait(&state, error, sizeof(error)));
+    ASSERT_EQ(state.last_event, PERSISTENCE_AUTO_SAVE_EVENT_COMPLETED);
+    ASSERT_FALSE(persistence_auto_save_is_busy(&state));
+    ASSERT_TRUE(state.dirty);
+
+    FamilyTree *loaded = persistence_tree_load(auto_save_path, error, sizeof(error));
+    ASSERT_NOT_NULL(loaded);
+    Person *loaded_root = family_tree_find_person(loaded, 1U);
+    ASSERT_NOT_NULL(loaded_root);
+    ASSERT_STREQ(loaded_root->name.first, "Ada");
+    family_tree_destroy(loaded);
+
+    char temp_path[160];
+    (void)snprintf(temp_path, sizeof(temp_path), "%s.tmp", auto_save_path);
+    ASSERT_FALSE(test_file_exists(temp_path));
+
+    persistence_auto_save_shutdown(&state);
+    test_delete_file(auto_save_path);
+    fixture_cleanup(&fixture);
+}
+
+TEST(test_persistence_auto_save_flush_waits_for_background_job)
+{
+    AutoSaveFixture fixture;
+    fixture_init(&fixture);
+
+    char auto_save_path[128];
+    test_temp_file_path(auto_save_path, sizeof(auto_save_path), "flush_pending.json");
+    test_delete_file(auto_save_path);
+
+    PersistenceAutoSave state;
+    memset(&state, 0, sizeof(state));
+    PersistenceAutoSaveConfig config;
+    config.tree_supplier = fixture_tree_supplier;
+    config.user_data = &fixture;
+    config.path = auto_save_path;
+    config.interval_seconds = 1U;
+
+    char error[256];
+    ASSERT_TRUE(persistence_auto_save_init(&state, &config, error, sizeof(error)));
+    persistence_auto_save_mark_dirty(&state);
+    ASSERT_TRUE(persistence_auto_save_tick(&state, 2.0, error, sizeof(error)));
+    ASSERT_TRUE(persistence_auto_save_flush(&state, error, sizeof(error)));
+    ASSERT_FALSE(persistence_auto_save_is_busy(&state));
+    ASSERT_TRUE(test_file_exists(auto_save_path));
+
+    persistence_auto_save_shutdown(&state);
+    test_delete_file(auto_save_path);
+    fixture_cleanup(&fixture);
+}
+
+static void journal_path_for(char *buffer, size_t buffer_size, const char *snapshot_path)
+{
+    (void)snprintf(buffer, buffer_size, "%s.journal", snapshot_path);
+}
+
+TEST(test_persistence_auto_save_journal_replays_changes)
+{
+    AutoSaveFixture fixture;
+    fixture_init(&fixture);
+
+    char auto_save_path[128];
+    char journal_path[160];
+    test_temp_file_path(auto_save_path, sizeof(auto_save_path), "journal.json");
+    journal_path_for(journal_path, sizeof(journal_path), auto_save_path);
+    test_delete_file(auto_save_path);
+    test_delete_file(journal_path);
+
+    PersistenceAutoSave state;
+    memset(&state, 0, sizeof(state));
+    PersistenceAutoSaveConfig config;
+    config.tree_supplier = fixture_tree_supplier;
+    config.user_data = &fixture;
+    config.path = auto_save_path;
+    config.interval_seconds = 1U;
+
+    char error[256];
+    ASSERT_TRUE(persistence_auto_save_init(&state, &config, error, sizeof(error)));
+    persistence_auto_save_set_background(&state, false);
+    ASSERT_TRUE(persistence_auto_save_enable_journal(&state, 16U, error, sizeof(error)));
+
+    /* The first save after enabling always writes a full snapshot to anchor the journal. */
+    persistence_auto_save_mark_dirty(&state);
+    ASSERT_TRUE(persistence_auto_save_tick(&state, 1.0, error, sizeof(error)));
+    ASSERT_TRUE(test_file_exists(auto_save_path));
+    ASSERT_FALSE(test_file_exists(journal_path));
+
+    Person *parent = family_tree_find_person(fixture.tree, 2U);
+    ASSERT_NOT_NULL(parent);
+    Person *grandchild = person_create(3U);
+    ASSERT_NOT_NULL(grandchild);
+    ASSERT_TRUE(person_set_name(grandchild, "Ralph", NULL, "King"));
+    ASSERT_TRUE(person_set_birth(grandchild, "1839-07-02", "London"));
+    ASSERT_TRUE(person_add_child(parent, grandchild));
+    ASSERT_TRUE(family_tree_add_person(fixture.tree, grandchild));
+    ASSERT_TRUE(persistence_auto_save_record_change(&state, PERSISTENCE_JOURNAL_ADD, grandchild, error,
+                                                    sizeof(error)));
+
+    Person *root = family_tree_find_person(fixture.tree, 1U);
+    ASSERT_NOT_NULL(root);
+    ASSERT_TRUE(person_set_name(root, "Augusta", "Ada", "King"));
+    ASSERT_TRUE(persistence_auto_save_record_change(&state, PERSISTENCE_JOURNAL_EDIT, root, error, sizeof(error)));
+
+    ASSERT_TRUE(persistence_auto_save_tick(&state, 1.0, error, sizeof(error)));
+    ASSERT_EQ(state.last_event, PERSISTENCE_AUTO_SAVE_EVENT_COMPLETED);
+    ASSERT_FALSE(state.dirty);
+    ASSERT_TRUE(test_file_exists(journal_path));
+
+    /* The snapshot itself is untouched; the changes only live in the journal until compaction. */
+    FamilyTree *snapshot = persistence_tree_load(auto_save_path, error, sizeof(error));
+    ASSERT_NOT_NULL(snapshot);
+    ASSERT_EQ(snapshot->person_count, 2U);
+    family_tree_destroy(snapshot);
+
+    size_t replayed = 0U;
+    FamilyTree *recovered = persistence_tree_recover(auto_save_path, &replayed, error, sizeof(error));
+    ASSERT_NOT_NULL(recovered);
+    ASSERT_EQ(replayed, 2U);
+    ASSERT_EQ(recovered->person_count, 3U);
+    Person *recovered_root = family_tree_find_person(recovered, 1U);
+    ASSERT_NOT_NULL(recovered_root);
+    ASSERT_STREQ(recovered_root->name.first, "Augusta");
+    Person *recovered_parent = family_tree_find_person(recovered, 2U);
+    Person *recovered_grandchild = family_tree_find_person(recovered, 3U);
+    ASSERT_NOT_NULL(recovered_parent);
+    ASSERT_NOT_NULL(recovered_grandchild);
+    ASSERT_EQ(recovered_parent->children_count, 1U);
+    ASSERT_TRUE(recovered_parent->children[0] == recovered_grandchild);
+    ASSERT_TRUE(recovered_grandchild->parents[0] == recovered_parent);
+    family_tree_destroy(recovered);
+
+    family_tree_unlink_person(fixture.tree, grandchild);
+    ASSERT_NOT_NULL(family_tree_extract_person(fixture.tree, 3U));
+    ASSERT_TRUE(persistence_auto_save_record_change(&state, PERSISTENCE_JOURNAL_DELETE, grandchild, error,
+                                                    sizeof(error)));
+    person_destroy(grandchild);
+    ASSERT_TRUE(persistence_auto_save_flush(&state, error, sizeof(error)));
+
+    recovered = persistence_tree_recover(auto_save_path, &replayed, error, sizeof(error));
+    ASSERT_NOT_NULL(recovered);
+    ASSERT_EQ(replayed, 3U);
+    ASSERT_EQ(recovered->person_count, 2U);
+    recovered_parent = family_tree_find_person(recovered, 2U);
+    ASSERT_NOT_NULL(recovered_parent);
+    ASSERT_EQ(recovered_parent->children_count, 0U);
+    family_tree_destroy(recovered);
+
+    persistence_auto_save_shutdown(&state);
+    test_delete_file(auto_save_path);
+    test_delete_file(journal_path);
+    fixture_cleanup(&fixture);
+}
+
+TEST(test_persistence_auto_save_journal_compacts_after_threshold)
+{
+    AutoSaveFixture fixture;
+    fixture_init(&fixture);
+
+    char auto_save_path[128];
+    char journal_path[160];
+    test_temp_file_path(auto_save_path, sizeof(auto_save_path), "compact.json");
+    journal_path_for(journal_path, sizeof(journal_path), auto_save_path);
+    test_delete_file(auto_save_path);
+    test_delete_file(journal_path);
+
+    PersistenceAutoSave state;
+    memset(&state, 0, sizeof(state));
+    PersistenceAutoSaveConfig config;
+    config.tree_supplier = fixture_tree_supplier;
+    config.user_data = &fixture;
+    config.path = auto_save_path;
+    config.interval_seconds = 1U;
+
+    char error[256];
+    ASSERT_TRUE(persistence_auto_save_init(&state, &config, error, sizeof(error)));
+    ASSERT_TRUE(persistence_auto_save_enable_journal(&state, 2U, error, sizeof(error)));
+    persistence_auto_save_mark_dirty(&state);
+    ASSERT_TRUE(persistence_auto_save_flush(&state, error, sizeof(error)));
+
+    Person *root = family_tree_find_person(fixture.tree, 1U);
+    ASSERT_NOT_NULL(root);
+    ASSERT_TRUE(person_set_name(root, "First", NULL, "Edit"));
+    ASSERT_TRUE(persistence_auto_save_record_change(&state, PERSISTENCE_JOURNAL_EDIT, root, error, sizeof(error)));
+    ASSERT_TRUE(persistence_auto_save_tick(&state, 1.0, error, sizeof(error)));
+    ASSERT_FALSE(persistence_auto_save_is_busy(&state));
+    ASSERT_TRUE(test_file_exists(journal_path));
+
+    ASSERT_TRUE(person_set_name(root, "Second", NULL, "Edit"));
+    ASSERT_TRUE(persistence_auto_save_record_change(&state, PERSISTENCE_JOURNAL_EDIT, root, error, sizeof(error)));
+    ASSERT_TRUE(persistence_auto_save_tick(&state, 1.0, error, sizeof(error)));
+    ASSERT_EQ(state.last_event, PERSISTENCE_AUTO_SAVE_EVENT_STARTED);
+    ASSERT_TRUE(persistence_auto_save_wait(&state, error, sizeof(error)));
+    ASSERT_FALSE(test_file_exists(journal_path));
+    ASSERT_EQ(state.journal.committed_records, 0U);
+
+    FamilyTree *loaded = persistence_tree_load(auto_save_path, error, sizeof(error));
+    ASSERT_NOT_NULL(loaded);
+    Person *loaded_root = family_tree_find_person(loaded, 1U);
+    ASSERT_NOT_NULL(loaded_root);
+    ASSERT_STREQ(loaded_root->name.first, "Second");
+    family_tree_destroy(loaded);
+
+    persistence_auto_save_shutdown(&state);
+    char backup_path[160];
+    (void)snprintf(backup_path, sizeof(backup_path), "%s.bak", auto_save_path);
+    test_delete_file(backup_path);
+    test_delete_file(auto_save_path);
+    test_delete_file(journal_path);
+    fixture_cleanup(&fixture);
+}
+
+TEST(test_persistence_journal_replay_stops_at_torn_record)
+{
+    AutoSaveFixture fixture;
+    fixture_init(&fixture);
+
+    char snapshot_path[128];
+    test_temp_file_path(snapshot_path, sizeof(snapshot_path), "torn.json");
+    PersistenceJournal journal;
+    char error[256];
+    ASSERT_TRUE(persistence_journal_init(&journal, snapshot_path, error, sizeof(error)));
+    test_delete_file(journal.path);
+
+    Person *root = family_tree_find_person(fixture.tree, 1U);
+    ASSERT_NOT_NULL(root);
+    ASSERT_TRUE(person_set_name(root, "Journaled", NULL, "Name"));
+    ASSERT_TRUE(persistence_journal_record(&journal, PERSISTENCE_JOURNAL_EDIT, root, error, sizeof(error)));
+    ASSERT_TRUE(persistence_journal_flush(&journal, error, sizeof(error)));
+    ASSERT_EQ(journal.committed_records, 1U);
+
+    FILE *stream = fopen(journal.path, "ab");
+    ASSERT_NOT_NULL(stream);
+    (void)fputs("@4096 00000000\n{\"op\": \"delete\", \"id\": 1", stream);
+    fclose(stream);
+
+    FamilyTree *target = test_build_sample_tree();
+    ASSERT_NOT_NULL(target);
+    size_t applied = 0U;
+    ASSERT_TRUE(persistence_journal_replay(target, journal.path, &applied, error, sizeof(error)));
+    ASSERT_EQ(applied, 1U);
+    Person *target_root = family_tree_find_person(target, 1U);
+    ASSERT_NOT_NULL(target_root);
+    ASSERT_STREQ(target_root->name.first, "Journaled");
+    family_tree_destroy(target);
+
+    test_delete_file(journal.path);
+    persistence_journal_shutdown(&journal);
+    fixture_cleanup(&fixture);
+}
+
+TEST(test_persistence_startup_recovers_journal_before_auto_save)
+{
+    AutoSaveFixture fixture;
+    fixture_init(&fixture);
+
+    char auto_save_path[128];
+    char journal_path[160];
+    char unrecovered_path[192];
+    test_temp_file_path(auto_save_path, sizeof(auto_save_path), "startup.json");
+    journal_path_for(journal_path, sizeof(journal_path), auto_save_path);
+    (void)snprintf(unrecovered_path, sizeof(unrecovered_path), "%s.unrecovered", journal_path);
+    test_delete_file(auto_save_path);
+    test_delete_file(journal_path);
+    test_delete_file(unrecovered_path);
+
+    /* The previous session: a snapshot, then an edit that only reached the journal before the crash. */
+    char error[256];
+    ASSERT_TRUE(persistence_tree_save(fixture.tree, auto_save_path, error, sizeof(error)));
+    PersistenceJournal journal;
+    ASSERT_TRUE(persistence_journal_init(&journal, auto_save_path, error, sizeof(error)));
+    Person *root = family_tree_find_person(fixture.tree, 1U);
+    ASSERT_NOT_NULL(root);
+    ASSERT_TRUE(person_set_name(root, "Recovered", NULL, "Edit"));
+    ASSERT_TRUE(persistence_journal_record(&journal, PERSISTENCE_JOURNAL_EDIT, root, error, sizeof(error)));
+    ASSERT_TRUE(persistence_journal_flush(&journal, error, sizeof(error)));
+    persistence_journal_shutdown(&journal);
+    fixture_cleanup(&fixture);
+
+    /* Startup, in the order main runs it: recover, then start the journaled auto-save on the result. */
+    FamilyTree *recovered = NULL;
+    size_t replayed = 0U;
+    ASSERT_TRUE(persistence_journal_recover_pending(auto_save_path, &recovered, &replayed, error, sizeof(error)));
+    ASSERT_NOT_NULL(recovered);
+    ASSERT_EQ(replayed, 1U);
+    ASSERT_STREQ(family_tree_find_person(recovered, 1U)->name.first, "Recovered");
+    ASSERT_FALSE(test_file_exists(journal_path));
+    fixture.tree = recovered;
+
+    PersistenceAutoSave state;
+    memset(&state, 0, sizeof(state));
+    PersistenceAutoSaveConfig config;
+    config.tree_supplier = fixture_tree_supplier;
+    config.user_data = &fixture;
+    config.path = auto_save_path;
+    config.interval_seconds = 1U;
+    ASSERT_TRUE(persistence_auto_save_init(&state, &config, error, sizeof(error)));
+    persistence_auto_save_set_background(&state, false);
+    persistence_auto_save_mark_dirty(&state);
+    ASSERT_TRUE(persistence_auto_save_enable_journal(&state, 16U, error, sizeof(error)));
+    ASSERT_TRUE(persistence_auto_save_tick(&state, 1.0, error, sizeof(error)));
+    persistence_auto_save_shutdown(&state);
+
+    FamilyTree *snapshot = persistence_tree_load(auto_save_path, error, sizeof(error));
+    ASSERT_NOT_NULL(snapshot);
+    ASSERT_STREQ(family_tree_find_person(snapshot, 1U)->name.first, "Recovered");
+    family_tree_destroy(snapshot);
+
+    /* Nothing left to replay on the next start. */
+    ASSERT_TRUE(persistence_journal_recover_pending(auto_save_path, &recovered, &replayed, error, sizeof(error)));
+    ASSERT_NULL(recovered);
+
+    /* A journal without its snapshot cannot be replayed; it is set aside rather than deleted. */
+    test_delete_file(auto_save_path);
+    ASSERT_TRUE(test_write_text_file(journal_path, "@2 00000000\n{}\n"));
+    ASSERT_FALSE(persistence_journal_recover_pending(auto_save_path, &recovered, &replayed, error, sizeof(error)));
+    ASSERT_NULL(recovered);
+    ASSERT_FALSE(test_file_exists(journal_path));
+    ASSERT_TRUE(test_file_exists(unrecovered_path));
+
+    char backup_path[160];
+    (void)snprintf(backup_path, sizeof(backup_path), "%s.bak", auto_save_path);
+    test_delete_file(backup_path);
+    test_delete_file(unrecovered_path);
+    test_delete_file(auto_save_path);
+    fixture_cleanup(&fixture);
+}
+
+TEST(test_persistence_startup_sets_journal_aside_when_snapshot_rewrite_fails)
+{
+    AutoSaveFixture fixture;
+    fixture_init(&fixture);
+
+    char auto_save_path[128];
+    char journal_path[160];
+    char unrecovered_path[192];
+    char blocked_temp_path[160];
+    test_temp_file_path(auto_save_path, sizeof(auto_save_path), "startup_blocked.json");
+    journal_path_for(journal_path, sizeof(journal_path), auto_save_path);
+    (void)snprintf(unrecovered_path, sizeof(unrecovered_path), "%s.unrecovered", journal_path);
+    (void)snprintf(blocked_temp_path, sizeof(blocked_temp_path), "%s.tmp", auto_save_path);
+    test_delete_file(unrecovered_path);
+
+    char error[256];
+    ASSERT_TRUE(persistence_tree_save(fixture.tree, auto_save_path, error, sizeof(error)));
+    PersistenceJournal journal;
+    ASSERT_TRUE(persistence_journal_init(&journal, auto_save_path, error, sizeof(error)));
+    Person *root = family_tree_find_person(fixture.tree, 1U);
+    ASSERT_NOT_NULL(root);
+    ASSERT_TRUE(person_set_name(root, "Unsaved", NULL, "Edit"));
+    ASSERT_TRUE(persistence_journal_record(&journal, PERSISTENCE_JOURNAL_EDIT, root, error, sizeof(error)));
+    ASSERT_TRUE(persistence_journal_flush(&journal, error, sizeof(error)));
+    persistence_journal_shutdown(&journal);
+
+    /* A directory where the atomic save wants its temp file makes the snapshot rewrite fail after the replay. */
+#if defined(_WIN32)
+    ASSERT_EQ(_mkdir(blocked_temp_path), 0);
+#else
+    ASSERT_EQ(mkdir(blocked_temp_path, 0775), 0);
+#endif
+    FamilyTree *recovered = NULL;
+    size_t replayed = 0U;
+    ASSERT_FALSE(persistence_journal_recover_pending(auto_save_path, &recovered, &replayed, error, sizeof(error)));
+    ASSERT_NULL(recovered);
+    ASSERT_FALSE(test_file_exists(journal_path));
+    ASSERT_TRUE(test_file_exists(unrecovered_path));
+    ASSERT_NOT_NULL(strstr(error, "journal kept as"));
+
+#if defined(_WIN32)
+    (void)_rmdir(blocked_temp_path);
+#else
+    (void)rmdir(blocked_temp_path);
+#endif
+    test_delete_file(unrecovered_path);
+    test_delete_file(auto_save_path);
+    fixture_cleanup(&fixture);
+}
+
 void register_persistence_auto_save_tests(TestRegistry *registry)
 {
     REGISTER_TEST(registry, test_persistence_auto_save_triggers_after_interval);
@@ -202,4 +622,11 @@ void register_persistence_auto_save_tests(TestRegistry *registry)
     REGISTER_TEST(registry, test_persistence_auto_save_handles_path_updates);
     REGISTER_TEST(registry, test_persistence_auto_save_respects_disable);
     REGISTER_TEST(registry, test_persistence_auto_save_interval_updates_reset_timer);
+    REGISTER_TEST(registry, test_persistence_auto_save_background_writes_snapshot);
+    REGISTER_TEST(registry, test_persistence_auto_save_flush_waits_for_background_job);
+    REGISTER_TEST(registry, test_persistence_auto_save_journal_replays_changes);
+    REGISTER_TEST(registry, test_persistence_auto_save_journal_compacts_after_threshold);
+    REGISTER_TEST(registry, test_persistence_journal_replay_stops_at_torn_record);
+    REGISTER_TEST(registry, test_persistence_startup_recovers_journal_before_auto_save);
+    REGISTER_TEST(registry, test_persistence_startup_sets_journal_aside_when_snapshot_rewrite_fails);
 }
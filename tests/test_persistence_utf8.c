@@ -0,0 +1,202 @@
+#include "persistence_utf8.h"
+#include "test_framework.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define UTF8_FUZZ_ITERATIONS 20000U
+#define UTF8_FUZZ_MAX_LENGTH 160U
+
+static const PersistenceUtf8Kernel g_utf8_kernels[] = {PERSISTENCE_UTF8_KERNEL_SCALAR,
+                                                       PERSISTENCE_UTF8_KERNEL_SSE4,
+                                                       PERSISTENCE_UTF8_KERNEL_AVX2};
+
+static uint32_t utf8_fuzz_next(uint32_t *state)
+{
+    uint32_t value = *state;
+    value ^= value << 13;
+    value ^= value >> 17;
+    value ^= value << 5;
+    *state = value;
+    return value;
+}
+
+static size_t utf8_fuzz_encode(uint32_t codepoint, unsigned char *out)
+{
+    if (codepoint < 0x80U)
+    {
+        out[0] = (unsigned char)codepoint;
+        return 1U;
+    }
+    if (codepoint < 0x800U)
+    {
+        out[0] = (unsigned char)(0xC0U | (codepoint >> 6));
+        out[1] = (unsigned char)(0x80U | (codepoint & 0x3FU));
+        return 2U;
+    }
+    if (codepoint < 0x10000U)
+    {
+        out[0] = (unsigned char)(0xE0U | (codepoint >> 12));
+        out[1] = (unsigned char)(0x80U | ((codepoint >> 6) & 0x3FU));
+        out[2] = (unsigned char)(0x80U | (codepoint & 0x3FU));
+        return 3U;
+    }
+    out[0] = (unsigned char)(0xF0U | (codepoint >> 18));
+    out[1] = (unsigned char)(0x80U | ((codepoint >> 12) & 0x3FU));
+    out[2] = (unsigned char)(0x80U | ((codepoint >> 6) & 0x3FU));
+    out[3] = (unsigned char)(0x80U | (codepoint & 0x3FU));
+    return 4U;
+}
+
+/* Valid text with a bias towards ASCII runs, so blocks alternate between the fast path and full checks. */
+static size_t utf8_fuzz_fill_valid(uint32_t *state, unsigned char *buffer, size_t capacity)
+{
+    size_t length = 0U;
+    size_t target = utf8_fuzz_next(state) % capacity;
+    while (length + 4U <= target)
+    {
+        uint32_t pick = utf8_fuzz_next(state);
+        uint32_t codepoint;
+        switch (pick % 5U)
+        {
+        case 0U:
+        case 1U:
+            codepoint = pick % 0x80U;
+            break;
+        case 2U:
+            codepoint = 0x80U + (pick % (0x800U - 0x80U));
+            break;
+        case 3U:
+            codepoint = 0x800U + (pick % (0x10000U - 0x800U));
+            if (codepoint >= 0xD800U && codepoint <= 0xDFFFU)
+            {
+                codepoint -= 0x800U;
+            }
+            break;
+        default:
+            codepoint = 0x10000U + (pick % (0x110000U - 0x10000U));
+            break;
+        }
+        length += utf8_fuzz_encode(codepoint, buffer + length);
+    }
+    return length;
+}
+
+static bool utf8_kernels_agree(const unsigned char *buffer, size_t length, bool *out_expected)
+{
+    const char *data = (const char *)buffer;
+    bool expected = persistence_utf8_validate_scalar(data, length);
+    if (out_expected)
+    {
+        *out_expected = expected;
+    }
+    for (size_t index = 0U; index < sizeof(g_utf8_kernels) / sizeof(g_utf8_kernels[0]); ++index)
+    {
+        PersistenceUtf8Kernel kernel = g_utf8_kernels[index];
+        if (!persistence_utf8_kernel_supported(kernel))
+        {
+            continue;
+        }
+        if (persistence_utf8_validate_with(kernel, data, length) != expected)
+        {
+            fprintf(stderr, "utf8 kernel %d disagrees with scalar on %zu bytes\n", (int)kernel, length);
+            return false;
+        }
+    }
+    return persistence_utf8_validate_length(data, length) == expected;
+}
+
+TEST(test_persistence_utf8_known_sequences_across_block_edges)
+{
+    static const struct
+    {
+        const char *bytes;
+        bool valid;
+    } cases[] = {
+        {"\xC3\xA9", true},           /* U+00E9 */
+        {"\xE2\x82\xAC", true},       /* U+20AC */
+        {"\xF0\x9F\x98\x80", true},   /* U+1F600 */
+        {"\xF4\x8F\xBF\xBF", true},   /* U+10FFFF */
+        {"\xC0\xAF", false},          /* overlong '/' */
+        {"\xC1\xBF", false},          /* overlong 2-byte */
+        {"\xE0\x9F\xBF", false},      /* overlong 3-byte */
+        {"\xF0\x8F\xBF\xBF", false},  /* overlong 4-byte */
+        {"\xED\xA0\x80", false},      /* surrogate U+D800 */
+        {"\xF4\x90\x80\x80", false},  /* beyond U+10FFFF */
+        {"\xF8\x88\x80\x80\x80", false},
+        {"\x80", false},              /* stray continuation */
+        {"\xE2\x82", false},          /* truncated */
+        {"\xF0\x9F\x98", false},      /* truncated */
+        {"\xC3\xA9\xA9", false},      /* extra continuation */
+    };
+    unsigned char buffer[96];
+    for (size_t index = 0U; index < sizeof(cases) / sizeof(cases[0]); ++index)
+    {
+        size_t sequence_length = strlen(cases[index].bytes);
+        /* Slide the sequence across the 16- and 32-byte block boundaries, with and without trailing text. */
+        for (size_t offset = 0U; offset + sequence_length + 8U <= sizeof(buffer); ++offset)
+        {
+            memset(buffer, 'a', sizeof(buffer));
+            memcpy(buffer + offset, cases[index].bytes, sequence_length);
+            bool expected = false;
+            ASSERT_TRUE(utf8_kernels_agree(buffer, offset + sequence_length, &expected));
+            ASSERT_EQ(cases[index].valid, expected);
+            ASSERT_TRUE(utf8_kernels_agree(buffer, offset + sequence_length + 8U, &expected));
+            ASSERT_EQ(cases[index].valid, expected);
+        }
+    }
+    ASSERT_TRUE(persistence_utf8_validate(NULL));
+    ASSERT_TRUE(persistence_utf8_validate(""));
+}
+
+TEST(test_persistence_utf8_kernels_match_scalar_on_fuzzed_input)
+{
+    unsigned char buffer[UTF8_FUZZ_MAX_LENGTH];
+    uint32_t state = 0x9E3779B9U;
+    size_t valid_inputs = 0U;
+    for (unsigned int iteration = 0U; iteration < UTF8_FUZZ_ITERATIONS; ++iteration)
+    {
+        size_t length = utf8_fuzz_fill_valid(&state, buffer, sizeof(buffer));
+        switch (iteration % 4U)
+        {
+        case 0U:
+            break;
+        case 1U:
+            /* Flip one byte of otherwise valid text. */
+            if (length > 0U)
+            {
+                buffer[utf8_fuzz_next(&state) % length] = (unsigned char)utf8_fuzz_next(&state);
+            }
+            break;
+        case 2U:
+            /* Truncate mid-sequence. */
+            if (length > 0U)
+            {
+                length = utf8_fuzz_next(&state) % length;
+            }
+            break;
+        default:
+            length = utf8_fuzz_next(&state) % sizeof(buffer);
+            for (size_t index = 0U; index < length; ++index)
+            {
+                buffer[index] = (unsigned char)utf8_fuzz_next(&state);
+            }
+            break;
+        }
+        bool expected = false;
+        ASSERT_TRUE(utf8_kernels_agree(buffer, length, &expected));
+        if (expected)
+        {
+            valid_inputs++;
+        }
+    }
+    ASSERT_TRUE(valid_inputs >= UTF8_FUZZ_ITERATIONS / 4U);
+    ASSERT_TRUE(valid_inputs < UTF8_FUZZ_ITERATIONS);
+}
+
+void register_persistence_utf8_tests(TestRegistry *registry)
+{
+    REGISTER_TEST(registry, test_persistence_utf8_known_sequences_across_block_edges);
+    REGISTER_TEST(registry, test_persistence_utf8_kernels_match_scalar_on_fuzzed_input);
+}
@@ -0,0 +1,119 @@
+#include "person_slab.h"
+#include "test_framework.h"
+#include "tree.h"
+
+TEST(test_person_slab_recycles_released_records)
+{
+    PersonSlab *slab = person_slab_create();
+    ASSERT_NOT_NULL(slab);
+
+    Person *first = person_create_in(1U, slab, NULL);
+    Person *second = person_create_in(2U, slab, NULL);
+    ASSERT_NOT_NULL(first);
+    ASSERT_NOT_NULL(second);
+    ASSERT_EQ(first + 1, second);
+    ASSERT_TRUE(person_set_name(first, "Ada", NULL, "Lovelace"));
+
+    PersonSlabStats stats;
+    person_slab_get_stats(slab, &stats);
+    ASSERT_EQ(stats.block_count, 1U);
+    ASSERT_EQ(stats.live_records, 2U);
+
+    person_destroy(first);
+    person_slab_get_stats(slab, &stats);
+    ASSERT_EQ(stats.live_records, 1U);
+    ASSERT_EQ(stats.free_records, 1U);
+
+    Person *reused = person_create_in(3U, slab, NULL);
+    ASSERT_EQ(reused, first);
+    ASSERT_EQ(reused->id, 3U);
+    ASSERT_NULL(reused->name.first);
+    ASSERT_TRUE(reused->is_alive);
+
+    person_destroy(reused);
+    person_destroy(second);
+    person_slab_orphan(slab);
+}
+
+TEST(test_person_slab_grows_across_blocks)
+{
+    PersonSlab *slab = person_slab_create();
+    ASSERT_NOT_NULL(slab);
+    Person *persons[300];
+    for (size_t index = 0U; index < sizeof(persons) / sizeof(persons[0]); ++index)
+    {
+        persons[index] = person_create_in((uint32_t)index + 1U, slab, NULL);
+        ASSERT_NOT_NULL(persons[index]);
+    }
+    PersonSlabStats stats;
+    person_slab_get_stats(slab, &stats);
+    ASSERT_TRUE(stats.block_count > 1U);
+    ASSERT_TRUE(stats.capacity >= 300U);
+    ASSERT_EQ(stats.live_records, 300U);
+    ASSERT_EQ(persons[299]->id, 300U);
+    for (size_t index = 0U; index < sizeof(persons) / sizeof(persons[0]); ++index)
+    {
+        person_destroy(persons[index]);
+    }
+    person_slab_orphan(slab);
+}
+
+TEST(test_person_slab_extracted_person_outlives_tree)
+{
+    FamilyTree *tree = family_tree_create("Slab");
+    ASSERT_NOT_NULL(tree);
+    Person *parent = family_tree_create_person(tree, 1U);
+    Person *child = family_tree_create_person(tree, 2U);
+    ASSERT_NOT_NULL(parent);
+    ASSERT_NOT_NULL(child);
+    ASSERT_EQ(parent->slab, tree->slab);
+    ASSERT_TRUE(person_set_name(parent, "Grace", NULL, "Hopper"));
+    ASSERT_TRUE(person_set_name(child, "Ada", NULL, "Hopper"));
+    ASSERT_TRUE(family_tree_add_person(tree, parent));
+    ASSERT_TRUE(family_tree_add_person(tree, child));
+    ASSERT_TRUE(person_add_child(parent, child));
+
+    Person *extracted = family_tree_extract_person(tree, 2U);
+    ASSERT_EQ(extracted, child);
+    family_tree_destroy(tree);
+
+    /* The orphaned slab stays alive until its last record is destroyed. */
+    ASSERT_STREQ(extracted->name.first, "Ada");
+    ASSERT_EQ(extracted->id, 2U);
+    person_destroy(extracted);
+}
+
+TEST(test_person_slab_tree_teardown_abandons_members_and_destroys_strays)
+{
+    FamilyTree *tree = family_tree_create("Slab");
+    ASSERT_NOT_NULL(tree);
+    Person *parent = family_tree_create_person(tree, 1U);
+    Person *child = family_tree_create_person(tree, 2U);
+    Person *stray = person_create(3U);
+    ASSERT_NOT_NULL(parent);
+    ASSERT_NOT_NULL(child);
+    ASSERT_NOT_NULL(stray);
+    ASSERT_TRUE(person_set_name(parent, "Grace", NULL, "Hopper"));
+    ASSERT_TRUE(person_set_name(stray, "Alan", NULL, "Turing"));
+    ASSERT_TRUE(person_metadata_set(parent, "occupation", "Admiral"));
+    ASSERT_TRUE(family_tree_add_person(tree, parent));
+    ASSERT_TRUE(family_tree_add_person(tree, child));
+    ASSERT_TRUE(family_tree_add_person(tree, stray));
+    ASSERT_TRUE(person_add_child(parent, child));
+    ASSERT_TRUE(person_add_spouse(parent, stray));
+
+    PersonSlabStats stats;
+    person_slab_get_stats(tree->slab, &stats);
+    ASSERT_EQ(stats.live_records, 2U);
+
+    /* Slab members are abandoned with their blocks; the heap-allocated member is destroyed on its own. */
+    family_tree_destroy(tree);
+}
+
+void register_person_slab_tests(TestRegistry *registry)
+{
+    REGISTER_TEST(registry, test_person_slab_recycles_released_records);
+    REGISTER_TEST(registry, test_person_slab_grows_across_blocks);
+    REGISTER_TEST(registry, test_person_slab_extracted_person_outlives_tree);
+    REGISTER_TEST(registry, test_person_slab_tree_teardown_abandons_members_and_destroys_strays);
+}
@@ -86,8 +86,10 @@ TEST(test_render_collect_parent_child_segments_collects_all_children)
     layout.nodes[2].position[1] = -1.0f;
     layout.nodes[2].position[2] = 0.0f;
 
+    RenderState state;
+    render_state_init(&state);
     RenderConnectionSegment segments[4];
-    size_t count = render_collect_parent_child_segments(&layout, segments, 4U);
+    size_t count = render_collect_parent_child_segments(&state, &layout, segments, 4U);
     ASSERT_EQ(count, 2U);
 
     bool seen_a = false;
@@ -108,6 +110,7 @@ TEST(test_render_collect_parent_child_segments_collects_all_children)
     ASSERT_TRUE(seen_a);
     ASSERT_TRUE(seen_b);
 
+    render_cleanup(&state);
     test_free_layout(&layout);
     person_destroy(child_b);
     person_destroy(child_a);
@@ -133,17 +136,64 @@ TEST(test_render_collect_spouse_segments_ignores_duplicates)
     layout.nodes[1].position[1] = 0.0f;
     layout.nodes[1].position[2] = 0.0f;
 
+    RenderState state;
+    render_state_init(&state);
     RenderConnectionSegment segments[4];
-    size_t count = render_collect_spouse_segments(&layout, segments, 4U);
+    size_t count = render_collect_spouse_segments(&state, &layout, segments, 4U);
     ASSERT_EQ(count, 1U);
     ASSERT_FLOAT_NEAR(segments[0].start[0], 0.0f, 0.0001f);
     ASSERT_FLOAT_NEAR(segments[0].end[0], 2.0f, 0.0001f);
 
+    render_cleanup(&state);
     test_free_layout(&layout);
     person_destroy(two);
     person_destroy(one);
 }
 
+TEST(test_render_connection_cache_follows_person_changes)
+{
+    Person *parent = person_create(40U);
+    Person *first = person_create(41U);
+    Person *second = person_create(42U);
+    ASSERT_TRUE(parent != NULL && first != NULL && second != NULL);
+    ASSERT_TRUE(person_add_child(parent, first));
+
+    LayoutResult layout;
+    layout.count = 3U;
+    layout.nodes = calloc(layout.count, sizeof(LayoutNode));
+    ASSERT_NOT_NULL(layout.nodes);
+    layout.nodes[0].person = parent;
+    layout.nodes[1].person = first;
+    layout.nodes[1].position[0] = 1.0f;
+    layout.nodes[2].person = second;
+    layout.nodes[2].position[0] = 2.0f;
+
+    RenderState state;
+    render_state_init(&state);
+    RenderConnectionSegment segments[4];
+    ASSERT_EQ(render_collect_parent_child_segments(&state, &layout, segments, 4U), 1U);
+
+    /* The graph is cached, so a link only shows up once the edit is reported. */
+    ASSERT_TRUE(person_add_child(parent, second));
+    ASSERT_EQ(render_collect_parent_child_segments(&state, &layout, segments, 4U), 1U);
+    render_connections_person_edited(&state, parent);
+    ASSERT_EQ(render_collect_parent_child_segments(&state, &layout, segments, 4U), 2U);
+
+    /* Moving nodes keeps the cache; dropping one from the layout only re-maps it. */
+    layout.nodes[1].position[0] = 5.0f;
+    ASSERT_EQ(render_collect_parent_child_segments(&state, &layout, segments, 4U), 2U);
+    ASSERT_FLOAT_NEAR(segments[0].end[0], 5.0f, 0.0001f);
+    render_connections_person_removed(&state, second);
+    layout.count = 2U;
+    ASSERT_EQ(render_collect_parent_child_segments(&state, &layout, segments, 4U), 1U);
+
+    render_cleanup(&state);
+    test_free_layout(&layout);
+    person_destroy(second);
+    person_destroy(first);
+    person_destroy(parent);
+}
+
 TEST(test_render_config_validate_rejects_invalid_style)
 {
     RenderConfig config = render_config_default();
@@ -291,6 +341,7 @@ void register_render_tests(TestRegistry *registry)
     REGISTER_TEST(registry, test_render_find_person_position_returns_expected_coordinates);
     REGISTER_TEST(registry, test_render_collect_parent_child_segments_collects_all_children);
     REGISTER_TEST(registry, test_render_collect_spouse_segments_ignores_duplicates);
+    REGISTER_TEST(registry, test_render_connection_cache_follows_person_changes);
     REGISTER_TEST(registry, test_render_config_validate_rejects_invalid_style);
     REGISTER_TEST(registry, test_render_batcher_plan_groups_alive_and_deceased);
     REGISTER_TEST(registry, test_render_batcher_plan_handles_selected_and_hovered);
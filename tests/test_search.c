@@ -134,9 +134,34 @@ DECLARE_TEST(test_search_birth_year_range_limits_results)
     family_tree_destroy(tree);
 }
 
+DECLARE_TEST(test_search_keeps_first_names_when_capacity_is_short)
+{
+    FamilyTree *tree = make_sample_tree();
+    ASSERT_NOT_NULL(tree);
+
+    const Person *results[2];
+    size_t count = search_execute(tree, NULL, results, 2U);
+    ASSERT_EQ(count, 2U);
+    ASSERT_EQ(results[0]->id, 1U);
+    ASSERT_EQ(results[1]->id, 2U);
+
+    /* Renaming re-keys the person, so the cached sort key must not outlive the edit. */
+    Person *avery = family_tree_find_person(tree, 1U);
+    ASSERT_NOT_NULL(avery);
+    ASSERT_TRUE(person_set_name(avery, "Zed", NULL, "Tester"));
+    family_tree_note_person_edited(tree, avery);
+    count = search_execute(tree, NULL, results, 2U);
+    ASSERT_EQ(count, 2U);
+    ASSERT_EQ(results[0]->id, 2U);
+    ASSERT_EQ(results[1]->id, 3U);
+
+    family_tree_destroy(tree);
+}
+
 void register_search_tests(TestRegistry *registry)
 {
     REGISTER_TEST(registry, test_search_name_substring_matches_case_insensitive);
     REGISTER_TEST(registry, test_search_filters_alive_status);
     REGISTER_TEST(registry, test_search_birth_year_range_limits_results);
+    REGISTER_TEST(registry, test_search_keeps_first_names_when_capacity_is_short);
 }
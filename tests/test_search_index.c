@@ -0,0 +1,92 @@
+#include "search_index.h"
+#include "test_framework.h"
+#include "tree.h"
+
+#include <string.h>
+
+typedef struct SearchIndexTestHits
+{
+    uint32_t ids[8];
+    size_t count;
+} SearchIndexTestHits;
+
+static bool search_index_test_collect(const Person *person, const char *folded_name, void *user_data)
+{
+    (void)folded_name;
+    SearchIndexTestHits *hits = (SearchIndexTestHits *)user_data;
+    hits->ids[hits->count++] = person->id;
+    return hits->count < 8U;
+}
+
+static Person *search_index_test_person(FamilyTree *tree, uint32_t id, const char *first, const char *last)
+{
+    Person *person = family_tree_create_person(tree, id);
+    if (person && person_set_name(person, first, NULL, last) && family_tree_add_person(tree, person))
+    {
+        return person;
+    }
+    person_destroy(person);
+    return NULL;
+}
+
+TEST(test_search_index_query_matches_substrings_in_tree_order)
+{
+    FamilyTree *tree = family_tree_create("Index");
+    ASSERT_NOT_NULL(tree);
+    Person *anna = search_index_test_person(tree, 1U, "Anna", "Hannover");
+    ASSERT_NOT_NULL(search_index_test_person(tree, 2U, "Bert", "Mann"));
+    ASSERT_NOT_NULL(search_index_test_person(tree, 3U, "Hanna", "Berg"));
+    ASSERT_NOT_NULL(anna);
+    ASSERT_TRUE(search_index_ensure(tree->search, tree->persons, tree->person_count));
+    ASSERT_STREQ(search_index_folded_name(tree->search, anna), "anna hannover");
+
+    SearchIndexTestHits hits = {{0U}, 0U};
+    ASSERT_EQ(search_index_query(tree->search, "ann", search_index_test_collect, &hits), 3U);
+    ASSERT_EQ(hits.ids[0], 1U);
+    ASSERT_EQ(hits.ids[1], 2U);
+    ASSERT_EQ(hits.ids[2], 3U);
+
+    hits.count = 0U;
+    ASSERT_EQ(search_index_query(tree->search, "hann", search_index_test_collect, &hits), 2U);
+    ASSERT_EQ(hits.ids[0], 1U);
+    ASSERT_EQ(hits.ids[1], 3U);
+
+    hits.count = 0U;
+    ASSERT_EQ(search_index_query(tree->search, "be", search_index_test_collect, &hits), 2U);
+    ASSERT_EQ(hits.ids[0], 2U);
+    ASSERT_EQ(hits.ids[1], 3U);
+
+    hits.count = 0U;
+    ASSERT_EQ(search_index_query(tree->search, "zzz", search_index_test_collect, &hits), 0U);
+    family_tree_destroy(tree);
+}
+
+TEST(test_search_index_follows_tree_edits)
+{
+    FamilyTree *tree = family_tree_create("Index");
+    ASSERT_NOT_NULL(tree);
+    Person *first = search_index_test_person(tree, 1U, "Clara", "Stone");
+    ASSERT_NOT_NULL(first);
+    ASSERT_NOT_NULL(search_index_test_person(tree, 2U, "Dora", "Stone"));
+    ASSERT_TRUE(search_index_ensure(tree->search, tree->persons, tree->person_count));
+
+    ASSERT_NOT_NULL(search_index_test_person(tree, 3U, "Stoney", "Brook"));
+    ASSERT_TRUE(person_set_name(first, "Clara", NULL, "Rivers"));
+    family_tree_note_person_edited(tree, first);
+    ASSERT_TRUE(family_tree_remove_person(tree, 2U));
+    ASSERT_TRUE(search_index_is_built(tree->search));
+
+    SearchIndexTestHits hits = {{0U}, 0U};
+    ASSERT_EQ(search_index_query(tree->search, "stone", search_index_test_collect, &hits), 1U);
+    ASSERT_EQ(hits.ids[0], 3U);
+    hits.count = 0U;
+    ASSERT_EQ(search_index_query(tree->search, "river", search_index_test_collect, &hits), 1U);
+    ASSERT_EQ(hits.ids[0], 1U);
+    family_tree_destroy(tree);
+}
+
+void register_search_index_tests(TestRegistry *registry)
+{
+    REGISTER_TEST(registry, test_search_index_query_matches_substrings_in_tree_order);
+    REGISTER_TEST(registry, test_search_index_follows_tree_edits);
+}
@@ -20,6 +20,7 @@ TEST(test_settings_defaults_are_expected)
     ASSERT_EQ(settings.default_layout_algorithm, SETTINGS_LAYOUT_ALGORITHM_HIERARCHICAL);
     ASSERT_EQ(settings.color_scheme, SETTINGS_COLOR_SCHEME_CYAN_GRAPH);
     ASSERT_EQ(settings.language, SETTINGS_LANGUAGE_ENGLISH);
+    ASSERT_EQ(settings.texture_budget_megabytes, 256U);
 }
 
 TEST(test_settings_mark_dirty_increments_revision)
@@ -43,6 +44,7 @@ TEST(test_settings_save_and_load_round_trip)
     settings.default_layout_algorithm = SETTINGS_LAYOUT_ALGORITHM_FORCE_DIRECTED;
     settings.color_scheme = SETTINGS_COLOR_SCHEME_SOLAR_ORCHID;
     settings.language = SETTINGS_LANGUAGE_FUTURE;
+    settings.texture_budget_megabytes = 512U;
     settings_mark_dirty(&settings);
 
     char path[128];
@@ -64,6 +66,7 @@ TEST(test_settings_save_and_load_round_trip)
     ASSERT_EQ(loaded.default_layout_algorithm, SETTINGS_LAYOUT_ALGORITHM_FORCE_DIRECTED);
     ASSERT_EQ(loaded.color_scheme, SETTINGS_COLOR_SCHEME_SOLAR_ORCHID);
     ASSERT_EQ(loaded.language, SETTINGS_LANGUAGE_FUTURE);
+    ASSERT_EQ(loaded.texture_budget_megabytes, 512U);
 
     test_delete_file(path);
 }
@@ -72,9 +72,31 @@ TEST(test_settings_runtime_input_sensitivity_clamped)
     ASSERT_FLOAT_NEAR(zoom, 1.0f, 0.0001f);
 }
 
+TEST(test_settings_runtime_texture_budget_clamped)
+{
+    TextureResidency residency;
+    texture_residency_init(&residency, 0U);
+    TextureResidencyCounters counters;
+
+    ASSERT_FALSE(settings_runtime_apply_texture_budget(NULL, NULL));
+    ASSERT_TRUE(settings_runtime_apply_texture_budget(NULL, &residency));
+    texture_residency_get_counters(&residency, &counters);
+    ASSERT_EQ(counters.budget_bytes, (size_t)256U * 1024U * 1024U);
+
+    Settings settings;
+    settings_init_defaults(&settings);
+    settings.texture_budget_megabytes = 1U;
+    ASSERT_TRUE(settings_runtime_apply_texture_budget(&settings, &residency));
+    texture_residency_get_counters(&residency, &counters);
+    ASSERT_EQ(counters.budget_bytes, (size_t)16U * 1024U * 1024U);
+
+    texture_residency_shutdown(&residency);
+}
+
 void register_settings_runtime_tests(TestRegistry *registry)
 {
     REGISTER_TEST(registry, test_settings_runtime_camera_scaling_respects_settings);
     REGISTER_TEST(registry, test_settings_runtime_render_quality_and_colors);
     REGISTER_TEST(registry, test_settings_runtime_input_sensitivity_clamped);
+    REGISTER_TEST(registry, test_settings_runtime_texture_budget_clamped);
 }
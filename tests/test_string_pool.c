@@ -0,0 +1,107 @@
+#include "at_string_pool.h"
+#include "test_framework.h"
+
+#include <stdio.h>
+#include <string.h>
+
+TEST(test_string_pool_interns_equal_values_once)
+{
+    AtStringPool *pool = at_string_pool_create();
+    ASSERT_NOT_NULL(pool);
+
+    char buffer[16];
+    memcpy(buffer, "Lovelace", sizeof("Lovelace"));
+    const char *first = at_string_pool_intern(pool, "Lovelace");
+    const char *second = at_string_pool_intern(pool, buffer);
+    const char *other = at_string_pool_intern(pool, "Byron");
+    ASSERT_NOT_NULL(first);
+    ASSERT_EQ(first, second);
+    ASSERT_TRUE(first != buffer);
+    ASSERT_TRUE(other != first);
+    ASSERT_STREQ(other, "Byron");
+    ASSERT_NULL(at_string_pool_intern(pool, NULL));
+
+    AtStringPoolStats stats;
+    at_string_pool_get_stats(pool, &stats);
+    ASSERT_EQ(stats.unique_strings, 2U);
+    ASSERT_EQ(stats.references, 3U);
+    ASSERT_EQ(stats.bytes_stored, sizeof("Lovelace") + sizeof("Byron"));
+    ASSERT_EQ(stats.bytes_requested, 2U * sizeof("Lovelace") + sizeof("Byron"));
+    ASSERT_EQ(stats.bytes_saved, sizeof("Lovelace"));
+    ASSERT_TRUE(stats.arena_bytes >= stats.bytes_stored);
+
+    at_string_pool_release(pool, first);
+    at_string_pool_release(pool, second);
+    at_string_pool_release(pool, other);
+    at_string_pool_get_stats(pool, &stats);
+    ASSERT_EQ(stats.unique_strings, 0U);
+    ASSERT_EQ(stats.references, 0U);
+    ASSERT_EQ(stats.bytes_saved, 0U);
+
+    at_string_pool_destroy(pool);
+}
+
+TEST(test_string_pool_keeps_value_until_last_release)
+{
+    AtStringPool *pool = at_string_pool_create();
+    ASSERT_NOT_NULL(pool);
+
+    const char *first = at_string_pool_intern(pool, "Paoli");
+    const char *second = at_string_pool_intern(pool, "Paoli");
+    at_string_pool_release(pool, first);
+    ASSERT_STREQ(second, "Paoli");
+    ASSERT_EQ(at_string_pool_intern(pool, "Paoli"), second);
+    at_string_pool_release(pool, second);
+    at_string_pool_release(pool, second);
+
+    /* Freed slots are recycled for values in the same size class. */
+    const char *reused = at_string_pool_intern(pool, "Osaka");
+    ASSERT_EQ(reused, second);
+    ASSERT_STREQ(reused, "Osaka");
+    at_string_pool_release(pool, reused);
+
+    at_string_pool_destroy(pool);
+}
+
+TEST(test_string_pool_survives_growth_and_large_values)
+{
+    AtStringPool *pool = at_string_pool_create();
+    ASSERT_NOT_NULL(pool);
+
+    char large[2048];
+    memset(large, 'x', sizeof(large) - 1U);
+    large[sizeof(large) - 1U] = '\0';
+    const char *large_copy = at_string_pool_intern(pool, large);
+    ASSERT_NOT_NULL(large_copy);
+    ASSERT_STREQ(large_copy, large);
+
+    const char *first_value = at_string_pool_intern(pool, "value-0");
+    char value[32];
+    for (unsigned int index = 0U; index < 5000U; ++index)
+    {
+        (void)snprintf(value, sizeof(value), "value-%u", index);
+        ASSERT_NOT_NULL(at_string_pool_intern(pool, value));
+    }
+    ASSERT_EQ(at_string_pool_intern(pool, "value-0"), first_value);
+    ASSERT_EQ(at_string_pool_intern(pool, large), large_copy);
+
+    AtStringPoolStats stats;
+    at_string_pool_get_stats(pool, &stats);
+    ASSERT_EQ(stats.unique_strings, 5001U);
+    ASSERT_EQ(stats.references, 5004U);
+
+    /* Owners torn down after discard must not touch the pool's bookkeeping. */
+    at_string_pool_discard(pool);
+    at_string_pool_release(pool, large_copy);
+    at_string_pool_get_stats(pool, &stats);
+    ASSERT_EQ(stats.references, 5004U);
+
+    at_string_pool_destroy(pool);
+}
+
+void register_string_pool_tests(TestRegistry *registry)
+{
+    REGISTER_TEST(registry, test_string_pool_interns_equal_values_once);
+    REGISTER_TEST(registry, test_string_pool_keeps_value_until_last_release);
+    REGISTER_TEST(registry, test_string_pool_survives_growth_and_large_values);
+}
@@ -0,0 +1,172 @@
+#include "test_framework.h"
+#include "texture_residency.h"
+
+typedef struct TestResidencyOwner
+{
+    TextureResidencyHandle handles[8];
+    int evicted[8];
+} TestResidencyOwner;
+
+static void testresidency_evict(void *owner, size_t slot)
+{
+    TestResidencyOwner *state = (TestResidencyOwner *)owner;
+    state->handles[slot] = 0U;
+    state->evicted[slot] += 1;
+}
+
+static TextureResidencyHandle testresidency_load(TextureResidency *residency, TestResidencyOwner *owner,
+                                                 TextureResidencyKind kind, size_t bytes, size_t slot)
+{
+    if (!texture_residency_reserve(residency, bytes))
+    {
+        return 0U;
+    }
+    owner->handles[slot] = texture_residency_track(residency, kind, bytes, testresidency_evict, owner, slot);
+    return owner->handles[slot];
+}
+
+TEST(test_texture_residency_evicts_least_recently_used_across_kinds)
+{
+    TextureResidency residency;
+    texture_residency_init(&residency, 300U);
+    TestResidencyOwner owner = {0};
+
+    ASSERT_NE(testresidency_load(&residency, &owner, TEXTURE_RESIDENCY_DETAIL_VIEW, 100U, 0U), 0U);
+    texture_residency_begin_frame(&residency);
+    ASSERT_NE(testresidency_load(&residency, &owner, TEXTURE_RESIDENCY_GALLERY, 100U, 1U), 0U);
+    texture_residency_begin_frame(&residency);
+    ASSERT_NE(testresidency_load(&residency, &owner, TEXTURE_RESIDENCY_LABEL, 100U, 2U), 0U);
+
+    /* Drawing the profile again makes the gallery texture the oldest. */
+    texture_residency_begin_frame(&residency);
+    texture_residency_touch(&residency, owner.handles[0]);
+    ASSERT_NE(testresidency_load(&residency, &owner, TEXTURE_RESIDENCY_LABEL, 100U, 3U), 0U);
+    ASSERT_EQ(owner.evicted[1], 1);
+    ASSERT_EQ(owner.handles[1], 0U);
+    ASSERT_EQ(owner.evicted[0], 0);
+    ASSERT_EQ(owner.evicted[2], 0);
+
+    TextureResidencyCounters counters;
+    texture_residency_get_counters(&residency, &counters);
+    ASSERT_EQ(counters.budget_bytes, 300U);
+    ASSERT_EQ(counters.resident_bytes, 300U);
+    ASSERT_EQ(counters.resident_textures, 3U);
+    ASSERT_EQ(counters.peak_bytes, 300U);
+    ASSERT_EQ(counters.bytes_by_kind[TEXTURE_RESIDENCY_DETAIL_VIEW], 100U);
+    ASSERT_EQ(counters.bytes_by_kind[TEXTURE_RESIDENCY_GALLERY], 0U);
+    ASSERT_EQ(counters.textures_by_kind[TEXTURE_RESIDENCY_LABEL], 2U);
+    ASSERT_EQ(counters.evictions, 1U);
+    ASSERT_EQ(counters.evicted_bytes, 100U);
+
+    texture_residency_shutdown(&residency);
+}
+
+TEST(test_texture_residency_never_evicts_textures_drawn_this_frame)
+{
+    TextureResidency residency;
+    texture_residency_init(&residency, 200U);
+    TestResidencyOwner owner = {0};
+
+    ASSERT_NE(testresidency_load(&residency, &owner, TEXTURE_RESIDENCY_LABEL, 100U, 0U), 0U);
+    ASSERT_NE(testresidency_load(&residency, &owner, TEXTURE_RESIDENCY_LABEL, 100U, 1U), 0U);
+    ASSERT_EQ(testresidency_load(&residency, &owner, TEXTURE_RESIDENCY_GALLERY, 100U, 2U), 0U);
+    ASSERT_EQ(owner.evicted[0] + owner.evicted[1], 0);
+
+    /* Larger than the whole budget: rejected without evicting anything. */
+    texture_residency_begin_frame(&residency);
+    ASSERT_FALSE(texture_residency_reserve(&residency, 500U));
+    ASSERT_EQ(owner.evicted[0] + owner.evicted[1], 0);
+
+    TextureResidencyCounters counters;
+    texture_residency_get_counters(&residency, &counters);
+    ASSERT_EQ(counters.rejected_reservations, 2U);
+    ASSERT_EQ(counters.evictions, 0U);
+
+    /* Once idle, the next reservation makes room. */
+    ASSERT_NE(testresidency_load(&residency, &owner, TEXTURE_RESIDENCY_GALLERY, 100U, 2U), 0U);
+    ASSERT_EQ(owner.evicted[0], 1);
+    ASSERT_EQ(owner.evicted[1], 0);
+
+    texture_residency_shutdown(&residency);
+}
+
+TEST(test_texture_residency_release_and_budget_changes)
+{
+    TextureResidency residency;
+    texture_residency_init(&residency, 1000U);
+    TestResidencyOwner owner = {0};
+
+    for (size_t slot = 0U; slot < 4U; ++slot)
+    {
+        ASSERT_NE(testresidency_load(&residency, &owner, TEXTURE_RESIDENCY_GALLERY, 200U, slot), 0U);
+    }
+    /* An owner unloading on its own is not an eviction and frees the handle for reuse. */
+    texture_residency_release(&residency, owner.handles[3]);
+    texture_residency_release(&residency, owner.handles[3]);
+    ASSERT_EQ(owner.evicted[3], 0);
+
+    TextureResidencyCounters counters;
+    texture_residency_get_counters(&residency, &counters);
+    ASSERT_EQ(counters.resident_bytes, 600U);
+    ASSERT_EQ(counters.resident_textures, 3U);
+    ASSERT_EQ(counters.peak_bytes, 800U);
+
+    /* Shrinking the budget evicts oldest first until it fits. */
+    texture_residency_begin_frame(&residency);
+    texture_residency_set_budget(&residency, 250U);
+    ASSERT_EQ(owner.evicted[0], 1);
+    ASSERT_EQ(owner.evicted[1], 1);
+    ASSERT_EQ(owner.evicted[2], 0);
+    texture_residency_get_counters(&residency, &counters);
+    ASSERT_EQ(counters.resident_bytes, 200U);
+    ASSERT_EQ(counters.budget_bytes, 250U);
+
+    /* Untracked handles and a missing manager are harmless. */
+    texture_residency_touch(&residency, 0U);
+    texture_residency_touch(&residency, 999U);
+    ASSERT_TRUE(texture_residency_reserve(NULL, 1U << 30));
+    ASSERT_EQ(texture_residency_track(NULL, TEXTURE_RESIDENCY_LABEL, 10U, NULL, NULL, 0U), 0U);
+
+    ASSERT_EQ(texture_residency_estimate_bytes(16, 8, false), 512U);
+    ASSERT_EQ(texture_residency_estimate_bytes(16, 8, true), 682U);
+    ASSERT_EQ(texture_residency_estimate_bytes(0, 8, false), 0U);
+
+    texture_residency_shutdown(&residency);
+}
+
+TEST(test_texture_residency_grows_past_initial_capacity)
+{
+    TextureResidency residency;
+    texture_residency_init(&residency, 100000U);
+    TextureResidencyHandle handles[200];
+    for (size_t index = 0U; index < 200U; ++index)
+    {
+        handles[index] = texture_residency_track(&residency, TEXTURE_RESIDENCY_LABEL, 10U, NULL, NULL, index);
+        ASSERT_NE(handles[index], 0U);
+    }
+    for (size_t index = 0U; index < 200U; index += 2U)
+    {
+        texture_residency_release(&residency, handles[index]);
+    }
+    TextureResidencyCounters counters;
+    texture_residency_get_counters(&residency, &counters);
+    ASSERT_EQ(counters.resident_textures, 100U);
+    ASSERT_EQ(counters.resident_bytes, 1000U);
+
+    /* Shrinking to zero evicts everything idle, walking the list without callbacks. */
+    texture_residency_begin_frame(&residency);
+    texture_residency_set_budget(&residency, 0U);
+    texture_residency_get_counters(&residency, &counters);
+    ASSERT_EQ(counters.resident_textures, 0U);
+    ASSERT_EQ(counters.evictions, 100U);
+
+    texture_residency_shutdown(&residency);
+}
+
+void register_texture_residency_tests(TestRegistry *registry)
+{
+    REGISTER_TEST(registry, test_texture_residency_evicts_least_recently_used_across_kinds);
+    REGISTER_TEST(registry, test_texture_residency_never_evicts_textures_drawn_this_frame);
+    REGISTER_TEST(registry, test_texture_residency_release_and_budget_changes);
+    REGISTER_TEST(registry, test_texture_residency_grows_past_initial_capacity);
+}
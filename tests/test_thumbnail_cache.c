@@ -0,0 +1,336 @@
+#include "test_framework.h"
+#include "thumbnail_cache.h"
+
+#include "at_memory.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+#define TEST_THUMB_ROOT "Testing/Temporary/thumbnail_cache"
+
+typedef struct TestThumbDecoder
+{
+    int width;
+    int height;
+    int calls;
+} TestThumbDecoder;
+
+static void testthumb_create_directory(const char *path)
+{
+#if defined(_WIN32)
+    (void)_mkdir(path);
+#else
+    (void)mkdir(path, 0775);
+#endif
+}
+
+static bool testthumb_write_file(const char *path, const char *contents)
+{
+    FILE *file = fopen(path, "wb");
+    if (!file)
+    {
+        return false;
+    }
+    bool ok = fputs(contents, file) >= 0;
+    return (fclose(file) == 0) && ok;
+}
+
+static bool testthumb_fill_gradient(ThumbnailImage *image, int width, int height)
+{
+    image->pixels = (unsigned char *)AT_MALLOC((size_t)width * (size_t)height * 4U);
+    if (!image->pixels)
+    {
+        return false;
+    }
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            unsigned char *pixel = image->pixels + ((size_t)y * (size_t)width + (size_t)x) * 4U;
+            pixel[0] = (unsigned char)(x * 255 / (width - 1));
+            pixel[1] = 0U;
+            pixel[2] = 128U;
+            pixel[3] = 255U;
+        }
+    }
+    image->width = width;
+    image->height = height;
+    return true;
+}
+
+/* Stands in for the image decoder: any readable file decodes to a gradient of the configured size. The call
+ * counter is only used by single-threaded tests. */
+static bool testthumb_decode(const char *path, ThumbnailImage *out_image, void *user_data)
+{
+    TestThumbDecoder *decoder = (TestThumbDecoder *)user_data;
+    decoder->calls += 1;
+    FILE *file = fopen(path, "rb");
+    if (!file)
+    {
+        return false;
+    }
+    fclose(file);
+    return testthumb_fill_gradient(out_image, decoder->width, decoder->height);
+}
+
+static bool testthumb_decode_portrait(const char *path, ThumbnailImage *out_image, void *user_data)
+{
+    (void)user_data;
+    FILE *file = fopen(path, "rb");
+    if (!file)
+    {
+        return false;
+    }
+    fclose(file);
+    return testthumb_fill_gradient(out_image, 90, 120);
+}
+
+TEST(test_thumbnail_downscale_box_filters_and_keeps_aspect)
+{
+    unsigned char pixels[4 * 2 * 4];
+    for (int index = 0; index < 8; ++index)
+    {
+        pixels[index * 4 + 0] = (unsigned char)(index % 4 < 2 ? 0 : 200);
+        pixels[index * 4 + 1] = (unsigned char)(index < 4 ? 10 : 30);
+        pixels[index * 4 + 2] = 7U;
+        pixels[index * 4 + 3] = 255U;
+    }
+    ThumbnailImage source = {pixels, 4, 2};
+    ThumbnailImage scaled = {NULL, 0, 0};
+    ASSERT_TRUE(thumbnail_downscale(&source, 2, &scaled));
+    ASSERT_EQ(scaled.width, 2);
+    ASSERT_EQ(scaled.height, 1);
+    ASSERT_EQ(scaled.pixels[0], 0);
+    ASSERT_EQ(scaled.pixels[1], 20);
+    ASSERT_EQ(scaled.pixels[4], 200);
+    ASSERT_EQ(scaled.pixels[6], 7);
+    thumbnail_image_reset(&scaled);
+
+    /* Already small enough: copied untouched. */
+    ASSERT_TRUE(thumbnail_downscale(&source, 8, &scaled));
+    ASSERT_EQ(scaled.width, 4);
+    ASSERT_EQ(memcmp(scaled.pixels, pixels, sizeof(pixels)), 0);
+    thumbnail_image_reset(&scaled);
+
+    ThumbnailImage wide = {NULL, 0, 0};
+    ASSERT_TRUE(testthumb_fill_gradient(&wide, 300, 100));
+    ASSERT_TRUE(thumbnail_downscale(&wide, 64, &scaled));
+    ASSERT_EQ(scaled.width, 64);
+    ASSERT_EQ(scaled.height, 21);
+    ASSERT_EQ(scaled.pixels[2], 128);
+    ASSERT_EQ(scaled.pixels[3], 255);
+    thumbnail_image_reset(&scaled);
+    thumbnail_image_reset(&wide);
+}
+
+TEST(test_thumbnail_cache_reuses_until_source_changes)
+{
+    testthumb_create_directory("Testing");
+    testthumb_create_directory("Testing/Temporary");
+    const char *source_path = "Testing/Temporary/thumbnail_source.png";
+    ASSERT_TRUE(testthumb_write_file(source_path, "first version"));
+
+    TestThumbDecoder decoder = {640, 480, 0};
+    ThumbnailCacheConfig config = {TEST_THUMB_ROOT, 64, 1U, testthumb_decode, &decoder, 0U};
+    uint64_t key = 0U;
+    ASSERT_TRUE(thumbnail_cache_key(source_path, 64, &key));
+    char cached_path[256];
+    (void)snprintf(cached_path, sizeof(cached_path), "%s/%016llx.thumb", TEST_THUMB_ROOT, (unsigned long long)key);
+    (void)remove(cached_path);
+
+    ThumbnailImage image = {NULL, 0, 0};
+    bool cache_hit = true;
+    char error[128];
+    ASSERT_TRUE(thumbnail_cache_load_or_build(&config, source_path, &image, &cache_hit, error, sizeof(error)));
+    ASSERT_FALSE(cache_hit);
+    ASSERT_EQ(decoder.calls, 1);
+    ASSERT_EQ(image.width, 64);
+    ASSERT_EQ(image.height, 48);
+    unsigned char first_pixel = image.pixels[0];
+    thumbnail_image_reset(&image);
+
+    ASSERT_TRUE(thumbnail_cache_load_or_build(&config, source_path, &image, &cache_hit, error, sizeof(error)));
+    ASSERT_TRUE(cache_hit);
+    ASSERT_EQ(decoder.calls, 1);
+    ASSERT_EQ(image.width, 64);
+    ASSERT_EQ(image.pixels[0], first_pixel);
+    thumbnail_image_reset(&image);
+
+    /* A different size means a different key, so the stale thumbnail is never served. */
+    ASSERT_TRUE(testthumb_write_file(source_path, "second, longer version"));
+    uint64_t changed_key = 0U;
+    ASSERT_TRUE(thumbnail_cache_key(source_path, 64, &changed_key));
+    ASSERT_TRUE(changed_key != key);
+    ASSERT_TRUE(thumbnail_cache_load_or_build(&config, source_path, &image, &cache_hit, error, sizeof(error)));
+    ASSERT_FALSE(cache_hit);
+    ASSERT_EQ(decoder.calls, 2);
+    thumbnail_image_reset(&image);
+
+    ASSERT_FALSE(thumbnail_cache_load_or_build(&config, "Testing/Temporary/thumbnail_missing.png", &image,
+                                               &cache_hit, error, sizeof(error)));
+    ASSERT_TRUE(strstr(error, "not found") != NULL);
+
+    (void)remove(source_path);
+}
+
+TEST(test_thumbnail_cache_fetches_on_workers)
+{
+    testthumb_create_directory("Testing");
+    testthumb_create_directory("Testing/Temporary");
+    const char *source_path = "Testing/Temporary/thumbnail_async.png";
+    ASSERT_TRUE(testthumb_write_file(source_path, "async source"));
+
+    ThumbnailCacheConfig config = {TEST_THUMB_ROOT, 30, 2U, testthumb_decode_portrait, NULL, 0U};
+    ThumbnailCache *cache = thumbnail_cache_create(&config);
+    ASSERT_NOT_NULL(cache);
+
+    ThumbnailImage image = {NULL, 0, 0};
+    ThumbnailStatus status = thumbnail_cache_fetch(cache, source_path, &image);
+    ASSERT_TRUE(status == THUMBNAIL_STATUS_PENDING || status == THUMBNAIL_STATUS_READY);
+    (void)thumbnail_cache_fetch(cache, "Testing/Temporary/thumbnail_async_missing.png", &image);
+    thumbnail_cache_wait_idle(cache);
+
+    ASSERT_EQ(thumbnail_cache_fetch(cache, source_path, &image), THUMBNAIL_STATUS_READY);
+    ASSERT_NOT_NULL(image.pixels);
+    ASSERT_EQ(image.width, 23);
+    ASSERT_EQ(image.height, 30);
+    thumbnail_image_reset(&image);
+    ASSERT_EQ(thumbnail_cache_fetch(cache, "Testing/Temporary/thumbnail_async_missing.png", &image),
+              THUMBNAIL_STATUS_FAILED);
+    ASSERT_NULL(image.pixels);
+
+    /* Taken results are forgotten; the next fetch is served from disk. */
+    ASSERT_EQ(thumbnail_cache_fetch(cache, source_path, &image), THUMBNAIL_STATUS_PENDING);
+    thumbnail_cache_wait_idle(cache);
+    ASSERT_EQ(thumbnail_cache_fetch(cache, source_path, &image), THUMBNAIL_STATUS_READY);
+    thumbnail_image_reset(&image);
+
+    thumbnail_cache_destroy(cache);
+    (void)remove(source_path);
+}
+
+TEST(test_thumbnail_cache_prefetch_stays_within_budget)
+{
+    testthumb_create_directory("Testing");
+    testthumb_create_directory("Testing/Temporary");
+    const char *paths[3] = {"Testing/Temporary/thumbnail_prefetch_a.png", "Testing/Temporary/thumbnail_prefetch_b.png",
+                            "Testing/Temporary/thumbnail_prefetch_c.png"};
+    for (size_t index = 0U; index < 3U; ++index)
+    {
+        ASSERT_TRUE(testthumb_write_file(paths[index], paths[index]));
+    }
+    const char *missing_path = "Testing/Temporary/thumbnail_prefetch_missing.png";
+    const size_t thumbnail_bytes = 23U * 30U * 4U;
+
+    /* Room for two decoded thumbnails. */
+    ThumbnailCacheConfig config = {TEST_THUMB_ROOT, 30, 1U, testthumb_decode_portrait, NULL, thumbnail_bytes * 2U};
+    ThumbnailCache *cache = thumbnail_cache_create(&config);
+    ASSERT_NOT_NULL(cache);
+    bool exists = true;
+    ASSERT_FALSE(thumbnail_cache_lookup_exists(cache, missing_path, &exists));
+    for (size_t index = 0U; index < 3U; ++index)
+    {
+        ASSERT_TRUE(thumbnail_cache_prefetch(cache, paths[index]));
+    }
+    ASSERT_TRUE(thumbnail_cache_prefetch(cache, missing_path));
+    ASSERT_FALSE(thumbnail_cache_prefetch(cache, paths[2]));
+    thumbnail_cache_wait_idle(cache);
+
+    ThumbnailCacheStats stats;
+    thumbnail_cache_get_stats(cache, &stats);
+    ASSERT_EQ(stats.prefetched_bytes, thumbnail_bytes * 2U);
+    ASSERT_EQ(stats.prefetch_evictions, 1U);
+    /* A failed prefetch is forgotten rather than remembered as missing; the file may still appear. */
+    ASSERT_FALSE(thumbnail_cache_lookup_exists(cache, missing_path, &exists));
+    ASSERT_TRUE(thumbnail_cache_prefetch(cache, missing_path));
+    thumbnail_cache_wait_idle(cache);
+    ASSERT_TRUE(thumbnail_cache_lookup_exists(cache, paths[2], &exists));
+    ASSERT_TRUE(exists);
+
+    /* The newest results survived and are handed out without waiting; the evicted one is queued again. */
+    ThumbnailImage image = {NULL, 0, 0};
+    ASSERT_EQ(thumbnail_cache_fetch(cache, paths[2], &image), THUMBNAIL_STATUS_READY);
+    ASSERT_EQ(image.width, 23);
+    thumbnail_image_reset(&image);
+    ASSERT_EQ(thumbnail_cache_fetch(cache, paths[0], &image), THUMBNAIL_STATUS_PENDING);
+    thumbnail_cache_wait_idle(cache);
+    thumbnail_cache_get_stats(cache, &stats);
+    ASSERT_EQ(stats.prefetch_hits, 1U);
+    ASSERT_EQ(stats.prefetched_bytes, thumbnail_bytes);
+
+    thumbnail_cache_destroy(cache);
+    for (size_t index = 0U; index < 3U; ++index)
+    {
+        (void)remove(paths[index]);
+    }
+}
+
+TEST(test_thumbnail_cache_retries_failures_once_reported)
+{
+    testthumb_create_directory("Testing");
+    testthumb_create_directory("Testing/Temporary");
+    ThumbnailCacheConfig config = {TEST_THUMB_ROOT, 30, 2U, testthumb_decode_portrait, NULL, 0U};
+    ThumbnailCache *cache = thumbnail_cache_create(&config);
+    ASSERT_NOT_NULL(cache);
+
+    /* Enough requests to grow the path index and exercise removal from it. */
+    char paths[48][64];
+    ThumbnailImage image = {NULL, 0, 0};
+    for (size_t index = 0U; index < 48U; ++index)
+    {
+        (void)snprintf(paths[index], sizeof(paths[index]), "Testing/Temporary/thumbnail_late_%02u.png",
+                       (unsigned int)index);
+        (void)remove(paths[index]);
+        ASSERT_EQ(thumbnail_cache_fetch(cache, paths[index], &image), THUMBNAIL_STATUS_PENDING);
+    }
+    thumbnail_cache_wait_idle(cache);
+
+    bool exists = true;
+    for (size_t index = 0U; index < 48U; ++index)
+    {
+        ASSERT_FALSE(thumbnail_cache_lookup_exists(cache, paths[index], &exists));
+        ASSERT_EQ(thumbnail_cache_fetch(cache, paths[index], &image), THUMBNAIL_STATUS_FAILED);
+    }
+
+    /* Half the files show up after the failure was reported; the next fetch picks them up. */
+    for (size_t index = 0U; index < 48U; index += 2U)
+    {
+        ASSERT_TRUE(testthumb_write_file(paths[index], paths[index]));
+    }
+    for (size_t index = 0U; index < 48U; ++index)
+    {
+        ASSERT_EQ(thumbnail_cache_fetch(cache, paths[index], &image), THUMBNAIL_STATUS_PENDING);
+    }
+    thumbnail_cache_wait_idle(cache);
+    for (size_t index = 0U; index < 48U; ++index)
+    {
+        bool known = thumbnail_cache_lookup_exists(cache, paths[index], &exists);
+        ASSERT_EQ(known, index % 2U == 0U);
+        ThumbnailStatus expected = (index % 2U == 0U) ? THUMBNAIL_STATUS_READY : THUMBNAIL_STATUS_FAILED;
+        ASSERT_EQ(thumbnail_cache_fetch(cache, paths[index], &image), expected);
+        thumbnail_image_reset(&image);
+    }
+
+    thumbnail_cache_destroy(cache);
+    for (size_t index = 0U; index < 48U; index += 2U)
+    {
+        (void)remove(paths[index]);
+    }
+}
+
+void register_thumbnail_cache_tests(TestRegistry *registry)
+{
+    REGISTER_TEST(registry, test_thumbnail_downscale_box_filters_and_keeps_aspect);
+    REGISTER_TEST(registry, test_thumbnail_cache_reuses_until_source_changes);
+    REGISTER_TEST(registry, test_thumbnail_cache_fetches_on_workers);
+    REGISTER_TEST(registry, test_thumbnail_cache_prefetch_stays_within_budget);
+    REGISTER_TEST(registry, test_thumbnail_cache_retries_failures_once_reported);
+}
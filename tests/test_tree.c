@@ -91,6 +91,50 @@ TEST(test_tree_detects_cycles)
 
     char buffer[128];
     ASSERT_FALSE(family_tree_validate(tree, buffer, sizeof(buffer)));
+    ASSERT_STREQ(buffer, "Cycle detected involving person 20: 20 -> 21 -> 20");
+    ASSERT_FALSE(family_tree_check_cycles(tree, buffer, sizeof(buffer)));
+
+    family_tree_destroy(tree);
+}
+
+TEST(test_tree_validates_deep_lineage_iteratively)
+{
+    enum
+    {
+        GENERATIONS = 5000
+    };
+    FamilyTree *tree = family_tree_create("Deep");
+    ASSERT_NOT_NULL(tree);
+    Person *first = NULL;
+    Person *previous = NULL;
+    for (uint32_t generation = 0U; generation < GENERATIONS; ++generation)
+    {
+        Person *person = family_tree_create_person(tree, generation + 1U);
+        ASSERT_NOT_NULL(person);
+        ASSERT_TRUE(family_tree_add_person(tree, person));
+        ASSERT_TRUE(person_set_name(person, "Heir", NULL, "Line"));
+        ASSERT_TRUE(person_set_birth(person, "1900-01-01", "Town"));
+        if (previous)
+        {
+            ASSERT_TRUE(person_add_child(previous, person));
+        }
+        else
+        {
+            first = person;
+        }
+        previous = person;
+    }
+
+    /* Deeper than any recursive walk should be trusted with, and not a cycle. */
+    char buffer[128];
+    ASSERT_TRUE(family_tree_validate(tree, buffer, sizeof(buffer)));
+    ASSERT_TRUE(person_validate(first, buffer, sizeof(buffer)));
+
+    ASSERT_TRUE(person_add_child(previous, first));
+    ASSERT_FALSE(family_tree_check_cycles(tree, buffer, sizeof(buffer)));
+    ASSERT_TRUE(strncmp(buffer, "Cycle detected involving person 1: 1 -> 2 -> 3", 46U) == 0);
+    ASSERT_FALSE(person_validate(first, buffer, sizeof(buffer)));
+    ASSERT_STREQ(buffer, "Person 1 participates in a relationship cycle");
 
     family_tree_destroy(tree);
 }
@@ -135,6 +179,89 @@ TEST(test_tree_root_detection)
     family_tree_destroy(tree);
 }
 
+TEST(test_tree_clone_remaps_relationships)
+{
+    FamilyTree *tree = family_tree_create("Clone Source");
+    ASSERT_NOT_NULL(tree);
+    Person *parent = person_create(40U);
+    Person *spouse = person_create(41U);
+    Person *child = person_create(42U);
+    ASSERT_TRUE(person_set_name(parent, "Grace", NULL, "Hopper"));
+    ASSERT_TRUE(person_set_birth(parent, "1906-12-09", "New York"));
+    ASSERT_TRUE(person_set_name(spouse, "Vincent", NULL, "Hopper"));
+    ASSERT_TRUE(person_set_birth(spouse, "1906-01-01", NULL));
+    ASSERT_TRUE(person_set_name(child, "Ada", NULL, "Hopper"));
+    ASSERT_TRUE(person_set_birth(child, "1930-02-02", NULL));
+    ASSERT_TRUE(person_metadata_set(child, "note", "cloned"));
+    ASSERT_TRUE(person_add_certificate(child, "certs/ada.png"));
+    ASSERT_TRUE(person_add_spouse(parent, spouse));
+    ASSERT_TRUE(person_set_marriage(parent, spouse, "1930-06-15", "Poughkeepsie"));
+    ASSERT_TRUE(person_add_child(parent, child));
+    ASSERT_TRUE(family_tree_add_person(tree, parent));
+    ASSERT_TRUE(family_tree_add_person(tree, spouse));
+    ASSERT_TRUE(family_tree_add_person(tree, child));
+
+    FamilyTree *clone = family_tree_clone(tree);
+    ASSERT_NOT_NULL(clone);
+    ASSERT_EQ(clone->person_count, 3U);
+    ASSERT_STREQ(clone->name, "Clone Source");
+    Person *clone_parent = family_tree_find_person(clone, 40U);
+    Person *clone_spouse = family_tree_find_person(clone, 41U);
+    Person *clone_child = family_tree_find_person(clone, 42U);
+    ASSERT_NOT_NULL(clone_parent);
+    ASSERT_NOT_NULL(clone_child);
+    ASSERT_TRUE(clone_parent != parent);
+    ASSERT_EQ(clone_parent->children[0], clone_child);
+    ASSERT_EQ(clone_child->parents[0], clone_parent);
+    ASSERT_EQ(clone_parent->spouses[0].partner, clone_spouse);
+    ASSERT_STREQ(clone_spouse->spouses[0].marriage_location, "Poughkeepsie");
+    ASSERT_STREQ(clone_child->metadata[0].value, "cloned");
+    ASSERT_STREQ(clone_child->certificate_paths[0], "certs/ada.png");
+    ASSERT_EQ(clone_parent->name.last, clone_child->name.last);
+
+    char error[128];
+    ASSERT_TRUE(family_tree_validate(clone, error, sizeof(error)));
+
+    ASSERT_TRUE(person_set_name(parent, "Changed", NULL, "Name"));
+    ASSERT_STREQ(clone_parent->name.first, "Grace");
+
+    family_tree_destroy(clone);
+    family_tree_destroy(tree);
+}
+
+TEST(test_tree_shares_member_strings)
+{
+    FamilyTree *tree = family_tree_create("Pooled");
+    ASSERT_NOT_NULL(tree);
+    Person *first = person_create(60U);
+    Person *second = person_create(61U);
+    ASSERT_TRUE(person_set_name(first, "Katherine", NULL, "Johnson"));
+    ASSERT_TRUE(person_set_birth(first, "1918-08-26", "White Sulphur Springs"));
+    ASSERT_TRUE(person_set_name(second, "Joylette", NULL, "Johnson"));
+    ASSERT_TRUE(person_set_birth(second, "1939-01-01", "White Sulphur Springs"));
+    ASSERT_TRUE(family_tree_add_person(tree, first));
+    ASSERT_TRUE(family_tree_add_person(tree, second));
+
+    ASSERT_EQ(first->name.last, second->name.last);
+    ASSERT_EQ(first->dates.birth_location, second->dates.birth_location);
+    AtStringPoolStats stats;
+    family_tree_get_string_stats(tree, &stats);
+    ASSERT_EQ(stats.bytes_saved, sizeof("Johnson") + sizeof("White Sulphur Springs"));
+
+    /* Updating one member must not leak into the other through the shared copy. */
+    ASSERT_TRUE(person_set_name(second, "Joylette", NULL, "Hylick"));
+    ASSERT_STREQ(first->name.last, "Johnson");
+
+    /* Extracted members own private strings that outlive the tree. */
+    Person *extracted = family_tree_extract_person(tree, 60U);
+    ASSERT_EQ(extracted, first);
+    family_tree_destroy(tree);
+    ASSERT_STREQ(extracted->name.last, "Johnson");
+    ASSERT_STREQ(extracted->dates.birth_location, "White Sulphur Springs");
+    ASSERT_TRUE(person_set_birth(extracted, "1918-08-26", "Hampton"));
+    person_destroy(extracted);
+}
+
 void register_tree_tests(TestRegistry *registry)
 {
     REGISTER_TEST(registry, test_tree_add_person_and_find);
@@ -142,5 +269,8 @@ void register_tree_tests(TestRegistry *registry)
     REGISTER_TEST(registry, test_tree_remove_person);
     REGISTER_TEST(registry, test_tree_relationship_validation);
     REGISTER_TEST(registry, test_tree_detects_cycles);
+    REGISTER_TEST(registry, test_tree_validates_deep_lineage_iteratively);
     REGISTER_TEST(registry, test_tree_root_detection);
+    REGISTER_TEST(registry, test_tree_clone_remaps_relationships);
+    REGISTER_TEST(registry, test_tree_shares_member_strings);
 }
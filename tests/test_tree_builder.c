@@ -0,0 +1,84 @@
+#include "test_framework.h"
+#include "tree_builder.h"
+
+#include <string.h>
+
+static Person *test_tree_builder_person(FamilyTreeBuilder *builder, uint32_t id, const char *first,
+                                        const char *birth_date)
+{
+    Person *person = family_tree_create_person(family_tree_builder_tree(builder), id);
+    if (person && (!person_set_name(person, first, NULL, "Builder") || !person_set_birth(person, birth_date, "Town") ||
+                   !family_tree_builder_add_person(builder, person)))
+    {
+        person_destroy(person);
+        return NULL;
+    }
+    return person;
+}
+
+TEST(test_tree_builder_resolves_links_in_any_order)
+{
+    FamilyTreeBuilder *builder = family_tree_builder_create("Imported", 4U, 4U);
+    ASSERT_NOT_NULL(builder);
+
+    /* Links may name persons that arrive later. */
+    ASSERT_TRUE(family_tree_builder_add_child(builder, 1U, 3U));
+    ASSERT_TRUE(family_tree_builder_add_spouse(builder, 1U, 2U, "1920-06-01", "Chapel"));
+    Person *father = test_tree_builder_person(builder, 1U, "Aldo", "1890-01-01");
+    Person *mother = test_tree_builder_person(builder, 2U, "Bea", "1892-02-02");
+    Person *child = test_tree_builder_person(builder, 3U, "Cid", "1921-03-03");
+    ASSERT_NOT_NULL(father);
+    ASSERT_NOT_NULL(mother);
+    ASSERT_NOT_NULL(child);
+    ASSERT_TRUE(family_tree_builder_add_child(builder, 2U, 3U));
+    ASSERT_EQ(family_tree_builder_find_person(builder, 2U), mother);
+
+    Person *duplicate = person_create(2U);
+    ASSERT_FALSE(family_tree_builder_add_person(builder, duplicate));
+    person_destroy(duplicate);
+
+    FamilyTreeBuilderStats stats;
+    char error[128];
+    FamilyTree *tree = family_tree_builder_finish(builder, &stats, error, sizeof(error));
+    ASSERT_NOT_NULL(tree);
+    ASSERT_STREQ(tree->name, "Imported");
+    ASSERT_EQ(tree->person_count, 3U);
+    ASSERT_EQ(stats.persons, 3U);
+    ASSERT_EQ(stats.relationships, 3U);
+    ASSERT_TRUE(stats.ingest_seconds >= 0.0 && stats.resolve_seconds >= 0.0 && stats.validate_seconds >= 0.0);
+
+    ASSERT_EQ(father->children_count, 1U);
+    ASSERT_EQ(mother->children[0], child);
+    ASSERT_EQ(child->parents[PERSON_PARENT_FATHER], father);
+    ASSERT_EQ(child->parents[PERSON_PARENT_MOTHER], mother);
+    ASSERT_EQ(mother->spouses_count, 1U);
+    ASSERT_STREQ(father->spouses[0].marriage_date, "1920-06-01");
+    ASSERT_EQ(family_tree_find_person(tree, 3U), child);
+    family_tree_destroy(tree);
+}
+
+TEST(test_tree_builder_fails_on_unknown_reference)
+{
+    FamilyTreeBuilder *builder = family_tree_builder_create(NULL, 0U, 0U);
+    ASSERT_NOT_NULL(builder);
+    ASSERT_NOT_NULL(test_tree_builder_person(builder, 7U, "Dov", "1950-05-05"));
+    ASSERT_TRUE(family_tree_builder_add_child(builder, 7U, 8U));
+    ASSERT_FALSE(family_tree_builder_add_child(builder, 7U, 0U));
+
+    char error[128];
+    ASSERT_NULL(family_tree_builder_finish(builder, NULL, error, sizeof(error)));
+    ASSERT_STREQ(error, "Relationship 7 -> 8 references an unknown person");
+
+    /* Validation runs once at the end; a person missing required fields fails the whole import. */
+    builder = family_tree_builder_create(NULL, 1U, 0U);
+    ASSERT_NOT_NULL(builder);
+    ASSERT_TRUE(family_tree_builder_add_person(builder, person_create(9U)));
+    ASSERT_NULL(family_tree_builder_finish(builder, NULL, error, sizeof(error)));
+    ASSERT_TRUE(strstr(error, "Person 9") != NULL);
+}
+
+void register_tree_builder_tests(TestRegistry *registry)
+{
+    REGISTER_TEST(registry, test_tree_builder_resolves_links_in_any_order);
+    REGISTER_TEST(registry, test_tree_builder_fails_on_unknown_reference);
+}
@@ -0,0 +1,110 @@
+#include "test_framework.h"
+#include "tree_graph.h"
+
+TEST(test_tree_graph_build_lays_out_rows)
+{
+    Person *father = person_create(1U);
+    Person *mother = person_create(2U);
+    Person *child = person_create(3U);
+    Person *outsider = person_create(4U);
+    ASSERT_TRUE(person_add_spouse(father, mother));
+    ASSERT_TRUE(person_add_child(father, child));
+    ASSERT_TRUE(person_add_child(mother, child));
+    ASSERT_TRUE(person_add_child(father, outsider));
+
+    Person *persons[4] = {father, mother, child, father};
+    TreeGraph graph;
+    tree_graph_init(&graph);
+    ASSERT_TRUE(tree_graph_build(&graph, persons, 4U));
+    ASSERT_EQ(graph.count, 4U);
+    ASSERT_EQ(tree_graph_find(&graph, father), 0U);
+    ASSERT_EQ(tree_graph_find(&graph, child), 2U);
+    ASSERT_EQ(tree_graph_find(&graph, outsider), TREE_GRAPH_NONE);
+
+    uint32_t count = 0U;
+    const uint32_t *row = tree_graph_children(&graph, 0U, &count);
+    ASSERT_EQ(count, 1U);
+    ASSERT_EQ(row[0], 2U);
+    row = tree_graph_parents(&graph, 2U, &count);
+    ASSERT_EQ(count, 2U);
+    ASSERT_EQ(row[0], 0U);
+    ASSERT_EQ(row[1], 1U);
+    row = tree_graph_spouses(&graph, 1U, &count);
+    ASSERT_EQ(count, 1U);
+    ASSERT_EQ(row[0], 0U);
+    (void)tree_graph_children(&graph, 3U, &count);
+    ASSERT_EQ(count, 0U);
+    ASSERT_NULL(tree_graph_children(&graph, 4U, &count));
+    ASSERT_EQ(count, 0U);
+
+    tree_graph_reset(&graph);
+    ASSERT_EQ(graph.count, 0U);
+    person_destroy(outsider);
+    person_destroy(child);
+    person_destroy(mother);
+    person_destroy(father);
+}
+
+TEST(test_tree_graph_incremental_edits_keep_rows_reciprocal)
+{
+    enum
+    {
+        CHILD_COUNT = 48
+    };
+    Person *parent = person_create(1U);
+    Person *children[CHILD_COUNT];
+    TreeGraph graph;
+    tree_graph_init(&graph);
+    ASSERT_TRUE(tree_graph_build(&graph, &parent, 1U));
+
+    /* Each new child outgrows the parent's row, so rows move to the tail until a compaction folds them back. */
+    for (uint32_t index = 0U; index < CHILD_COUNT; ++index)
+    {
+        children[index] = person_create(index + 2U);
+        ASSERT_TRUE(person_add_child(parent, children[index]));
+        ASSERT_TRUE(tree_graph_add_person(&graph, children[index]));
+    }
+    ASSERT_EQ(graph.count, (size_t)CHILD_COUNT + 1U);
+    ASSERT_TRUE(graph.children.wasted * 2U <= graph.children.used);
+
+    uint32_t count = 0U;
+    const uint32_t *row = tree_graph_children(&graph, 0U, &count);
+    ASSERT_EQ(count, (uint32_t)CHILD_COUNT);
+    for (uint32_t index = 0U; index < CHILD_COUNT; ++index)
+    {
+        ASSERT_EQ(row[index], index + 1U);
+    }
+    row = tree_graph_parents(&graph, CHILD_COUNT, &count);
+    ASSERT_EQ(count, 1U);
+    ASSERT_EQ(row[0], 0U);
+
+    /* Removal drops the node from its relatives even though their Person links still name it. */
+    ASSERT_TRUE(tree_graph_remove_person(&graph, children[0]));
+    ASSERT_EQ(tree_graph_find(&graph, children[0]), TREE_GRAPH_NONE);
+    row = tree_graph_children(&graph, 0U, &count);
+    ASSERT_EQ(count, (uint32_t)CHILD_COUNT - 1U);
+    ASSERT_EQ(row[0], 2U);
+    (void)tree_graph_parents(&graph, 1U, &count);
+    ASSERT_EQ(count, 0U);
+    ASSERT_FALSE(tree_graph_update_person(&graph, children[0]));
+
+    /* Re-adding the removed person gives it a fresh node. */
+    ASSERT_TRUE(tree_graph_add_person(&graph, children[0]));
+    ASSERT_EQ(tree_graph_find(&graph, children[0]), (uint32_t)CHILD_COUNT + 1U);
+    row = tree_graph_children(&graph, 0U, &count);
+    ASSERT_EQ(count, (uint32_t)CHILD_COUNT);
+    ASSERT_EQ(row[0], (uint32_t)CHILD_COUNT + 1U);
+
+    tree_graph_reset(&graph);
+    for (uint32_t index = 0U; index < CHILD_COUNT; ++index)
+    {
+        person_destroy(children[index]);
+    }
+    person_destroy(parent);
+}
+
+void register_tree_graph_tests(TestRegistry *registry)
+{
+    REGISTER_TEST(registry, test_tree_graph_build_lays_out_rows);
+    REGISTER_TEST(registry, test_tree_graph_incremental_edits_keep_rows_reciprocal);
+}
@@ -0,0 +1,113 @@
+#include "test_framework.h"
+#include "tree_hot.h"
+
+TEST(test_tree_hot_index_packs_links_and_filters)
+{
+    FamilyTree *tree = family_tree_create("Hot");
+    ASSERT_NOT_NULL(tree);
+    Person *father = person_create(10U);
+    Person *mother = person_create(11U);
+    Person *child = person_create(12U);
+    ASSERT_TRUE(person_set_name(father, "Pierre", NULL, "Curie"));
+    ASSERT_TRUE(person_set_birth(father, "1859-05-15", "Paris"));
+    ASSERT_TRUE(person_set_death(father, "1906-04-19", "Paris"));
+    ASSERT_TRUE(person_set_name(mother, "Marie", NULL, "Curie"));
+    ASSERT_TRUE(person_set_birth(mother, "1867-11-07", "Warsaw"));
+    ASSERT_TRUE(person_set_name(child, "Irene", NULL, "Curie"));
+    ASSERT_TRUE(family_tree_add_person(tree, father));
+    ASSERT_TRUE(family_tree_add_person(tree, mother));
+    ASSERT_TRUE(family_tree_add_person(tree, child));
+    ASSERT_TRUE(person_add_spouse(father, mother));
+    ASSERT_TRUE(person_add_child(father, child));
+    ASSERT_TRUE(person_add_child(mother, child));
+
+    TreeHotIndex index;
+    tree_hot_index_init(&index);
+    ASSERT_TRUE(tree_hot_index_build(&index, tree));
+    ASSERT_EQ(sizeof(TreeHotRecord), 32U);
+    ASSERT_EQ(index.count, 3U);
+
+    const TreeHotRecord *hot_father = &index.records[0];
+    const TreeHotRecord *hot_child = &index.records[2];
+    ASSERT_EQ(index.cold[0], father);
+    ASSERT_EQ(hot_father->id, 10U);
+    ASSERT_EQ(hot_father->flags & TREE_HOT_ALIVE, 0U);
+    ASSERT_TRUE((hot_father->flags & TREE_HOT_HAS_BIRTH_YEAR) != 0U);
+    ASSERT_EQ(hot_father->birth_year, 1859);
+    ASSERT_EQ(hot_father->child_count, 1U);
+    ASSERT_EQ(index.edges[hot_father->child_offset], 2U);
+    ASSERT_EQ(hot_father->spouse_count, 1U);
+    ASSERT_EQ(index.edges[hot_father->spouse_offset], 1U);
+
+    ASSERT_EQ(hot_child->parents[PERSON_PARENT_FATHER], 0U);
+    ASSERT_EQ(hot_child->parents[PERSON_PARENT_MOTHER], 1U);
+    ASSERT_TRUE((hot_child->flags & TREE_HOT_ALIVE) != 0U);
+    ASSERT_EQ(hot_child->flags & TREE_HOT_HAS_BIRTH_YEAR, 0U);
+    ASSERT_EQ(tree_hot_index_find(&index, mother), 1U);
+
+    tree_hot_index_reset(&index);
+    ASSERT_EQ(index.count, 0U);
+    family_tree_destroy(tree);
+}
+
+TEST(test_tree_hot_index_drops_links_outside_tree)
+{
+    FamilyTree *tree = family_tree_create("Partial");
+    ASSERT_NOT_NULL(tree);
+    Person *parent = person_create(1U);
+    Person *member = person_create(2U);
+    Person *outsider = person_create(3U);
+    ASSERT_TRUE(person_set_name(parent, "Ada", NULL, "Byron"));
+    ASSERT_TRUE(person_set_name(member, "Anne", NULL, "Byron"));
+    ASSERT_TRUE(family_tree_add_person(tree, parent));
+    ASSERT_TRUE(family_tree_add_person(tree, member));
+    ASSERT_TRUE(person_add_child(parent, member));
+    ASSERT_TRUE(person_add_child(parent, outsider));
+
+    TreeHotIndex index;
+    tree_hot_index_init(&index);
+    ASSERT_TRUE(tree_hot_index_build(&index, tree));
+    ASSERT_EQ(index.records[0].child_count, 1U);
+    ASSERT_EQ(index.edges[index.records[0].child_offset], 1U);
+    ASSERT_EQ(tree_hot_index_find(&index, outsider), TREE_HOT_NONE);
+    tree_hot_index_reset(&index);
+
+    int year = 0;
+    ASSERT_TRUE(tree_hot_parse_year("circa 1815", &year));
+    ASSERT_EQ(year, 1815);
+    ASSERT_FALSE(tree_hot_parse_year("15th", &year));
+
+    family_tree_unlink_person(tree, outsider);
+    person_destroy(outsider);
+    family_tree_destroy(tree);
+}
+
+TEST(test_tree_hot_index_builds_without_links)
+{
+    FamilyTree *tree = family_tree_create("Unlinked");
+    ASSERT_NOT_NULL(tree);
+    Person *first = person_create(1U);
+    Person *second = person_create(2U);
+    ASSERT_TRUE(person_set_name(first, "Ada", NULL, "Lovelace"));
+    ASSERT_TRUE(person_set_name(second, "Alan", NULL, "Turing"));
+    ASSERT_TRUE(family_tree_add_person(tree, first));
+    ASSERT_TRUE(family_tree_add_person(tree, second));
+
+    TreeHotIndex index;
+    tree_hot_index_init(&index);
+    ASSERT_TRUE(tree_hot_index_build(&index, tree));
+    ASSERT_EQ(index.count, 2U);
+    ASSERT_EQ(index.edge_count, 0U);
+    ASSERT_NULL(index.edges);
+    ASSERT_EQ(index.records[1].child_count, 0U);
+    ASSERT_EQ(index.records[1].spouse_count, 0U);
+    tree_hot_index_reset(&index);
+    family_tree_destroy(tree);
+}
+
+void register_tree_hot_tests(TestRegistry *registry)
+{
+    REGISTER_TEST(registry, test_tree_hot_index_packs_links_and_filters);
+    REGISTER_TEST(registry, test_tree_hot_index_drops_links_outside_tree);
+    REGISTER_TEST(registry, test_tree_hot_index_builds_without_links);
+}